@@ -28,6 +28,25 @@ except ImportError:
     import numpy as np
 
 
+# legate.numpy has fused kernels for the level-1 updates that read each
+# vector once, fall back to the plain expressions for other NumPys
+if hasattr(np.linalg, "axpby_dot"):
+    axpy = np.linalg.axpy
+    axpby = np.linalg.axpby
+    axpby_dot = np.linalg.axpby_dot
+else:
+
+    def axpy(a, x, y):
+        return a * x + y
+
+    def axpby(a, x, b, y):
+        return a * x + b * y
+
+    def axpby_dot(a, x, b, y):
+        z = a * x + b * y
+        return z, z.dot(z)
+
+
 # This is technically dead code right now, but we'll keep it around in
 # case we want to generate a symmetrix positive definite matrix later
 def generate_random(N):
@@ -89,9 +108,8 @@ def solve(A, b, conv_iters, max_iters, verbose):
     for i in range(max_iters):
         Ap = A.dot(p)
         alpha = rsold / (p.dot(Ap))
-        x = x + alpha * p
-        r = r - alpha * Ap
-        rsnew = r.dot(r)
+        x = axpy(alpha, p, x)
+        r, rsnew = axpby_dot(-alpha, Ap, 1.0, r)
         # We only do the convergence test every conv_iters or on the last
         # iteration
         if (i % conv_iters == 0 or i == (max_iters - 1)) and np.sqrt(
@@ -102,7 +120,7 @@ def solve(A, b, conv_iters, max_iters, verbose):
         if verbose:
             print("Residual: " + str(rsnew))
         beta = rsnew / rsold
-        p = r + beta * p
+        p = axpby(1.0, r, beta, p)
         rsold = rsnew
     if converged < 0:
         print("Convergence FAILURE!")
@@ -135,9 +153,8 @@ def preconditioned_solve(A, M, b, conv_iters, max_iters, verbose):
     for i in range(max_iters):
         Ap = A.dot(p)
         alpha = rzold / (p.dot(Ap))
-        x = x + alpha * p
-        r = r - alpha * Ap
-        rznew = r.dot(r)
+        x = axpy(alpha, p, x)
+        r, rznew = axpby_dot(-alpha, Ap, 1.0, r)
         # We only do the convergence test every conv_iters or on the
         # last iteration
         if (i % conv_iters == 0 or i == (max_iters - 1)) and np.sqrt(
@@ -150,7 +167,7 @@ def preconditioned_solve(A, M, b, conv_iters, max_iters, verbose):
         z = M.dot(r)
         rznew = r.dot(z)
         beta = rznew / rzold
-        p = z + beta * p
+        p = axpby(1.0, z, beta, p)
         rzold = rznew
     if converged < 0:
         print("Convergence FAILURE!")
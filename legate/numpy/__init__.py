@@ -18,7 +18,7 @@ from __future__ import absolute_import, division, print_function
 import sys as _sys
 
 import numpy as _np
-from legate.numpy import linalg, random
+from legate.numpy import bfloat16, bitmask, fusion, linalg, random
 from legate.numpy.array import ndarray
 from legate.numpy.module import *
 from legate.numpy.ufunc import *
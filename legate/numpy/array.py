@@ -15,8 +15,10 @@
 
 from __future__ import absolute_import, division, print_function
 
+import dis
 import functools
-import warnings
+import os
+import sys
 
 import numpy as np
 import pyarrow
@@ -27,7 +29,7 @@ from legate.core import LegateArray
 from .config import NumPyOpCode
 from .doc_utils import copy_docstring
 from .runtime import runtime
-from .utils import unimplemented
+from .utils import is_sole_reference, unimplemented
 
 try:
     reduce  # Python 2
@@ -40,6 +42,61 @@ except NameError:
     xrange = range  # Python 3
 
 
+# Opcodes that evaluate Python operators, names differ between versions
+_OPERATOR_OPCODES = frozenset(
+    dis.opmap[name]
+    for name in (
+        "BINARY_OP",
+        "BINARY_ADD",
+        "BINARY_SUBTRACT",
+        "BINARY_MULTIPLY",
+        "BINARY_TRUE_DIVIDE",
+        "BINARY_POWER",
+        "UNARY_NEGATIVE",
+    )
+    if name in dis.opmap
+)
+
+
+# Count the references to the operand of an operator method, which must
+# pass its self argument straight in. Only count them when the method was
+# called by the interpreter evaluating an expression since C code calling
+# the method can hold borrowed references that do not show up in the count.
+def _operand_refcount(operand):
+    frame = sys._getframe(2)
+    if frame.f_code.co_code[frame.f_lasti] not in _OPERATOR_OPCODES:
+        return 0
+    return sys.getrefcount(operand)
+
+
+class _RefcountProbe(object):
+    def __add__(self, rhs):
+        return _operand_refcount(self)
+
+    def __radd__(self, lhs):
+        return _operand_refcount(self)
+
+    def __neg__(self):
+        return _operand_refcount(self)
+
+
+# Count the references to an operand that only lives on the interpreter
+# stack and check that a named operand has exactly one more
+def _temporary_refcount():
+    named = _RefcountProbe()
+    counts = (_RefcountProbe() + 0, 0 + _RefcountProbe(), -_RefcountProbe())
+    named_counts = (named + 0, 0 + named, -named)
+    if counts[0] == 0 or any(
+        count != counts[0] or named_count != count + 1
+        for count, named_count in zip(counts, named_counts)
+    ):
+        return None
+    return counts[0]
+
+
+_TEMPORARY_REFCOUNT = _temporary_refcount()
+
+
 @copy_docstring(np.ndarray)
 class ndarray(object):
     def __init__(
@@ -245,8 +302,14 @@ class ndarray(object):
         return self.perform_unary_op(NumPyOpCode.ABSOLUTE, self)
 
     def __add__(self, rhs):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         rhs_array = self.convert_to_legate_ndarray(rhs)
-        return self.perform_binary_op(NumPyOpCode.ADD, self, rhs_array)
+        return self.perform_binary_op(
+            NumPyOpCode.ADD,
+            self,
+            rhs_array,
+            out=self._elision_target(temporary, rhs_array),
+        )
 
     def __and__(self, rhs):
         rhs_array = self.convert_to_legate_ndarray(rhs)
@@ -477,6 +540,22 @@ class ndarray(object):
         self.perform_binary_op(NumPyOpCode.SUBTRACT, self, rhs_array, out=self)
         return self
 
+    # Return this array as the output of an operator with the other operand
+    # when this array is a temporary whose storage can be overwritten
+    # instead of allocating new storage for the result
+    def _elision_target(self, temporary, other):
+        if not temporary or self.size <= 1:
+            return None
+        if broadcast_shapes(self.shape, other.shape) != self.shape:
+            return None
+        if self.find_common_type(self, other) != self.dtype:
+            return None
+        if not is_sole_reference(self, "_thunk"):
+            return None
+        if not self._thunk.owns_storage():
+            return None
+        return self
+
     def internal_truediv(self, rhs, inplace, stacklevel):
         rhs_array = self.convert_to_legate_ndarray(
             rhs, stacklevel=(stacklevel + 1)
@@ -565,8 +644,14 @@ class ndarray(object):
         return self.perform_binary_op(NumPyOpCode.MOD, self, rhs_array)
 
     def __mul__(self, rhs):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         rhs_array = self.convert_to_legate_ndarray(rhs)
-        return self.perform_binary_op(NumPyOpCode.MULTIPLY, self, rhs_array)
+        return self.perform_binary_op(
+            NumPyOpCode.MULTIPLY,
+            self,
+            rhs_array,
+            out=self._elision_target(temporary, rhs_array),
+        )
 
     def __ne__(self, rhs):
         rhs_array = self.convert_to_legate_ndarray(rhs)
@@ -578,13 +663,18 @@ class ndarray(object):
         )
 
     def __neg__(self):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         if (
             self.dtype.type == np.uint16
             or self.dtype.type == np.uint32
             or self.dtype.type == np.uint64
         ):
             raise TypeError("cannot negate unsigned type " + str(self.dtype))
-        return self.perform_unary_op(NumPyOpCode.NEGATIVE, self)
+        return self.perform_unary_op(
+            NumPyOpCode.NEGATIVE,
+            self,
+            dst=self._elision_target(temporary, self),
+        )
 
     # __new__
 
@@ -670,7 +760,15 @@ class ndarray(object):
         return self.perform_binary_op(NumPyOpCode.POWER, self, rhs_array)
 
     def __radd__(self, lhs):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         lhs_array = self.convert_to_legate_ndarray(lhs)
+        out = self._elision_target(temporary, lhs_array)
+        # The inplace tasks only alias their first operand with the output
+        # so the operands swap places when we write into this array
+        if out is not None:
+            return self.perform_binary_op(
+                NumPyOpCode.ADD, self, lhs_array, out=out
+            )
         return self.perform_binary_op(NumPyOpCode.ADD, lhs_array, self)
 
     def __rand__(self, lhs):
@@ -708,7 +806,13 @@ class ndarray(object):
         return self.perform_binary_op(NumPyOpCode.MODULUS, lhs_array, self)
 
     def __rmul__(self, lhs):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         lhs_array = self.convert_to_legate_ndarray(lhs)
+        out = self._elision_target(temporary, lhs_array)
+        if out is not None:
+            return self.perform_binary_op(
+                NumPyOpCode.MULTIPLY, self, lhs_array, out=out
+            )
         return self.perform_binary_op(NumPyOpCode.MULTIPLY, lhs_array, self)
 
     def __ror__(self, lhs):
@@ -760,8 +864,14 @@ class ndarray(object):
         return self.__array__(stacklevel=2).__sizeof__(*args, **kwargs)
 
     def __sub__(self, rhs):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
         rhs_array = self.convert_to_legate_ndarray(rhs)
-        return self.perform_binary_op(NumPyOpCode.SUBTRACT, self, rhs_array)
+        return self.perform_binary_op(
+            NumPyOpCode.SUBTRACT,
+            self,
+            rhs_array,
+            out=self._elision_target(temporary, rhs_array),
+        )
 
     def __str__(self):
         if self.size == 1:
@@ -774,8 +884,16 @@ class ndarray(object):
             return str(self.__array__(stacklevel=2))
 
     def __truediv__(self, rhs, stacklevel=1):
+        temporary = _operand_refcount(self) == _TEMPORARY_REFCOUNT
+        if temporary and self.dtype.kind in ("f", "c"):
+            rhs = self.convert_to_legate_ndarray(
+                rhs, stacklevel=(stacklevel + 1)
+            )
+            temporary = self._elision_target(temporary, rhs) is not None
+        else:
+            temporary = False
         return self.internal_truediv(
-            rhs, inplace=False, stacklevel=(stacklevel + 1)
+            rhs, inplace=temporary, stacklevel=(stacklevel + 1)
         )
 
     def __xor__(self, rhs):
@@ -884,34 +1002,61 @@ class ndarray(object):
         )
         return self.convert_to_legate_ndarray(numpy_array, stacklevel=3)
 
+    @staticmethod
+    def _clip_limit(dtype, upper):
+        # A missing bound of clip never moves any value
+        if dtype.kind in ("i", "u"):
+            info = np.iinfo(dtype)
+            return info.max if upper else info.min
+        if dtype.kind == "b":
+            return upper
+        return np.inf if upper else -np.inf
+
     def clip(self, min=None, max=None, out=None):
-        args = (
-            np.array(min, dtype=self.dtype),
-            np.array(max, dtype=self.dtype),
-        )
-        if (args[0] is not None and args[0].size != 1) or (
-            args[1] is not None and args[1].size != 1
-        ):
-            warnings.warn(
-                "legate.numpy has not implemented clip with array-like "
-                "arguments and is falling back to canonical numpy. You "
-                "may notice significantly decreased performance for this "
-                "function call.",
-                stacklevel=2,
-                category=RuntimeWarning,
+        if min is None and max is None:
+            raise ValueError("One of max or min must be given")
+        if min is None:
+            min = self._clip_limit(self.dtype, upper=False)
+        if max is None:
+            max = self._clip_limit(self.dtype, upper=True)
+        if np.size(min) == 1 and np.size(max) == 1:
+            args = (
+                np.array(min, dtype=self.dtype),
+                np.array(max, dtype=self.dtype),
             )
-            if out is not None:
-                self.__array__(stacklevel=2).clip(min, max, out=out)
-                return self.convert_to_legate_ndarray(
-                    out, stacklevel=2, share=True
-                )
-            else:
-                return self.convert_to_legate_ndarray(
-                    self.__array__.clip(min, max)
-                )
-        return self.perform_unary_op(
-            NumPyOpCode.CLIP, self, dst=out, args=args
-        )
+            return self.perform_unary_op(
+                NumPyOpCode.CLIP, self, dst=out, args=args
+            )
+        # Array bounds are broadcast in the task instead of copied
+        min = self.convert_to_legate_ndarray(min).astype(self.dtype)
+        max = self.convert_to_legate_ndarray(max).astype(self.dtype)
+        out_shape = broadcast_shapes(self.shape, min.shape, max.shape)
+        if out is None:
+            out = ndarray(
+                shape=out_shape, dtype=self.dtype, inputs=(self, min, max)
+            )
+        elif out.shape != out_shape:
+            raise ValueError(
+                "out array shape "
+                + str(out.shape)
+                + " does not match expected shape "
+                + str(out_shape)
+            )
+        if out.dtype != self.dtype:
+            result = ndarray(
+                shape=out_shape, dtype=self.dtype, inputs=(self, min, max)
+            )
+        else:
+            result = out
+        src = self
+        if self.size == 1:
+            # A single value is spread over the whole result first
+            result.fill(self.__array__(stacklevel=2))
+            src = result
+        result._thunk.clip(src._thunk, min._thunk, max._thunk, stacklevel=2)
+        if result is not out:
+            out._thunk.convert(result._thunk, stacklevel=2)
+        return out
 
     @unimplemented
     def compress(self, condition, axis=None, out=None):
@@ -1500,6 +1645,15 @@ class ndarray(object):
         return self.convert_to_legate_ndarray(numpy_array, stacklevel=3)
 
     def tofile(self, fid, sep="", format="%s"):
+        # Raw binary files that we can name are written in parallel by all
+        # the point tasks without bringing the whole array back here
+        if (
+            sep == ""
+            and isinstance(fid, (str, os.PathLike))
+            and runtime.is_file_io_type(self.dtype, self.shape)
+        ):
+            self._thunk.write_file(os.fspath(fid), 0, None, True, stacklevel=2)
+            return
         return self.__array__(stacklevel=2).tofile(
             fid=fid, sep=sep, format=format
         )
@@ -1527,8 +1681,13 @@ class ndarray(object):
             )
             axes = tuple(range(self.ndim - 1, -1, -1))
         elif len(axes) == self.ndim:
+            if any(axis < -self.ndim or axis >= self.ndim for axis in axes):
+                raise ValueError("axis out of range for transpose")
+            axes = tuple(axis % self.ndim for axis in axes)
+            if len(set(axes)) != self.ndim:
+                raise ValueError("repeated axis in transpose")
             result = ndarray(
-                shape=tuple(map(lambda x, y: x[y], self.shape, axes)),
+                shape=tuple(self.shape[axis] for axis in axes),
                 dtype=self.dtype,
                 stacklevel=(stacklevel + 1),
             )
@@ -0,0 +1,337 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from __future__ import absolute_import, division, print_function
+
+import numpy as np
+
+from .array import ndarray
+from .config import NumPyOpCode
+from .module import (
+    absolute as _abs,
+    add as _add,
+    exp as _exp,
+    log as _log,
+    maximum as _max,
+    minimum as _min,
+    multiply as _mul,
+    negative as _neg,
+    sqrt as _sqrt,
+    subtract as _sub,
+    tanh as _tanh,
+    true_divide as _div,
+)
+from .utils import bfloat16_to_float, float_to_bfloat16
+
+_ufuncs = {
+    NumPyOpCode.ADD: _add,
+    NumPyOpCode.SUBTRACT: _sub,
+    NumPyOpCode.MULTIPLY: _mul,
+    NumPyOpCode.DIVIDE: _div,
+    NumPyOpCode.MAXIMUM: _max,
+    NumPyOpCode.MINIMUM: _min,
+    NumPyOpCode.NEGATIVE: _neg,
+    NumPyOpCode.ABSOLUTE: _abs,
+    NumPyOpCode.SQRT: _sqrt,
+    NumPyOpCode.EXP: _exp,
+    NumPyOpCode.LOG: _log,
+    NumPyOpCode.TANH: _tanh,
+}
+
+
+def _is_scalar(value):
+    return np.isscalar(value) or (
+        isinstance(value, (np.ndarray, ndarray)) and value.ndim == 0
+    )
+
+
+class BFloat16Array(object):
+    """An array of bfloat16 values, which are float32 values with only
+    the upper 16 bits of their mantissa kept. The values are stored as
+    their bits in an array of uint16 so they take half the memory of
+    float32 values. The ufuncs here compute in float32 and round their
+    results to the nearest even bfloat16 value, sums accumulate in
+    float32, and dot and matmul widen their operands to float32 tiles
+    before multiplying them.
+
+    Arrays are made with the array function in this module and turned
+    back into arrays of float32 values with astype.
+    """
+
+    def __init__(self, bits):
+        assert bits.dtype == np.uint16
+        self.bits = bits
+
+    @property
+    def shape(self):
+        return self.bits.shape
+
+    @property
+    def ndim(self):
+        return self.bits.ndim
+
+    @property
+    def size(self):
+        return self.bits.size
+
+    @property
+    def nbytes(self):
+        return self.bits.nbytes
+
+    def __len__(self):
+        return len(self.bits)
+
+    def __repr__(self):
+        return "BFloat16Array(" + repr(self.__array__()) + ")"
+
+    def __array__(self, dtype=None):
+        values = bfloat16_to_float(np.asarray(self.bits))
+        return values if dtype is None else values.astype(dtype)
+
+    def __getitem__(self, key):
+        return BFloat16Array(self.bits[key])
+
+    def __setitem__(self, key, value):
+        self.bits[key] = array(value, stacklevel=2).bits
+
+    def astype(self, dtype, stacklevel=1):
+        """Widen the values into a new array of the given type."""
+        dtype = np.dtype(dtype)
+        if dtype == np.float32 or dtype == np.float64:
+            return _widen(self, dtype, stacklevel=(stacklevel + 1))
+        return _widen(self, np.dtype(np.float32), stacklevel + 1).astype(
+            dtype
+        )
+
+    def copy(self):
+        return BFloat16Array(self.bits.copy())
+
+    def _binary(self, op, other, reverse=False):
+        return _binary_ufunc(op, self, other, reverse, stacklevel=3)
+
+    def __add__(self, other):
+        return self._binary(NumPyOpCode.ADD, other)
+
+    def __radd__(self, other):
+        return self._binary(NumPyOpCode.ADD, other, reverse=True)
+
+    def __sub__(self, other):
+        return self._binary(NumPyOpCode.SUBTRACT, other)
+
+    def __rsub__(self, other):
+        return self._binary(NumPyOpCode.SUBTRACT, other, reverse=True)
+
+    def __mul__(self, other):
+        return self._binary(NumPyOpCode.MULTIPLY, other)
+
+    def __rmul__(self, other):
+        return self._binary(NumPyOpCode.MULTIPLY, other, reverse=True)
+
+    def __truediv__(self, other):
+        return self._binary(NumPyOpCode.DIVIDE, other)
+
+    def __rtruediv__(self, other):
+        return self._binary(NumPyOpCode.DIVIDE, other, reverse=True)
+
+    def __neg__(self):
+        return _unary_ufunc(NumPyOpCode.NEGATIVE, self, stacklevel=2)
+
+    def __abs__(self):
+        return _unary_ufunc(NumPyOpCode.ABSOLUTE, self, stacklevel=2)
+
+    def __matmul__(self, other):
+        return matmul(self, other, stacklevel=2)
+
+    def dot(self, other, stacklevel=1):
+        return dot(self, other, stacklevel=(stacklevel + 1))
+
+    def sum(self, axis=None, stacklevel=1):
+        """Sum the values in float32. Summing over every axis returns a
+        float32 value and summing over some of them rounds the sums to a
+        new array of bfloat16 values."""
+        if axis is None:
+            if self.size <= 1:
+                return np.float32(np.sum(self.__array__()))
+            return np.float32(
+                self.bits._thunk.bf16_sum(stacklevel=(stacklevel + 1))
+            )
+        values = self.astype(np.float32, stacklevel=(stacklevel + 1))
+        return array(values.sum(axis=axis), stacklevel=(stacklevel + 1))
+
+    def mean(self, axis=None, stacklevel=1):
+        if axis is None:
+            return np.float32(
+                self.sum(stacklevel=(stacklevel + 1)) / np.float32(self.size)
+            )
+        values = self.astype(np.float32, stacklevel=(stacklevel + 1))
+        return array(values.mean(axis=axis), stacklevel=(stacklevel + 1))
+
+
+def _widen(a, dtype, stacklevel):
+    if a.size <= 1:
+        return ndarray.convert_to_legate_ndarray(
+            np.asarray(a).astype(dtype), stacklevel=(stacklevel + 1)
+        )
+    result = ndarray(shape=a.shape, dtype=dtype, inputs=(a.bits,))
+    result._thunk.bf16_convert(
+        a.bits._thunk, False, stacklevel=(stacklevel + 1)
+    )
+    return result
+
+
+def _narrow(a, stacklevel):
+    a = ndarray.convert_to_legate_ndarray(a, stacklevel=(stacklevel + 1))
+    if a.dtype != np.float32 and a.dtype != np.float64:
+        a = a.astype(np.float32)
+    # Arrays with a single element would live in futures, so we round
+    # those on the host
+    if a.size <= 1:
+        return BFloat16Array(
+            ndarray.convert_to_legate_ndarray(
+                float_to_bfloat16(np.asarray(a)), stacklevel=(stacklevel + 1)
+            )
+        )
+    bits = ndarray(shape=a.shape, dtype=np.dtype(np.uint16), inputs=(a,))
+    bits._thunk.bf16_convert(a._thunk, True, stacklevel=(stacklevel + 1))
+    return BFloat16Array(bits)
+
+
+def _unary_ufunc(op, a, stacklevel):
+    if a.size <= 1:
+        values = _widen(a, np.dtype(np.float32), stacklevel=(stacklevel + 1))
+        return _narrow(_ufuncs[op](values), stacklevel=(stacklevel + 1))
+    bits = ndarray(shape=a.shape, dtype=np.dtype(np.uint16), inputs=(a.bits,))
+    bits._thunk.bf16_ufunc(
+        op, a.bits._thunk, None, False, stacklevel=(stacklevel + 1)
+    )
+    return BFloat16Array(bits)
+
+
+def _binary_ufunc(op, a, b, reverse, stacklevel):
+    if _is_scalar(b):
+        b = float(np.asarray(b))
+    elif not isinstance(b, BFloat16Array):
+        # Mixing with arrays of other types follows the promotion rules of
+        # float32 and leaves the result in the wider type
+        b = ndarray.convert_to_legate_ndarray(b, stacklevel=(stacklevel + 1))
+        dtype = np.result_type(np.float32, b.dtype)
+        lhs = a.astype(dtype, stacklevel=(stacklevel + 1))
+        return _ufuncs[op](b, lhs) if reverse else _ufuncs[op](lhs, b)
+    elif reverse:
+        a, b, reverse = b, a, False
+    if a.size > 1 and (not isinstance(b, BFloat16Array) or b.shape == a.shape):
+        inputs = (a.bits,) if isinstance(b, float) else (a.bits, b.bits)
+        bits = ndarray(shape=a.shape, dtype=np.dtype(np.uint16), inputs=inputs)
+        bits._thunk.bf16_ufunc(
+            op,
+            a.bits._thunk,
+            b if isinstance(b, float) else b.bits._thunk,
+            reverse,
+            stacklevel=(stacklevel + 1),
+        )
+        return BFloat16Array(bits)
+    # Broadcasting and single values go through float32 arrays
+    lhs = _widen(a, np.dtype(np.float32), stacklevel=(stacklevel + 1))
+    if isinstance(b, float):
+        rhs = np.float32(b)
+    else:
+        rhs = _widen(b, np.dtype(np.float32), stacklevel=(stacklevel + 1))
+    result = _ufuncs[op](rhs, lhs) if reverse else _ufuncs[op](lhs, rhs)
+    return _narrow(result, stacklevel=(stacklevel + 1))
+
+
+def array(obj, stacklevel=1):
+    """Round the values of an array to a new BFloat16Array."""
+    if isinstance(obj, BFloat16Array):
+        return obj.copy()
+    return _narrow(obj, stacklevel=(stacklevel + 1))
+
+
+def frombits(bits, stacklevel=1):
+    """Wrap an array of uint16 that already holds bfloat16 bits."""
+    bits = ndarray.convert_to_legate_ndarray(bits, stacklevel=(stacklevel + 1))
+    if bits.dtype != np.uint16:
+        raise TypeError("bfloat16 bits must be stored as uint16")
+    return BFloat16Array(bits)
+
+
+def _widen_operand(a, stacklevel):
+    if isinstance(a, BFloat16Array):
+        return _widen(a, np.dtype(np.float32), stacklevel=(stacklevel + 1))
+    return ndarray.convert_to_legate_ndarray(
+        a, stacklevel=(stacklevel + 1)
+    ).astype(np.float32)
+
+
+def dot(a, b, stacklevel=1):
+    """Multiply bfloat16 arrays with the float32 dot product after widening
+    both of them and round the products back to bfloat16."""
+    lhs = _widen_operand(a, stacklevel=(stacklevel + 1))
+    rhs = _widen_operand(b, stacklevel=(stacklevel + 1))
+    return _narrow(lhs.dot(rhs), stacklevel=(stacklevel + 1))
+
+
+def matmul(a, b, stacklevel=1):
+    lhs = _widen_operand(a, stacklevel=(stacklevel + 1))
+    rhs = _widen_operand(b, stacklevel=(stacklevel + 1))
+    return _narrow(lhs @ rhs, stacklevel=(stacklevel + 1))
+
+
+def _as_bfloat16(a, stacklevel):
+    if isinstance(a, BFloat16Array):
+        return a
+    return _narrow(a, stacklevel=(stacklevel + 1))
+
+
+def maximum(a, b, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _binary_ufunc(
+        NumPyOpCode.MAXIMUM, a, b, False, stacklevel=(stacklevel + 1)
+    )
+
+
+def minimum(a, b, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _binary_ufunc(
+        NumPyOpCode.MINIMUM, a, b, False, stacklevel=(stacklevel + 1)
+    )
+
+
+def sqrt(a, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _unary_ufunc(NumPyOpCode.SQRT, a, stacklevel=(stacklevel + 1))
+
+
+def exp(a, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _unary_ufunc(NumPyOpCode.EXP, a, stacklevel=(stacklevel + 1))
+
+
+def log(a, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _unary_ufunc(NumPyOpCode.LOG, a, stacklevel=(stacklevel + 1))
+
+
+def tanh(a, stacklevel=1):
+    a = _as_bfloat16(a, stacklevel=(stacklevel + 1))
+    return _unary_ufunc(NumPyOpCode.TANH, a, stacklevel=(stacklevel + 1))
+
+
+def sum(a, axis=None, stacklevel=1):
+    return a.sum(axis=axis, stacklevel=(stacklevel + 1))
+
+
+def mean(a, axis=None, stacklevel=1):
+    return a.mean(axis=axis, stacklevel=(stacklevel + 1))
@@ -0,0 +1,256 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from __future__ import absolute_import, division, print_function
+
+import numpy as np
+
+from .array import ndarray
+from .config import NumPyOpCode
+from .module import (
+    equal as _eq,
+    greater as _gt,
+    greater_equal as _geq,
+    less as _lt,
+    less_equal as _leq,
+    not_equal as _neq,
+)
+from .runtime import runtime
+from .utils import calculate_volume
+
+_comparisons = {
+    NumPyOpCode.EQUAL: _eq,
+    NumPyOpCode.NOT_EQUAL: _neq,
+    NumPyOpCode.LESS: _lt,
+    NumPyOpCode.LESS_EQUAL: _leq,
+    NumPyOpCode.GREATER: _gt,
+    NumPyOpCode.GREATER_EQUAL: _geq,
+}
+
+
+def _num_words(size):
+    # Masks always get at least two words so that the words never end up
+    # in a future, any words past the last element are simply left clear
+    return max((size + 63) // 64, 2)
+
+
+def _host_words(bits):
+    packed = np.packbits(np.ravel(bits), bitorder="little")
+    words = np.zeros(_num_words(np.size(bits)) * 8, dtype=np.uint8)
+    words[: packed.size] = packed
+    return ndarray.convert_to_legate_ndarray(
+        words.view("<u8").astype(np.uint64)
+    )
+
+
+class BitMask(object):
+    """A boolean array that keeps one bit for each of its elements, in C
+    order, in 64-bit words. Masks take an eighth of the memory of an
+    array of bools and the logical operations, counts and searches on
+    them work on whole words at a time.
+
+    Masks are made by comparing arrays with the functions in this module
+    and turned back into arrays of bools with unpack.
+    """
+
+    def __init__(self, shape, words):
+        self.shape = shape
+        self.size = calculate_volume(shape)
+        self.words = words
+
+    @property
+    def ndim(self):
+        return len(self.shape)
+
+    @property
+    def nbytes(self):
+        return self.words.nbytes
+
+    def __repr__(self):
+        return "BitMask(" + repr(self.unpack(stacklevel=2)) + ")"
+
+    def _logical(self, op, other, stacklevel):
+        if other is not None:
+            if not isinstance(other, BitMask):
+                raise TypeError("logical operations need two bitmasks")
+            if other.shape != self.shape:
+                raise ValueError("bitmasks must have the same shape")
+        inputs = (self.words,) if other is None else (self.words, other.words)
+        words = ndarray(
+            shape=self.words.shape,
+            dtype=np.dtype(np.uint64),
+            inputs=inputs,
+        )
+        words._thunk.bitmask_logical(
+            op,
+            self.words._thunk,
+            None if other is None else other.words._thunk,
+            self.size,
+            stacklevel=(stacklevel + 1),
+        )
+        return BitMask(self.shape, words)
+
+    def __and__(self, other):
+        return self._logical(NumPyOpCode.LOGICAL_AND, other, stacklevel=2)
+
+    def __or__(self, other):
+        return self._logical(NumPyOpCode.LOGICAL_OR, other, stacklevel=2)
+
+    def __xor__(self, other):
+        return self._logical(NumPyOpCode.LOGICAL_XOR, other, stacklevel=2)
+
+    def __invert__(self):
+        return self._logical(NumPyOpCode.LOGICAL_NOT, None, stacklevel=2)
+
+    def count_nonzero(self, stacklevel=1):
+        """Count the elements that are set with one popcount for every 64
+        of them."""
+        if self.size == 0:
+            return 0
+        return self.words._thunk.bitmask_count(stacklevel=(stacklevel + 1))
+
+    def any(self, stacklevel=1):
+        return self.count_nonzero(stacklevel=(stacklevel + 1)) > 0
+
+    def all(self, stacklevel=1):
+        return self.count_nonzero(stacklevel=(stacklevel + 1)) == self.size
+
+    def nonzero(self, stacklevel=1):
+        """Return the indices of the elements that are set in each
+        dimension like numpy.nonzero."""
+        thunk = self.words._thunk.bitmask_nonzero(stacklevel=(stacklevel + 1))
+        flat = ndarray(shape=thunk.shape, thunk=thunk)
+        if self.ndim <= 1:
+            return (flat,)
+        result = ()
+        stride = self.size
+        for extent in self.shape:
+            stride //= extent
+            result += ((flat // np.uint64(stride)) % np.uint64(extent),)
+        return result
+
+    def unpack(self, stacklevel=1):
+        """Expand the mask into an array of bools with the same shape."""
+        if self.size <= 1:
+            bits = np.unpackbits(
+                np.asarray(self.words).astype("<u8").view(np.uint8),
+                count=self.size,
+                bitorder="little",
+            )
+            return ndarray.convert_to_legate_ndarray(
+                bits.astype(np.bool_).reshape(self.shape)
+            )
+        result = ndarray(
+            shape=(self.size,),
+            dtype=np.dtype(np.bool_),
+            inputs=(self.words,),
+        )
+        result._thunk.unpack_bits(
+            self.words._thunk, stacklevel=(stacklevel + 1)
+        )
+        if self.ndim == 1:
+            return result
+        return result.reshape(self.shape)
+
+
+def _compare(op, a, b, stacklevel):
+    a = ndarray.convert_to_legate_ndarray(a, stacklevel=(stacklevel + 1))
+    if isinstance(b, ndarray) and b.ndim == 0:
+        b = np.asarray(b)
+    scalar = np.isscalar(b) or (isinstance(b, np.ndarray) and b.ndim == 0)
+    if scalar:
+        dtype = np.result_type(a.dtype, b)
+    else:
+        b = ndarray.convert_to_legate_ndarray(b, stacklevel=(stacklevel + 1))
+        dtype = np.result_type(a.dtype, b.dtype)
+    # Anything that the packing tasks cannot handle directly goes through
+    # an array of bools first
+    if (
+        a.size <= 1
+        or (not scalar and b.shape != a.shape)
+        or not runtime.is_supported_type(dtype)
+        or dtype.kind == "c"
+    ):
+        bits = _comparisons[op](a, b, stacklevel=(stacklevel + 1))
+        if bits.size <= 1:
+            return BitMask(bits.shape, _host_words(np.asarray(bits)))
+        return pack(bits, stacklevel=(stacklevel + 1))
+    shape = a.shape
+    if a.dtype != dtype:
+        a = a.astype(dtype)
+    if a.ndim != 1:
+        a = a.ravel(stacklevel=(stacklevel + 1))
+    if scalar:
+        rhs = dtype.type(b)
+        inputs = (a,)
+    else:
+        if b.dtype != dtype:
+            b = b.astype(dtype)
+        if b.ndim != 1:
+            b = b.ravel(stacklevel=(stacklevel + 1))
+        rhs = b._thunk
+        inputs = (a, b)
+    words = ndarray(
+        shape=(_num_words(a.size),),
+        dtype=np.dtype(np.uint64),
+        inputs=inputs,
+    )
+    words._thunk.pack_bits(op, a._thunk, rhs, stacklevel=(stacklevel + 1))
+    return BitMask(shape, words)
+
+
+def pack(a, stacklevel=1):
+    """Pack the elements of an array that are not zero into a BitMask."""
+    a = ndarray.convert_to_legate_ndarray(a, stacklevel=(stacklevel + 1))
+    return _compare(
+        NumPyOpCode.NOT_EQUAL,
+        a,
+        a.dtype.type(0),
+        stacklevel=(stacklevel + 1),
+    )
+
+
+def equal(a, b, stacklevel=1):
+    return _compare(NumPyOpCode.EQUAL, a, b, stacklevel=(stacklevel + 1))
+
+
+def not_equal(a, b, stacklevel=1):
+    return _compare(NumPyOpCode.NOT_EQUAL, a, b, stacklevel=(stacklevel + 1))
+
+
+def less(a, b, stacklevel=1):
+    return _compare(NumPyOpCode.LESS, a, b, stacklevel=(stacklevel + 1))
+
+
+def less_equal(a, b, stacklevel=1):
+    return _compare(NumPyOpCode.LESS_EQUAL, a, b, stacklevel=(stacklevel + 1))
+
+
+def greater(a, b, stacklevel=1):
+    return _compare(NumPyOpCode.GREATER, a, b, stacklevel=(stacklevel + 1))
+
+
+def greater_equal(a, b, stacklevel=1):
+    return _compare(
+        NumPyOpCode.GREATER_EQUAL, a, b, stacklevel=(stacklevel + 1)
+    )
+
+
+def count_nonzero(mask, stacklevel=1):
+    return mask.count_nonzero(stacklevel=(stacklevel + 1))
+
+
+def nonzero(mask, stacklevel=1):
+    return mask.nonzero(stacklevel=(stacklevel + 1))
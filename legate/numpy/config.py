@@ -189,6 +189,37 @@ class NumPyOpCode(IntEnum):
     INCLUSIVE_SCAN = legate_numpy.NUMPY_INCLUSIVE_SCAN
     CONVERT_TO_RECT = legate_numpy.NUMPY_CONVERT_TO_RECT
     ARANGE = legate_numpy.NUMPY_ARANGE
+    POTRF = legate_numpy.NUMPY_POTRF
+    TRSM = legate_numpy.NUMPY_TRSM
+    SYRK = legate_numpy.NUMPY_SYRK
+    GEMM = legate_numpy.NUMPY_GEMM
+    GEQRF = legate_numpy.NUMPY_GEQRF
+    NRM2 = legate_numpy.NUMPY_NRM2
+    AXPBY = legate_numpy.NUMPY_AXPBY
+    READ_FILE = legate_numpy.NUMPY_READ_FILE
+    WRITE_FILE = legate_numpy.NUMPY_WRITE_FILE
+    COUNT_LINES = legate_numpy.NUMPY_COUNT_LINES
+    READ_TEXT = legate_numpy.NUMPY_READ_TEXT
+    CHECKPOINT = legate_numpy.NUMPY_CHECKPOINT
+    RESTORE = legate_numpy.NUMPY_RESTORE
+    PACK_BITS = legate_numpy.NUMPY_PACK_BITS
+    UNPACK_BITS = legate_numpy.NUMPY_UNPACK_BITS
+    BITMASK_LOGICAL = legate_numpy.NUMPY_BITMASK_LOGICAL
+    BITMASK_COUNT = legate_numpy.NUMPY_BITMASK_COUNT
+    BITMASK_NONZERO = legate_numpy.NUMPY_BITMASK_NONZERO
+    BF16_CONVERT = legate_numpy.NUMPY_BF16_CONVERT
+    BF16_UFUNC = legate_numpy.NUMPY_BF16_UFUNC
+    BF16_SUM = legate_numpy.NUMPY_BF16_SUM
+    FUSED = legate_numpy.NUMPY_FUSED
+    FUSED_SUM = legate_numpy.NUMPY_FUSED_SUM
+    FUSED_SCALAR = legate_numpy.NUMPY_FUSED_SCALAR
+    READ_ITEMS = legate_numpy.NUMPY_READ_ITEMS
+    WRITE_ITEMS = legate_numpy.NUMPY_WRITE_ITEMS
+    GATHER = legate_numpy.NUMPY_GATHER
+    SCATTER_ADD = legate_numpy.NUMPY_SCATTER_ADD
+    GATHER_RANGES = legate_numpy.NUMPY_GATHER_RANGES
+    MASKED_SELECT = legate_numpy.NUMPY_MASKED_SELECT
+    MASKED_ASSIGN = legate_numpy.NUMPY_MASKED_ASSIGN
 
 
 # Match these to NumPyRedopID in legate_numpy_c.h
@@ -216,12 +247,19 @@ numpy_reduction_op_offsets = {
     NumPyOpCode.ALLCLOSE: legion.LEGION_REDOP_KIND_PROD,
     # Norm uses sum reduction
     NumPyOpCode.NORM: legion.LEGION_REDOP_KIND_SUM,
+    # The fused update sums the squares of its result
+    NumPyOpCode.AXPBY: legion.LEGION_REDOP_KIND_SUM,
     NumPyOpCode.ARGMIN: NumPyRedopCode.ARGMIN_REDOP,
     NumPyOpCode.ARGMAX: NumPyRedopCode.ARGMAX_REDOP,
     # bool sum is "or"
     NumPyOpCode.CONTAINS: legion.LEGION_REDOP_KIND_SUM,
     # nonzeros are counted with sum
     NumPyOpCode.COUNT_NONZERO: legion.LEGION_REDOP_KIND_SUM,
+    NumPyOpCode.BITMASK_COUNT: legion.LEGION_REDOP_KIND_SUM,
+    NumPyOpCode.BF16_SUM: legion.LEGION_REDOP_KIND_SUM,
+    NumPyOpCode.FUSED_SUM: legion.LEGION_REDOP_KIND_SUM,
+    # Scatter-add folds rows into the array with sums
+    NumPyOpCode.SCATTER_ADD: legion.LEGION_REDOP_KIND_SUM,
 }
 
 
@@ -239,6 +277,7 @@ class NumPyTunable(IntEnum):
     MAX_EAGER_VOLUME = legate_numpy.NUMPY_TUNABLE_MAX_EAGER_VOLUME
     FIELD_REUSE_SIZE = legate_numpy.NUMPY_TUNABLE_FIELD_REUSE_SIZE
     FIELD_REUSE_FREQ = legate_numpy.NUMPY_TUNABLE_FIELD_REUSE_FREQUENCY
+    FIELD_POOL_SIZE = legate_numpy.NUMPY_TUNABLE_FIELD_POOL_SIZE
 
 
 # Match these to NumPyTag in legate_numpy_c.h
@@ -253,9 +292,18 @@ class NumPyMappingTag(IntEnum):
     RADIX_DIM_TAG = legate_numpy.NUMPY_RADIX_DIM_TAG
 
 
+# Match these to NumPySemanticTag in legate_numpy_c.h
+@unique
+class NumPySemanticTag(IntEnum):
+    FILE_BACKED = legate_numpy.NUMPY_FILE_BACKED_SEMANTIC_TAG
+
+
 RADIX_GEN_SHIFT = 5
 RADIX_DIM_SHIFT = 8
 
+# Smallest tile we will use for the tiled linear algebra routines
+LINALG_MIN_TILE_SIZE = 256
+
 
 # Match these to NumPyProjectionCode in legate_numpy_c.h
 @unique
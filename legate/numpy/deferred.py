@@ -15,6 +15,7 @@
 
 from __future__ import absolute_import, division, print_function
 
+import os
 import warnings
 
 import numpy as np
@@ -22,8 +23,14 @@ import numpy as np
 from legate.core import *  # noqa F403
 
 from .config import *  # noqa F403
+from .program import (
+    FusedProgram,
+    fused_arity,
+    is_fusable_op,
+    is_fusable_type,
+)
 from .thunk import NumPyThunk
-from .utils import calculate_volume
+from .utils import calculate_volume, is_sole_reference
 
 try:
     xrange  # Python 2
@@ -35,6 +42,10 @@ try:
 except NameError:
     long = int  # Python 3
 
+# Buffered scalar expressions that grow past this many operations get
+# launched so that their programs stay short
+_max_scalar_operations = 32
+
 
 class DeferredArray(NumPyThunk):
     """This is a deferred thunk for describing NumPy computations.
@@ -49,6 +60,89 @@ class DeferredArray(NumPyThunk):
         assert base is not None
         self.base = base  # Either a RegionField or a Future
         self.scalar = scalar
+        # Writes of single items that we have yet to launch
+        self.pending_items = None
+
+    @property
+    def base(self):
+        # A scalar whose operations we buffered gets its future once
+        # something needs it
+        if self.expression is not None:
+            self._base = self._launch_scalar_expression(self.expression)
+            self.expression = None
+        return self._base
+
+    @base.setter
+    def base(self, base):
+        self.expression = None
+        self._base = base
+
+    def _buffer_scalar_op(self, op, op_dtype, operands, where, args):
+        # Operations on scalars become an expression of the futures that
+        # they read instead of a task each. The expression holds on to the
+        # futures and not the arrays, so it does not see later writes.
+        if (
+            not self.scalar
+            or self.runtime.shadow_debug
+            or where is not True
+            or args
+            or op_dtype != self.dtype
+            or not is_fusable_op(op)
+            or not is_fusable_type(self.dtype)
+            or fused_arity(op) != len(operands)
+        ):
+            return False
+        for rhs in operands:
+            if not rhs.scalar or rhs.dtype != self.dtype:
+                return False
+        num_operations = 1
+        leaves = list()
+        for rhs in operands:
+            expression = rhs.expression
+            if (
+                expression is not None
+                and expression[2] < _max_scalar_operations
+            ):
+                leaves.append(expression)
+                num_operations += expression[2]
+            else:
+                leaves.append(rhs.base)
+        self._base = None
+        self.expression = (op, tuple(leaves), num_operations)
+        return True
+
+    def _launch_scalar_expression(self, expression):
+        program = FusedProgram(self.dtype)
+        futures = list()
+        handles = dict()
+
+        def emit(expression):
+            op, leaves, _ = expression
+            operands = list()
+            for leaf in leaves:
+                if id(leaf) not in handles:
+                    if isinstance(leaf, Future):
+                        handles[id(leaf)] = program.input()
+                        futures.append(leaf)
+                    else:
+                        handles[id(leaf)] = emit(leaf)
+                operands.append(handles[id(leaf)])
+            return program.apply(op, *operands)
+
+        emit(expression)
+        argbuf = BufferBuilder()
+        program.pack(argbuf)
+        task = Task(
+            self.runtime.get_nullary_task_id(
+                NumPyOpCode.FUSED_SCALAR, result_type=self.dtype
+            ),
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+        )
+        for future in futures:
+            task.add_future(future)
+        return self.runtime.dispatch(task)
 
     @property
     def storage(self):
@@ -61,6 +155,28 @@ class DeferredArray(NumPyThunk):
     def ndim(self):
         return len(self.shape)
 
+    def owns_storage(self):
+        if self.scalar or isinstance(self.base, Future):
+            return False
+        base = self.base
+        # Views, attached or mapped host memory and files can all see the
+        # field behind our back
+        if (
+            base.parent is not None
+            or base.subviews
+            or base.attach_array is not None
+            or base.numpy_array is not None
+            or base.physical_region is not None
+            or base.file_backed
+            or not base.field.own
+        ):
+            return False
+        # Any other region field on the same field or thunk on the same
+        # region field would hold another reference to it
+        return is_sole_reference(self, "base") and is_sole_reference(
+            base, "field"
+        )
+
     def __numpy_array__(self, stacklevel):
         if self.scalar:
             return np.full(
@@ -344,7 +460,19 @@ class DeferredArray(NumPyThunk):
     def get_item(self, key, stacklevel, view=None, dim_map=None):
         assert self.size > 1
         # Check to see if this is advanced indexing or not
-        if self._is_advanced_indexing(key):
+        if self._is_point_indexing(key):
+            points, shape = self._get_indexed_points(
+                key, stacklevel=(stacklevel + 1)
+            )
+            values = self.get_items(points, stacklevel=(stacklevel + 1))
+            result = self.runtime.find_or_create_array_thunk(
+                values.reshape(shape), stacklevel=(stacklevel + 1)
+            )
+        elif self._is_row_indexing(key):
+            result = self._gather_rows(key, stacklevel=(stacklevel + 1))
+        elif self._is_mask_indexing(key):
+            result = self._masked_select(key, stacklevel=(stacklevel + 1))
+        elif self._is_advanced_indexing(key):
             # Create the indexing array
             index_array = self._create_indexing_array(
                 key, stacklevel=(stacklevel + 1)
@@ -490,7 +618,20 @@ class DeferredArray(NumPyThunk):
         )
         assert self.dtype == value_array.dtype
         # Check to see if this is advanced indexing or not
-        if self._is_advanced_indexing(key):
+        if self._is_point_indexing(key):
+            points, shape = self._get_indexed_points(
+                key, stacklevel=(stacklevel + 1)
+            )
+            values = np.broadcast_to(
+                value_array.__numpy_array__(stacklevel=(stacklevel + 1)),
+                shape,
+            )
+            self.set_items(
+                points, values.reshape(-1), stacklevel=(stacklevel + 1)
+            )
+        elif self._is_mask_indexing(key):
+            self._masked_assign(key, value_array, stacklevel=(stacklevel + 1))
+        elif self._is_advanced_indexing(key):
             # Create the indexing array
             index_array = self._create_indexing_array(
                 key, stacklevel=(stacklevel + 1)
@@ -582,32 +723,43 @@ class DeferredArray(NumPyThunk):
                 assert value_array.size == 1
                 use_key = tuple([x.start for x in view])
                 assert len(use_key) == self.ndim
-                dst = self.base
-                # Create the arguments to the task
-                argbuf = BufferBuilder()
-                argbuf.pack_dimension(self.ndim)
-                argbuf.pack_accessor(dst.field.field_id, dst.transform)
-                argbuf.pack_point(use_key)
-                # No need for dependence since this is immediate
-                argbuf.pack_value(
-                    value_array.get_scalar_array(stacklevel + 1),
-                    value_array.dtype.type,
-                )
-                # Now we can make the Task and add the region requirements
-                task = Task(
-                    self.runtime.get_nullary_task_id(
-                        NumPyOpCode.WRITE, result_type=self.dtype
-                    ),
-                    argbuf.get_string(),
-                    argbuf.get_size(),
-                    mapper=self.runtime.mapper_id,
-                )
-                task.add_read_write_requirement(
-                    dst.region,
-                    dst.field.field_id,
-                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
-                )
-                self.runtime.dispatch(task)
+                # Writes of single values wait for the next launch so that
+                # loops setting many of them take one task instead of one
+                # each, unless the host has views that could see the field
+                # before then
+                if not self.runtime.num_host_mappings:
+                    self.runtime.buffer_item_write(
+                        self,
+                        use_key,
+                        value_array.get_scalar_array(stacklevel + 1),
+                    )
+                else:
+                    dst = self.base
+                    # Create the arguments to the task
+                    argbuf = BufferBuilder()
+                    argbuf.pack_dimension(self.ndim)
+                    argbuf.pack_accessor(dst.field.field_id, dst.transform)
+                    argbuf.pack_point(use_key)
+                    # No need for dependence since this is immediate
+                    argbuf.pack_value(
+                        value_array.get_scalar_array(stacklevel + 1),
+                        value_array.dtype.type,
+                    )
+                    # Now we can make the Task and add the region requirements
+                    task = Task(
+                        self.runtime.get_nullary_task_id(
+                            NumPyOpCode.WRITE, result_type=self.dtype
+                        ),
+                        argbuf.get_string(),
+                        argbuf.get_size(),
+                        mapper=self.runtime.mapper_id,
+                    )
+                    task.add_read_write_requirement(
+                        dst.region,
+                        dst.field.field_id,
+                        tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                    )
+                    self.runtime.dispatch(task)
             else:
                 # Get the view for the result
                 subview = self.runtime.find_or_create_view(
@@ -634,163 +786,876 @@ class DeferredArray(NumPyThunk):
             self.shadow.set_item(key, rhs.shadow, stacklevel=(stacklevel + 1))
             self.runtime.check_shadow(self, "set_item")
 
-    def reshape(self, newshape, order, stacklevel):
-        assert isinstance(newshape, tuple)
-        # Check to see if we can make an affine mapping that maps points
-        # in the new shape into points in the old shape
-        transform = None
-        if len(newshape) >= self.ndim:
-            if order == "C" or order == "A":
-                # See if we can group the dimensions from right to left
-                # in a way that creates dimensions in the old shape
-                # TODO: there are better ways to do this with prime
-                # factorization so we can handle weird splits between
-                # dimensions
-                transform = Transform(self.ndim, len(newshape), False)
-                dim = len(newshape) - 1
-                for idx in xrange(self.ndim - 1, -1, -1):
-                    stride = 1
-                    current_dim = self.shape[idx]
-                    while stride < current_dim:
-                        assert dim >= 0
-                        if stride * newshape[dim] <= current_dim:
-                            if newshape[dim] > 1:
-                                transform.trans[idx][dim] = stride
-                                stride *= newshape[dim]
-                            dim -= 1
-                        else:
-                            # We failed, so we're done
-                            transform = None
-                            break
-                    if transform is None:
-                        break
-            if order == "F" or (order == "A" and transform is None):
-                # See if we can group the dimensions from left to right in
-                # a way that creates dimensions in the old shape
-                # TODO; think about how this interoperates with partitioning
-                pass
-        if transform is None:
-            # If we don't have a transform then we need to make a copy
-            warnings.warn(
-                "legate.numpy has not implemented reshape/ravel for newshape "
-                + str(newshape)
-                + " which is a non-affine mapping and is falling back to "
-                + "canonical numpy. You may notice significantly decreased "
-                + "performance for this function call.",
-                stacklevel=(stacklevel + 1),
-                category=RuntimeWarning,
-            )
-            numpy_array = self.__numpy_array__(stacklevel=(stacklevel + 1))
-            # Force a copy here because we know we can't build a view
-            result_array = numpy_array.reshape(newshape, order=order).copy()
-            result = self.runtime.get_numpy_thunk(
-                result_array, stacklevel=(stacklevel + 1)
-            )
-        else:
-            # If we have a transform then we can make a view
-            affine_transform = AffineTransform(self.ndim, len(newshape), False)
-            affine_transform.trans = transform.trans
-            result = self.runtime.create_transform_view(
-                self.base, newshape, affine_transform
-            )
-        if self.runtime.shadow_debug:
-            result.shadow = self.shadow.reshape(
-                newshape, order, stacklevel=(stacklevel + 1)
-            )
-        return result
+    def _is_point_indexing(self, key):
+        # One array of integers for each of our dimensions picks out a list
+        # of points, which we read and write directly
+        if self.ndim < 2 or not isinstance(key, tuple):
+            return False
+        if len(key) != self.ndim:
+            return False
+        for k in key:
+            if not isinstance(k, NumPyThunk) or k.dtype.kind not in "iu":
+                return False
+        return True
 
-    def squeeze(self, axis, stacklevel):
-        if axis is None:
-            new_shape = ()
-            axis = ()
-            for idx in xrange(self.ndim):
-                if self.shape[idx] != 1:
-                    new_shape = new_shape + (self.shape[idx],)
-                else:
-                    # Record the dropped axis index
-                    axis = axis + (idx,)
-        elif isinstance(axis, int):
-            new_shape = ()
-            for idx in xrange(self.ndim):
-                if idx == axis:
-                    assert self.shape[idx] == 1
-                else:
-                    new_shape = new_shape + (self.shape[idx],)
-            # Convert to a tuple of dropped axes
-            axis = (axis,)
-        elif isinstance(axis, tuple):
-            new_shape = ()
-            for idx in xrange(self.ndim):
-                if idx in axis:
-                    assert self.shape[idx] == 1
-                else:
-                    new_shape = new_shape + (self.shape[idx],)
+    def _get_indexed_points(self, key, stacklevel):
+        arrays = np.broadcast_arrays(
+            *[k.__numpy_array__(stacklevel=(stacklevel + 1)) for k in key]
+        )
+        shape = arrays[0].shape
+        points = np.stack(
+            [array.reshape(-1).astype(np.int64) for array in arrays], axis=1
+        )
+        extents = np.array(self.shape, dtype=np.int64)
+        points = np.where(points < 0, points + extents, points)
+        if np.any((points < 0) | (points >= extents)):
+            raise IndexError("index out of bounds for advanced indexing")
+        return points, shape
+
+    def _group_items(self, points):
+        # Sort the points by the tile of our key partition that holds them
+        # so that every point task finds its own points in one range of the
+        # list. Views and arrays that we do not split take a single task.
+        launch_space = None
+        if self.base.parent is None and self.base.transform is None:
+            launch_space = self.base.compute_parallel_launch_space()
+        if launch_space is None:
+            offsets = np.array([0, len(points)], dtype=np.int64)
+            return None, (1,) * self.ndim, np.arange(len(points)), offsets
+        part, _, __ = self.base.find_or_create_key_partition()
+        tile_shape = np.array(part.tile_shape, dtype=np.int64)
+        colors = np.ravel_multi_index(
+            tuple((points // tile_shape).T), launch_space
+        )
+        order = np.argsort(colors, kind="stable")
+        offsets = np.searchsorted(
+            colors[order], np.arange(calculate_volume(launch_space) + 1)
+        )
+        return part, launch_space, order, offsets
+
+    def _pack_items(self, argbuf, points, values, indices):
+        argbuf.pack_32bit_int(len(indices))
+        for idx, point in zip(indices, points[indices].tolist()):
+            argbuf.pack_point(tuple(point))
+            if values is not None:
+                argbuf.pack_value(values[idx], self.dtype.type)
+
+    def _launch_items(self, op, points, values, grouping, out=None):
+        part, launch_space, order, offsets = grouping
+        argbuf = BufferBuilder()
+        if part is not None:
+            self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
         else:
-            raise TypeError(
-                '"axis" argument for squeeze must be int-like or tuple-like'
-            )
-        if not self.scalar:
-            # Make transform for the lost dimensions
-            transform = AffineTransform(self.ndim, len(new_shape), False)
-            child_idx = 0
-            for parent_idx in xrange(self.ndim):
-                # If this is a collapsed dimension then record it
-                if parent_idx not in axis:
-                    transform.trans[parent_idx, child_idx] = 1
-                    child_idx += 1
-            assert child_idx == len(new_shape)
-            result = self.runtime.create_transform_view(
-                self.base, new_shape, transform
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+        if out is not None:
+            argbuf.pack_accessor(out.field.field_id, out.transform)
+        task_id = self.runtime.get_nullary_task_id(op, result_type=self.dtype)
+        if part is not None:
+            # Only the tiles that hold points get a point task, and each
+            # of them gets just its own points in the argument map
+            colors = list()
+            argmap = legion.legion_argument_map_create()
+            for flat in xrange(len(offsets) - 1):
+                if offsets[flat] == offsets[flat + 1]:
+                    continue
+                color = tuple(
+                    int(x) for x in np.unravel_index(flat, launch_space)
+                )
+                colors.append(color)
+                pointbuf = BufferBuilder()
+                self._pack_items(
+                    pointbuf,
+                    points,
+                    values,
+                    order[offsets[flat] : offsets[flat + 1]],
+                )
+                arg = ffi.new("legion_untyped_buffer_t *")
+                data = ffi.from_buffer(pointbuf.get_string())
+                arg.args = data
+                arg.arglen = pointbuf.get_size()
+                legion.legion_argument_map_set_point(
+                    argmap, Point(color).raw(), arg[0], True
+                )
+            if len(colors) < len(offsets) - 1:
+                space = self.runtime.create_sparse_index_space(colors)
+                domain = legion.legion_index_space_get_domain(
+                    self.runtime.runtime, space
+                )
+            else:
+                space = None
+                domain = Rect(launch_space)
+            _, shardfn, shardsp = self.base.find_or_create_key_partition()
+            task = IndexTask(
+                task_id,
+                domain,
+                argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
             )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if out is None:
+                task.add_read_write_requirement(
+                    part,
+                    self.base.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                task.add_read_requirement(
+                    part,
+                    self.base.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+                # Each color gets its own run of slots along the last axis
+                width = out.shape[-1] // launch_space[-1]
+                out_part = out.find_or_create_partition(
+                    launch_space, (1,) * (self.ndim - 1) + (width,)
+                )
+                task.add_write_requirement(
+                    out_part,
+                    out.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                )
         else:
-            # Easy case of size 1 array, nothing to do
-            result = DeferredArray(
-                self.runtime, self.base, new_shape, self.dtype, True
-            )
-        if self.runtime.shadow_debug:
-            result.shadow = self.shadow.squeeze(
-                axis, stacklevel=(stacklevel + 1)
+            # Single tasks find all the points after the other arguments
+            self._pack_items(argbuf, points, values, order)
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
             )
-        return result
-
-    def swapaxes(self, axis1, axis2, stacklevel):
-        if self.size == 1:
-            return self
-        # Make a new deferred array object and swap the results
-        assert axis1 < self.ndim and axis2 < self.ndim
-        # Create a new shape and transform for the region field object
-        new_shape = ()
-        for idx in xrange(self.ndim):
-            if idx == axis1:
-                new_shape = new_shape + (self.shape[axis2],)
-            elif idx == axis2:
-                new_shape = new_shape + (self.shape[axis1],)
+            if out is None:
+                task.add_read_write_requirement(
+                    self.base.region,
+                    self.base.field.field_id,
+                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                )
             else:
-                new_shape = new_shape + (self.shape[idx],)
-        transform = AffineTransform(self.ndim, self.ndim, True)
-        transform.transform[axis1, axis1] = 0
-        transform.transform[axis2, axis2] = 0
-        transform.transform[axis1, axis2] = 1
-        transform.transform[axis2, axis1] = 1
-        result = self.runtime.create_transform_view(
-            self.base, new_shape, transform
+                task.add_read_requirement(
+                    self.base.region,
+                    self.base.field.field_id,
+                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                )
+                task.add_write_requirement(out.region, out.field.field_id)
+        self.runtime.dispatch(task)
+        if part is not None:
+            legion.legion_argument_map_destroy(argmap)
+            if space is not None:
+                self.runtime.destroy_index_space(space)
+
+    def get_items(self, points, stacklevel):
+        assert points.ndim == 2 and points.shape[1] == self.ndim
+        result = np.empty((len(points),), dtype=self.dtype)
+        if len(points) == 0:
+            return result
+        grouping = self._group_items(points)
+        _, launch_space, order, offsets = grouping
+        counts = np.diff(offsets)
+        width = int(counts.max())
+        # Every point task puts the values of its points in its own run of
+        # slots in a buffer that has room for the largest group
+        out = self.runtime.allocate_field(
+            launch_space[:-1] + (launch_space[-1] * width,), self.dtype
         )
-        if self.runtime.shadow_debug:
-            result.shadow = self.shadow.swapaxes(
-                axis1, axis2, stacklevel=(stacklevel + 1)
-            )
+        self._launch_items(
+            NumPyOpCode.READ_ITEMS, points, None, grouping, out=out
+        )
+        buffer = out.get_numpy_array().reshape(-1)
+        groups = np.repeat(np.arange(len(counts)), counts)
+        slots = np.arange(len(points)) - offsets[groups]
+        result[order] = buffer[groups * width + slots]
+        self.runtime.profile_callsite(stacklevel + 1, True)
         return result
 
-    # Convert the source array to the destination array
-    def convert(self, rhs, stacklevel, warn=True, callsite=None):
-        src_array = self.runtime.to_deferred_array(
-            rhs, stacklevel=(stacklevel + 1)
+    def set_items(self, points, values, stacklevel):
+        assert points.ndim == 2 and points.shape[1] == self.ndim
+        assert len(values) == len(points)
+        if len(points) > 0:
+            self._launch_items(
+                NumPyOpCode.WRITE_ITEMS,
+                points,
+                values,
+                self._group_items(points),
+            )
+        self.runtime.profile_callsite(stacklevel + 1, True)
+        if self.runtime.shadow_debug:
+            self.shadow.set_items(points, values, stacklevel=(stacklevel + 1))
+            self.runtime.check_shadow(self, "set_items")
+
+    def _is_row_indexing(self, key):
+        # A single array of integers picks out whole rows, which we gather
+        # with tasks that only map the rows that each tile of indices needs
+        if isinstance(key, tuple):
+            if len(key) != 1:
+                return False
+            key = key[0]
+        if not isinstance(key, NumPyThunk) or key.dtype.kind not in "iu":
+            return False
+        return key.ndim > 0 and self._can_index_rows()
+
+    def _can_index_rows(self):
+        return (
+            self.ndim <= 3
+            and self.base.parent is None
+            and self.base.transform is None
         )
-        dst_array = self
-        dst_dtype = dst_array.dtype
-        assert src_array.dtype != dst_dtype
-        assert src_array.shape == dst_array.shape or (
-            src_array.size == 1 and dst_array.size == 1
+
+    def _get_row_index(self, key, stacklevel):
+        # The tasks take a vector of int64 indices in a region of its own
+        index = self.runtime.to_deferred_array(
+            key, stacklevel=(stacklevel + 1)
+        )
+        if index.ndim != 1:
+            index = self.runtime.to_deferred_array(
+                index.reshape((index.size,), "C", stacklevel=(stacklevel + 1)),
+                stacklevel=(stacklevel + 1),
+            )
+        if (
+            index.dtype != np.int64
+            or index.base.parent is not None
+            or index.base.transform is not None
+        ):
+            temp = self.runtime.create_empty_thunk(
+                index.shape, dtype=np.dtype(np.int64), inputs=(index,)
+            )
+            if index.dtype != np.int64:
+                temp.convert(index, stacklevel=(stacklevel + 1), warn=False)
+            else:
+                temp.copy(index, deep=True, stacklevel=(stacklevel + 1))
+            index = self.runtime.to_deferred_array(
+                temp, stacklevel=(stacklevel + 1)
+            )
+        if index.size > 0:
+            self._check_row_index(index, stacklevel=(stacklevel + 1))
+        return index
+
+    def _check_row_index(self, index, stacklevel):
+        # The tasks only assert that the rows exist, so find the smallest
+        # and largest indices first and raise like NumPy does
+        extent = self.shape[0]
+        for op, redop in (
+            (NumPyOpCode.MIN, NumPyOpCode.MIN_RADIX),
+            (NumPyOpCode.MAX, NumPyOpCode.MAX_RADIX),
+        ):
+            bound = self.runtime.create_empty_thunk(
+                shape=(1,), dtype=index.dtype, inputs=(index,)
+            )
+            bound.unary_reduction(
+                op,
+                redop,
+                index,
+                stacklevel=(stacklevel + 1),
+                axes=None,
+                keepdims=False,
+                where=True,
+                initial=None,
+                args=None,
+            )
+            value = int(bound.get_scalar_array(stacklevel=(stacklevel + 1)))
+            if value < -extent or value >= extent:
+                raise IndexError(
+                    "index "
+                    + str(value)
+                    + " is out of bounds for axis 0 with size "
+                    + str(extent)
+                )
+
+    def _create_row_image(self, index, index_part, launch_space, shardfn):
+        # Record the rectangle of the row that every index picks out and
+        # make an image of them so each point task maps only those rows
+        ranges = self.runtime.allocate_field(
+            index.shape,
+            np.dtype(
+                (np.void, ffi.sizeof("legion_rect_{}d_t".format(self.ndim)))
+            ),
+        )
+        ranges_part = ranges.find_or_create_congruent_partition(index_part)
+        argbuf = BufferBuilder()
+        argbuf.pack_dimension(self.ndim)
+        self.pack_shape(
+            argbuf, index.shape, index_part.tile_shape, 0, pack_dim=False
+        )
+        argbuf.pack_accessor(ranges.field.field_id, ranges.transform)
+        argbuf.pack_accessor(index.base.field.field_id, index.base.transform)
+        argbuf.pack_point(self.shape)
+        task = IndexTask(
+            self.runtime.get_nullary_task_id(
+                NumPyOpCode.GATHER_RANGES, result_type=index.dtype
+            ),
+            Rect(launch_space),
+            self.runtime.empty_argmap,
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+            tag=shardfn,
+        )
+        task.add_write_requirement(ranges_part, ranges.field.field_id, 0)
+        task.add_read_requirement(
+            index_part,
+            index.base.field.field_id,
+            0,
+            tag=NumPyMappingTag.KEY_REGION_TAG,
+        )
+        self.runtime.dispatch(task)
+        functor = PartitionByImageRange(
+            ranges.region,
+            ranges_part,
+            ranges.field.field_id,
+            self.runtime.mapper_id,
+        )
+        index_partition = IndexPartition(
+            self.runtime.context,
+            self.runtime.runtime,
+            self.base.region.index_space,
+            ranges_part.color_space,
+            functor,
+            kind=legion.LEGION_COMPUTE_KIND,
+        )
+        return self.base.region.get_child(index_partition)
+
+    def _launch_rows(self, op, index, other):
+        # Gathers write the rows of other and scatters read them, and both
+        # split other along its first dimension like the indices
+        argbuf = BufferBuilder()
+        argbuf.pack_dimension(self.ndim)
+        index_array = index.base
+        launch_space = index_array.compute_parallel_launch_space()
+        if launch_space is not None:
+            (
+                index_part,
+                shardfn,
+                shardsp,
+            ) = index_array.find_or_create_key_partition()
+            other_part = other.base.find_or_create_partition(
+                launch_space + (1,) * (self.ndim - 1),
+                index_part.tile_shape + self.shape[1:],
+            )
+            if self.ndim == 1:
+                other_proj = 0
+            elif self.ndim == 2:
+                other_proj = (
+                    self.runtime.first_proj_id + NumPyProjCode.PROJ_1D_2D_X
+                )
+            else:
+                other_proj = (
+                    self.runtime.first_proj_id + NumPyProjCode.PROJ_1D_3D_X
+                )
+            self.pack_shape(
+                argbuf,
+                other.shape,
+                other_part.tile_shape,
+                other_proj,
+                pack_dim=False,
+            )
+        else:
+            self.pack_shape(argbuf, other.shape, pack_dim=False)
+        if op == NumPyOpCode.GATHER:
+            first, last = other.base, self.base
+        else:
+            first, last = self.base, other.base
+        argbuf.pack_accessor(first.field.field_id, first.transform)
+        argbuf.pack_accessor(index_array.field.field_id, index_array.transform)
+        argbuf.pack_accessor(last.field.field_id, last.transform)
+        argbuf.pack_point(self.shape)
+        task_id = self.runtime.get_nullary_task_id(op, result_type=self.dtype)
+        redop = self.runtime.get_reduction_op_id(
+            NumPyOpCode.SCATTER_ADD, self.dtype
+        )
+        if launch_space is not None:
+            image = self._create_row_image(
+                index, index_part, launch_space, shardfn
+            )
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if op == NumPyOpCode.GATHER:
+                task.add_write_requirement(
+                    other_part,
+                    other.base.field.field_id,
+                    other_proj,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                # Different tiles of indices can pick out the same rows, so
+                # they fold their sums into them
+                task.add_reduction_requirement(
+                    image, self.base.field.field_id, redop, 0
+                )
+            task.add_read_requirement(
+                index_part,
+                index_array.field.field_id,
+                0,
+                tag=NumPyMappingTag.KEY_REGION_TAG,
+            )
+            if op == NumPyOpCode.GATHER:
+                task.add_read_requirement(image, self.base.field.field_id, 0)
+            else:
+                task.add_read_requirement(
+                    other_part,
+                    other.base.field.field_id,
+                    other_proj,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+        else:
+            shardpt, shardfn, shardsp = index_array.find_point_sharding()
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if op == NumPyOpCode.GATHER:
+                task.add_write_requirement(
+                    other.base.region, other.base.field.field_id
+                )
+            else:
+                task.add_reduction_requirement(
+                    self.base.region, self.base.field.field_id, redop
+                )
+            task.add_read_requirement(
+                index_array.region, index_array.field.field_id
+            )
+            if op == NumPyOpCode.GATHER:
+                task.add_read_requirement(
+                    self.base.region, self.base.field.field_id
+                )
+            else:
+                task.add_read_requirement(
+                    other.base.region, other.base.field.field_id
+                )
+        self.runtime.dispatch(task)
+
+    def _gather_rows(self, key, stacklevel):
+        if isinstance(key, tuple):
+            key = key[0]
+        index = self._get_row_index(key, stacklevel=(stacklevel + 1))
+        result = self.runtime.to_deferred_array(
+            self.runtime.create_empty_thunk(
+                index.shape + self.shape[1:],
+                dtype=self.dtype,
+                inputs=(self, index),
+            ),
+            stacklevel=(stacklevel + 1),
+        )
+        if index.size > 0:
+            self._launch_rows(NumPyOpCode.GATHER, index, result)
+        if key.ndim != 1:
+            result = result.reshape(
+                key.shape + self.shape[1:], "C", stacklevel=(stacklevel + 1)
+            )
+        return result
+
+    def scatter_add(self, index, values, stacklevel):
+        if not self._can_index_rows():
+            raise NotImplementedError(
+                "legate.numpy only supports add.at on arrays that are not "
+                + "views with up to three dimensions"
+            )
+        index = self._get_row_index(index, stacklevel=(stacklevel + 1))
+        values = self.runtime.to_deferred_array(
+            values, stacklevel=(stacklevel + 1)
+        )
+        assert values.shape == index.shape + self.shape[1:]
+        assert values.dtype == self.dtype
+        if values.base.parent is not None or values.base.transform is not None:
+            temp = self.runtime.to_deferred_array(
+                self.runtime.create_empty_thunk(
+                    values.shape, dtype=self.dtype, inputs=(values,)
+                ),
+                stacklevel=(stacklevel + 1),
+            )
+            temp.copy(values, deep=True, stacklevel=(stacklevel + 1))
+            values = temp
+        if index.size > 0:
+            self._launch_rows(NumPyOpCode.SCATTER_ADD, index, values)
+        self.runtime.profile_callsite(stacklevel + 1, True)
+        if self.runtime.shadow_debug:
+            self.shadow.scatter_add(
+                index.shadow, values.shadow, stacklevel=(stacklevel + 1)
+            )
+            self.runtime.check_shadow(self, "scatter_add")
+
+    def _is_mask_indexing(self, key):
+        # A boolean array with our shape picks out the values to pack, which
+        # we move directly instead of through the coordinates of nonzero
+        if isinstance(key, tuple):
+            if len(key) != 1:
+                return False
+            key = key[0]
+        return (
+            isinstance(key, NumPyThunk)
+            and key.dtype == np.bool_
+            and key.shape == self.shape
+            and self.size > 1
+        )
+
+    def _get_mask_tiles(self, key, stacklevel):
+        # The mask gets split like our key partition
+        if isinstance(key, tuple):
+            key = key[0]
+        mask = self.runtime.to_deferred_array(key, stacklevel=(stacklevel + 1))
+        launch_space = self.base.compute_parallel_launch_space()
+        if launch_space is None:
+            return mask, (None, None, None, None, None)
+        part, shardfn, shardsp = self.base.find_or_create_key_partition()
+        mask_part = mask.base.find_or_create_congruent_partition(part)
+        return mask, (launch_space, part, mask_part, shardfn, shardsp)
+
+    def _launch_masked(self, op, mask, tiles, counts, packed):
+        # Packed has the values of the set entries of the mask in C order
+        # within each tile and the tiles one after another, so every point
+        # task finds its range of them in the image of the scanned counts.
+        # Assignments of a single value take it in a future instead.
+        launch_space, part, mask_part, shardfn, shardsp = tiles
+        scalar = isinstance(packed, Future)
+        write = op == NumPyOpCode.MASKED_ASSIGN
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+        argbuf.pack_accessor(mask.base.field.field_id, mask.base.transform)
+        if write:
+            argbuf.pack_bool(scalar)
+        if not scalar:
+            argbuf.pack_accessor(
+                packed.base.field.field_id, packed.base.transform
+            )
+        task_id = self.runtime.get_nullary_task_id(op, result_type=self.dtype)
+        if launch_space is not None:
+            if not scalar:
+                packed_part = self._partition_by_counts(counts, packed.base)
+                packed_proj = (
+                    self.runtime.first_proj_id
+                    + NumPyProjCode.PROJ_ND_1D_C_ORDER
+                )
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if write:
+                task.add_read_write_requirement(
+                    part,
+                    self.base.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                task.add_read_requirement(
+                    part,
+                    self.base.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            task.add_read_requirement(mask_part, mask.base.field.field_id, 0)
+            if not scalar and write:
+                task.add_read_requirement(
+                    packed_part,
+                    packed.base.field.field_id,
+                    packed_proj,
+                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                )
+            elif not scalar:
+                task.add_write_requirement(
+                    packed_part,
+                    packed.base.field.field_id,
+                    packed_proj,
+                    tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                )
+        else:
+            shardpt, shardfn, shardsp = self.base.find_point_sharding()
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if write:
+                task.add_read_write_requirement(
+                    self.base.region, self.base.field.field_id
+                )
+            else:
+                task.add_read_requirement(
+                    self.base.region, self.base.field.field_id
+                )
+            task.add_read_requirement(
+                mask.base.region, mask.base.field.field_id
+            )
+            if not scalar and write:
+                task.add_read_requirement(
+                    packed.base.region, packed.base.field.field_id
+                )
+            elif not scalar:
+                task.add_write_requirement(
+                    packed.base.region, packed.base.field.field_id
+                )
+        if scalar:
+            task.add_future(packed)
+        self.runtime.dispatch(task)
+
+    def _count_masked(self, mask, tiles):
+        # Count the set entries of the mask in every tile, and in all of
+        # them to know how long the packed values are
+        launch_space, _, mask_part, shardfn, shardsp = tiles
+        counts = mask._count_per_tile(
+            mask_part, launch_space, shardfn, shardsp
+        )
+        return counts, int(counts.get_numpy_array().sum())
+
+    def _masked_select(self, key, stacklevel):
+        mask, tiles = self._get_mask_tiles(key, stacklevel=(stacklevel + 1))
+        counts, total = self._count_masked(mask, tiles)
+        result = self.runtime.create_empty_thunk(
+            (total,), dtype=self.dtype, inputs=(self, mask)
+        )
+        if total == 0:
+            return result
+        result = self.runtime.to_deferred_array(
+            result, stacklevel=(stacklevel + 1)
+        )
+        self._launch_masked(
+            NumPyOpCode.MASKED_SELECT, mask, tiles, counts, result
+        )
+        return result
+
+    def _masked_assign(self, key, value_array, stacklevel):
+        mask, tiles = self._get_mask_tiles(key, stacklevel=(stacklevel + 1))
+        if value_array.size == 1:
+            # Every set entry gets the same value, so we do not need to know
+            # how many there are
+            if isinstance(value_array.base, Future):
+                value = value_array.base
+            else:
+                value = value_array.__numpy_array__(
+                    stacklevel=(stacklevel + 1)
+                ).copy()
+                value = self.runtime.create_future(value.data, value.nbytes)
+            self._launch_masked(
+                NumPyOpCode.MASKED_ASSIGN, mask, tiles, None, value
+            )
+            return
+        counts, total = self._count_masked(mask, tiles)
+        if value_array.size != total:
+            raise ValueError(
+                "NumPy boolean array indexing assignment cannot assign "
+                + str(value_array.size)
+                + " input values to the "
+                + str(total)
+                + " output values where the mask is true"
+            )
+        if value_array.ndim != 1:
+            value_array = self.runtime.to_deferred_array(
+                value_array.reshape(
+                    (total,), "C", stacklevel=(stacklevel + 1)
+                ),
+                stacklevel=(stacklevel + 1),
+            )
+        if (
+            value_array.base.parent is not None
+            or value_array.base.transform is not None
+        ):
+            temp = self.runtime.to_deferred_array(
+                self.runtime.create_empty_thunk(
+                    (total,), dtype=self.dtype, inputs=(value_array,)
+                ),
+                stacklevel=(stacklevel + 1),
+            )
+            temp.copy(value_array, deep=True, stacklevel=(stacklevel + 1))
+            value_array = temp
+        self._launch_masked(
+            NumPyOpCode.MASKED_ASSIGN, mask, tiles, counts, value_array
+        )
+
+    def reshape(self, newshape, order, stacklevel):
+        assert isinstance(newshape, tuple)
+        # Check to see if we can make an affine mapping that maps points
+        # in the new shape into points in the old shape
+        transform = None
+        if len(newshape) >= self.ndim:
+            if order == "C" or order == "A":
+                # See if we can group the dimensions from right to left
+                # in a way that creates dimensions in the old shape
+                # TODO: there are better ways to do this with prime
+                # factorization so we can handle weird splits between
+                # dimensions
+                transform = Transform(self.ndim, len(newshape), False)
+                dim = len(newshape) - 1
+                for idx in xrange(self.ndim - 1, -1, -1):
+                    stride = 1
+                    current_dim = self.shape[idx]
+                    while stride < current_dim:
+                        assert dim >= 0
+                        if stride * newshape[dim] <= current_dim:
+                            if newshape[dim] > 1:
+                                transform.trans[idx][dim] = stride
+                                stride *= newshape[dim]
+                            dim -= 1
+                        else:
+                            # We failed, so we're done
+                            transform = None
+                            break
+                    if transform is None:
+                        break
+            if order == "F" or (order == "A" and transform is None):
+                # See if we can group the dimensions from left to right in
+                # a way that creates dimensions in the old shape
+                # TODO; think about how this interoperates with partitioning
+                pass
+        if transform is None:
+            # If we don't have a transform then we need to make a copy
+            warnings.warn(
+                "legate.numpy has not implemented reshape/ravel for newshape "
+                + str(newshape)
+                + " which is a non-affine mapping and is falling back to "
+                + "canonical numpy. You may notice significantly decreased "
+                + "performance for this function call.",
+                stacklevel=(stacklevel + 1),
+                category=RuntimeWarning,
+            )
+            numpy_array = self.__numpy_array__(stacklevel=(stacklevel + 1))
+            # Force a copy here because we know we can't build a view
+            result_array = numpy_array.reshape(newshape, order=order).copy()
+            result = self.runtime.get_numpy_thunk(
+                result_array, stacklevel=(stacklevel + 1)
+            )
+        else:
+            # If we have a transform then we can make a view
+            affine_transform = AffineTransform(self.ndim, len(newshape), False)
+            affine_transform.trans = transform.trans
+            result = self.runtime.create_transform_view(
+                self.base, newshape, affine_transform
+            )
+        if self.runtime.shadow_debug:
+            result.shadow = self.shadow.reshape(
+                newshape, order, stacklevel=(stacklevel + 1)
+            )
+        return result
+
+    def squeeze(self, axis, stacklevel):
+        if axis is None:
+            new_shape = ()
+            axis = ()
+            for idx in xrange(self.ndim):
+                if self.shape[idx] != 1:
+                    new_shape = new_shape + (self.shape[idx],)
+                else:
+                    # Record the dropped axis index
+                    axis = axis + (idx,)
+        elif isinstance(axis, int):
+            new_shape = ()
+            for idx in xrange(self.ndim):
+                if idx == axis:
+                    assert self.shape[idx] == 1
+                else:
+                    new_shape = new_shape + (self.shape[idx],)
+            # Convert to a tuple of dropped axes
+            axis = (axis,)
+        elif isinstance(axis, tuple):
+            new_shape = ()
+            for idx in xrange(self.ndim):
+                if idx in axis:
+                    assert self.shape[idx] == 1
+                else:
+                    new_shape = new_shape + (self.shape[idx],)
+        else:
+            raise TypeError(
+                '"axis" argument for squeeze must be int-like or tuple-like'
+            )
+        if not self.scalar:
+            # Make transform for the lost dimensions
+            transform = AffineTransform(self.ndim, len(new_shape), False)
+            child_idx = 0
+            for parent_idx in xrange(self.ndim):
+                # If this is a collapsed dimension then record it
+                if parent_idx not in axis:
+                    transform.trans[parent_idx, child_idx] = 1
+                    child_idx += 1
+            assert child_idx == len(new_shape)
+            result = self.runtime.create_transform_view(
+                self.base, new_shape, transform
+            )
+        else:
+            # Easy case of size 1 array, nothing to do
+            result = DeferredArray(
+                self.runtime, self.base, new_shape, self.dtype, True
+            )
+        if self.runtime.shadow_debug:
+            result.shadow = self.shadow.squeeze(
+                axis, stacklevel=(stacklevel + 1)
+            )
+        return result
+
+    def swapaxes(self, axis1, axis2, stacklevel):
+        if self.size == 1:
+            return self
+        # Make a new deferred array object and swap the results
+        assert axis1 < self.ndim and axis2 < self.ndim
+        # Create a new shape and transform for the region field object
+        new_shape = ()
+        for idx in xrange(self.ndim):
+            if idx == axis1:
+                new_shape = new_shape + (self.shape[axis2],)
+            elif idx == axis2:
+                new_shape = new_shape + (self.shape[axis1],)
+            else:
+                new_shape = new_shape + (self.shape[idx],)
+        transform = AffineTransform(self.ndim, self.ndim, True)
+        transform.transform[axis1, axis1] = 0
+        transform.transform[axis2, axis2] = 0
+        transform.transform[axis1, axis2] = 1
+        transform.transform[axis2, axis1] = 1
+        result = self.runtime.create_transform_view(
+            self.base, new_shape, transform
+        )
+        if self.runtime.shadow_debug:
+            result.shadow = self.shadow.swapaxes(
+                axis1, axis2, stacklevel=(stacklevel + 1)
+            )
+        return result
+
+    # Convert the source array to the destination array
+    def convert(self, rhs, stacklevel, warn=True, callsite=None):
+        src_array = self.runtime.to_deferred_array(
+            rhs, stacklevel=(stacklevel + 1)
+        )
+        dst_array = self
+        dst_dtype = dst_array.dtype
+        assert src_array.dtype != dst_dtype
+        assert src_array.shape == dst_array.shape or (
+            src_array.size == 1 and dst_array.size == 1
         )
         src = src_array.base
         dst = dst_array.base
@@ -2547,30 +3412,547 @@ class DeferredArray(NumPyThunk):
         assert lhs_array.dtype == rhs_array.dtype
         assert lhs_array.ndim == rhs_array.ndim
         assert lhs_array.ndim == len(axes)
-        # We don't support some cases right now
-        if lhs_array.ndim > 2:
-            raise NotImplementedError(
-                "legate.numpy only supports standard 2-D transposes for now"
+        src = rhs_array.base
+        dst = lhs_array.base
+        # View the source through the permutation so that it has the same
+        # shape as the destination. The task then only sees the permutation
+        # in the strides of its accessors and the source can be partitioned
+        # with the same tiles as the destination for any number of axes.
+        permutation = AffineTransform(rhs_array.ndim, lhs_array.ndim, False)
+        for dim, axis in enumerate(axes):
+            permutation.trans[axis, dim] = 1
+        src_view = self.runtime.create_transform_view(
+            src, lhs_array.shape, permutation
+        ).base
+        launch_space = dst.compute_parallel_launch_space()
+        # Now launch the task
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            dst_part, shardfn, shardsp = dst.find_or_create_key_partition()
+            self.pack_shape(argbuf, lhs_array.shape, dst_part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, lhs_array.shape)
+        argbuf.pack_accessor(dst.field.field_id, dst.transform)
+        argbuf.pack_accessor(src.field.field_id, src_view.transform)
+        if launch_space is not None:
+            task = IndexTask(
+                self.runtime.get_unary_task_id(
+                    NumPyOpCode.TRANSPOSE,
+                    result_type=lhs_array.dtype,
+                    argument_type=rhs_array.dtype,
+                ),
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_write_requirement(
+                dst_part,
+                dst.field.field_id,
+                0,
+                tag=NumPyMappingTag.KEY_REGION_TAG,
+            )
+            # Tile the permuted source the same way as the destination
+            src_part = src_view.find_or_create_partition(
+                launch_space, dst_part.tile_shape, dst_part.tile_offset
+            )
+            task.add_read_requirement(
+                src_part,
+                src.field.field_id,
+                0,
+                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+            )
+            self.runtime.dispatch(task)
+        else:
+            shardpt, shardfn, shardsp = dst.find_point_sharding()
+            task = Task(
+                self.runtime.get_unary_task_id(
+                    NumPyOpCode.TRANSPOSE,
+                    result_type=lhs_array.dtype,
+                    argument_type=rhs_array.dtype,
+                ),
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_write_requirement(dst.region, dst.field.field_id)
+            task.add_read_requirement(src.region, src.field.field_id)
+            self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        # See if we are doing shadow debugging
+        if self.runtime.shadow_debug:
+            self.shadow.transpose(
+                rhs.shadow, axes, stacklevel=(stacklevel + 1)
+            )
+            self.runtime.check_shadow(self, "transpose")
+
+    # Pick a tile size for the tiled linear algebra routines
+    def _compute_linalg_tile_size(self, extent):
+        # We want a few tiles per processor in each dimension so there is
+        # enough parallelism in the trailing updates, but we don't want
+        # the tiles to get so small that the BLAS calls stop being efficient
+        tiles = 1
+        while tiles * tiles < 4 * self.runtime.num_pieces:
+            tiles += 1
+        return max((extent + tiles - 1) // tiles, LINALG_MIN_TILE_SIZE)
+
+    # Get a view of a block of rows and columns of a matrix
+    def _get_linalg_tile(self, rows, cols, stacklevel):
+        if rows == (0, self.shape[0]) and cols == (0, self.shape[1]):
+            return self
+        return self.get_item(
+            (slice(rows[0], rows[1]), slice(cols[0], cols[1])),
+            stacklevel=(stacklevel + 1),
+        )
+
+    # Launch one of the single-tile linear algebra tasks, the first
+    # tile is the one that gets updated and the rest are read-only
+    def _launch_linalg_task(self, op_code, tiles, flags=(), write=False):
+        argbuf = BufferBuilder()
+        for flag in flags:
+            argbuf.pack_bool(flag)
+        for tile in tiles:
+            self.pack_shape(argbuf, tile.shape)
+            argbuf.pack_accessor(tile.base.field.field_id, tile.base.transform)
+        task = Task(
+            self.runtime.get_nullary_task_id(op_code, result_type=self.dtype),
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+        )
+        dst = tiles[0].base
+        if write:
+            task.add_write_requirement(dst.region, dst.field.field_id)
+        else:
+            task.add_read_write_requirement(dst.region, dst.field.field_id)
+        for tile in tiles[1:]:
+            task.add_read_requirement(
+                tile.base.region, tile.base.field.field_id
+            )
+        return self.runtime.dispatch(task)
+
+    def cholesky(self, rhs, stacklevel, callsite=None):
+        rhs_array = self.runtime.to_deferred_array(
+            rhs, stacklevel=(stacklevel + 1)
+        )
+        assert self.ndim == 2 and self.shape[0] == self.shape[1]
+        assert self.dtype.type == np.float32 or self.dtype.type == np.float64
+        # Factor a copy of the input in place
+        self.copy(rhs_array, deep=True, stacklevel=(stacklevel + 1))
+        n = self.shape[0]
+        tile_size = self._compute_linalg_tile_size(n)
+        bounds = [
+            (lo, min(lo + tile_size, n)) for lo in range(0, n, tile_size)
+        ]
+        num_tiles = len(bounds)
+        tiles = dict()
+
+        def tile(i, j):
+            if (i, j) not in tiles:
+                tiles[(i, j)] = self._get_linalg_tile(
+                    bounds[i], bounds[j], stacklevel=(stacklevel + 1)
+                )
+            return tiles[(i, j)]
+
+        # Right-looking tiled Cholesky, Legion finds the parallelism
+        # between the tile tasks from their region requirements
+        infos = list()
+        for k in range(num_tiles):
+            infos.append(
+                self._launch_linalg_task(NumPyOpCode.POTRF, (tile(k, k),))
+            )
+            for i in range(k + 1, num_tiles):
+                # L_ik = A_ik L_kk^-T
+                self._launch_linalg_task(
+                    NumPyOpCode.TRSM,
+                    (tile(i, k), tile(k, k)),
+                    flags=(False, True, True),
+                )
+            for j in range(k + 1, num_tiles):
+                # A_jj -= L_jk L_jk^T
+                self._launch_linalg_task(
+                    NumPyOpCode.SYRK, (tile(j, j), tile(j, k))
+                )
+                for i in range(j + 1, num_tiles):
+                    # A_ij -= L_ik L_jk^T
+                    self._launch_linalg_task(
+                        NumPyOpCode.GEMM,
+                        (tile(i, j), tile(i, k), tile(j, k)),
+                        flags=(False, True),
+                    )
+        # The POTRF tasks clean up the diagonal tiles, we still need to
+        # clear out the tiles above the diagonal
+        zero = np.array(0, dtype=self.dtype)
+        for i in range(num_tiles):
+            for j in range(i + 1, num_tiles):
+                tile(i, j).fill(zero, stacklevel=(stacklevel + 1))
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        # Check every diagonal tile since a failure in one of them need
+        # not carry over to the tiles factored after it
+        for info in infos:
+            status = np.frombuffer(
+                info.get_buffer(4), dtype=np.int32, count=1
+            )
+            if status[0] != 0:
+                raise np.linalg.LinAlgError("Matrix is not positive definite")
+        if self.runtime.shadow_debug:
+            self.shadow.cholesky(rhs.shadow, stacklevel=(stacklevel + 1))
+            self.runtime.check_shadow(self, "cholesky")
+
+    def solve_triangular(self, a, b, lower, trans, stacklevel, callsite=None):
+        a_array = self.runtime.to_deferred_array(
+            a, stacklevel=(stacklevel + 1)
+        )
+        b_array = self.runtime.to_deferred_array(
+            b, stacklevel=(stacklevel + 1)
+        )
+        assert self.ndim == 2 and self.shape == b_array.shape
+        assert a_array.shape == (self.shape[0], self.shape[0])
+        assert self.dtype.type == np.float32 or self.dtype.type == np.float64
+        # Solve in place on a copy of the right-hand sides
+        self.copy(b_array, deep=True, stacklevel=(stacklevel + 1))
+        n = self.shape[0]
+        tile_size = self._compute_linalg_tile_size(n)
+        bounds = [
+            (lo, min(lo + tile_size, n)) for lo in range(0, n, tile_size)
+        ]
+        columns = (0, self.shape[1])
+        # op(A) is lower triangular if exactly one of these is set in which
+        # case we do forward substitution over the row blocks, otherwise
+        # we do backward substitution
+        if lower != trans:
+            order = list(range(len(bounds)))
+        else:
+            order = list(reversed(range(len(bounds))))
+        solved = list()
+        for i in order:
+            x_i = self._get_linalg_tile(
+                bounds[i], columns, stacklevel=(stacklevel + 1)
+            )
+            for j in solved:
+                x_j = self._get_linalg_tile(
+                    bounds[j], columns, stacklevel=(stacklevel + 1)
+                )
+                # x_i -= op(A)_ij x_j
+                if trans:
+                    a_ij = a_array._get_linalg_tile(
+                        bounds[j], bounds[i], stacklevel=(stacklevel + 1)
+                    )
+                else:
+                    a_ij = a_array._get_linalg_tile(
+                        bounds[i], bounds[j], stacklevel=(stacklevel + 1)
+                    )
+                self._launch_linalg_task(
+                    NumPyOpCode.GEMM, (x_i, a_ij, x_j), flags=(trans, False)
+                )
+            a_ii = a_array._get_linalg_tile(
+                bounds[i], bounds[i], stacklevel=(stacklevel + 1)
+            )
+            self._launch_linalg_task(
+                NumPyOpCode.TRSM, (x_i, a_ii), flags=(True, lower, trans)
+            )
+            solved.append(i)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.solve_triangular(
+                a.shadow, b.shadow, lower, trans, stacklevel=(stacklevel + 1)
+            )
+            self.runtime.check_shadow(self, "solve_triangular")
+
+    def qr_r(self, rhs, stacklevel, callsite=None):
+        rhs_array = self.runtime.to_deferred_array(
+            rhs, stacklevel=(stacklevel + 1)
+        )
+        assert rhs_array.ndim == 2
+        k = rhs_array.shape[1]
+        assert self.shape == (k, k)
+        assert self.dtype.type == np.float32 or self.dtype.type == np.float64
+        # Tall-skinny QR: factor blocks of rows independently, stack up
+        # their R factors and keep reducing them until one block is left
+        current = rhs_array
+        pieces = min(self.runtime.num_pieces, rhs_array.shape[0] // k)
+        while pieces > 1:
+            launch_space = (pieces, 1)
+            src = current.base
+            src_part = src.find_or_create_partition(launch_space)
+            dst_shape = (pieces * k, k)
+            dst = self.runtime.allocate_field(dst_shape, self.dtype)
+            dst_part = dst.find_or_create_partition(launch_space, (k, k))
+            argbuf = BufferBuilder()
+            self.pack_shape(argbuf, dst_shape, dst_part.tile_shape, 0)
+            argbuf.pack_accessor(dst.field.field_id, dst.transform)
+            self.pack_shape(argbuf, current.shape, src_part.tile_shape, 0)
+            argbuf.pack_accessor(src.field.field_id, src.transform)
+            task = IndexTask(
+                self.runtime.get_nullary_task_id(
+                    NumPyOpCode.GEQRF, result_type=self.dtype
+                ),
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+            )
+            task.add_write_requirement(
+                dst_part,
+                dst.field.field_id,
+                0,
+                tag=NumPyMappingTag.KEY_REGION_TAG,
+            )
+            task.add_read_requirement(src_part, src.field.field_id, 0)
+            self.runtime.dispatch(task)
+            current = DeferredArray(
+                self.runtime,
+                dst,
+                shape=dst_shape,
+                dtype=self.dtype,
+                scalar=False,
+            )
+            pieces = (pieces + self.runtime.radix - 1) // self.runtime.radix
+        self._launch_linalg_task(
+            NumPyOpCode.GEQRF, (self, current), write=True
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.qr_r(rhs.shadow, stacklevel=(stacklevel + 1))
+            self.runtime.check_shadow(self, "qr_r")
+
+    def nrm2(self, rhs, stacklevel, callsite=None):
+        rhs_array = self.runtime.to_deferred_array(
+            rhs, stacklevel=(stacklevel + 1)
+        )
+        assert self.size == 1
+        assert self.dtype.type == np.float32 or self.dtype.type == np.float64
+        assert rhs_array.dtype == self.dtype
+        src = rhs_array.base
+        # Each piece writes the scale and the scaled sum of squares of its
+        # elements into its own entry of two fields shaped like the launch
+        # space, then a scalar task merges them into the norm
+        launch_space = src.compute_parallel_launch_space()
+        partial_shape = launch_space if launch_space is not None else (1,)
+        scale = self.runtime.allocate_field(partial_shape, self.dtype)
+        sumsq = self.runtime.allocate_field(partial_shape, self.dtype)
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            src_part, shardfn, shardsp = src.find_or_create_key_partition()
+            self.pack_shape(argbuf, rhs_array.shape, src_part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, rhs_array.shape)
+        argbuf.pack_accessor(src.field.field_id, src.transform)
+        argbuf.pack_bool(launch_space is not None)
+        argbuf.pack_dimension(len(partial_shape))
+        argbuf.pack_accessor(scale.field.field_id, scale.transform)
+        argbuf.pack_accessor(sumsq.field.field_id, sumsq.transform)
+        task_id = self.runtime.get_nullary_task_id(
+            NumPyOpCode.NRM2, result_type=self.dtype
+        )
+        if launch_space is not None:
+            unit = (1,) * len(launch_space)
+            scale_part = scale.find_or_create_partition(launch_space, unit)
+            sumsq_part = sumsq.find_or_create_partition(launch_space, unit)
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_read_requirement(
+                src_part,
+                src.field.field_id,
+                0,
+                tag=NumPyMappingTag.KEY_REGION_TAG,
+            )
+            task.add_write_requirement(scale_part, scale.field.field_id, 0)
+            task.add_write_requirement(sumsq_part, sumsq.field.field_id, 0)
+        else:
+            shardpt, shardfn, shardsp = src.find_point_sharding()
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_read_requirement(src.region, src.field.field_id)
+            task.add_write_requirement(scale.region, scale.field.field_id)
+            task.add_write_requirement(sumsq.region, sumsq.field.field_id)
+        self.runtime.dispatch(task)
+        argbuf = BufferBuilder()
+        self.pack_shape(argbuf, partial_shape)
+        argbuf.pack_accessor(scale.field.field_id, scale.transform)
+        argbuf.pack_accessor(sumsq.field.field_id, sumsq.transform)
+        task = Task(
+            self.runtime.get_nullary_task_id(
+                NumPyOpCode.NRM2,
+                result_type=self.dtype,
+                variant_code=NumPyVariantCode.SCALAR,
+            ),
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+        )
+        task.add_read_requirement(scale.region, scale.field.field_id)
+        task.add_read_requirement(sumsq.region, sumsq.field.field_id)
+        self.base = self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.nrm2(rhs.shadow, stacklevel=(stacklevel + 1))
+            self.runtime.check_shadow(self, "nrm2")
+
+    def axpby(self, alpha, x, beta, y, norm, stacklevel, callsite=None):
+        lhs_array = self
+        x_array = self.runtime.to_deferred_array(
+            x, stacklevel=(stacklevel + 1)
+        )
+        y_array = self.runtime.to_deferred_array(
+            y, stacklevel=(stacklevel + 1)
+        )
+        coefficients = []
+        for coefficient in (alpha, beta):
+            coefficient_array = self.runtime.to_deferred_array(
+                coefficient, stacklevel=(stacklevel + 1)
+            )
+            assert coefficient_array.size == 1
+            assert coefficient_array.dtype == self.dtype
+            coefficients.append(coefficient_array.base)
+        assert self.dtype.type == np.float32 or self.dtype.type == np.float64
+        assert x_array.shape == self.shape and y_array.shape == self.shape
+        assert x_array.dtype == self.dtype and y_array.dtype == self.dtype
+        dst = lhs_array.base
+        src1 = x_array.base
+        src2 = y_array.base
+        # The update is a single pass over the three vectors, which all
+        # share the partition of the output, and with a norm we get its
+        # square back as a sum reduction over the point tasks
+        variant = (
+            NumPyVariantCode.NORMAL
+            if norm is None
+            else NumPyVariantCode.REDUCTION
+        )
+        task_id = self.runtime.get_nullary_task_id(
+            NumPyOpCode.AXPBY, result_type=self.dtype, variant_code=variant
+        )
+        launch_space = dst.compute_parallel_launch_space()
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            dst_part, shardfn, shardsp = dst.find_or_create_key_partition()
+            self.pack_shape(argbuf, self.shape, dst_part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_accessor(dst.field.field_id, dst.transform)
+        argbuf.pack_accessor(src1.field.field_id, src1.transform)
+        argbuf.pack_accessor(src2.field.field_id, src2.transform)
+        if launch_space is not None:
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_write_requirement(
+                dst_part,
+                dst.field.field_id,
+                0,
+                tag=NumPyMappingTag.KEY_REGION_TAG,
+            )
+            src1_part = src1.find_or_create_congruent_partition(dst_part)
+            task.add_read_requirement(src1_part, src1.field.field_id, 0)
+            src2_part = src2.find_or_create_congruent_partition(dst_part)
+            task.add_read_requirement(src2_part, src2.field.field_id, 0)
+        else:
+            shardpt, shardfn, shardsp = dst.find_point_sharding()
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_write_requirement(dst.region, dst.field.field_id)
+            task.add_read_requirement(src1.region, src1.field.field_id)
+            task.add_read_requirement(src2.region, src2.field.field_id)
+        for future in coefficients:
+            task.add_future(future)
+        if norm is None:
+            self.runtime.dispatch(task)
+        else:
+            norm_array = self.runtime.to_deferred_array(
+                norm, stacklevel=(stacklevel + 1)
+            )
+            assert norm_array.size == 1
+            if launch_space is not None:
+                norm_array.base = self.runtime.dispatch(
+                    task,
+                    redop=self.runtime.get_reduction_op_id(
+                        NumPyOpCode.AXPBY, self.dtype
+                    ),
+                )
+            else:
+                norm_array.base = self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.axpby(
+                alpha.shadow,
+                x.shadow,
+                beta.shadow,
+                y.shadow,
+                None if norm is None else norm.shadow,
+                stacklevel=(stacklevel + 1),
             )
-        src = rhs_array.base
-        dst = lhs_array.base
-        launch_space = dst.compute_parallel_launch_space()
-        # Now launch the task
+            self.runtime.check_shadow(self, "axpby")
+
+    def _create_path_future(self, filename):
+        # The point tasks can run anywhere so they need the absolute path
+        path = os.fsencode(os.path.abspath(filename)) + b"\0"
+        array = np.frombuffer(path, dtype=np.uint8)
+        return self.runtime.create_future(array.data, array.nbytes)
+
+    def _launch_file_task(self, op, write, argfn, futures):
+        # Every point task moves the bytes of its own tile directly between
+        # the file and its instance, so we use the key partition of the
+        # array as is, whatever it looks like
+        region = self.base
+        task_id = self.runtime.get_nullary_task_id(op, result_type=self.dtype)
+        launch_space = region.compute_parallel_launch_space()
         argbuf = BufferBuilder()
         if launch_space is not None:
-            dst_part, shardfn, shardsp = dst.find_or_create_key_partition()
-            self.pack_shape(argbuf, lhs_array.shape, dst_part.tile_shape, 0)
+            part, shardfn, shardsp = region.find_or_create_key_partition()
+            self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
         else:
-            self.pack_shape(argbuf, lhs_array.shape)
-        argbuf.pack_accessor(dst.field.field_id, dst.transform)
-        argbuf.pack_accessor(src.field.field_id, src.transform)
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_point(self.shape)
+        argbuf.pack_accessor(region.field.field_id, region.transform)
+        argfn(argbuf)
         if launch_space is not None:
             task = IndexTask(
-                self.runtime.get_unary_task_id(
-                    NumPyOpCode.TRANSPOSE,
-                    result_type=lhs_array.dtype,
-                    argument_type=rhs_array.dtype,
-                ),
+                task_id,
                 Rect(launch_space),
                 self.runtime.empty_argmap,
                 argbuf.get_string(),
@@ -2580,35 +3962,24 @@ class DeferredArray(NumPyThunk):
             )
             if shardsp is not None:
                 task.set_sharding_space(shardsp)
-            task.add_write_requirement(
-                dst_part,
-                dst.field.field_id,
-                0,
-                tag=NumPyMappingTag.KEY_REGION_TAG,
-            )
-            # Compute the partition using the transposed launch space
-            src_launch_space = tuple(map(lambda x: launch_space[x], axes))
-            src_tile_shape = tuple(map(lambda x: dst_part.tile_shape[x], axes))
-            src_offset = tuple(map(lambda x: dst_part.tile_offset[x], axes))
-            src_part = src.find_or_create_partition(
-                src_launch_space, src_tile_shape, src_offset
-            )
-            # TODO: change the hard-coded projection function for 2D
-            task.add_read_requirement(
-                src_part,
-                src.field.field_id,
-                self.runtime.first_proj_id + NumPyProjCode.PROJ_2D_2D_YX,
-                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
-            )
-            self.runtime.dispatch(task)
+            if write:
+                task.add_write_requirement(
+                    part,
+                    region.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                task.add_read_requirement(
+                    part,
+                    region.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
         else:
-            shardpt, shardfn, shardsp = dst.find_point_sharding()
+            shardpt, shardfn, shardsp = region.find_point_sharding()
             task = Task(
-                self.runtime.get_unary_task_id(
-                    NumPyOpCode.TRANSPOSE,
-                    result_type=lhs_array.dtype,
-                    argument_type=rhs_array.dtype,
-                ),
+                task_id,
                 argbuf.get_string(),
                 argbuf.get_size(),
                 mapper=self.runtime.mapper_id,
@@ -2618,16 +3989,200 @@ class DeferredArray(NumPyThunk):
                 task.set_point(shardpt)
             if shardsp is not None:
                 task.set_sharding_space(shardsp)
-            task.add_write_requirement(dst.region, dst.field.field_id)
-            task.add_read_requirement(src.region, src.field.field_id)
-            self.runtime.dispatch(task)
+            if write:
+                task.add_write_requirement(
+                    region.region, region.field.field_id
+                )
+            else:
+                task.add_read_requirement(region.region, region.field.field_id)
+        for future in futures:
+            task.add_future(future)
+        return self.runtime.dispatch(task)
+
+    def read_file(self, filename, offset, npy, stacklevel, callsite=None):
+        assert not self.scalar and self.size > 0
+
+        def pack_args(argbuf):
+            argbuf.pack_bool(npy)
+            argbuf.pack_value(offset, np.uint64)
+
+        self._launch_file_task(
+            NumPyOpCode.READ_FILE,
+            True,
+            pack_args,
+            (self._create_path_future(filename),),
+        )
         self.runtime.profile_callsite(stacklevel + 1, True, callsite)
-        # See if we are doing shadow debugging
         if self.runtime.shadow_debug:
-            self.shadow.transpose(
-                rhs.shadow, axes, stacklevel=(stacklevel + 1)
+            self.shadow.read_file(
+                filename, offset, npy, stacklevel=(stacklevel + 1)
+            )
+            self.runtime.check_shadow(self, "read_file")
+
+    def write_file(
+        self, filename, offset, header, truncate, stacklevel, callsite=None
+    ):
+        assert not self.scalar and self.size > 0
+        futures = [self._create_path_future(filename)]
+        if header is not None:
+            array = np.frombuffer(header, dtype=np.uint8)
+            futures.append(
+                self.runtime.create_future(array.data, array.nbytes)
+            )
+
+        def pack_args(argbuf):
+            argbuf.pack_bool(truncate)
+            argbuf.pack_bool(header is not None)
+            argbuf.pack_value(offset, np.uint64)
+
+        # The writes are side effects that nothing in the program depends
+        # on, so wait for them before anyone can look at the file
+        self._launch_file_task(
+            NumPyOpCode.WRITE_FILE, False, pack_args, futures
+        ).wait()
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+
+    def count_lines(
+        self, filename, comment, splits, stacklevel, callsite=None
+    ):
+        # One point task counts the rows of data in each chunk of the file
+        # between a pair of splits, which always fall at the start of a line
+        assert self.ndim == 1 and self.shape[0] == len(splits) - 1
+        region = self.base
+        task_id = self.runtime.get_nullary_task_id(
+            NumPyOpCode.COUNT_LINES, result_type=self.dtype
+        )
+        argbuf = BufferBuilder()
+        if self.shape[0] > 1:
+            part = region.find_or_create_partition(self.shape)
+            self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_accessor(region.field.field_id, region.transform)
+        argbuf.pack_32bit_int(0 if comment is None else ord(comment))
+        argbuf.pack_32bit_uint(self.shape[0])
+        for split in splits:
+            argbuf.pack_value(split, np.uint64)
+        if self.shape[0] > 1:
+            task = IndexTask(
+                task_id,
+                Rect(self.shape),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+            )
+            task.add_write_requirement(
+                part,
+                region.field.field_id,
+                0,
+                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+            )
+        else:
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+            )
+            task.add_write_requirement(region.region, region.field.field_id)
+        task.add_future(self._create_path_future(filename))
+        self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+
+    def read_text(
+        self,
+        filename,
+        comment,
+        delimiter,
+        chunks,
+        stop,
+        stacklevel,
+        callsite=None,
+    ):
+        assert not self.scalar and 0 < self.ndim <= 2
+
+        def pack_args(argbuf):
+            argbuf.pack_32bit_int(0 if comment is None else ord(comment))
+            argbuf.pack_32bit_int(0 if delimiter is None else ord(delimiter))
+            argbuf.pack_32bit_uint(len(chunks))
+            for start, first_row in chunks:
+                argbuf.pack_value(start, np.uint64)
+                argbuf.pack_value(first_row, np.uint64)
+            argbuf.pack_value(stop, np.uint64)
+
+        # Each point task parses the rows of its own tile starting from the
+        # chunk that holds the first of them
+        self._launch_file_task(
+            NumPyOpCode.READ_TEXT,
+            True,
+            pack_args,
+            (self._create_path_future(filename),),
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.read_text(
+                filename,
+                comment,
+                delimiter,
+                chunks,
+                stop,
+                stacklevel=(stacklevel + 1),
+            )
+            self.runtime.check_shadow(self, "read_text")
+
+    def checkpoint(self, prefix, compress, stacklevel, callsite=None):
+        assert not self.scalar and self.size > 0
+        # Every point task writes its own tile of the key partition into a
+        # file of its own, so the shape and origin of those tiles are all
+        # that a restore needs to know to find them again. The tiles of
+        # views can start before their first element.
+        tile_origin = (0,) * self.ndim
+        if self.base.compute_parallel_launch_space() is not None:
+            part, _, _ = self.base.find_or_create_key_partition()
+            tile_shape = tuple(int(x) for x in part.tile_shape)
+            if part.tile_offset is not None:
+                tile_origin = tuple(int(x) for x in part.tile_offset)
+        else:
+            tile_shape = self.shape
+
+        def pack_args(argbuf):
+            argbuf.pack_bool(compress)
+            argbuf.pack_point(tile_shape)
+            argbuf.pack_point(tile_origin)
+
+        self._launch_file_task(
+            NumPyOpCode.CHECKPOINT,
+            False,
+            pack_args,
+            (self._create_path_future(prefix),),
+        ).wait()
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        return tile_shape, tile_origin
+
+    def restore(
+        self, prefix, tile_shape, tile_origin, stacklevel, callsite=None
+    ):
+        assert not self.scalar and self.size > 0
+
+        def pack_args(argbuf):
+            argbuf.pack_point(tile_shape)
+            argbuf.pack_point(tile_origin)
+
+        # The saved tiles can have any shape so each point task reads all
+        # the ones that overlap its own tile
+        self._launch_file_task(
+            NumPyOpCode.RESTORE,
+            True,
+            pack_args,
+            (self._create_path_future(prefix),),
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            # There is nothing to check the restored values against
+            self.shadow.array[:] = self.__numpy_array__(
+                stacklevel=(stacklevel + 1)
             )
-            self.runtime.check_shadow(self, "transpose")
 
     # Perform a bin count operation on the array
     def bincount(self, rhs, stacklevel, weights=None, callsite=None):
@@ -2895,6 +4450,133 @@ class DeferredArray(NumPyThunk):
             check_types=False,
         )
 
+    def _count_per_tile(self, part, launch_space, shardfn, shardsp):
+        # Counts the nonzeros in every tile of part into a vector with one
+        # entry for each point of the launch space in C order, or in the
+        # whole array into a vector of one entry without a launch space
+        rhs = self.base
+        task_id = self.runtime.get_unary_task_id(
+            NumPyOpCode.COUNT_NONZERO_REDUC,
+            result_type=np.dtype(np.uint64),
+            argument_type=self.dtype,
+        )
+        argbuf = BufferBuilder()
+        if launch_space is None:
+            counts_shape = (1,)
+            counts = self.runtime.allocate_field(
+                counts_shape, np.dtype(np.uint64)
+            )
+            self.pack_shape(argbuf, self.shape)
+            argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
+            self.pack_shape(argbuf, counts_shape)
+            argbuf.pack_accessor(counts.field.field_id, counts.transform)
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+            )
+            task.add_read_requirement(rhs.region, rhs.field.field_id)
+            task.add_write_requirement(counts.region, counts.field.field_id)
+            self.runtime.dispatch(task)
+            return counts
+        counts_shape = (calculate_volume(launch_space),)
+        counts = self.runtime.allocate_field(counts_shape, np.dtype(np.uint64))
+        counts_part = counts.find_or_create_partition(counts_shape)
+        counts_proj = (
+            self.runtime.first_proj_id + NumPyProjCode.PROJ_ND_1D_C_ORDER
+        )
+        self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
+        argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
+        self.pack_shape(
+            argbuf, counts_shape, counts_part.tile_shape, counts_proj
+        )
+        argbuf.pack_accessor(counts.field.field_id, counts.transform)
+        task = IndexTask(
+            task_id,
+            Rect(launch_space),
+            self.runtime.empty_argmap,
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+            tag=shardfn,
+        )
+        if shardsp is not None:
+            task.set_sharding_space(shardsp)
+        task.add_read_requirement(
+            part, rhs.field.field_id, 0, tag=NumPyMappingTag.KEY_REGION_TAG
+        )
+        task.add_write_requirement(
+            counts_part,
+            counts.field.field_id,
+            counts_proj,
+            tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+        )
+        self.runtime.dispatch(task)
+        return counts
+
+    def _partition_by_counts(self, counts, dst, ndim=None):
+        # Turns the number of entries that each point task will write into
+        # a partition of the columns of dst that gives every point task its
+        # own range of them in order, or of dst itself when ndim is None
+        # and dst is a vector. The counts are scanned in place.
+        counts_shape = counts.shape
+        argbuf = BufferBuilder()
+        self.pack_shape(argbuf, counts_shape, pack_dim=False)
+        argbuf.pack_accessor(counts.field.field_id, counts.transform)
+        task = Task(
+            self.runtime.get_unary_task_id(
+                NumPyOpCode.INCLUSIVE_SCAN,
+                result_type=counts.field.dtype,
+                argument_type=counts.field.dtype,
+            ),
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+        )
+        task.add_read_write_requirement(counts.region, counts.field.field_id)
+        self.runtime.dispatch(task)
+
+        rect_type = "legion_rect_1d_t" if ndim is None else "legion_rect_2d_t"
+        ranges = self.runtime.allocate_field(
+            counts_shape, np.dtype((np.void, ffi.sizeof(rect_type)))
+        )
+        argbuf = BufferBuilder()
+        argbuf.pack_32bit_int(-1 if ndim is None else ndim - 1)
+        self.pack_shape(argbuf, counts_shape)
+        argbuf.pack_accessor(counts.field.field_id, counts.transform)
+        argbuf.pack_accessor(ranges.field.field_id, ranges.transform)
+        task = Task(
+            self.runtime.get_unary_task_id(
+                NumPyOpCode.CONVERT_TO_RECT,
+                result_type=np.dtype(np.uint64),
+                argument_type=counts.field.dtype,
+            ),
+            argbuf.get_string(),
+            argbuf.get_size(),
+            mapper=self.runtime.mapper_id,
+        )
+        task.add_read_requirement(counts.region, counts.field.field_id)
+        task.add_write_requirement(ranges.region, ranges.field.field_id)
+        self.runtime.dispatch(task)
+
+        projection = ranges.find_or_create_partition(counts_shape)
+        functor = PartitionByImageRange(
+            ranges.region,
+            projection,
+            ranges.field.field_id,
+            self.runtime.mapper_id,
+        )
+        index_partition = IndexPartition(
+            self.runtime.context,
+            self.runtime.runtime,
+            dst.region.index_space,
+            projection.color_space,
+            functor,
+            kind=legion.DISJOINT_COMPLETE_KIND,
+        )
+        return dst.region.get_child(index_partition)
+
     def nonzero(self, stacklevel, callsite=None):
         # First we need to count how many non-zero elements there are and then
         # we can make arrays for recording the indexes in each dimension
@@ -2943,30 +4625,22 @@ class DeferredArray(NumPyThunk):
         if launch_space is not None:  # Index task launch
             # First get the amount of nonzeros for each point in the
             # launch_space
-            nonzeros_dist_shape = (calculate_volume(launch_space),)
-            nonzeros_dist_field = self.runtime.allocate_field(
-                nonzeros_dist_shape, np.dtype(np.uint64)
+            launch_part, shardfn, shardsp = rhs.find_or_create_key_partition()
+            nonzeros_dist_field = self._count_per_tile(
+                launch_part, launch_space, shardfn, shardsp
             )
-            nonzeros_dist_part = nonzeros_dist_field.find_or_create_partition(
-                nonzeros_dist_shape
+
+            dst_partition = self._partition_by_counts(
+                nonzeros_dist_field, dst, self.ndim
             )
-            launch_part, shardfn, shardsp = rhs.find_or_create_key_partition()
+
             argbuf = BufferBuilder()
             self.pack_shape(argbuf, self.shape, launch_part.tile_shape, 0)
             argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
-            self.pack_shape(
-                argbuf,
-                nonzeros_dist_shape,
-                nonzeros_dist_part.tile_shape,
-                self.runtime.first_proj_id + NumPyProjCode.PROJ_ND_1D_C_ORDER,
-            )
-            argbuf.pack_accessor(
-                nonzeros_dist_field.field.field_id,
-                nonzeros_dist_field.transform,
-            )
+            argbuf.pack_accessor(dst.field.field_id, dst.transform)
             index_task = IndexTask(
                 self.runtime.get_unary_task_id(
-                    NumPyOpCode.COUNT_NONZERO_REDUC,
+                    NumPyOpCode.NONZERO,
                     result_type=np.dtype(np.uint64),
                     argument_type=self.dtype,
                 ),
@@ -2977,8 +4651,6 @@ class DeferredArray(NumPyThunk):
                 mapper=self.runtime.mapper_id,
                 tag=shardfn,
             )
-            if shardsp is not None:
-                task.set_sharding_space(shardsp)
             index_task.add_read_requirement(
                 launch_part,
                 self.base.field.field_id,
@@ -2986,99 +4658,317 @@ class DeferredArray(NumPyThunk):
                 tag=NumPyMappingTag.KEY_REGION_TAG,
             )
             index_task.add_write_requirement(
-                nonzeros_dist_part,
-                nonzeros_dist_field.field.field_id,
+                dst_partition,
+                dst.field.field_id,
                 self.runtime.first_proj_id + NumPyProjCode.PROJ_ND_1D_C_ORDER,
                 tag=NumPyMappingTag.NO_MEMOIZE_TAG,
             )
             self.runtime.dispatch(index_task)
-
+        else:  # Single task launch
             argbuf = BufferBuilder()
-            self.pack_shape(argbuf, nonzeros_dist_shape, pack_dim=False)
-            argbuf.pack_accessor(
-                nonzeros_dist_field.field.field_id,
-                nonzeros_dist_field.transform,
-            )
+            self.pack_shape(argbuf, self.shape)
+            argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
+            # Shape of the destination is not packed since it can be irregular
+            # in multiple launch space, and it needs to be unpacked
+            # dynamically.  self.pack_shape(argbuf, dst.shape, pack_dim=False)
+            argbuf.pack_accessor(dst.field.field_id, dst.transform)
+            shardpt, shardfn, shardsp = rhs.find_point_sharding()
             task = Task(
                 self.runtime.get_unary_task_id(
-                    NumPyOpCode.INCLUSIVE_SCAN,
-                    result_type=nonzeros_dist_field.field.dtype,
-                    argument_type=nonzeros_dist_field.field.dtype,
+                    NumPyOpCode.NONZERO,
+                    argument_type=self.dtype,
+                    result_type=self.dtype,
                 ),
                 argbuf.get_string(),
                 argbuf.get_size(),
                 mapper=self.runtime.mapper_id,
+                tag=shardfn,
             )
-            task.add_read_write_requirement(
-                nonzeros_dist_field.region, nonzeros_dist_field.field.field_id
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_read_requirement(
+                rhs.region,
+                rhs.field.field_id,
+                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
             )
-            self.runtime.dispatch(task)
-
-            nonzeros_ranges_field = self.runtime.allocate_field(
-                nonzeros_dist_shape,
-                np.dtype((np.void, ffi.sizeof("legion_rect_2d_t"))),
+            task.add_write_requirement(
+                dst.region,
+                dst.field.field_id,
+                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
             )
-            argbuf = BufferBuilder()
-            argbuf.pack_32bit_int(self.ndim - 1)
-            self.pack_shape(argbuf, nonzeros_dist_shape)
-            argbuf.pack_accessor(
-                nonzeros_dist_field.field.field_id,
-                nonzeros_dist_field.transform,
+            self.runtime.dispatch(task)
+        result = ()
+        for idx in xrange(self.ndim):
+            result += (
+                dst_array.get_item(
+                    (idx, slice(None, None, None)), stacklevel=(stacklevel + 1)
+                ),
             )
-            argbuf.pack_accessor(
-                nonzeros_ranges_field.field.field_id,
-                nonzeros_ranges_field.transform,
+        return result
+
+    def _launch_tiled_task(
+        self, op, key, argfn, regions, redop=None, result_type=None
+    ):
+        # The key array decides how we launch and every other region gets
+        # tiles that line up with the tiles of the key, like the words of
+        # a bitmask and the 64 times as many elements that they hold. Each
+        # region is a tuple of the thunk, whether we write it, and how many
+        # of its entries go with each entry of the key, or None if it has
+        # one entry for every point task.
+        if result_type is None:
+            result_type = np.dtype(np.uint64)
+        task_id = self.runtime.get_nullary_task_id(op, result_type=result_type)
+        launch_space = key.base.compute_parallel_launch_space()
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            part, shardfn, shardsp = key.base.find_or_create_key_partition()
+            self.pack_shape(argbuf, key.shape, part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, key.shape)
+        argfn(argbuf)
+        if launch_space is not None:
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
             )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+        else:
+            shardpt, shardfn, shardsp = key.base.find_point_sharding()
             task = Task(
-                self.runtime.get_unary_task_id(
-                    NumPyOpCode.CONVERT_TO_RECT,
-                    result_type=np.dtype(np.uint64),
-                    argument_type=nonzeros_dist_field.field.dtype,
-                ),
+                task_id,
                 argbuf.get_string(),
                 argbuf.get_size(),
                 mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+        for thunk, write, per_key in regions:
+            region = thunk.base
+            tag = 0
+            if launch_space is None:
+                region_part = region.region
+            elif thunk is key:
+                region_part = part
+                tag = NumPyMappingTag.KEY_REGION_TAG
+            elif per_key is None:
+                region_part = region.find_or_create_partition(launch_space)
+                tag = NumPyMappingTag.NO_MEMOIZE_TAG
+            elif per_key > 1:
+                region_part = region.find_or_create_partition(
+                    launch_space, (part.tile_shape[0] * per_key,)
+                )
+            else:
+                region_part = region.find_or_create_congruent_partition(part)
+            if launch_space is None:
+                if write:
+                    task.add_write_requirement(
+                        region_part, region.field.field_id
+                    )
+                else:
+                    task.add_read_requirement(
+                        region_part, region.field.field_id
+                    )
+            elif write:
+                task.add_write_requirement(
+                    region_part, region.field.field_id, 0, tag=tag
+                )
+            else:
+                task.add_read_requirement(
+                    region_part, region.field.field_id, 0, tag=tag
+                )
+        if redop is not None and launch_space is not None:
+            return self.runtime.dispatch(task, redop=redop)
+        return self.runtime.dispatch(task)
+
+    def pack_bits(self, op, rhs1, rhs2, stacklevel, callsite=None):
+        # Set the bit of every element of rhs1 that compares true with the
+        # matching element of rhs2, or with rhs2 itself if it is a scalar
+        assert self.ndim == 1 and rhs1.ndim == 1
+        assert self.shape[0] * 64 >= rhs1.shape[0]
+        rhs1 = self.runtime.to_deferred_array(
+            rhs1, stacklevel=(stacklevel + 1)
+        )
+        regions = [(self, True, 1), (rhs1, False, 64)]
+        if isinstance(rhs2, NumPyThunk):
+            assert rhs2.shape == rhs1.shape and rhs2.dtype == rhs1.dtype
+            rhs2 = self.runtime.to_deferred_array(
+                rhs2, stacklevel=(stacklevel + 1)
             )
-            task.add_read_requirement(
-                nonzeros_dist_field.region, nonzeros_dist_field.field.field_id
+            regions.append((rhs2, False, 64))
+
+        def pack_args(argbuf):
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+            argbuf.pack_value(rhs1.shape[0], np.uint64)
+            argbuf.pack_32bit_int(op)
+            argbuf.pack_accessor(rhs1.base.field.field_id, rhs1.base.transform)
+            if isinstance(rhs2, NumPyThunk):
+                argbuf.pack_bool(False)
+                argbuf.pack_accessor(
+                    rhs2.base.field.field_id, rhs2.base.transform
+                )
+            else:
+                argbuf.pack_bool(True)
+                argbuf.pack_value(rhs2, rhs1.dtype)
+
+        self._launch_tiled_task(
+            NumPyOpCode.PACK_BITS, self, pack_args, regions
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.pack_bits(
+                op,
+                rhs1.shadow,
+                rhs2.shadow if isinstance(rhs2, NumPyThunk) else rhs2,
+                stacklevel=(stacklevel + 1),
             )
-            task.add_write_requirement(
-                nonzeros_ranges_field.region,
-                nonzeros_ranges_field.field.field_id,
+            self.runtime.check_shadow(self, "pack_bits")
+
+    def unpack_bits(self, rhs, stacklevel, callsite=None):
+        assert self.ndim == 1 and self.dtype == np.bool_
+        assert rhs.shape[0] * 64 >= self.shape[0]
+        rhs = self.runtime.to_deferred_array(rhs, stacklevel=(stacklevel + 1))
+
+        def pack_args(argbuf):
+            argbuf.pack_accessor(rhs.base.field.field_id, rhs.base.transform)
+            argbuf.pack_value(self.shape[0], np.uint64)
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+
+        self._launch_tiled_task(
+            NumPyOpCode.UNPACK_BITS,
+            rhs,
+            pack_args,
+            [(rhs, False, 1), (self, True, 64)],
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.unpack_bits(rhs.shadow, stacklevel=(stacklevel + 1))
+            self.runtime.check_shadow(self, "unpack_bits")
+
+    def bitmask_logical(self, op, rhs1, rhs2, size, stacklevel, callsite=None):
+        # Whole words at a time, so 64 elements for every operation
+        assert rhs1.shape == self.shape
+        rhs1 = self.runtime.to_deferred_array(
+            rhs1, stacklevel=(stacklevel + 1)
+        )
+        regions = [(self, True, 1), (rhs1, False, 1)]
+        if rhs2 is not None:
+            assert rhs2.shape == self.shape
+            rhs2 = self.runtime.to_deferred_array(
+                rhs2, stacklevel=(stacklevel + 1)
             )
-            self.runtime.dispatch(task)
+            regions.append((rhs2, False, 1))
 
-            nonzeros_projection = (
-                nonzeros_ranges_field.find_or_create_partition(  # noqa E501
-                    nonzeros_dist_shape
+        def pack_args(argbuf):
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+            argbuf.pack_value(size, np.uint64)
+            argbuf.pack_32bit_int(op)
+            argbuf.pack_accessor(rhs1.base.field.field_id, rhs1.base.transform)
+            if rhs2 is not None:
+                argbuf.pack_accessor(
+                    rhs2.base.field.field_id, rhs2.base.transform
                 )
+
+        self._launch_tiled_task(
+            NumPyOpCode.BITMASK_LOGICAL, self, pack_args, regions
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.bitmask_logical(
+                op,
+                rhs1.shadow,
+                None if rhs2 is None else rhs2.shadow,
+                size,
+                stacklevel=(stacklevel + 1),
             )
-            functor = PartitionByImageRange(
-                nonzeros_ranges_field.region,
-                nonzeros_projection,
-                nonzeros_ranges_field.field.field_id,
-                self.runtime.mapper_id,
+            self.runtime.check_shadow(self, "bitmask_logical")
+
+    def _count_bits(self, counts):
+        regions = [(self, False, 1)]
+        if counts is not None:
+            regions.append((counts, True, None))
+
+        def pack_args(argbuf):
+            argbuf.pack_bool(counts is not None)
+            if counts is not None:
+                argbuf.pack_accessor(
+                    counts.base.field.field_id, counts.base.transform
+                )
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+
+        future = self._launch_tiled_task(
+            NumPyOpCode.BITMASK_COUNT,
+            self,
+            pack_args,
+            regions,
+            redop=self.runtime.get_reduction_op_id(
+                NumPyOpCode.BITMASK_COUNT, np.dtype(np.uint64)
+            ),
+        )
+        return int(
+            np.frombuffer(future.get_buffer(8), dtype=np.uint64, count=1)[0]
+        )
+
+    def bitmask_count(self, stacklevel, callsite=None):
+        # One popcount for every 64 elements
+        result = self._count_bits(None)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        return result
+
+    def bitmask_nonzero(self, stacklevel, callsite=None):
+        # Works just like nonzero except that the counts come from popcounts
+        # and the tasks jump from one set bit to the next to find indices
+        launch_space = self.base.compute_parallel_launch_space()
+        counts = None
+        if launch_space is not None:
+            counts_shape = (calculate_volume(launch_space),)
+            counts = DeferredArray(
+                self.runtime,
+                self.runtime.allocate_field(counts_shape, np.dtype(np.uint64)),
+                shape=counts_shape,
+                dtype=np.dtype(np.uint64),
+                scalar=False,
             )
-            index_partition = IndexPartition(
-                self.runtime.context,
-                self.runtime.runtime,
-                dst.region.index_space,
-                nonzeros_projection.color_space,
-                functor,
-                kind=legion.DISJOINT_COMPLETE_KIND,
+        num_nonzero = self._count_bits(counts)
+        if num_nonzero == 0:
+            self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+            return self.runtime.create_empty_thunk(
+                shape=(0,), dtype=np.dtype(np.uint64), inputs=(self,)
             )
-            dst_partition = dst.region.get_child(index_partition)
-
-            argbuf = BufferBuilder()
-            self.pack_shape(argbuf, self.shape, launch_part.tile_shape, 0)
-            argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
-            argbuf.pack_accessor(dst.field.field_id, dst.transform)
-            index_task = IndexTask(
-                self.runtime.get_unary_task_id(
-                    NumPyOpCode.NONZERO,
-                    result_type=np.dtype(np.uint64),
-                    argument_type=self.dtype,
-                ),
+        dst_array = self.runtime.to_deferred_array(
+            self.runtime.create_empty_thunk(
+                shape=(1, num_nonzero),
+                dtype=np.dtype(np.uint64),
+                inputs=(self,),
+            ),
+            stacklevel=(stacklevel + 1),
+        )
+        dst = dst_array.base
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            part, shardfn, shardsp = self.base.find_or_create_key_partition()
+            self.pack_shape(argbuf, self.shape, part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, self.shape)
+        argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+        argbuf.pack_accessor(dst.field.field_id, dst.transform)
+        task_id = self.runtime.get_nullary_task_id(
+            NumPyOpCode.BITMASK_NONZERO, result_type=np.dtype(np.uint64)
+        )
+        if launch_space is not None:
+            dst_partition = self._partition_by_counts(counts.base, dst, 1)
+            task = IndexTask(
+                task_id,
                 Rect(launch_space),
                 self.runtime.empty_argmap,
                 argbuf.get_string(),
@@ -3086,34 +4976,24 @@ class DeferredArray(NumPyThunk):
                 mapper=self.runtime.mapper_id,
                 tag=shardfn,
             )
-            index_task.add_read_requirement(
-                launch_part,
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            task.add_read_requirement(
+                part,
                 self.base.field.field_id,
                 0,
                 tag=NumPyMappingTag.KEY_REGION_TAG,
             )
-            index_task.add_write_requirement(
+            task.add_write_requirement(
                 dst_partition,
                 dst.field.field_id,
-                self.runtime.first_proj_id + NumPyProjCode.PROJ_ND_1D_C_ORDER,
+                0,
                 tag=NumPyMappingTag.NO_MEMOIZE_TAG,
             )
-            self.runtime.dispatch(index_task)
-        else:  # Single task launch
-            argbuf = BufferBuilder()
-            self.pack_shape(argbuf, self.shape)
-            argbuf.pack_accessor(rhs.field.field_id, rhs.transform)
-            # Shape of the destination is not packed since it can be irregular
-            # in multiple launch space, and it needs to be unpacked
-            # dynamically.  self.pack_shape(argbuf, dst.shape, pack_dim=False)
-            argbuf.pack_accessor(dst.field.field_id, dst.transform)
-            shardpt, shardfn, shardsp = rhs.find_point_sharding()
+        else:
+            shardpt, shardfn, shardsp = self.base.find_point_sharding()
             task = Task(
-                self.runtime.get_unary_task_id(
-                    NumPyOpCode.NONZERO,
-                    argument_type=self.dtype,
-                    result_type=self.dtype,
-                ),
+                task_id,
                 argbuf.get_string(),
                 argbuf.get_size(),
                 mapper=self.runtime.mapper_id,
@@ -3124,24 +5004,186 @@ class DeferredArray(NumPyThunk):
             if shardsp is not None:
                 task.set_sharding_space(shardsp)
             task.add_read_requirement(
-                rhs.region,
-                rhs.field.field_id,
-                tag=NumPyMappingTag.NO_MEMOIZE_TAG,
+                self.base.region, self.base.field.field_id
             )
             task.add_write_requirement(
                 dst.region,
                 dst.field.field_id,
                 tag=NumPyMappingTag.NO_MEMOIZE_TAG,
             )
-            self.runtime.dispatch(task)
-        result = ()
-        for idx in xrange(self.ndim):
-            result += (
-                dst_array.get_item(
-                    (idx, slice(None, None, None)), stacklevel=(stacklevel + 1)
-                ),
+        self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        return dst_array.get_item(
+            (0, slice(None, None, None)), stacklevel=(stacklevel + 1)
+        )
+
+    def bf16_convert(self, rhs, narrow, stacklevel, callsite=None):
+        # Round float values to bfloat16 bits when narrowing and widen the
+        # bits back out again otherwise
+        assert self.shape == rhs.shape
+        rhs = self.runtime.to_deferred_array(rhs, stacklevel=(stacklevel + 1))
+        bits, values = (self, rhs) if narrow else (rhs, self)
+        assert bits.dtype == np.uint16
+        assert values.dtype == np.float32 or values.dtype == np.float64
+
+        def pack_args(argbuf):
+            argbuf.pack_bool(narrow)
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+            argbuf.pack_accessor(rhs.base.field.field_id, rhs.base.transform)
+
+        self._launch_tiled_task(
+            NumPyOpCode.BF16_CONVERT,
+            self,
+            pack_args,
+            [(self, True, 1), (rhs, False, 1)],
+            result_type=values.dtype,
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.bf16_convert(
+                rhs.shadow, narrow, stacklevel=(stacklevel + 1)
             )
-        return result
+            self.runtime.check_shadow(self, "bf16_convert")
+
+    def bf16_ufunc(self, op, rhs1, rhs2, reverse, stacklevel, callsite=None):
+        # Everything is computed in float32 registers and rounded once
+        assert self.dtype == np.uint16 and rhs1.dtype == np.uint16
+        assert self.shape == rhs1.shape
+        rhs1 = self.runtime.to_deferred_array(
+            rhs1, stacklevel=(stacklevel + 1)
+        )
+        regions = [(self, True, 1), (rhs1, False, 1)]
+        if isinstance(rhs2, NumPyThunk):
+            assert rhs2.shape == self.shape and rhs2.dtype == np.uint16
+            rhs2 = self.runtime.to_deferred_array(
+                rhs2, stacklevel=(stacklevel + 1)
+            )
+            regions.append((rhs2, False, 1))
+
+        def pack_args(argbuf):
+            argbuf.pack_32bit_int(op)
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+            argbuf.pack_accessor(rhs1.base.field.field_id, rhs1.base.transform)
+            if isinstance(rhs2, NumPyThunk):
+                argbuf.pack_bool(False)
+                argbuf.pack_accessor(
+                    rhs2.base.field.field_id, rhs2.base.transform
+                )
+            elif rhs2 is not None:
+                argbuf.pack_bool(True)
+                argbuf.pack_value(rhs2, np.float32)
+                argbuf.pack_bool(reverse)
+
+        self._launch_tiled_task(
+            NumPyOpCode.BF16_UFUNC,
+            self,
+            pack_args,
+            regions,
+            result_type=np.dtype(np.uint16),
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.bf16_ufunc(
+                op,
+                rhs1.shadow,
+                rhs2.shadow if isinstance(rhs2, NumPyThunk) else rhs2,
+                reverse,
+                stacklevel=(stacklevel + 1),
+            )
+            self.runtime.check_shadow(self, "bf16_ufunc")
+
+    def bf16_sum(self, stacklevel, callsite=None):
+        # The partial sums and their reduction are all in float32
+        assert self.dtype == np.uint16
+
+        def pack_args(argbuf):
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+
+        future = self._launch_tiled_task(
+            NumPyOpCode.BF16_SUM,
+            self,
+            pack_args,
+            [(self, False, 1)],
+            redop=self.runtime.get_reduction_op_id(
+                NumPyOpCode.BF16_SUM, np.dtype(np.float32)
+            ),
+            result_type=np.dtype(np.uint16),
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        return float(
+            np.frombuffer(future.get_buffer(4), dtype=np.float32, count=1)[0]
+        )
+
+    def fused_op(self, program, inputs, stacklevel, callsite=None):
+        # A single pass over every tile evaluates the whole program, the
+        # values in between never leave the blocks of registers of the task
+        assert not self.scalar and len(inputs) == program.num_inputs
+        assert self.dtype == program.dtype
+        inputs = [
+            self.runtime.to_deferred_array(rhs, stacklevel=(stacklevel + 1))
+            for rhs in inputs
+        ]
+        regions = [(self, True, 1)]
+        for rhs in inputs:
+            assert rhs.shape == self.shape and rhs.dtype == self.dtype
+            assert rhs.base is not self.base
+            regions.append((rhs, False, 1))
+
+        def pack_args(argbuf):
+            argbuf.pack_accessor(self.base.field.field_id, self.base.transform)
+            argbuf.pack_32bit_int(len(inputs))
+            for rhs in inputs:
+                argbuf.pack_accessor(
+                    rhs.base.field.field_id, rhs.base.transform
+                )
+            program.pack(argbuf)
+
+        self._launch_tiled_task(
+            NumPyOpCode.FUSED,
+            self,
+            pack_args,
+            regions,
+            result_type=self.dtype,
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.fused_op(
+                program,
+                [rhs.shadow for rhs in inputs],
+                stacklevel=(stacklevel + 1),
+            )
+            self.runtime.check_shadow(self, "fused_op")
+
+    def fused_sum(self, program, inputs, stacklevel, callsite=None):
+        # Each point task sums the values of the program over its tiles of
+        # the inputs, which are all in registers and never written out
+        assert self.size == 1 and self.dtype == program.dtype
+        assert len(inputs) == program.num_inputs > 0
+        key = inputs[0]
+        regions = list()
+        for rhs in inputs:
+            assert rhs.shape == key.shape and rhs.dtype == self.dtype
+            regions.append((rhs, False, 1))
+
+        def pack_args(argbuf):
+            argbuf.pack_32bit_int(len(inputs))
+            for rhs in inputs:
+                argbuf.pack_accessor(
+                    rhs.base.field.field_id, rhs.base.transform
+                )
+            program.pack(argbuf)
+
+        self.base = self._launch_tiled_task(
+            NumPyOpCode.FUSED_SUM,
+            key,
+            pack_args,
+            regions,
+            redop=self.runtime.get_reduction_op_id(
+                NumPyOpCode.FUSED_SUM, self.dtype
+            ),
+            result_type=self.dtype,
+        )
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
 
     def sort(self, rhs, stacklevel, callsite=None):
         assert lhs_array.ndim == 1
@@ -3425,6 +5467,9 @@ class DeferredArray(NumPyThunk):
         else:
             assert where is True
             where_array = None
+        if self._buffer_scalar_op(op, op_dtype, (rhs_array,), where, args):
+            self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+            return
         rhs = rhs_array.base
         # If we haven't computed a parallel launch space yet for
         # the destination array and the shapes are the same then
@@ -3819,6 +5864,13 @@ class DeferredArray(NumPyThunk):
         stacklevel,
         callsite=None,
     ):
+        # A sum of an expression that is yet to be computed folds the
+        # expression into the sum instead of writing it out first
+        if self.runtime.is_lazy_array(src) and src.can_sum_into(
+            self, op, where, args, initial
+        ):
+            src.sum_into(self, stacklevel=(stacklevel + 1), callsite=callsite)
+            return
         lhs_array = self
         rhs_array = self.runtime.to_deferred_array(
             src, stacklevel=(stacklevel + 1)
@@ -4677,6 +6729,11 @@ class DeferredArray(NumPyThunk):
         else:
             assert where is True
             where_array = None
+        if self._buffer_scalar_op(
+            op, rhs1_array.dtype, (rhs1_array, rhs2_array), where, args
+        ):
+            self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+            return
         lhs_array = self
         rhs1 = rhs1_array.base
         rhs2 = rhs2_array.base
@@ -5680,6 +7737,149 @@ class DeferredArray(NumPyThunk):
             )
             self.runtime.check_shadow(self, op)
 
+    def clip(self, rhs, lo, hi, stacklevel, callsite=None):
+        lhs_array = self
+        rhs_array = self.runtime.to_deferred_array(
+            rhs, stacklevel=(stacklevel + 1)
+        )
+        lo_array = self.runtime.to_deferred_array(
+            lo, stacklevel=(stacklevel + 1)
+        )
+        hi_array = self.runtime.to_deferred_array(
+            hi, stacklevel=(stacklevel + 1)
+        )
+        result = lhs_array.base
+        inplace = rhs_array.base is result
+        assert not isinstance(rhs_array.base, Future)
+        # Bounds of a single value go in futures and the other operands
+        # read through transforms that broadcast them to our shape
+        if inplace:
+            operands = (lo_array, hi_array)
+        else:
+            operands = (rhs_array, lo_array, hi_array)
+        regions = list()
+        futures = list()
+        launch_space = result.compute_parallel_launch_space()
+        argbuf = BufferBuilder()
+        if launch_space is not None:
+            (
+                result_part,
+                shardfn,
+                shardsp,
+            ) = result.find_or_create_key_partition()
+            self.pack_shape(argbuf, lhs_array.shape, result_part.tile_shape, 0)
+        else:
+            self.pack_shape(argbuf, lhs_array.shape)
+        argbuf.pack_accessor(result.field.field_id, result.transform)
+        # Only the bounds say whether they are futures, and they are
+        # always the last two operands
+        for index, array in enumerate(operands):
+            is_bound = index >= len(operands) - 2
+            if isinstance(array.base, Future):
+                assert is_bound
+                argbuf.pack_bool(True)  # Is a future
+                futures.append(array.base)
+                continue
+            if is_bound:
+                argbuf.pack_bool(False)  # Not a future
+            if array.shape != lhs_array.shape:
+                (
+                    transform,
+                    offset,
+                    proj_id,
+                ) = self.runtime.compute_broadcast_transform(
+                    lhs_array.shape, array.shape
+                )
+                tag = NumPyMappingTag.NO_MEMOIZE_TAG if proj_id > 0 else 0
+            else:
+                transform = None
+                offset = None
+                proj_id = 0
+                tag = 0
+            self.pack_transform_accessor(
+                argbuf, lhs_array, array, array.base, transform
+            )
+            regions.append((array.base, transform, offset, proj_id, tag))
+        task_id = self.runtime.get_unary_task_id(
+            NumPyOpCode.CLIP,
+            result_type=lhs_array.dtype,
+            argument_type=lhs_array.dtype,
+            variant_code=NumPyVariantCode.INPLACE_BROADCAST
+            if inplace
+            else NumPyVariantCode.BROADCAST,
+        )
+        if launch_space is not None:
+            task = IndexTask(
+                task_id,
+                Rect(launch_space),
+                self.runtime.empty_argmap,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if inplace:
+                task.add_read_write_requirement(
+                    result_part,
+                    result.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                task.add_write_requirement(
+                    result_part,
+                    result.field.field_id,
+                    0,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            for region, transform, offset, proj_id, tag in regions:
+                part = region.find_or_create_congruent_partition(
+                    result_part, transform, offset
+                )
+                task.add_read_requirement(
+                    part, region.field.field_id, proj_id, tag=tag
+                )
+        else:
+            shardpt, shardfn, shardsp = result.find_point_sharding()
+            task = Task(
+                task_id,
+                argbuf.get_string(),
+                argbuf.get_size(),
+                mapper=self.runtime.mapper_id,
+                tag=shardfn,
+            )
+            if shardpt is not None:
+                task.set_point(shardpt)
+            if shardsp is not None:
+                task.set_sharding_space(shardsp)
+            if inplace:
+                task.add_read_write_requirement(
+                    result.region,
+                    result.field.field_id,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            else:
+                task.add_write_requirement(
+                    result.region,
+                    result.field.field_id,
+                    tag=NumPyMappingTag.KEY_REGION_TAG,
+                )
+            for region, _, _, _, tag in regions:
+                task.add_read_requirement(
+                    region.region, region.field.field_id, tag=tag
+                )
+        for future in futures:
+            task.add_future(future)
+        self.runtime.dispatch(task)
+        self.runtime.profile_callsite(stacklevel + 1, True, callsite)
+        if self.runtime.shadow_debug:
+            self.shadow.clip(
+                rhs.shadow, lo.shadow, hi.shadow, stacklevel=(stacklevel + 1)
+            )
+            self.runtime.check_shadow(self, "clip")
+
     # A helper method for attaching arguments
     def add_arguments(self, task, args):
         assert args is not None
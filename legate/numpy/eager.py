@@ -15,10 +15,53 @@
 
 from __future__ import absolute_import, division, print_function
 
+import os
+import struct
+
 import numpy as np
 
 from .config import NumPyOpCode
 from .thunk import NumPyThunk
+from .utils import bfloat16_to_float, float_to_bfloat16
+
+
+# Bitmasks keep element i in bit i % 64 of word i // 64
+def _pack_words(bits, count):
+    packed = np.packbits(bits.ravel(), bitorder="little")
+    words = np.zeros(count * 8, dtype=np.uint8)
+    words[: packed.size] = packed
+    return words.view("<u8").astype(np.uint64)
+
+
+def _unpack_words(words, size):
+    return np.unpackbits(
+        words.astype("<u8").view(np.uint8), count=size, bitorder="little"
+    ).astype(np.bool_)
+
+
+_bitmask_comparisons = {
+    NumPyOpCode.EQUAL: np.equal,
+    NumPyOpCode.NOT_EQUAL: np.not_equal,
+    NumPyOpCode.LESS: np.less,
+    NumPyOpCode.LESS_EQUAL: np.less_equal,
+    NumPyOpCode.GREATER: np.greater,
+    NumPyOpCode.GREATER_EQUAL: np.greater_equal,
+}
+
+_bfloat16_ufuncs = {
+    NumPyOpCode.ADD: np.add,
+    NumPyOpCode.SUBTRACT: np.subtract,
+    NumPyOpCode.MULTIPLY: np.multiply,
+    NumPyOpCode.DIVIDE: np.true_divide,
+    NumPyOpCode.MAXIMUM: np.maximum,
+    NumPyOpCode.MINIMUM: np.minimum,
+    NumPyOpCode.NEGATIVE: np.negative,
+    NumPyOpCode.ABSOLUTE: np.absolute,
+    NumPyOpCode.SQRT: np.sqrt,
+    NumPyOpCode.EXP: np.exp,
+    NumPyOpCode.LOG: np.log,
+    NumPyOpCode.TANH: np.tanh,
+}
 
 
 class EagerArray(NumPyThunk):
@@ -68,6 +111,9 @@ class EagerArray(NumPyThunk):
             elif self.runtime.is_deferred_array(arg):
                 self.to_deferred_array(stacklevel=(stacklevel + 1))
                 break
+            elif self.runtime.is_lazy_array(arg):
+                self.to_deferred_array(stacklevel=(stacklevel + 1))
+                break
             else:
                 raise RuntimeError("bad argument type")
 
@@ -214,6 +260,37 @@ class EagerArray(NumPyThunk):
                 else:
                     self.array[key] = value
 
+    def get_items(self, points, stacklevel):
+        if self.deferred is not None:
+            return self.deferred.get_items(points, stacklevel=(stacklevel + 1))
+        return self.array[tuple(points.T)]
+
+    def set_items(self, points, values, stacklevel):
+        if self.deferred is not None:
+            self.deferred.set_items(
+                points, values, stacklevel=(stacklevel + 1)
+            )
+        else:
+            self.array[tuple(points.T)] = values
+
+    def scatter_add(self, index, values, stacklevel):
+        if self.shadow:
+            index = self.runtime.to_eager_array(
+                index, stacklevel=(stacklevel + 1)
+            )
+            values = self.runtime.to_eager_array(
+                values, stacklevel=(stacklevel + 1)
+            )
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), index, values)
+        if self.deferred is not None:
+            self.deferred.scatter_add(
+                index, values, stacklevel=(stacklevel + 1)
+            )
+        else:
+            np.add.at(self.array, index.array, values.array)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
     def reshape(self, newshape, order, stacklevel):
         if self.deferred is not None:
             return self.deferred.reshape(
@@ -320,6 +397,166 @@ class EagerArray(NumPyThunk):
                 self.array[:] = np.transpose(rhs.array, axes)
             self.runtime.profile_callsite(stacklevel + 1, False)
 
+    def cholesky(self, rhs, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs)
+        if self.deferred is not None:
+            self.deferred.cholesky(rhs, stacklevel=(stacklevel + 1))
+        else:
+            self.array[:] = np.linalg.cholesky(rhs.array)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def solve_triangular(self, a, b, lower, trans, stacklevel):
+        if self.shadow:
+            a = self.runtime.to_eager_array(a, stacklevel=(stacklevel + 1))
+            b = self.runtime.to_eager_array(b, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), a, b)
+        if self.deferred is not None:
+            self.deferred.solve_triangular(
+                a, b, lower, trans, stacklevel=(stacklevel + 1)
+            )
+        else:
+            matrix = np.tril(a.array) if lower else np.triu(a.array)
+            if trans:
+                matrix = matrix.T
+            self.array[:] = np.linalg.solve(matrix, b.array)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def qr_r(self, rhs, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs)
+        if self.deferred is not None:
+            self.deferred.qr_r(rhs, stacklevel=(stacklevel + 1))
+        else:
+            r = np.linalg.qr(rhs.array, mode="r")
+            self.array.fill(0)
+            self.array[: r.shape[0]] = r
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def nrm2(self, rhs, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs)
+        if self.deferred is not None:
+            self.deferred.nrm2(rhs, stacklevel=(stacklevel + 1))
+        else:
+            self.array.fill(np.linalg.norm(rhs.array.reshape(-1)))
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def axpby(self, alpha, x, beta, y, norm, stacklevel):
+        if self.shadow:
+            alpha = self.runtime.to_eager_array(
+                alpha, stacklevel=(stacklevel + 1)
+            )
+            x = self.runtime.to_eager_array(x, stacklevel=(stacklevel + 1))
+            beta = self.runtime.to_eager_array(
+                beta, stacklevel=(stacklevel + 1)
+            )
+            y = self.runtime.to_eager_array(y, stacklevel=(stacklevel + 1))
+            if norm is not None:
+                norm = self.runtime.to_eager_array(
+                    norm, stacklevel=(stacklevel + 1)
+                )
+        elif self.deferred is None:
+            if norm is None:
+                self.check_eager_args((stacklevel + 1), alpha, x, beta, y)
+            else:
+                self.check_eager_args(
+                    (stacklevel + 1), alpha, x, beta, y, norm
+                )
+        if self.deferred is not None:
+            self.deferred.axpby(
+                alpha, x, beta, y, norm, stacklevel=(stacklevel + 1)
+            )
+        else:
+            self.array[:] = alpha.array * x.array + beta.array * y.array
+            if norm is not None:
+                norm.array.fill(np.dot(self.array, self.array))
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def read_file(self, filename, offset, npy, stacklevel):
+        if self.deferred is not None:
+            self.deferred.read_file(
+                filename, offset, npy, stacklevel=(stacklevel + 1)
+            )
+        else:
+            self.array[:] = np.fromfile(
+                filename,
+                dtype=self.array.dtype,
+                count=self.array.size,
+                offset=offset,
+            ).reshape(self.array.shape)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def write_file(self, filename, offset, header, truncate, stacklevel):
+        if self.deferred is not None:
+            self.deferred.write_file(
+                filename, offset, header, truncate, stacklevel=(stacklevel + 1)
+            )
+        else:
+            mode = "wb" if truncate or not os.path.exists(filename) else "r+b"
+            with open(filename, mode) as f:
+                if header is not None:
+                    f.write(header)
+                f.seek(offset)
+                np.ascontiguousarray(self.array).tofile(f)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def read_text(
+        self, filename, comment, delimiter, chunks, stop, stacklevel
+    ):
+        if self.deferred is not None:
+            self.deferred.read_text(
+                filename,
+                comment,
+                delimiter,
+                chunks,
+                stop,
+                stacklevel=(stacklevel + 1),
+            )
+        else:
+            with open(filename, "rb") as f:
+                f.seek(chunks[0][0])
+                rows = np.loadtxt(
+                    f,
+                    dtype=self.array.dtype,
+                    comments=comment,
+                    delimiter=delimiter,
+                    ndmin=2,
+                )
+            rows = rows[: self.array.shape[0]]
+            self.array[:] = rows.reshape(self.array.shape)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def checkpoint(self, prefix, compress, stacklevel):
+        if self.deferred is not None:
+            return self.deferred.checkpoint(
+                prefix, compress, stacklevel=(stacklevel + 1)
+            )
+        # We are small enough that the whole array is one tile and not
+        # worth compressing
+        data = np.ascontiguousarray(self.array).tobytes()
+        path = prefix + "." + "_".join("0" * self.array.ndim)
+        with open(path, "wb") as f:
+            f.write(struct.pack("<4sIQQ", b"LGCK", 0, len(data), len(data)))
+            f.write(data)
+        self.runtime.profile_callsite(stacklevel + 1, False)
+        return self.array.shape, (0,) * self.array.ndim
+
+    def restore(self, prefix, tile_shape, tile_origin, stacklevel):
+        # Only the restore tasks know how to decode compressed tiles
+        if self.deferred is None:
+            self.to_deferred_array(stacklevel=(stacklevel + 1))
+        self.deferred.restore(
+            prefix, tile_shape, tile_origin, stacklevel=(stacklevel + 1)
+        )
+
     def diag(self, rhs, extract, k, stacklevel):
         if self.shadow:
             rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
@@ -407,6 +644,159 @@ class EagerArray(NumPyThunk):
                 result += (EagerArray(self.runtime, array),)
             return result
 
+    def pack_bits(self, op, rhs1, rhs2, stacklevel):
+        if self.shadow:
+            rhs1 = self.runtime.to_eager_array(
+                rhs1, stacklevel=(stacklevel + 1)
+            )
+            if isinstance(rhs2, NumPyThunk):
+                rhs2 = self.runtime.to_eager_array(
+                    rhs2, stacklevel=(stacklevel + 1)
+                )
+        elif self.deferred is None:
+            if isinstance(rhs2, NumPyThunk):
+                self.check_eager_args((stacklevel + 1), rhs1, rhs2)
+            else:
+                self.check_eager_args((stacklevel + 1), rhs1)
+        if self.deferred is not None:
+            self.deferred.pack_bits(
+                op, rhs1, rhs2, stacklevel=(stacklevel + 1)
+            )
+        else:
+            bits = _bitmask_comparisons[op](
+                rhs1.array,
+                rhs2.array if isinstance(rhs2, EagerArray) else rhs2,
+            )
+            self.array[:] = _pack_words(bits, self.array.size)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def unpack_bits(self, rhs, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs)
+        if self.deferred is not None:
+            self.deferred.unpack_bits(rhs, stacklevel=(stacklevel + 1))
+        else:
+            self.array[:] = _unpack_words(rhs.array, self.array.size)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def bitmask_logical(self, op, rhs1, rhs2, size, stacklevel):
+        if self.shadow:
+            rhs1 = self.runtime.to_eager_array(
+                rhs1, stacklevel=(stacklevel + 1)
+            )
+            if rhs2 is not None:
+                rhs2 = self.runtime.to_eager_array(
+                    rhs2, stacklevel=(stacklevel + 1)
+                )
+        elif self.deferred is None:
+            if rhs2 is not None:
+                self.check_eager_args((stacklevel + 1), rhs1, rhs2)
+            else:
+                self.check_eager_args((stacklevel + 1), rhs1)
+        if self.deferred is not None:
+            self.deferred.bitmask_logical(
+                op, rhs1, rhs2, size, stacklevel=(stacklevel + 1)
+            )
+        else:
+            if op == NumPyOpCode.LOGICAL_AND:
+                np.bitwise_and(rhs1.array, rhs2.array, out=self.array)
+            elif op == NumPyOpCode.LOGICAL_OR:
+                np.bitwise_or(rhs1.array, rhs2.array, out=self.array)
+            elif op == NumPyOpCode.LOGICAL_XOR:
+                np.bitwise_xor(rhs1.array, rhs2.array, out=self.array)
+            else:
+                assert op == NumPyOpCode.LOGICAL_NOT
+                # Keep the bits past the end of the mask clear
+                self.array[:] = _pack_words(
+                    np.logical_not(_unpack_words(rhs1.array, size)),
+                    self.array.size,
+                )
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def bitmask_count(self, stacklevel):
+        if self.deferred is not None:
+            return self.deferred.bitmask_count(stacklevel=(stacklevel + 1))
+        self.runtime.profile_callsite(stacklevel + 1, False)
+        return int(np.unpackbits(self.array.view(np.uint8)).sum())
+
+    def bitmask_nonzero(self, stacklevel):
+        if self.deferred is not None:
+            return self.deferred.bitmask_nonzero(stacklevel=(stacklevel + 1))
+        bits = _unpack_words(self.array, self.array.size * 64)
+        self.runtime.profile_callsite(stacklevel + 1, False)
+        return EagerArray(self.runtime, np.flatnonzero(bits).astype(np.uint64))
+
+    def bf16_convert(self, rhs, narrow, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs)
+        if self.deferred is not None:
+            self.deferred.bf16_convert(
+                rhs, narrow, stacklevel=(stacklevel + 1)
+            )
+        else:
+            if narrow:
+                self.array[...] = float_to_bfloat16(rhs.array)
+            else:
+                self.array[...] = bfloat16_to_float(rhs.array)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def bf16_ufunc(self, op, rhs1, rhs2, reverse, stacklevel):
+        if self.shadow:
+            rhs1 = self.runtime.to_eager_array(
+                rhs1, stacklevel=(stacklevel + 1)
+            )
+            if isinstance(rhs2, NumPyThunk):
+                rhs2 = self.runtime.to_eager_array(
+                    rhs2, stacklevel=(stacklevel + 1)
+                )
+        elif self.deferred is None:
+            if isinstance(rhs2, NumPyThunk):
+                self.check_eager_args((stacklevel + 1), rhs1, rhs2)
+            else:
+                self.check_eager_args((stacklevel + 1), rhs1)
+        if self.deferred is not None:
+            self.deferred.bf16_ufunc(
+                op, rhs1, rhs2, reverse, stacklevel=(stacklevel + 1)
+            )
+        else:
+            x = bfloat16_to_float(rhs1.array)
+            if isinstance(rhs2, EagerArray):
+                result = _bfloat16_ufuncs[op](x, bfloat16_to_float(rhs2.array))
+            elif rhs2 is None:
+                result = _bfloat16_ufuncs[op](x)
+            elif reverse:
+                result = _bfloat16_ufuncs[op](np.float32(rhs2), x)
+            else:
+                result = _bfloat16_ufuncs[op](x, np.float32(rhs2))
+            self.array[...] = float_to_bfloat16(result)
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def bf16_sum(self, stacklevel):
+        if self.deferred is not None:
+            return self.deferred.bf16_sum(stacklevel=(stacklevel + 1))
+        self.runtime.profile_callsite(stacklevel + 1, False)
+        return float(np.sum(bfloat16_to_float(self.array), dtype=np.float32))
+
+    def fused_op(self, program, inputs, stacklevel):
+        if self.shadow:
+            inputs = [
+                self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+                for rhs in inputs
+            ]
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), *inputs)
+        if self.deferred is not None:
+            self.deferred.fused_op(
+                program, inputs, stacklevel=(stacklevel + 1)
+            )
+        else:
+            self.array[...] = program.evaluate([rhs.array for rhs in inputs])
+            self.runtime.profile_callsite(stacklevel + 1, False)
+
     def sort(self, rhs, stacklevel):
         if self.shadow:
             rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
@@ -991,3 +1381,16 @@ class EagerArray(NumPyThunk):
                     "unsupported ternary reduction op " + str(op)
                 )
             self.runtime.profile_callsite(stacklevel + 1, False)
+
+    def clip(self, rhs, lo, hi, stacklevel):
+        if self.shadow:
+            rhs = self.runtime.to_eager_array(rhs, stacklevel=(stacklevel + 1))
+            lo = self.runtime.to_eager_array(lo, stacklevel=(stacklevel + 1))
+            hi = self.runtime.to_eager_array(hi, stacklevel=(stacklevel + 1))
+        elif self.deferred is None:
+            self.check_eager_args((stacklevel + 1), rhs, lo, hi)
+        if self.deferred is not None:
+            self.deferred.clip(rhs, lo, hi, stacklevel=(stacklevel + 1))
+        else:
+            np.clip(rhs.array, lo.array, hi.array, out=self.array)
+            self.runtime.profile_callsite(stacklevel + 1, False)
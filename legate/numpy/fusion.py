@@ -0,0 +1,65 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from __future__ import absolute_import, division, print_function
+
+import numpy as np
+
+from .array import ndarray
+from .program import (  # noqa F401
+    FusedProgram,
+    fused_arity,
+    is_fusable_op,
+    is_fusable_type,
+)
+from .utils import calculate_volume
+
+
+def evaluate(program, inputs, stacklevel=1):
+    """Evaluate a FusedProgram over arrays that all have the same shape
+    with one task launch and return the values of its last operation."""
+    if len(inputs) != program.num_inputs:
+        raise ValueError(
+            "the program takes " + str(program.num_inputs) + " inputs"
+        )
+    if len(inputs) == 0:
+        raise ValueError("a fused program needs at least one input array")
+    arrays = list()
+    for array in inputs:
+        array = ndarray.convert_to_legate_ndarray(
+            array, stacklevel=(stacklevel + 1)
+        )
+        if arrays and array.shape != arrays[0].shape:
+            raise ValueError("all inputs of a fused program need one shape")
+        if array.dtype != program.dtype:
+            array = array.astype(program.dtype)
+        arrays.append(array)
+    shape = arrays[0].shape
+    # Arrays of one element live in futures so just do those on the host
+    if calculate_volume(shape) <= 1:
+        result = program.evaluate([np.asarray(array) for array in arrays])
+        return ndarray.convert_to_legate_ndarray(np.reshape(result, shape))
+    result = ndarray(
+        shape=shape,
+        dtype=program.dtype,
+        stacklevel=(stacklevel + 1),
+        inputs=arrays,
+    )
+    result._thunk.fused_op(
+        program,
+        [array._thunk for array in arrays],
+        stacklevel=(stacklevel + 1),
+    )
+    return result
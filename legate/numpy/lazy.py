@@ -15,111 +15,324 @@
 
 from __future__ import absolute_import, division, print_function
 
+import inspect
+import weakref
+
+from .config import NumPyOpCode
+from .deferred import DeferredArray
+from .program import (
+    FusedProgram,
+    fused_arity,
+    is_fusable_op,
+    is_fusable_type,
+)
 from .thunk import NumPyThunk
 
+# Expressions that grow past this many operations get computed so that the
+# programs we launch stay short and nothing gets inlined too many times
+_max_fused_operations = 32
+
 
 class LazyArray(NumPyThunk):
     """This is a lazy thunk for describing NumPy computations.
     It is backed by an AST that describes a computation that is
     yet to be performed.
 
+    Elementwise operations whose operands all have the shape and type of
+    the result record their operation and operands instead of launching a
+    task. The values get computed when something needs them: any other
+    method, including the ones that give the application the values, or
+    the next operation the runtime launches if the ndarray of the lazy
+    array is still alive then. Operands that nothing else can see any more
+    are folded into the program of the array that reads them, so a chain
+    of operations runs as one fused task, and a sum of a lazy array runs
+    the chain and the sum in one task without ever writing the chain out.
+
     :meta private:
     """
 
-    def __init__(self, runtime, shape, dtype, thunk):
+    def __init__(self, runtime, shape, dtype, thunk=None):
         NumPyThunk.__init__(self, runtime, shape, dtype)
+        # The deferred array that holds our values once we compute them
         self.thunk = thunk
+        # The operation that computes us and its operands, which are lazy
+        # or deferred arrays of our shape and type or scalar constants
+        self.op = None
+        self.operands = None
+        self.num_operations = 0
+        self.callsite = None
+        self.wrappers = None
+
+    def wrap(self, ndarray):
+        if self.wrappers is None:
+            self.wrappers = list()
+        self.wrappers.append(weakref.ref(ndarray))
+
+    def owns_storage(self):
+        return False
+
+    def is_pending(self):
+        return self.op is not None
+
+    def is_live(self):
+        # Arrays that no ndarray wraps are only used inside the runtime
+        if self.wrappers is None:
+            return True
+        for wrapper in self.wrappers:
+            if wrapper() is not None:
+                return True
+        return False
 
     @property
     def storage(self):
-        raise NotImplementedError("Implement in derived classes")
+        return self.materialize(stacklevel=2).storage
 
     def __numpy_array__(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def imag(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def real(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def copy(self, rhs, deep, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def get_scalar_array(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def get_item(self, key, stacklevel, view=None, dim_map=None):
-        raise NotImplementedError("Implement in derived classes")
-
-    def set_item(self, key, value, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def reshape(self, newshape, order, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def squeeze(self, axis, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def swapaxes(self, axis1, axis2, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def convert(self, rhs, stacklevel, warn=True):
-        raise NotImplementedError("Implement in derived classes")
-
-    def fill(self, value, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def dot(self, rhs1, rhs2, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def transpose(self, rhs, axes, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def diag(self, rhs, extract, k, stacklevel):
-        """Fill in or extract a diagonal from a matrix
-
-        :meta private:
+        return self.materialize(stacklevel=(stacklevel + 1)).__numpy_array__(
+            stacklevel=(stacklevel + 1)
+        )
+
+    def __getattr__(self, name):
+        # Anything else that only deferred arrays have needs our values
+        if name.startswith("_"):
+            raise AttributeError(name)
+        return getattr(self.materialize(stacklevel=2), name)
+
+    def materialize(self, stacklevel):
+        """Return the deferred array with our values, computing them with
+        one fused task if we are still pending."""
+        if self.thunk is None:
+            self.thunk = DeferredArray(
+                self.runtime,
+                self.runtime.allocate_field(
+                    self.shape, self.dtype, pooled=True
+                ),
+                shape=self.shape,
+                dtype=self.dtype,
+                scalar=False,
+            )
+        if self.op is not None:
+            program, inputs = self.plan(stacklevel=(stacklevel + 1))
+            self.op = None
+            self.operands = None
+            # Other pending arrays may read us, so they have to wait until
+            # our task is launched before they get computed
+            flushing = self.runtime.flushing_lazy_arrays
+            self.runtime.flushing_lazy_arrays = True
+            self.thunk.fused_op(
+                program,
+                inputs,
+                stacklevel=(stacklevel + 1),
+                callsite=self.callsite,
+            )
+            self.runtime.flushing_lazy_arrays = flushing
+        return self.thunk
+
+    def plan(self, stacklevel):
+        """Build the fused program that computes our values and return it
+        with the deferred arrays that are its inputs.
+
+        Pending operands that an ndarray still holds get computed first,
+        since we will need their values again anyway, and the rest have
+        their operations inlined into the program.
         """
-        raise NotImplementedError("Implement in derived classes")
-
-    def eye(self, k, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def tile(self, rhs, reps, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def bincount(self, rhs, stacklevel, weights=None):
-        raise NotImplementedError("Implement in derived classes")
-
-    def nonzero(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def sort(self, rhs, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def random_uniform(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def random_normal(self, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def random_integer(self, low, high, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
+        assert self.op is not None
+        program = FusedProgram(self.dtype)
+        inputs = list()
+        self._emit(program, inputs, dict(), stacklevel + 1)
+        return program, inputs
+
+    def _emit(self, program, inputs, handles, stacklevel):
+        operands = list()
+        for operand in self.operands:
+            if isinstance(operand, LazyArray):
+                if operand.is_pending() and not operand.is_live():
+                    # Operands that we read twice are only inlined once
+                    if id(operand) not in handles:
+                        handles[id(operand)] = operand._emit(
+                            program, inputs, handles, stacklevel
+                        )
+                    operands.append(handles[id(operand)])
+                    continue
+                operand = operand.materialize(stacklevel=(stacklevel + 1))
+            if isinstance(operand, DeferredArray):
+                if id(operand) not in handles:
+                    handles[id(operand)] = program.input()
+                    inputs.append(operand)
+                operands.append(handles[id(operand)])
+            else:
+                operands.append(program.constant(operand))
+        return program.apply(self.op, *operands)
+
+    def sum_into(self, lhs, stacklevel, callsite=None):
+        """Sum our values into the future of the deferred array lhs with one
+        task that computes them and adds them up. We stay pending, so only
+        if something needs our values later do they get written out."""
+        program, inputs = self.plan(stacklevel=(stacklevel + 1))
+        # Nothing in the sum writes to what other pending arrays read
+        flushing = self.runtime.flushing_lazy_arrays
+        self.runtime.flushing_lazy_arrays = True
+        lhs.fused_sum(
+            program,
+            inputs,
+            stacklevel=(stacklevel + 1),
+            callsite=callsite,
+        )
+        self.runtime.flushing_lazy_arrays = flushing
+
+    def can_sum_into(self, lhs, op, where, args, initial):
+        return (
+            self.op is not None
+            and op == NumPyOpCode.SUM
+            and where is True
+            and not args
+            and initial is None
+            and lhs.size == 1
+            and lhs.dtype == self.dtype
+        )
+
+    def _fusable_operand(self, operand):
+        if isinstance(operand, LazyArray):
+            return (
+                operand is not self
+                and operand.shape == self.shape
+                and operand.dtype == self.dtype
+            )
+        if self.runtime.is_deferred_array(operand):
+            return (
+                not operand.scalar
+                and operand.shape == self.shape
+                and operand.dtype == self.dtype
+            )
+        # Scalars that the host has become constants of the program
+        return (
+            self.runtime.is_eager_array(operand)
+            and operand.deferred is None
+            and operand.size == 1
+            and operand.dtype == self.dtype
+        )
+
+    def _record(self, op, operands, where, args, stacklevel):
+        """Try to record op on operands as the expression for our values
+        and return whether we did."""
+        if (
+            self.thunk is not None
+            or self.op is not None
+            or not is_fusable_op(op)
+            or not is_fusable_type(self.dtype)
+            or len(operands) != fused_arity(op)
+            or where is not True
+            or args
+            # The host can write through its views before we read them
+            or self.runtime.num_host_mappings
+        ):
+            return False
+        for operand in operands:
+            if not self._fusable_operand(operand):
+                return False
+        num_operations = 1
+        recorded = list()
+        for operand in operands:
+            if isinstance(operand, LazyArray):
+                if operand.is_pending():
+                    if operand.num_operations >= _max_fused_operations:
+                        operand.materialize(stacklevel=(stacklevel + 1))
+                    else:
+                        num_operations += operand.num_operations
+            elif self.runtime.is_eager_array(operand):
+                operand = operand.array.reshape(())[()]
+            recorded.append(operand)
+        self.op = op
+        self.operands = tuple(recorded)
+        self.num_operations = num_operations
+        if self.runtime.callsite_summaries is not None:
+            self.callsite = self.runtime.create_callsite(stacklevel + 1)
+        self.runtime.record_lazy_array(self)
+        return True
 
     def unary_op(self, op, op_type, rhs, where, args, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def unary_reduction(
-        self, op, redop, rhs, where, axes, keepdims, args, initial, stacklevel
-    ):
-        raise NotImplementedError("Implement in derived classes")
+        if op_type == self.dtype and self._record(
+            op, (rhs,), where, args, stacklevel=(stacklevel + 1)
+        ):
+            return
+        self.materialize(stacklevel=(stacklevel + 1)).unary_op(
+            op,
+            op_type,
+            _materialize(rhs, stacklevel + 1),
+            _materialize(where, stacklevel + 1),
+            args,
+            stacklevel=(stacklevel + 1),
+        )
 
     def binary_op(self, op, rhs1, rhs2, where, args, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
-
-    def binary_reduction(self, op, rhs1, rhs2, broadcast, args, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
+        if self._record(
+            op, (rhs1, rhs2), where, args, stacklevel=(stacklevel + 1)
+        ):
+            return
+        self.materialize(stacklevel=(stacklevel + 1)).binary_op(
+            op,
+            _materialize(rhs1, stacklevel + 1),
+            _materialize(rhs2, stacklevel + 1),
+            _materialize(where, stacklevel + 1),
+            args,
+            stacklevel=(stacklevel + 1),
+        )
 
     def ternary_op(self, op, rhs1, rhs2, rhs3, where, args, stacklevel):
-        raise NotImplementedError("Implement in derived classes")
+        if self._record(
+            op, (rhs1, rhs2, rhs3), where, args, stacklevel=(stacklevel + 1)
+        ):
+            return
+        self.materialize(stacklevel=(stacklevel + 1)).ternary_op(
+            op,
+            _materialize(rhs1, stacklevel + 1),
+            _materialize(rhs2, stacklevel + 1),
+            _materialize(rhs3, stacklevel + 1),
+            _materialize(where, stacklevel + 1),
+            args,
+            stacklevel=(stacklevel + 1),
+        )
+
+
+def _materialize(value, stacklevel):
+    if isinstance(value, LazyArray):
+        return value.materialize(stacklevel=(stacklevel + 1))
+    if isinstance(value, (list, tuple)):
+        return type(value)(_materialize(v, stacklevel + 1) for v in value)
+    return value
+
+
+def _delegate(name):
+    # Every argument of the method follows self in its signature
+    parameters = list(inspect.signature(getattr(NumPyThunk, name)).parameters)
+    position = parameters.index("stacklevel") - 1
+
+    def method(self, *args, **kwargs):
+        args = list(args)
+        if "stacklevel" in kwargs:
+            kwargs["stacklevel"] += 1
+            stacklevel = kwargs["stacklevel"]
+        else:
+            args[position] += 1
+            stacklevel = args[position]
+        thunk = self.materialize(stacklevel=stacklevel)
+        args = [_materialize(arg, stacklevel) for arg in args]
+        for key, value in kwargs.items():
+            kwargs[key] = _materialize(value, stacklevel)
+        return getattr(thunk, name)(*args, **kwargs)
+
+    method.__name__ = name
+    method.__doc__ = getattr(NumPyThunk, name).__doc__
+    return method
+
+
+# Everything that we do not record computes our values and then does the
+# same thing as the deferred array that holds them
+for _name, _value in list(vars(NumPyThunk).items()):
+    if (
+        inspect.isfunction(_value)
+        and not _name.startswith("_")
+        and _name not in vars(LazyArray)
+        and "stacklevel" in inspect.signature(_value).parameters
+    ):
+        setattr(LazyArray, _name, _delegate(_name))
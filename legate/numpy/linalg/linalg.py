@@ -20,56 +20,382 @@ from legate.numpy.config import NumPyOpCode
 from legate.numpy.module import power as _power, sqrt as _sqrt
 
 
+def _linalg_dtype(*arrays):
+    # The tiled kernels are built on LAPACK so we only support
+    # single and double precision, promote everything else. There are no
+    # complex kernels, so those go to NumPy on the host.
+    dtype = ndarray.find_common_type(*arrays)
+    if dtype == np.float32 or dtype == np.complex64:
+        return dtype
+    if dtype.kind == "c":
+        return np.dtype(np.complex128)
+    return np.dtype(np.float64)
+
+
+def cholesky(a, stacklevel=1):
+    lg_array = ndarray.convert_to_legate_ndarray(a)
+    if lg_array.ndim != 2 or lg_array.shape[0] != lg_array.shape[1]:
+        raise np.linalg.LinAlgError(
+            "Last 2 dimensions of the array must be square"
+        )
+    dtype = _linalg_dtype(lg_array)
+    if lg_array.size == 1 or dtype.kind == "c":
+        # Nothing to distribute here
+        return ndarray.convert_to_legate_ndarray(
+            np.linalg.cholesky(
+                lg_array.__array__(stacklevel=(stacklevel + 1))
+            ).astype(dtype)
+        )
+    if lg_array.dtype != dtype:
+        lg_array = lg_array.astype(dtype)
+    result = ndarray(
+        shape=lg_array.shape, dtype=dtype, stacklevel=(stacklevel + 1)
+    )
+    result._thunk.cholesky(lg_array._thunk, stacklevel=(stacklevel + 1))
+    return result
+
+
+def solve_triangular(a, b, lower=False, trans=False, stacklevel=1):
+    """Solve op(a) x = b where a is triangular. This is an extension to the
+    NumPy API that follows the basic interface of
+    scipy.linalg.solve_triangular and is computed with tiled tasks so that
+    neither a nor b ever has to be gathered to a single processor."""
+    a_array = ndarray.convert_to_legate_ndarray(a)
+    b_array = ndarray.convert_to_legate_ndarray(b)
+    if a_array.ndim != 2 or a_array.shape[0] != a_array.shape[1]:
+        raise ValueError("expected square matrix")
+    if b_array.ndim not in (1, 2) or b_array.shape[0] != a_array.shape[0]:
+        raise ValueError("shapes of a and b are incompatible")
+    dtype = _linalg_dtype(a_array, b_array)
+    if a_array.dtype != dtype:
+        a_array = a_array.astype(dtype)
+    if b_array.dtype != dtype:
+        b_array = b_array.astype(dtype)
+    if a_array.size == 1 or b_array.size == 1 or dtype.kind == "c":
+        # Nothing to distribute here
+        matrix = a_array.__array__(stacklevel=(stacklevel + 1))
+        matrix = np.tril(matrix) if lower else np.triu(matrix)
+        if trans:
+            matrix = matrix.T
+        return ndarray.convert_to_legate_ndarray(
+            np.linalg.solve(
+                matrix, b_array.__array__(stacklevel=(stacklevel + 1))
+            ).astype(dtype)
+        )
+    vector = b_array.ndim == 1
+    if vector:
+        b_array = b_array.reshape((b_array.shape[0], 1))
+    result = ndarray(
+        shape=b_array.shape, dtype=dtype, stacklevel=(stacklevel + 1)
+    )
+    result._thunk.solve_triangular(
+        a_array._thunk,
+        b_array._thunk,
+        bool(lower),
+        bool(trans),
+        stacklevel=(stacklevel + 1),
+    )
+    if vector:
+        return result.reshape((result.shape[0],))
+    return result
+
+
+def lstsq(a, b, rcond="warn", stacklevel=1):
+    a_array = ndarray.convert_to_legate_ndarray(a)
+    b_array = ndarray.convert_to_legate_ndarray(b)
+    if a_array.ndim != 2:
+        raise np.linalg.LinAlgError(
+            "%d-dimensional array given. Array must be two-dimensional"
+            % a_array.ndim
+        )
+    if b_array.ndim not in (1, 2) or b_array.shape[0] != a_array.shape[0]:
+        raise np.linalg.LinAlgError("Incompatible dimensions")
+    m, n = a_array.shape
+    vector = b_array.ndim == 1
+    k = 1 if vector else b_array.shape[1]
+    dtype = _linalg_dtype(a_array, b_array)
+    if m < n + k or dtype.kind == "c":
+        # Only the real tall-skinny case stays distributed
+        return np.linalg.lstsq(
+            a_array.__array__(stacklevel=(stacklevel + 1)),
+            b_array.__array__(stacklevel=(stacklevel + 1)),
+            rcond=rcond,
+        )
+    # Factor [A | b] with a tall-skinny QR so we never need Q:
+    #   Q^T [A | b] = [[R11, R12], [0, R22]]
+    # then x = R11^-1 R12 and the residuals are the column norms of R22
+    augmented = ndarray(
+        shape=(m, n + k), dtype=dtype, stacklevel=(stacklevel + 1)
+    )
+    augmented[:, :n] = a_array
+    if vector:
+        augmented[:, n] = b_array
+    else:
+        augmented[:, n:] = b_array
+    r = ndarray(shape=(n + k, n + k), dtype=dtype, stacklevel=(stacklevel + 1))
+    r._thunk.qr_r(augmented._thunk, stacklevel=(stacklevel + 1))
+    x = solve_triangular(
+        r[:n, :n], r[:n, n:], lower=False, stacklevel=(stacklevel + 1)
+    )
+    residuals = (r[n:, n:] * r[n:, n:]).sum(
+        axis=0, stacklevel=(stacklevel + 1)
+    )
+    # R11 is only n x n so the rank and singular values are cheap to
+    # compute on the host
+    s = np.linalg.svd(
+        r[:n, :n].__array__(stacklevel=(stacklevel + 1)), compute_uv=False
+    )
+    if rcond == "warn" or rcond is None:
+        rcond = np.finfo(dtype).eps * max(m, n)
+    rank = int((s > rcond * s[0]).sum()) if s.size > 0 else 0
+    if rank < n:
+        # Rank deficient problems have no unique answer so
+        # let NumPy pick the minimum norm one like it normally would
+        return np.linalg.lstsq(
+            a_array.__array__(stacklevel=(stacklevel + 1)),
+            b_array.__array__(stacklevel=(stacklevel + 1)),
+            rcond=rcond,
+        )
+    if vector:
+        x = x.reshape((n,))
+    return x, residuals, rank, s
+
+
+def _axpby(a, x, b, y, dot, stacklevel):
+    x_array = ndarray.convert_to_legate_ndarray(x)
+    y_array = ndarray.convert_to_legate_ndarray(y)
+    a_array = ndarray.convert_to_legate_ndarray(a)
+    b_array = ndarray.convert_to_legate_ndarray(b)
+    dtype = ndarray.find_common_type(x_array, y_array)
+    if (
+        x_array.shape != y_array.shape
+        or x_array.size == 1
+        or a_array.size != 1
+        or b_array.size != 1
+        or (dtype != np.float32 and dtype != np.float64)
+    ):
+        # Anything the fused kernel doesn't cover goes through the ufuncs
+        result = a_array * x_array + b_array * y_array
+        if not dot:
+            return result
+        return result, result.dot(result, stacklevel=(stacklevel + 1))
+    # Everything has to agree on the type for the kernel
+    operands = []
+    for array in (a_array, x_array, b_array, y_array):
+        if array.dtype != dtype:
+            array = array.astype(dtype)
+        operands.append(array._thunk)
+    result = ndarray(
+        shape=x_array.shape, dtype=dtype, stacklevel=(stacklevel + 1)
+    )
+    norm = None
+    if dot:
+        norm = ndarray(shape=(), dtype=dtype, stacklevel=(stacklevel + 1))
+    result._thunk.axpby(
+        *operands,
+        None if norm is None else norm._thunk,
+        stacklevel=(stacklevel + 1),
+    )
+    if not dot:
+        return result
+    return result, norm
+
+
+def axpy(a, x, y, stacklevel=1):
+    """Compute a * x + y in a single pass over the arrays. This is an
+    extension to the NumPy API for the level-1 updates in Krylov solvers;
+    a is a scalar and x and y must have the same shape."""
+    return _axpby(a, x, 1, y, False, stacklevel + 1)
+
+
+def axpby(a, x, b, y, stacklevel=1):
+    """Compute a * x + b * y in a single pass over the arrays. This is an
+    extension to the NumPy API; a and b are scalars and x and y must have
+    the same shape."""
+    return _axpby(a, x, b, y, False, stacklevel + 1)
+
+
+def axpby_dot(a, x, b, y, stacklevel=1):
+    """Compute z = a * x + b * y together with z.dot(z), returning both.
+    This is the fused residual update of a Krylov solver and reads each
+    array once instead of once for the update and again for the norm."""
+    return _axpby(a, x, b, y, True, stacklevel + 1)
+
+
+def _singular_values(a, stacklevel):
+    # The singular values of a tall matrix are those of the R factor of
+    # its QR factorization, which is only as big as the short side so it
+    # can go to the host for the SVD
+    if a.shape[0] < a.shape[1]:
+        a = a.transpose()
+    dtype = _linalg_dtype(a)
+    if dtype.kind == "c":
+        return np.linalg.svd(
+            a.__array__(stacklevel=(stacklevel + 1)), compute_uv=False
+        )
+    if a.dtype != dtype:
+        a = a.astype(dtype)
+    n = a.shape[1]
+    r = ndarray(shape=(n, n), dtype=dtype, stacklevel=(stacklevel + 1))
+    r._thunk.qr_r(a._thunk, stacklevel=(stacklevel + 1))
+    return np.linalg.svd(
+        r.__array__(stacklevel=(stacklevel + 1)), compute_uv=False
+    )
+
+
+def _keep_dims(result, ndim, keepdims, stacklevel):
+    if not keepdims:
+        return result
+    return result.reshape((1,) * ndim, stacklevel=(stacklevel + 1))
+
+
+def _nrm2(lg_array, keepdims, stacklevel):
+    # Overflow-safe 2-norm of every element in the array
+    result = ndarray(
+        shape=(), dtype=lg_array.dtype, stacklevel=(stacklevel + 1)
+    )
+    result._thunk.nrm2(lg_array._thunk, stacklevel=(stacklevel + 1))
+    return _keep_dims(result, lg_array.ndim, keepdims, stacklevel + 1)
+
+
+def _use_nrm2(lg_array):
+    # The scaled kernel only has CPU variants so leave the GPUs
+    # to the plain sum of squares
+    return (
+        lg_array.dtype == np.float32 or lg_array.dtype == np.float64
+    ) and runtime.num_gpus == 0
+
+
+def _frobenius(lg_array, keepdims, stacklevel):
+    # 2-norm of the flattened array of any dimension. This is spelled out
+    # as a sum of squares because the NORM reduction of an eager array is
+    # np.linalg.norm with ord=2, which is the spectral norm of a matrix
+    if _use_nrm2(lg_array):
+        return _nrm2(lg_array, keepdims, stacklevel + 1)
+    temp = abs(lg_array)
+    result = _sqrt(
+        (temp * temp).sum(stacklevel=(stacklevel + 1)),
+        stacklevel=(stacklevel + 1),
+    )
+    return _keep_dims(result, lg_array.ndim, keepdims, stacklevel + 1)
+
+
+def _vector_norm(lg_array, ord, axis, keepdims, stacklevel):
+    if ord == np.inf:
+        return abs(lg_array).max(
+            axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
+        )
+    elif ord == -np.inf:
+        return abs(lg_array).min(
+            axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
+        )
+    elif ord == 0:
+        # Check for where things are not zero and convert to integer
+        # for sum
+        temp = (lg_array != 0).astype(np.int64)
+        return temp.sum(
+            axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
+        )
+    elif ord is None or ord == 2:
+        if axis is None and _use_nrm2(lg_array):
+            return _nrm2(lg_array, keepdims, stacklevel + 1)
+        ord = 2
+    elif not isinstance(ord, (int, float, np.integer, np.floating)):
+        raise ValueError("Invalid norm order for vectors.")
+    if ord < 0:
+        # Negative orders are rare enough to build out of the ufuncs
+        temp = _power(
+            abs(lg_array.astype(np.float64)), ord, stacklevel=(stacklevel + 1)
+        ).sum(axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1))
+        return _power(temp, (1.0 / ord), stacklevel=(stacklevel + 1))
+    if ord != int(ord):
+        # Fractional powers are only computed in float32 or float64, so
+        # reduce complex values to their magnitudes and widen the rest
+        if lg_array.dtype.kind == "c":
+            lg_array = abs(lg_array)
+        if lg_array.dtype != np.float32 and lg_array.dtype != np.float64:
+            lg_array = lg_array.astype(np.float64)
+    result = ndarray.perform_unary_reduction(
+        NumPyOpCode.NORM,
+        NumPyOpCode.SUM_RADIX,
+        lg_array,
+        axis=axis,
+        keepdims=keepdims,
+        args=(np.array(ord, dtype=np.float64),),
+        stacklevel=(stacklevel + 1),
+    )
+    # Now we need to do the power part if this is not an eager array
+    # Eager arrays have the power part folded into their operation
+    # TODO: fix this as it is a hack
+    if (
+        runtime.is_eager_array(result._thunk)
+        and result._thunk.deferred is None
+    ) or ord == 1:
+        return result
+    elif ord == 2:
+        return _sqrt(result, stacklevel=stacklevel + 1)
+    else:
+        return _power(result, (1.0 / ord), stacklevel=(stacklevel + 1))
+
+
+def _matrix_norm(lg_array, ord, keepdims, stacklevel):
+    if ord is None or ord == "fro":
+        return _frobenius(lg_array, keepdims, stacklevel + 1)
+    elif ord in (1, -1, np.inf, -np.inf):
+        # Largest or smallest absolute column sum (1) or row sum (inf)
+        axis = 0 if ord in (1, -1) else 1
+        sums = abs(lg_array).sum(axis=axis, stacklevel=(stacklevel + 1))
+        if ord > 0:
+            result = sums.max(stacklevel=(stacklevel + 1))
+        else:
+            result = sums.min(stacklevel=(stacklevel + 1))
+        return _keep_dims(result, 2, keepdims, stacklevel + 1)
+    elif ord in (2, -2, "nuc"):
+        s = _singular_values(lg_array, stacklevel + 1)
+        if ord == 2:
+            value = s.max()
+        elif ord == -2:
+            value = s.min()
+        else:
+            value = s.sum()
+        result = ndarray.convert_to_legate_ndarray(np.array(value))
+        return _keep_dims(result, 2, keepdims, stacklevel + 1)
+    else:
+        raise ValueError("Invalid norm order for matrices.")
+
+
 def norm(x, ord=None, axis=None, keepdims=False, stacklevel=1):
     lg_array = ndarray.convert_to_legate_ndarray(x)
     # Easy case to handle
     if lg_array.size == 1:
         return lg_array
-    if (axis is None and lg_array.ndim == 1) or type(axis) == int:
-        # Handle the weird norm cases
-        if ord == np.inf:
-            return abs(lg_array).max(
-                axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
-            )
-        elif ord == -np.inf:
-            return abs(lg_array).min(
-                axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
+    if isinstance(axis, tuple) and len(axis) == 1:
+        axis = axis[0]
+    if isinstance(axis, tuple):
+        if len(axis) != 2 or lg_array.ndim != 2:
+            raise NotImplementedError(
+                "Legate needs support for norms over batches of matrices"
             )
-        elif ord == 0:
-            # Check for where things are not zero and convert to integer
-            # for sum
-            temp = (lg_array != 0).astype(np.int64)
-            return temp.sum(
-                axis=axis, keepdims=keepdims, stacklevel=(stacklevel + 1)
+        if axis[0] % 2 == axis[1] % 2:
+            raise ValueError("Duplicate axes given.")
+        if axis[0] % 2 == 1:
+            raise NotImplementedError(
+                "Legate needs support for matrix norms of transposed axes"
             )
-        elif ord is None:
-            args = (np.array(2, dtype=np.int32),)
-        elif type(ord) == int:
-            args = (np.array(ord, dtype=np.int32),)
-        else:
-            raise ValueError("Invalid 'ord' argument passed to norm")
-        result = ndarray.perform_unary_reduction(
-            NumPyOpCode.NORM,
-            NumPyOpCode.SUM_RADIX,
-            lg_array,
-            axis=axis,
-            keepdims=keepdims,
-            args=args,
-            stacklevel=(stacklevel + 1),
-        )
-        # Now we need to do the power part if this is not an eager array
-        # Eager arrays have the power part folded into their operation
-        # TODO: fix this as it is a hack
-        if (
-            runtime.is_eager_array(result._thunk)
-            and result._thunk.deferred is None
-        ) or ord == 1:
-            return result
-        elif ord == 2 or ord is None:
-            return _sqrt(result, stacklevel=stacklevel + 1)
-        else:
-            return _power(result, (1.0 / ord), stacklevel=(stacklevel + 1))
-    else:
-        raise NotImplementedError(
-            "Legate needs support for other kinds of norms"
-        )
+        axis = None
+    if axis is None:
+        if ord is None:
+            # The 2-norm of the flattened array for any dimension
+            if lg_array.ndim == 1:
+                return _vector_norm(
+                    lg_array, None, None, keepdims, stacklevel + 1
+                )
+            return _frobenius(lg_array, keepdims, stacklevel + 1)
+        if lg_array.ndim == 1:
+            return _vector_norm(lg_array, ord, None, keepdims, stacklevel + 1)
+        if lg_array.ndim == 2:
+            return _matrix_norm(lg_array, ord, keepdims, stacklevel + 1)
+        raise ValueError("Improper number of dimensions to norm.")
+    if isinstance(ord, str):
+        raise ValueError("Invalid norm order '%s' for vectors" % ord)
+    return _vector_norm(lg_array, ord, axis, keepdims, stacklevel + 1)
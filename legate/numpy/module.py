@@ -13,8 +13,15 @@
 # limitations under the License.
 #
 
+import io
+import json
 import math
+import os
+import shutil
+import struct
 import sys
+import zipfile
+from collections.abc import Mapping
 
 import numpy as np
 
@@ -22,6 +29,7 @@ from .array import ndarray
 from .config import NumPyOpCode
 from .doc_utils import copy_docstring
 from .runtime import runtime
+from .utils import calculate_volume
 
 try:
     xrange  # Python 2
@@ -846,6 +854,48 @@ def add(a, b, out=None, where=True, dtype=None, stacklevel=1):
     )
 
 
+# Backs add.at for an array of integer indices into the first dimension,
+# which is how the rows of an embedding table get their updates
+def _add_at(a, indices, b, stacklevel=1):
+    if not isinstance(a, ndarray):
+        raise TypeError("add.at needs a legate.numpy array to update")
+    index_array = ndarray.convert_to_legate_ndarray(
+        indices, stacklevel=(stacklevel + 1)
+    )
+    if index_array.dtype.kind not in "iu" or a.ndim == 0:
+        raise NotImplementedError(
+            "legate.numpy only supports add.at with an array of integer "
+            + "indices into the first dimension"
+        )
+    shape = index_array.shape + a.shape[1:]
+    b_array = ndarray.convert_to_legate_ndarray(b, stacklevel=(stacklevel + 1))
+    if b_array.shape != shape:
+        values = b_array.__array__(stacklevel=(stacklevel + 1))
+        if values.size == 1:
+            b_array = full(
+                shape,
+                values.reshape(()),
+                dtype=a.dtype,
+                stacklevel=(stacklevel + 1),
+            )
+        else:
+            b_array = ndarray.convert_to_legate_ndarray(
+                np.broadcast_to(values, shape).astype(a.dtype),
+                stacklevel=(stacklevel + 1),
+            )
+    b_array = b_array.astype(a.dtype)
+    if index_array.ndim != 1:
+        index_array = index_array.reshape(
+            (index_array.size,), stacklevel=(stacklevel + 1)
+        )
+        b_array = b_array.reshape(
+            index_array.shape + a.shape[1:], stacklevel=(stacklevel + 1)
+        )
+    a._thunk.scatter_add(
+        index_array._thunk, b_array._thunk, stacklevel=(stacklevel + 1)
+    )
+
+
 @copy_docstring(np.divide)
 def divide(a, b, out=None, where=True, dtype=None):
     # For python 3 switch this to truedivide
@@ -1634,7 +1684,7 @@ def genfromtxt(
     max_rows=None,
     encoding="bytes",
 ):
-    numpy_array = np.getfromtxt(
+    numpy_array = np.genfromtxt(
         fname,
         dtype=dtype,
         comments=comments,
@@ -1671,7 +1721,23 @@ def frombuffer(buffer, dtype=float, count=-1, offset=0):
 
 
 @copy_docstring(np.fromfile)
-def fromfile(file, dtype=float, count=-1, sep="", offset=0):
+def fromfile(file, dtype=float, count=-1, sep="", offset=0, stacklevel=1):
+    # Raw binary files that we can find by name are read in parallel by
+    # all the point tasks straight into their tiles
+    dtype = np.dtype(dtype)
+    if sep == "" and isinstance(file, (str, os.PathLike)):
+        filename = os.fspath(file)
+        available = (os.path.getsize(filename) - offset) // dtype.itemsize
+        if count < 0 or count > available:
+            count = available
+        if runtime.is_file_io_type(dtype, (count,)):
+            result = ndarray(
+                (count,), dtype=dtype, stacklevel=(stacklevel + 1)
+            )
+            result._thunk.read_file(
+                filename, offset, False, stacklevel=(stacklevel + 1)
+            )
+            return result
     numpy_array = np.fromfile(
         file=file, dtype=dtype, count=count, sep=sep, offset=offset
     )
@@ -1706,6 +1772,88 @@ def fromstring(string, dtype=float, count=-1, sep=""):
     return ndarray.convert_to_legate_ndarray(numpy_array)
 
 
+def _read_npy_header(fp):
+    # Returns the shape, order, type and data offset of the .npy file
+    # starting at the current position of fp, or None if we can't read it
+    # ourselves and have to leave it to NumPy
+    try:
+        version = np.lib.format.read_magic(fp)
+        if version == (1, 0):
+            header = np.lib.format.read_array_header_1_0(fp)
+        elif version == (2, 0):
+            header = np.lib.format.read_array_header_2_0(fp)
+        else:
+            return None
+    except ValueError:
+        return None
+    shape, fortran_order, dtype = header
+    return shape, fortran_order, dtype, fp.tell()
+
+
+def _load_npy_data(filename, header, npy, stacklevel):
+    shape, fortran_order, dtype, offset = header
+    # Fortran-ordered data is just the C-ordered transpose
+    if fortran_order:
+        shape = tuple(reversed(shape))
+    result = ndarray(shape, dtype=dtype, stacklevel=(stacklevel + 1))
+    result._thunk.read_file(filename, offset, npy, stacklevel=(stacklevel + 1))
+    if fortran_order:
+        result = result.transpose()
+    return result
+
+
+class NpzFile(Mapping):
+    """
+    The dictionary-like object returned by `load` for .npz files, whose
+    uncompressed members are read in parallel straight out of the archive
+    """
+
+    def __init__(self, filename, npz):
+        self._filename = filename
+        self._npz = npz
+        self.files = npz.files
+        self.zip = npz.zip
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def close(self):
+        self._npz.close()
+
+    def __iter__(self):
+        return iter(self.files)
+
+    def __len__(self):
+        return len(self.files)
+
+    def __contains__(self, key):
+        return key in self.files
+
+    def __getitem__(self, key):
+        if key not in self.files:
+            raise KeyError("%s is not a file in the archive" % key)
+        name = key + ".npy"
+        if name not in self.zip.namelist():
+            name = key
+        info = self.zip.getinfo(name)
+        header = None
+        # Stored members are plain .npy files at some offset in the archive
+        if info.compress_type == zipfile.ZIP_STORED:
+            with open(self._filename, "rb") as f:
+                f.seek(info.header_offset)
+                local = f.read(30)
+                if len(local) == 30 and local[:4] == b"PK\x03\x04":
+                    name_size, extra_size = struct.unpack("<HH", local[26:])
+                    f.seek(info.header_offset + 30 + name_size + extra_size)
+                    header = _read_npy_header(f)
+        if header is None or not runtime.is_file_io_type(header[2], header[0]):
+            return ndarray.convert_to_legate_ndarray(self._npz[key])
+        return _load_npy_data(self._filename, header, False, stacklevel=2)
+
+
 @copy_docstring(np.load)
 def load(
     file,
@@ -1713,7 +1861,46 @@ def load(
     allow_pickle=False,
     fix_imports=True,
     encoding="ASCII",
+    stacklevel=1,
 ):
+    # Files that we can find by name we read in parallel from all the
+    # point tasks rather than funneling them through this process, or
+    # when asked to map them we back the array by the file itself
+    if isinstance(file, (str, os.PathLike)):
+        filename = os.fspath(file)
+        with open(filename, "rb") as f:
+            magic = f.read(len(np.lib.format.MAGIC_PREFIX))
+            f.seek(0)
+            if magic.startswith(b"PK\x03\x04") and mmap_mode is None:
+                npz = np.load(
+                    filename,
+                    allow_pickle=allow_pickle,
+                    fix_imports=fix_imports,
+                    encoding=encoding,
+                )
+                return NpzFile(filename, npz)
+            header = None
+            if magic == np.lib.format.MAGIC_PREFIX:
+                header = _read_npy_header(f)
+        if header is not None and runtime.is_file_io_type(
+            header[2], header[0]
+        ):
+            if mmap_mode is None:
+                return _load_npy_data(
+                    filename, header, True, stacklevel=(stacklevel + 1)
+                )
+            shape, fortran_order, dtype, offset = header
+            if fortran_order:
+                shape = tuple(reversed(shape))
+            if mmap_mode != "w+":
+                result = memmap(
+                    filename,
+                    dtype=dtype,
+                    mode=mmap_mode,
+                    offset=offset,
+                    shape=shape,
+                )
+                return result.transpose() if fortran_order else result
     numpy_array = np.load(
         file,
         mmap_mode=mmap_mode,
@@ -1724,6 +1911,53 @@ def load(
     return ndarray.convert_to_legate_ndarray(numpy_array)
 
 
+def _is_text_char(char):
+    # Single ASCII characters that can separate or start things in a line
+    return (
+        isinstance(char, str)
+        and len(char) == 1
+        and char.isascii()
+        and not char.isspace()
+    )
+
+
+def _find_text_rows(filename, comment, delimiter, skiprows):
+    # Find where the rows of data start after the lines that we skip and
+    # how many columns there are in the first of them
+    with open(filename, "rb") as f:
+        for _ in range(skiprows):
+            if not f.readline():
+                return None
+        while True:
+            start = f.tell()
+            line = f.readline()
+            if not line:
+                return None
+            if comment is not None:
+                line = line.split(comment.encode())[0]
+            line = line.strip()
+            if line:
+                break
+    if delimiter is None:
+        return start, len(line.split())
+    return start, len(line.split(delimiter.encode()))
+
+
+def _split_text_file(filename, start, pieces):
+    # Cut the rest of the file into chunks of about the same size that all
+    # begin at the start of a line, but never smaller than 64 KB
+    stop = os.path.getsize(filename)
+    chunks = max(1, min(pieces, (stop - start) >> 16))
+    splits = [start]
+    with open(filename, "rb") as f:
+        for idx in range(1, chunks):
+            f.seek(start + idx * (stop - start) // chunks - 1)
+            f.readline()
+            splits.append(max(f.tell(), splits[-1]))
+    splits.append(stop)
+    return splits
+
+
 @copy_docstring(np.loadtxt)
 def loadtxt(
     fname,
@@ -1737,7 +1971,57 @@ def loadtxt(
     ndmin=0,
     encoding="bytes",
     max_rows=None,
+    stacklevel=1,
 ):
+    # Plain tables of numbers in files that we can find by name are split
+    # into chunks at line boundaries, counted, and then parsed in parallel
+    # by the tasks for the tiles of the result, anything else goes through
+    # NumPy. We leave max_rows to NumPy since what it counts has changed
+    # between versions.
+    dtype = np.dtype(dtype)
+    if (
+        isinstance(fname, (str, os.PathLike))
+        and (
+            (dtype.kind in "iu" and dtype.itemsize > 1)
+            or dtype.type in (np.float32, np.float64)
+        )
+        and (comments is None or _is_text_char(comments))
+        and (delimiter is None or _is_text_char(delimiter))
+        and delimiter != comments
+        and converters is None
+        and usecols is None
+        and not unpack
+        and max_rows is None
+    ):
+        filename = os.fspath(fname)
+        found = _find_text_rows(filename, comments, delimiter, skiprows)
+        if found is not None:
+            start, columns = found
+            splits = _split_text_file(filename, start, runtime.num_pieces)
+            counts = runtime.count_text_rows(
+                filename, comments, splits, stacklevel=(stacklevel + 1)
+            )
+            rows = int(counts.sum())
+            # NumPy squeezes out the dimensions of size one, so we leave
+            # tables that are only one row to it
+            if rows > 1:
+                if columns > 1 or ndmin == 2:
+                    shape = (rows, columns)
+                else:
+                    shape = (rows,)
+                result = ndarray(
+                    shape, dtype=dtype, stacklevel=(stacklevel + 1)
+                )
+                first_rows = np.cumsum(counts) - counts
+                result._thunk.read_text(
+                    filename,
+                    comments,
+                    delimiter,
+                    [(s, int(r)) for s, r in zip(splits[:-1], first_rows)],
+                    splits[-1],
+                    stacklevel=(stacklevel + 1),
+                )
+                return result
     numpy_array = np.loadtxt(
         fname,
         dtype=dtype,
@@ -1754,10 +2038,43 @@ def loadtxt(
     return ndarray.convert_to_legate_ndarray(numpy_array)
 
 
+_memmap_modes = {
+    "readonly": "r",
+    "readwrite": "r+",
+    "write": "w+",
+    "copyonwrite": "c",
+}
+
+
 @copy_docstring(np.memmap)
 def memmap(
     filename, dtype=np.uint8, mode="r+", offset=0, shape=None, order="C"
 ):
+    dtype = np.dtype(dtype)
+    if isinstance(shape, int):
+        shape = (shape,)
+    mode = _memmap_modes.get(mode, mode)
+    # Arrays that we can back by the file directly never have to fit in
+    # memory, anything else we leave to NumPy and share with it
+    if (
+        isinstance(filename, (str, os.PathLike))
+        and order == "C"
+        and mode in ("r", "r+", "w+", "c")
+        and (shape is not None or mode != "w+")
+    ):
+        filename = os.fspath(filename)
+        if mode == "w+":
+            nbytes = calculate_volume(shape) * dtype.itemsize
+            with open(filename, "w+b") as f:
+                f.truncate(offset + nbytes)
+            mode = "r+"
+        elif shape is None:
+            shape = ((os.path.getsize(filename) - offset) // dtype.itemsize,)
+        if runtime.is_file_io_type(dtype, shape):
+            thunk = runtime.create_file_thunk(
+                filename, tuple(shape), dtype, offset, mode
+            )
+            return ndarray(shape=None, stacklevel=2, thunk=thunk)
     numpy_array = np.memmap(
         filename,
         dtype=dtype,
@@ -1767,3 +2084,177 @@ def memmap(
         order=order,
     )
     return ndarray.convert_to_legate_ndarray(numpy_array, share=True)
+
+
+@copy_docstring(np.save)
+def save(file, arr, allow_pickle=True, fix_imports=True, stacklevel=1):
+    array = ndarray.convert_to_legate_ndarray(
+        arr, stacklevel=(stacklevel + 1)
+    )
+    named = isinstance(file, (str, os.PathLike))
+    if not named or not runtime.is_file_io_type(array.dtype, array.shape):
+        np.save(
+            file,
+            array.__array__(stacklevel=(stacklevel + 1)),
+            allow_pickle=allow_pickle,
+            fix_imports=fix_imports,
+        )
+        return
+    filename = os.fspath(file)
+    if not filename.endswith(".npy"):
+        filename += ".npy"
+    # Only the header goes through this process; the point tasks write
+    # the data for their own tiles right after it
+    fp = io.BytesIO()
+    header = {
+        "descr": np.lib.format.dtype_to_descr(array.dtype),
+        "fortran_order": False,
+        "shape": array.shape,
+    }
+    try:
+        np.lib.format.write_array_header_1_0(fp, header)
+    except ValueError:
+        fp = io.BytesIO()
+        np.lib.format.write_array_header_2_0(fp, header)
+    header = fp.getvalue()
+    array._thunk.write_file(
+        filename, len(header), header, True, stacklevel=(stacklevel + 1)
+    )
+
+
+@copy_docstring(np.savez)
+def savez(file, *args, **kwds):
+    # Zip archives need a checksum of every member up front, so these
+    # still go through NumPy
+    args = tuple(
+        a.__array__(stacklevel=2) if isinstance(a, ndarray) else a
+        for a in args
+    )
+    kwds = {
+        k: v.__array__(stacklevel=2) if isinstance(v, ndarray) else v
+        for k, v in kwds.items()
+    }
+    np.savez(file, *args, **kwds)
+
+
+_checkpoint_manifest = "manifest.json"
+
+
+def _checkpoint_generation(directory):
+    # The generation of the last checkpoint that finished, if any
+    try:
+        with open(os.path.join(directory, _checkpoint_manifest)) as f:
+            return json.load(f).get("generation")
+    except (OSError, ValueError):
+        return None
+
+
+def checkpoint(directory, compress=False, stacklevel=1, **arrays):
+    """Save the named arrays into a checkpoint directory. This is an
+    extension to the NumPy API where every tile of an array goes into a
+    file of its own straight from the processor that owns it, optionally
+    byte shuffled and compressed, and a manifest records the shape, type
+    and tiling of each array so that restore can read it back on any
+    number of processors. Each checkpoint writes its files into a new
+    generation directory and the manifest that names it is replaced last,
+    so a directory always holds the last checkpoint that finished."""
+    # Only the first shard touches the directories and the manifest, and
+    # the fences keep the other shards from running ahead of it
+    first = runtime.is_first_shard()
+    runtime.issue_fence(block=True)
+    previous = _checkpoint_generation(directory)
+    generation = 0 if previous is None else previous + 1
+    folder = os.path.join(directory, "gen%d" % generation)
+    if first:
+        os.makedirs(directory, exist_ok=True)
+        # Clear out anything left over from a checkpoint that did not finish
+        shutil.rmtree(folder, ignore_errors=True)
+        os.makedirs(folder)
+    runtime.issue_fence(block=True)
+    entries = {}
+    for name, value in arrays.items():
+        if os.sep in name or name == _checkpoint_manifest:
+            raise ValueError("invalid checkpoint array name " + repr(name))
+        array = ndarray.convert_to_legate_ndarray(
+            value, stacklevel=(stacklevel + 1)
+        )
+        prefix = os.path.join(folder, name)
+        entry = {
+            "shape": list(array.shape),
+            "dtype": np.lib.format.dtype_to_descr(array.dtype),
+        }
+        # Anything that the tasks cannot store goes into a .npy file
+        if runtime.is_file_io_type(array.dtype, array.shape):
+            tile_shape, tile_origin = array._thunk.checkpoint(
+                prefix, compress, stacklevel=(stacklevel + 1)
+            )
+            entry["tile_shape"] = list(tile_shape)
+            entry["tile_origin"] = list(tile_origin)
+        else:
+            values = array.__array__(stacklevel=(stacklevel + 1))
+            if first:
+                np.save(prefix + ".npy", values, allow_pickle=False)
+        entries[name] = entry
+    # Every tile is on disk once the tasks before this fence are done
+    runtime.issue_fence(block=True)
+    if first:
+        manifest = os.path.join(directory, _checkpoint_manifest)
+        with open(manifest + ".tmp", "w") as f:
+            json.dump(
+                {"version": 1, "generation": generation, "arrays": entries},
+                f,
+                indent=1,
+            )
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(manifest + ".tmp", manifest)
+        # Only now that nothing refers to the previous generation can it go
+        if previous is not None:
+            shutil.rmtree(
+                os.path.join(directory, "gen%d" % previous),
+                ignore_errors=True,
+            )
+    runtime.issue_fence(block=True)
+
+
+def restore(directory, stacklevel=1):
+    """Load the arrays of a checkpoint directory and return them in a
+    dictionary by name. Each processor reads the saved tiles that overlap
+    its own tiles of the arrays, whatever the number of processors that
+    wrote them."""
+    with open(os.path.join(directory, _checkpoint_manifest)) as f:
+        manifest = json.load(f)
+    if manifest.get("version") != 1:
+        raise ValueError("unsupported checkpoint version")
+    folder = os.path.join(directory, "gen%d" % manifest["generation"])
+    result = {}
+    for name, entry in manifest["arrays"].items():
+        prefix = os.path.join(folder, name)
+        if "tile_shape" not in entry:
+            result[name] = ndarray.convert_to_legate_ndarray(
+                np.load(prefix + ".npy"), stacklevel=(stacklevel + 1)
+            )
+            continue
+        array = ndarray(
+            tuple(entry["shape"]),
+            dtype=np.lib.format.descr_to_dtype(entry["dtype"]),
+            stacklevel=(stacklevel + 1),
+        )
+        array._thunk.restore(
+            prefix,
+            tuple(entry["tile_shape"]),
+            tuple(entry["tile_origin"]),
+            stacklevel=(stacklevel + 1),
+        )
+        result[name] = array
+    return result
+
+
+def field_pool_statistics():
+    """Return the counters of the pool of fields that back deferred
+    arrays. This is an extension to the NumPy API for tuning how much
+    memory the pool keeps around with NUMPY_FIELD_POOL_FRAC: the number of
+    fields made and reused, how many allocations were rounded up to a size
+    class, how many regions were destroyed to stay in the budget, and the
+    bytes in use, held for reuse and at the high water mark."""
+    return runtime.get_field_pool_statistics()
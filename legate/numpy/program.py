@@ -0,0 +1,217 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from __future__ import absolute_import, division, print_function
+
+import numpy as np
+
+from .config import NumPyOpCode
+
+# The ufuncs that a fused program can apply, with the NumPy functions
+# that compute them for eager arrays
+_fused_ufuncs = {
+    NumPyOpCode.ABSOLUTE: np.absolute,
+    NumPyOpCode.ARCCOS: np.arccos,
+    NumPyOpCode.ARCSIN: np.arcsin,
+    NumPyOpCode.ARCTAN: np.arctan,
+    NumPyOpCode.COS: np.cos,
+    NumPyOpCode.EXP: np.exp,
+    NumPyOpCode.LOG: np.log,
+    NumPyOpCode.NEGATIVE: np.negative,
+    NumPyOpCode.SIN: np.sin,
+    NumPyOpCode.SQRT: np.sqrt,
+    NumPyOpCode.TAN: np.tan,
+    NumPyOpCode.TANH: np.tanh,
+    NumPyOpCode.ADD: np.add,
+    NumPyOpCode.DIVIDE: np.divide,
+    NumPyOpCode.MULTIPLY: np.multiply,
+    NumPyOpCode.POWER: np.power,
+    NumPyOpCode.SUBTRACT: np.subtract,
+    NumPyOpCode.MAXIMUM: np.maximum,
+    NumPyOpCode.MINIMUM: np.minimum,
+    NumPyOpCode.EQUAL: np.equal,
+    NumPyOpCode.NOT_EQUAL: np.not_equal,
+    NumPyOpCode.GREATER: np.greater,
+    NumPyOpCode.GREATER_EQUAL: np.greater_equal,
+    NumPyOpCode.LESS: np.less,
+    NumPyOpCode.LESS_EQUAL: np.less_equal,
+    NumPyOpCode.WHERE: lambda cond, x, y: np.where(cond != 0, x, y),
+}
+
+# The fused tasks are registered for these types
+_fused_types = frozenset(
+    np.dtype(t)
+    for t in (
+        np.float16,
+        np.float32,
+        np.float64,
+        np.int16,
+        np.int32,
+        np.int64,
+        np.uint16,
+        np.uint32,
+        np.uint64,
+        np.bool_,
+        np.complex64,
+    )
+)
+
+
+def is_fusable_op(op):
+    return op in _fused_ufuncs
+
+
+def is_fusable_type(dtype):
+    return np.dtype(dtype) in _fused_types
+
+
+def fused_arity(op):
+    if op == NumPyOpCode.WHERE:
+        return 3
+    return _fused_ufuncs[op].nin
+
+
+class FusedProgram(object):
+    """A straight line program of elementwise ufuncs that a single task
+    evaluates for every element of its output in one pass over memory,
+    keeping the values in between in small blocks of registers instead
+    of temporary arrays.
+
+    Operands are the handles returned by input, constant and apply and
+    the program computes the value of the last operation applied. Every
+    value has the type of the program, so comparisons produce ones and
+    zeros of that type which where then selects on.
+    """
+
+    def __init__(self, dtype):
+        dtype = np.dtype(dtype)
+        if not is_fusable_type(dtype):
+            raise TypeError("cannot fuse operations on " + str(dtype))
+        self.dtype = dtype
+        self.num_inputs = 0
+        self.constants = []
+        self.instructions = []
+
+    def input(self):
+        """Add the next input array of the program."""
+        self.num_inputs += 1
+        return ("input", self.num_inputs - 1)
+
+    def constant(self, value):
+        """Add a scalar that every element of the program sees."""
+        self.constants.append(self.dtype.type(value))
+        return ("constant", len(self.constants) - 1)
+
+    def apply(self, op, *operands):
+        """Apply the ufunc with the given NumPyOpCode to the operands."""
+        if not is_fusable_op(op):
+            raise NotImplementedError(
+                "cannot fuse " + NumPyOpCode(op).name.lower()
+            )
+        if len(operands) != fused_arity(op):
+            raise ValueError(
+                NumPyOpCode(op).name.lower()
+                + " takes "
+                + str(fused_arity(op))
+                + " operands"
+            )
+        for operand in operands:
+            kind, index = operand
+            if kind == "value":
+                assert index < len(self.instructions)
+            elif kind == "constant":
+                assert index < len(self.constants)
+            else:
+                assert kind == "input" and index < self.num_inputs
+        self.instructions.append((op, operands))
+        return ("value", len(self.instructions) - 1)
+
+    def compile(self):
+        """Number the registers of the program, with the inputs first,
+        then the constants and then the values it computes, and return
+        how many registers it needs and its instructions.
+
+        A value gives its register up after the instruction that reads it
+        last so that long chains only need a handful of registers.
+        """
+        if len(self.instructions) == 0:
+            raise ValueError("a fused program needs at least one operation")
+        last_use = dict()
+        for idx, (op, operands) in enumerate(self.instructions):
+            for kind, index in operands:
+                if kind == "value":
+                    last_use[index] = idx
+        first_temporary = self.num_inputs + len(self.constants)
+        num_registers = first_temporary
+        registers = list()
+        free = list()
+        code = list()
+        for idx, (op, operands) in enumerate(self.instructions):
+            srcs = list()
+            for kind, index in operands:
+                if kind == "input":
+                    srcs.append(index)
+                elif kind == "constant":
+                    srcs.append(self.num_inputs + index)
+                else:
+                    srcs.append(registers[index])
+            # Operands like the two of x * x only give their register up
+            # once, and in order so every node packs the same program
+            for kind, index in operands:
+                if kind == "value" and last_use[index] == idx:
+                    if registers[index] not in free:
+                        free.append(registers[index])
+            if free:
+                dst = free.pop()
+            else:
+                dst = num_registers
+                num_registers += 1
+            registers.append(dst)
+            # Nothing reads values that are not the result
+            if idx not in last_use and idx < len(self.instructions) - 1:
+                free.append(dst)
+            code.append((op, dst, srcs + [-1] * (3 - len(srcs))))
+        return num_registers, code
+
+    def pack(self, argbuf):
+        num_registers, code = self.compile()
+        argbuf.pack_32bit_int(len(self.constants))
+        for value in self.constants:
+            argbuf.pack_value(value, self.dtype)
+        argbuf.pack_32bit_int(num_registers)
+        argbuf.pack_32bit_int(len(code))
+        for op, dst, srcs in code:
+            argbuf.pack_32bit_int(op)
+            argbuf.pack_32bit_int(dst)
+            for src in srcs:
+                argbuf.pack_32bit_int(src)
+
+    def evaluate(self, inputs):
+        """Evaluate the program with NumPy on NumPy arrays"""
+        assert len(inputs) == self.num_inputs
+        values = list()
+        with np.errstate(all="ignore"):
+            for op, operands in self.instructions:
+                args = list()
+                for kind, index in operands:
+                    if kind == "input":
+                        args.append(inputs[index])
+                    elif kind == "constant":
+                        args.append(self.constants[index])
+                    else:
+                        args.append(values[index])
+                result = np.asarray(_fused_ufuncs[op](*args))
+                values.append(result.astype(self.dtype, copy=False))
+        return values[-1]
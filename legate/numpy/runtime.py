@@ -19,6 +19,7 @@ import functools
 import gc
 import inspect
 import math
+import mmap
 import struct
 import sys
 import weakref
@@ -129,6 +130,9 @@ _sizeof_size_t = ffi.sizeof("size_t")
 assert _sizeof_size_t == 4 or _sizeof_size_t == 8
 _dim_names = np.array(["X", "Y", "Z", "W", "V", "U", "T", "S", "R"])
 
+# Writes of single items that we buffer before we launch them all at once
+_max_pending_items = 1 << 16
+
 
 # A helper class for doing field management with control replication
 class FieldMatch(object):
@@ -209,6 +213,52 @@ class FieldMatch(object):
                 self.manager.free_field(region, field_id, ordered=False)
 
 
+# Shapes with a first extent up to this size always get exact fields
+_FIELD_POOL_MIN_EXTENT = 16
+
+
+# Counters for the fields that all the field managers hand out
+class FieldPoolStatistics(object):
+    __slots__ = [
+        "allocations",
+        "reuses",
+        "rounded",
+        "evictions",
+        "bytes_in_use",
+        "bytes_held",
+        "bytes_ordered",
+        "high_water",
+    ]
+
+    def __init__(self):
+        self.allocations = 0  # fields that we had to make
+        self.reuses = 0  # fields that came back out of the free lists
+        self.rounded = 0  # allocations rounded up to a size class
+        self.evictions = 0  # regions destroyed to stay in the budget
+        self.bytes_in_use = 0
+        self.bytes_held = 0  # bytes of freed fields waiting to be reused
+        # The part of the held bytes that is on the ordered free lists,
+        # which is the same on every shard and so safe to make decisions
+        self.bytes_ordered = 0
+        self.high_water = 0
+
+    def update_high_water(self):
+        total = self.bytes_in_use + self.bytes_held
+        if total > self.high_water:
+            self.high_water = total
+
+    def as_dict(self):
+        return {
+            "allocations": self.allocations,
+            "reuses": self.reuses,
+            "rounded": self.rounded,
+            "evictions": self.evictions,
+            "bytes_in_use": self.bytes_in_use,
+            "bytes_held": self.bytes_held,
+            "high_water": self.high_water,
+        }
+
+
 # This class manages the allocation and reuse of fields
 class FieldManager(object):
     __slots__ = [
@@ -224,12 +274,25 @@ class FieldManager(object):
         "initial_future",
         "fill_space",
         "tile_shape",
+        "field_size",
+        "held_fields",
+        "region_fields",
+        "field_partitions",
     ]
 
     def __init__(self, runtime, shape, dtype):
         self.runtime = runtime
         self.shape = shape
         self.dtype = dtype
+        self.field_size = calculate_volume(shape) * dtype.itemsize
+        # The (tree_id,field_id) pairs of freed fields that count towards
+        # the bytes held by the pool, and the number of fields that each
+        # of our top-level regions has handed out
+        self.held_fields = set()
+        self.region_fields = dict()
+        # The subregion partitions of the freed fields that were rounded up
+        # to our shape, which we give back once every shard freed the field
+        self.field_partitions = dict()
         # This is a sanitized list of (region,field_id) pairs that is
         # guaranteed to be ordered across all the shards even with
         # control replication
@@ -270,7 +333,32 @@ class FieldManager(object):
         self.initial_future = None
         self.fill_space = None
 
+    def _reuse_field(self):
+        region, field_id = self.free_fields.popleft()
+        key = (region.handle.tree_id, field_id)
+        if key in self.held_fields:
+            self.held_fields.remove(key)
+            stats = self.runtime.field_pool_stats
+            stats.bytes_held -= self.field_size
+            stats.bytes_ordered -= self.field_size
+        return region, field_id, True
+
+    def _add_region_field(self, region):
+        tree_id = region.handle.tree_id
+        self.region_fields[tree_id] = self.region_fields.get(tree_id, 0) + 1
+
     def allocate_field(self):
+        region, field_id, reused = self._allocate_field()
+        stats = self.runtime.field_pool_stats
+        if reused:
+            stats.reuses += 1
+        else:
+            stats.allocations += 1
+        stats.bytes_in_use += self.field_size
+        stats.update_high_water()
+        return region, field_id
+
+    def _allocate_field(self):
         # Increment our match counter
         self.match_counter += 1
         # If the match counter equals our match frequency then do an exchange
@@ -297,7 +385,7 @@ class FieldManager(object):
             self.match_counter = 0
         # First, if we have a free field then we know everyone has one of those
         if len(self.free_fields) > 0:
-            return self.free_fields.popleft()
+            return self._reuse_field()
         # If we don't have any free fields then see if we have a pending match
         # outstanding that we can now add to our free fields and use
         while len(self.matches) > 0:
@@ -305,7 +393,7 @@ class FieldManager(object):
             match.update_free_fields()
             # Check again to see if we have any free fields
             if len(self.free_fields) > 0:
-                return self.free_fields.popleft()
+                return self._reuse_field()
         # Still don't have a field
         # Scan through looking for a free field of the right type
         for reg in self.top_regions:
@@ -317,7 +405,8 @@ class FieldManager(object):
             if len(reg.field_space) < LEGATE_MAX_FIELDS:
                 region = reg
                 field_id = reg.field_space.allocate_field(self.dtype)
-                return region, field_id
+                self._add_region_field(region)
+                return region, field_id, False
         # If we make it here then we need to make a new region
         index_space = self.runtime.find_or_create_index_space(self.shape)
         field_space = self.runtime.find_or_create_field_space(self.dtype)
@@ -346,9 +435,58 @@ class FieldManager(object):
                     field_id = fid
                 else:
                     self.free_fields.append((region, fid))
+                    self._add_region_field(region)
         else:
             field_id = field_space.allocate_field(self.dtype)
-        return region, field_id
+        self._add_region_field(region)
+        return region, field_id, False
+
+    def release_field(self, region, field_id, partition=None):
+        # A field that the application is done with, which waits in the
+        # unordered list until a match tells us every shard freed it
+        stats = self.runtime.field_pool_stats
+        stats.bytes_in_use -= self.field_size
+        stats.bytes_held += self.field_size
+        key = (region.handle.tree_id, field_id)
+        self.held_fields.add(key)
+        if partition is not None:
+            self.field_partitions[key] = partition
+        self.free_field(region, field_id)
+
+    def evict_regions(self, budget):
+        # Destroy top-level regions that have all their fields on the
+        # ordered free list until the ordered bytes fit in the budget. Only
+        # the ordered list goes into this so every shard evicts the same
+        # regions in the same order.
+        stats = self.runtime.field_pool_stats
+        while stats.bytes_ordered > budget and self.top_regions:
+            free_counts = dict()
+            for region, field_id in self.free_fields:
+                tree_id = region.handle.tree_id
+                free_counts[tree_id] = free_counts.get(tree_id, 0) + 1
+            victim = None
+            for region in self.top_regions:
+                tree_id = region.handle.tree_id
+                count = free_counts.get(tree_id, 0)
+                if count > 0 and count == self.region_fields.get(tree_id):
+                    victim = region
+                    break
+            if victim is None:
+                return
+            tree_id = victim.handle.tree_id
+            remaining = deque()
+            for region, field_id in self.free_fields:
+                if region.handle.tree_id != tree_id:
+                    remaining.append((region, field_id))
+                elif (tree_id, field_id) in self.held_fields:
+                    self.held_fields.remove((tree_id, field_id))
+                    stats.bytes_held -= self.field_size
+                    stats.bytes_ordered -= self.field_size
+            self.free_fields = remaining
+            del self.region_fields[tree_id]
+            self.top_regions.remove(victim)
+            victim.destroy()
+            stats.evictions += 1
 
     def free_field(self, region, field_id, ordered=False):
         if ordered:
@@ -375,6 +513,20 @@ class FieldManager(object):
             # self.runtime.dispatch(fill)
             if self.free_fields is not None:
                 self.free_fields.append((region, field_id))
+                key = (region.handle.tree_id, field_id)
+                # Every shard gets here at the same point, so this is where
+                # the partition of a rounded field can be given back
+                partition = self.field_partitions.pop(key, None)
+                if partition is not None:
+                    self.runtime.release_field_pool_partition(
+                        self.shape, partition
+                    )
+                if key in self.held_fields:
+                    stats = self.runtime.field_pool_stats
+                    stats.bytes_ordered += self.field_size
+                    budget = self.runtime.max_field_pool_size
+                    if budget > 0 and stats.bytes_ordered > budget:
+                        self.evict_regions(budget)
         else:  # Put this on the unordered list
             if self.freed_fields is not None:
                 self.freed_fields.append((region, field_id))
@@ -488,6 +640,7 @@ class RegionField(object):
         self.physical_region = None  # Physical region for attach
         self.physical_region_refs = 0
         self.physical_region_mapped = False
+        self.file_backed = False  # Whether the attached array is a file
 
     def __del__(self):
         if self.attach_array is not None:
@@ -850,10 +1003,56 @@ class RegionField(object):
             # If we're sharing this then we can also make this our numpy array
             self.numpy_array = weakref.ref(numpy_array)
 
+    def attach_file(self, filename, offset, mode):
+        assert self.parent is None
+        dtype = self.field.dtype
+        nbytes = calculate_volume(self.shape) * dtype.itemsize
+        # Map the whole file and attach it like any other NumPy array. The
+        # mapper uses the attachment of a file in place rather than making
+        # copies of it, so how much of it is in memory at any point is up
+        # to the kernel and not to us.
+        with open(filename, "r+b" if mode == "r+" else "rb") as f:
+            start = offset - offset % mmap.ALLOCATIONGRANULARITY
+            # Copy-on-write mappings leave the file alone but we can still
+            # write to the array through them
+            buffer = mmap.mmap(
+                f.fileno(),
+                offset + nbytes - start,
+                access=mmap.ACCESS_WRITE if mode == "r+" else mmap.ACCESS_COPY,
+                offset=start,
+            )
+        # Most of what we do walks through the tiles in order so tell the
+        # kernel to read ahead aggressively and drop pages behind us
+        if hasattr(buffer, "madvise"):
+            buffer.madvise(mmap.MADV_SEQUENTIAL)
+        array = np.ndarray(
+            self.shape, dtype=dtype, buffer=buffer, offset=(offset - start)
+        )
+        self.attach_numpy_array(array, share=False)
+        self.set_file_backed(True)
+
+    def set_file_backed(self, file_backed):
+        # Let the mapper know through the field so that it applies to all
+        # the views and partitions of this array
+        value = ffi.new("bool *", file_backed)
+        legion.legion_field_id_attach_semantic_information(
+            self.runtime.runtime,
+            self.region.field_space.handle,
+            self.field.field_id,
+            NumPySemanticTag.FILE_BACKED,
+            value,
+            ffi.sizeof("bool"),
+            True,
+        )
+        self.file_backed = file_backed
+
     def detach_numpy_array(self, unordered, defer=False):
         assert self.parent is None
         assert self.attach_array is not None
         assert self.physical_region is not None
+        # The field will get recycled for arrays in memory
+        if self.file_backed:
+            self.set_file_backed(False)
         detach = self.runtime.remove_detachment(self.detach_key)
         detach.unordered = unordered
         self.runtime.detach_array_field(
@@ -885,6 +1084,8 @@ class RegionField(object):
                 # Wait until it is valid before returning
                 self.physical_region.wait_until_valid()
             # Increment our ref count so we know when it can be collected
+            if self.physical_region_refs == 0:
+                self.runtime.num_host_mappings += 1
             self.physical_region_refs += 1
             return self.physical_region
         else:
@@ -898,17 +1099,11 @@ class RegionField(object):
                 self.runtime.unmap_region(self.physical_region)
                 self.physical_region = None
                 self.physical_region_mapped = False
+                self.runtime.num_host_mappings -= 1
         else:
             self.parent.decrement_inline_mapped_ref_count()
 
-    def get_numpy_array(self):
-        # See if we still have a valid numpy array to use
-        if self.numpy_array is not None:
-            # Test the weak reference to see if it is still alive
-            result = self.numpy_array()
-            if result is not None:
-                return result
-        physical_region = self.get_inline_mapped_region()
+    def create_numpy_array(self, physical_region):
         # We need a pointer to the physical allocation for this physical region
         dim = len(self.shape)
         # Build the accessor for this physical region
@@ -962,7 +1157,18 @@ class RegionField(object):
         initializer = _RegionNdarray(
             shape, self.field.dtype, base_ptr, strides, False
         )
-        array = np.asarray(initializer)
+        return np.asarray(initializer)
+
+    def get_numpy_array(self):
+        # See if we still have a valid numpy array to use
+        if self.numpy_array is not None:
+            # Test the weak reference to see if it is still alive
+            result = self.numpy_array()
+            if result is not None:
+                self.runtime.keep_host_view(result)
+                return result
+        physical_region = self.get_inline_mapped_region()
+        array = self.create_numpy_array(physical_region)
 
         # This will be the unmap call that will be invoked once the weakref is
         # removed
@@ -974,6 +1180,9 @@ class RegionField(object):
         callback = functools.partial(decrement, self)
         # Save a weak reference to the array so we don't prevent collection
         self.numpy_array = weakref.ref(array, callback)
+        # The runtime holds on to the array until the next launch so that
+        # calls back and forth with NumPy in between keep using the mapping
+        self.runtime.keep_host_view(array)
         return array
 
 
@@ -1047,6 +1256,10 @@ class Runtime(object):
         "max_eager_volume",
         "max_field_reuse_size",
         "max_field_reuse_frequency",
+        "max_field_pool_size",
+        "field_pool_stats",
+        "field_pool_partitions",
+        "num_gpus",
         "test_mode",
         "launch_spaces",
         "piece_factors",
@@ -1063,6 +1276,14 @@ class Runtime(object):
         "transform_sharding_functors",
         "transform_sharding_offset",
         "destroyed",
+        "host_views",
+        "num_host_mappings",
+        "lazy_evaluation",
+        "lazy_arrays",
+        "flushing_lazy_arrays",
+        "item_arrays",
+        "num_pending_items",
+        "flushing_item_writes",
     ]
 
     def __init__(self, runtime, context):
@@ -1086,11 +1307,22 @@ class Runtime(object):
             self.callsite_summaries = dict()
         except ValueError:
             self.callsite_summaries = None
+        try:
+            # Prune it out so the application does not see it
+            sys.argv.remove("-lg:numpy:lazy")
+            self.lazy_evaluation = True
+        except ValueError:
+            self.lazy_evaluation = False
         self.index_spaces = OrderedDict()  # map shapes to index spaces
         self.field_spaces = OrderedDict()  # map dtype to field spaces
         self.field_managers = (
             OrderedDict()
         )  # map from (shape,dtype) to field managers
+        self.field_pool_stats = FieldPoolStatistics()
+        # map from (size class, shape) to the number of live fields using
+        # the subregion partition for that shape
+        self.field_pool_partitions = dict()
+        self.max_field_pool_size = 0
         self.ptr_to_thunk = None  # map from external array pointer to thunks
         self.transform_sharding_functors = None
         self.transform_sharding_offset = legate_numpy.NUMPY_SHARD_EXTRA
@@ -1102,6 +1334,19 @@ class Runtime(object):
         )
         self.current_random_epoch = 0
         self.destroyed = False
+        # Views of inline mappings that we keep alive until the next launch
+        # and the number of fields that the host has mapped
+        self.host_views = None
+        self.num_host_mappings = 0
+        # Lazy arrays whose expressions we have yet to compute, in the
+        # order that they were recorded
+        self.lazy_arrays = None
+        self.flushing_lazy_arrays = False
+        # Deferred arrays with writes of single items that we have yet to
+        # launch and how many writes there are in all
+        self.item_arrays = None
+        self.num_pending_items = 0
+        self.flushing_item_writes = False
         # Get the initial task ID and mapper ID
         encoded_name = NUMPY_LIB_NAME.encode("utf-8")
         self.first_task_id = legion.legion_runtime_generate_library_task_ids(
@@ -1193,6 +1438,27 @@ class Runtime(object):
                     0,
                 )
             )
+            # Some kernels only have CPU variants so we need to know
+            # whether there are GPUs around that would be left idle
+            f7 = Future(
+                legion.legion_runtime_select_tunable_value(
+                    self.runtime,
+                    self.context,
+                    legate_numpy.NUMPY_TUNABLE_NUM_GPUS,
+                    self.mapper_id,
+                    0,
+                )
+            )
+            # Figure out how many bytes of freed fields the pool can hold
+            f8 = Future(
+                legion.legion_runtime_select_tunable_value(
+                    self.runtime,
+                    self.context,
+                    legate_numpy.NUMPY_TUNABLE_FIELD_POOL_SIZE,
+                    self.mapper_id,
+                    0,
+                )
+            )
             self.num_pieces = struct.unpack_from("i", f1.get_buffer(4))[0]
             if self.num_pieces > 1:
                 self.launch_spaces = dict()
@@ -1240,6 +1506,10 @@ class Runtime(object):
             self.max_field_reuse_frequency = struct.unpack_from(
                 "i", f6.get_buffer(4)
             )[0]
+            self.num_gpus = struct.unpack_from("i", f7.get_buffer(4))[0]
+            self.max_field_pool_size = struct.unpack_from(
+                "Q", f8.get_buffer(8)
+            )[0]
         # Make sure that our NumPyLib object knows about us so it can destroy
         # us
         numpy_lib.set_runtime(self)
@@ -1251,6 +1521,7 @@ class Runtime(object):
             self.empty_argmap = None
         # Remove references to our legion resources so they can be collected
         self.field_managers = None
+        self.field_pool_partitions = None
         self.field_spaces = None
         self.index_spaces = None
         if self.callsite_summaries is not None:
@@ -1358,19 +1629,76 @@ class Runtime(object):
         else:
             return result
 
-    def allocate_field(self, shape, dtype):
+    def find_field_pool_shape(self, shape):
+        # Round the first extent up to a size class so that shapes that
+        # drift a little from one allocation to the next end up sharing
+        # the same field manager. There are four classes between each pair
+        # of powers of two, so we never waste more than a quarter.
+        if self.max_field_pool_size == 0 or calculate_volume(shape) == 0:
+            return shape
+        extent = shape[0]
+        if extent <= _FIELD_POOL_MIN_EXTENT:
+            return shape
+        step = (1 << (extent.bit_length() - 1)) // 4
+        rounded = ((extent + step - 1) // step) * step
+        return (rounded,) + shape[1:]
+
+    def allocate_field(self, shape, dtype, pooled=False):
         assert not self.destroyed
         region = None
         field_id = None
+        # Pooled fields can live in a bigger region than the shape needs,
+        # but only fields that never get attached or handed to another
+        # library since those need a top-level region of the exact shape
+        field_shape = self.find_field_pool_shape(shape) if pooled else shape
         # Regions all have fields of the same field type and shape
-        key = (shape, dtype)
+        key = (field_shape, dtype)
         # if we don't have a field manager yet then make one
         if key not in self.field_managers:
-            self.field_managers[key] = FieldManager(self, shape, dtype)
+            self.field_managers[key] = FieldManager(self, field_shape, dtype)
         region, field_id = self.field_managers[key].allocate_field()
-        field = Field(self, region, field_id, dtype, shape)
+        field = Field(self, region, field_id, dtype, field_shape)
+        if field_shape != shape:
+            # Use the subregion at the start of the region as if it were a
+            # top-level region of our shape
+            self.field_pool_stats.rounded += 1
+            partition = _find_or_create_partition(
+                self,
+                region,
+                (1,) * len(shape),
+                shape,
+                (0,) * len(shape),
+                None,
+                complete=False,
+            )
+            key = (field_shape, shape)
+            self.field_pool_partitions[key] = (
+                self.field_pool_partitions.get(key, 0) + 1
+            )
+            field.partition = partition
+            region = partition.get_child(Point((0,) * len(shape)))
         return RegionField(self, region, field, shape)
 
+    def release_field_pool_partition(self, field_shape, partition):
+        # All the regions of a size class share an index space, so the
+        # partitions for the shapes in the class pile up on it unless we
+        # destroy each one once the last field using it goes away
+        if self.field_pool_partitions is None:
+            return
+        key = (field_shape, partition.tile_shape)
+        count = self.field_pool_partitions[key] - 1
+        if count > 0:
+            self.field_pool_partitions[key] = count
+            return
+        del self.field_pool_partitions[key]
+        # Take it out of the index space first so that nobody finds it
+        # when they look for a partition like it
+        index_partition = partition.index_partition
+        children = index_partition.parent.children
+        if children is not None and index_partition in children:
+            children.remove(index_partition)
+        index_partition.destroy(unordered=False)
+
     def free_field(self, region, field_id, dtype, shape, partition):
         # Have a guard here to make sure that we don't try to
         # do this after we have been destroyed
@@ -1379,7 +1707,12 @@ class Runtime(object):
         # Now save it in our data structure for free fields eligible for reuse
         key = (shape, dtype)
         if self.field_managers is not None:
-            self.field_managers[key].free_field(region, field_id)
+            self.field_managers[key].release_field(
+                region, field_id, partition
+            )
+
+    def get_field_pool_statistics(self):
+        return self.field_pool_stats.as_dict()
 
     def compute_parallel_launch_space_by_shape(self, shape):
         assert self.num_pieces > 0
@@ -1554,6 +1887,26 @@ class Runtime(object):
         self.index_spaces[bounds] = result
         return result
 
+    def create_sparse_index_space(self, points):
+        # An index space of just the given points, for launching tasks on
+        # some of the colors of a launch space
+        spaces = ffi.new("legion_index_space_t[]", len(points))
+        for idx, point in enumerate(points):
+            spaces[idx] = legion.legion_index_space_create_domain(
+                self.runtime,
+                self.context,
+                Rect(point, point, exclusive=False).raw(),
+            )
+        result = legion.legion_index_space_union(
+            self.runtime, self.context, spaces, len(points)
+        )
+        for idx in xrange(len(points)):
+            self.destroy_index_space(spaces[idx])
+        return result
+
+    def destroy_index_space(self, handle):
+        legion.legion_index_space_destroy(self.runtime, self.context, handle)
+
     def find_or_create_field_space(self, dtype):
         if dtype in self.field_spaces:
             return self.field_spaces[dtype]
@@ -1808,6 +2161,26 @@ class Runtime(object):
         return func
 
     def dispatch(self, operation, redop=None):
+        # Writes of single items come first, since any lazy arrays that are
+        # still pending were recorded after them
+        if self.item_arrays and not self.flushing_item_writes:
+            self.flush_item_writes()
+        # Anything we launch might read the lazy arrays that the application
+        # still holds or write to what they read, so compute them first
+        if self.lazy_arrays and not self.flushing_lazy_arrays:
+            self.flush_lazy_arrays()
+        # Let go of the views we kept for the host before anything else
+        # launches, which unmaps the ones the application does not hold.
+        # The region requirements of a launch stay on the Legion side, so
+        # we cannot tell which fields it touches and treat every launch
+        # that can touch a field as a conflict. Views are read-write, so
+        # Legion picks up what the host wrote when they are unmapped and
+        # there is nothing to flush. Inline mappings and field matches
+        # touch no fields and keep the views.
+        if self.host_views and not isinstance(
+            operation, (InlineMapping, FieldMatch)
+        ):
+            self.host_views = None
         # See if we have any deferred or pending detachments to deal with
         if self.deferred_detachments:
             self.perform_detachments()
@@ -1822,6 +2195,94 @@ class Runtime(object):
     def unmap_region(self, physical_region):
         physical_region.unmap(self.runtime, self.context)
 
+    def is_first_shard(self):
+        # Work outside of Legion that has to happen only once, like making
+        # directories, runs on the first shard with control replication
+        return (
+            legion.legion_context_get_shard_id(
+                self.runtime, self.context, True
+            )
+            == 0
+        )
+
+    def issue_fence(self, block=False):
+        # With control replication every shard takes part in a fence, so
+        # waiting on it also waits for all the shards to get to it
+        future = Future(
+            legion.legion_runtime_issue_execution_fence(
+                self.runtime, self.context
+            )
+        )
+        if block:
+            future.wait()
+
+    def keep_host_view(self, array):
+        if self.host_views is None:
+            self.host_views = dict()
+        self.host_views[id(array)] = array
+
+    def record_lazy_array(self, array):
+        if self.lazy_arrays is None:
+            self.lazy_arrays = list()
+        self.lazy_arrays.append(array)
+        # Arrays that nothing holds any more never need to be computed on
+        # their own, and if the rest are piling up we compute them now
+        if len(self.lazy_arrays) > 64:
+            self.lazy_arrays = [
+                lazy
+                for lazy in self.lazy_arrays
+                if lazy.is_pending() and lazy.is_live()
+            ]
+            if len(self.lazy_arrays) > 32:
+                self.flush_lazy_arrays()
+
+    def flush_lazy_arrays(self):
+        self.flushing_lazy_arrays = True
+        arrays = self.lazy_arrays
+        self.lazy_arrays = None
+        for array in arrays:
+            if array.is_pending() and array.is_live():
+                array.materialize(stacklevel=1)
+        self.flushing_lazy_arrays = False
+
+    def buffer_item_write(self, array, point, value):
+        # Pending lazy arrays that read the array need its old values
+        if self.lazy_arrays:
+            self.flush_lazy_arrays()
+        # Writes through other views of the same field have to land in the
+        # order that they were made, so the ones before go out first
+        if array.pending_items is None and self.item_arrays:
+            field = array.base.field
+            if any(other.base.field is field for other in self.item_arrays):
+                self.flush_item_writes()
+        if array.pending_items is None:
+            array.pending_items = dict()
+            if self.item_arrays is None:
+                self.item_arrays = list()
+            self.item_arrays.append(array)
+        array.pending_items[point] = value
+        self.num_pending_items += 1
+        if self.num_pending_items >= _max_pending_items:
+            self.flush_item_writes()
+
+    def flush_item_writes(self):
+        # Every array gets all of its writes in one launch, and none of the
+        # lazy arrays can run until they are all in
+        self.flushing_item_writes = True
+        flushing = self.flushing_lazy_arrays
+        self.flushing_lazy_arrays = True
+        arrays = self.item_arrays
+        self.item_arrays = None
+        self.num_pending_items = 0
+        for array in arrays:
+            items = array.pending_items
+            array.pending_items = None
+            points = np.array(list(items.keys()), dtype=np.int64)
+            values = np.array(list(items.values()), dtype=array.dtype)
+            array.set_items(points, values, stacklevel=1)
+        self.flushing_lazy_arrays = flushing
+        self.flushing_item_writes = False
+
     def perform_detachments(self):
         detachments = self.deferred_detachments
         self.deferred_detachments = None
@@ -1865,6 +2326,18 @@ class Runtime(object):
         assert isinstance(dtype, np.dtype)
         return dtype.type in numpy_field_type_offsets
 
+    def is_file_io_type(self, dtype, shape):
+        # Arrays that the file tasks can move straight between their
+        # instances and a file, anything else goes through NumPy
+        return (
+            dtype.isnative
+            and not dtype.hasobject
+            and dtype.fields is None
+            and self.is_supported_type(dtype)
+            and len(shape) > 0
+            and calculate_volume(shape) > 1
+        )
+
     def get_numpy_thunk(self, obj, stacklevel, share=False, dtype=None):
         # Check to see if this object implements the Legate data interface
         if hasattr(obj, "__legate_data_interface__"):
@@ -1983,6 +2456,39 @@ class Runtime(object):
         )
         return region_field
 
+    def create_file_thunk(self, filename, shape, dtype, offset, mode):
+        assert mode in ("r", "r+", "c")
+        region_field = self.allocate_field(shape, dtype)
+        region_field.attach_file(filename, offset, mode)
+        result = DeferredArray(
+            self,
+            region_field,
+            shape=shape,
+            dtype=dtype,
+            scalar=False,
+        )
+        # If we're doing shadow debug make an EagerArray shadow
+        if self.shadow_debug:
+            result.shadow = EagerArray(self, region_field.attach_array.copy())
+        return result
+
+    def count_text_rows(self, filename, comment, splits, stacklevel):
+        # Always count in parallel no matter how few chunks there are since
+        # each of them can still be a big piece of the file
+        shape = (len(splits) - 1,)
+        dtype = np.dtype(np.uint64)
+        counts = DeferredArray(
+            self,
+            self.allocate_field(shape, dtype),
+            shape=shape,
+            dtype=dtype,
+            scalar=False,
+        )
+        counts.count_lines(
+            filename, comment, splits, stacklevel=(stacklevel + 1)
+        )
+        return counts.base.get_numpy_array().copy()
+
     def detach_array_field(self, array, field, detach, defer):
         if defer:
             # If we need to defer this until later do that now
@@ -2204,8 +2710,14 @@ class Runtime(object):
                     result = DeferredArray(
                         self, Future(), shape=shape, dtype=dtype, scalar=True
                     )
+                elif self.lazy_evaluation and not self.shadow_debug:
+                    # The field is made when the values are computed
+                    result = LazyArray(self, shape, dtype)
                 else:
-                    region_field = self.allocate_field(shape, dtype)
+                    # Shadow debugging attaches its results to the fields
+                    region_field = self.allocate_field(
+                        shape, dtype, pooled=not self.shadow_debug
+                    )
                     result = DeferredArray(
                         self,
                         region_field,
@@ -2276,7 +2788,7 @@ class Runtime(object):
         elif self.is_eager_array(array):
             return array.to_deferred_array(stacklevel=(stacklevel + 1))
         elif self.is_lazy_array(array):
-            raise NotImplementedError("convert lazy array to deferred array")
+            return array.materialize(stacklevel=(stacklevel + 1))
         else:
             raise RuntimeError("invalid array type")
 
@@ -84,6 +84,14 @@ class NumPyThunk(LegateStore):
         """
         pass
 
+    def owns_storage(self):
+        """Return True if nothing but this thunk can observe its storage,
+        so an operation may overwrite it instead of allocating a new one
+
+        :meta private:
+        """
+        return False
+
     def imag(self, stacklevel):
         """Return a thunk for the imaginary part of this complex array
 
@@ -126,6 +134,30 @@ class NumPyThunk(LegateStore):
         """
         raise NotImplementedError("Implement in derived classes")
 
+    def get_items(self, points, stacklevel):
+        """Get the items at an array of points with one row per point
+        and return their values in a NumPy array
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def set_items(self, points, values, stacklevel):
+        """Set the items at an array of points with one row per point
+        to the values in a NumPy array
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def scatter_add(self, index, values, stacklevel):
+        """Add each row of values into the row of the array that the
+        matching entry of index picks out, once for every repeat
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
     def reshape(self, newshape, order, stacklevel):
         """Reshape the array using the same backing storage if possible
 
@@ -175,6 +207,79 @@ class NumPyThunk(LegateStore):
         """
         raise NotImplementedError("Implement in derived classes")
 
+    def cholesky(self, rhs, stacklevel):
+        """Compute the lower Cholesky factor of a matrix
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def solve_triangular(self, a, b, lower, trans, stacklevel):
+        """Solve a triangular system with multiple right-hand sides
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def qr_r(self, rhs, stacklevel):
+        """Compute the R factor of the QR factorization of a matrix
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def nrm2(self, rhs, stacklevel):
+        """Compute the 2-norm of a whole array without overflow
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def axpby(self, alpha, x, beta, y, norm, stacklevel):
+        """Fill in alpha * x + beta * y and optionally its squared 2-norm
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def read_file(self, filename, offset, npy, stacklevel):
+        """Fill in our thunk from the C-order data in a file
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def write_file(self, filename, offset, header, truncate, stacklevel):
+        """Write our thunk into a file in C order
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def read_text(
+        self, filename, comment, delimiter, chunks, stop, stacklevel
+    ):
+        """Fill in our thunk with the rows of numbers in a text file
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def checkpoint(self, prefix, compress, stacklevel):
+        """Write the tiles of our thunk into files starting with the prefix
+        and return the shape of the tiles and the origin of the first one
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def restore(self, prefix, tile_shape, tile_origin, stacklevel):
+        """Fill in our thunk from the tiles of a checkpoint
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
     def diag(self, rhs, extract, k, stacklevel):
         """Fill in or extract a diagonal from a matrix
 
@@ -211,6 +316,72 @@ class NumPyThunk(LegateStore):
         """
         raise NotImplementedError("Implement in derived classes")
 
+    def pack_bits(self, op, rhs1, rhs2, stacklevel):
+        """Pack the results of comparing rhs1 with rhs2 into the words of
+        a bitmask
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def unpack_bits(self, rhs, stacklevel):
+        """Expand the words of a bitmask into an array of bools
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bitmask_logical(self, op, rhs1, rhs2, size, stacklevel):
+        """Combine the words of bitmasks with a logical operation
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bitmask_count(self, stacklevel):
+        """Count the set bits in the words of a bitmask
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bitmask_nonzero(self, stacklevel):
+        """Return a thunk for the flattened indices of the set bits in the
+        words of a bitmask
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bf16_convert(self, rhs, narrow, stacklevel):
+        """Round float values to bfloat16 bits or widen bfloat16 bits back
+        to float values
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bf16_ufunc(self, op, rhs1, rhs2, reverse, stacklevel):
+        """Apply a ufunc to bfloat16 bits in float32 and round the result
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def bf16_sum(self, stacklevel):
+        """Sum bfloat16 bits into a float32 value
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
+    def fused_op(self, program, inputs, stacklevel):
+        """Evaluate a FusedProgram over the input thunks into this thunk
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
     def sort(self, rhs, stacklevel):
         """Sort the array
 
@@ -281,6 +452,14 @@ class NumPyThunk(LegateStore):
         """
         raise NotImplementedError("Implement in derived classes")
 
+    def clip(self, rhs, lo, hi, stacklevel):
+        """Clip rhs between the bounds lo and hi, which are broadcast
+        against it, and put the result in the dst array
+
+        :meta private:
+        """
+        raise NotImplementedError("Implement in derived classes")
+
     # Helper methods that are used in several sub-classes
     def _standardize_slice_key(self, key, dim):
         # Wrap around is permitted exactly once
@@ -15,6 +15,7 @@
 
 # Define ufuns for binary operations
 from .module import (
+    _add_at,
     add as _add,
     amax as _max,
     amin as _min,
@@ -53,6 +54,10 @@ class add(ufunc):
             a, axis=axis, dtype=dtype, out=out, keepdims=keepdims, stacklevel=2
         )
 
+    @staticmethod
+    def at(a, indices, b):
+        _add_at(a, indices, b, stacklevel=2)
+
 
 # ufunc-multiply class
 class multiply(ufunc):
@@ -15,6 +15,7 @@
 
 import functools
 import inspect
+import sys
 import warnings
 
 import numpy as np
@@ -100,3 +101,43 @@ def calculate_volume(shape):
     if shape == ():
         return 0
     return reduce(lambda x, y: x * y, shape)
+
+
+# bfloat16 values are kept as the upper 16 bits of float32 values in
+# arrays of uint16 and rounded to the nearest even value like the tasks do
+def float_to_bfloat16(values):
+    bits = np.asarray(values, dtype=np.float32).view(np.uint32)
+    rounded = bits + (np.uint32(0x7FFF) + ((bits >> 16) & np.uint32(1)))
+    nans = (bits & np.uint32(0x7FFFFFFF)) > np.uint32(0x7F800000)
+    rounded = np.where(nans, bits | np.uint32(0x00400000), rounded)
+    return (rounded >> 16).astype(np.uint16)
+
+
+def bfloat16_to_float(bits):
+    bits = np.asarray(bits, dtype=np.uint16).astype(np.uint32) << 16
+    return bits.view(np.float32)
+
+
+def _attribute_refcount(owner, name):
+    value = getattr(owner, name)
+    return sys.getrefcount(value)
+
+
+class _RefcountHolder(object):
+    __slots__ = ["value"]
+
+
+def _sole_attribute_refcount():
+    holder = _RefcountHolder()
+    holder.value = object()
+    return _attribute_refcount(holder, "value")
+
+
+# Measured once so that the check below does not depend on how the
+# interpreter counts the references held by its own frames
+_SOLE_ATTRIBUTE_REFCOUNT = _sole_attribute_refcount()
+
+
+# Return True if the attribute of owner is the only reference to its value
+def is_sole_reference(owner, name):
+    return _attribute_refcount(owner, name) <= _SOLE_ATTRIBUTE_REFCOUNT
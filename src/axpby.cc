@@ -0,0 +1,157 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "axpby.h"
+#include "point_task.h"
+#include "proj.h"
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Computes the update for one piece and returns the sum of the squares of
+// the new values when DOT is set. All three vectors are partitioned the
+// same way so in the common case they are all dense and the loops below
+// are straight-line code that the compiler vectorizes.
+template <typename T, int DIM, bool DOT>
+static T axpby(const Task* task,
+               LegateDeserializer& derez,
+               const std::vector<PhysicalRegion>& regions,
+               bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  T result             = SumReduction<T>::identity;
+  if (rect.empty()) return result;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const AccessorRO<T, DIM> x   = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  const AccessorRO<T, DIM> y   = derez.unpack_accessor_RO<T, DIM>(regions[2], rect);
+  const T alpha                = task->futures[0].get_result<T>();
+  const T beta                 = task->futures[1].get_result<T>();
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (out.accessor.is_dense_row_major(rect) && x.accessor.is_dense_row_major(rect) &&
+      y.accessor.is_dense_row_major(rect)) {
+    T* outptr     = out.ptr(rect);
+    const T* xptr = x.ptr(rect);
+    const T* yptr = y.ptr(rect);
+    if (DOT)
+      return sum_each_index<T>(size_t(0), volume, parallel, [&](size_t idx) {
+        const T value = alpha * xptr[idx] + beta * yptr[idx];
+        outptr[idx]   = value;
+        return value * value;
+      });
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      outptr[idx] = alpha * xptr[idx] + beta * yptr[idx];
+    });
+    return result;
+  }
+  return sum_each_index<T>(size_t(0), volume, parallel, [&](size_t idx) {
+    const Point<DIM> point = pitches.unflatten(idx, rect.lo);
+    const T value          = alpha * x[point] + beta * y[point];
+    out[point]             = value;
+    return DOT ? value * value : T(0);
+  });
+}
+
+template <typename T, bool DOT>
+static T axpby_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                           \
+  case DIM: {                                                  \
+    return axpby<T, DIM, DOT>(task, derez, regions, parallel); \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return SumReduction<T>::identity;
+}
+
+template <typename T>
+/*static*/ void AxpbyTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  axpby_task<T, false /*dot*/>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void AxpbyTask<T>::omp_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  axpby_task<T, false /*dot*/>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T>
+/*static*/ T AxpbyDotTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  return axpby_task<T, true /*dot*/>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ T AxpbyDotTask<T>::omp_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  return axpby_task<T, true /*dot*/>(task, regions, true /*parallel*/);
+}
+#endif
+
+// The solvers only work in floating point so that is all we provide
+#define INSTANTIATE_AXPBY_TASKS(type, base_id)                                 \
+  template <>                                                                  \
+  const int type<float>::TASK_ID = base_id + FLOAT_LT* NUMPY_MAX_VARIANTS;     \
+  template class type<float>;                                                  \
+  template <>                                                                  \
+  const int type<double>::TASK_ID = base_id + DOUBLE_LT* NUMPY_MAX_VARIANTS;   \
+  template class type<double>;
+
+INSTANTIATE_AXPBY_TASKS(AxpbyTask, static_cast<int>(NumPyOpCode::NUMPY_AXPBY) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_AXPBY_TASKS(AxpbyDotTask,
+                        static_cast<int>(NumPyOpCode::NUMPY_AXPBY) * NUMPY_TYPE_OFFSET +
+                          NUMPY_REDUCTION_VARIANT_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  legate::numpy::AxpbyTask<float>::register_variants();
+  legate::numpy::AxpbyTask<double>::register_variants();
+  legate::numpy::AxpbyDotTask<float>::register_variants_with_return<
+    float,
+    DeferredReduction<SumReduction<float>>>();
+  legate::numpy::AxpbyDotTask<double>::register_variants_with_return<
+    double,
+    DeferredReduction<SumReduction<double>>>();
+}
+}  // namespace
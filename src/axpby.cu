@@ -0,0 +1,120 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "axpby.h"
+#include "cuda_help.h"
+#include "point_task.h"
+#include "proj.h"
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+template <typename T, int DIM, bool DOT>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_axpby(DeferredReduction<SumReduction<T>> result,
+               const AccessorWO<T, DIM> out,
+               const AccessorRO<T, DIM> x,
+               const AccessorRO<T, DIM> y,
+               const T alpha,
+               const T beta,
+               const size_t iters,
+               const Point<DIM> origin,
+               const Pitches<DIM - 1> pitches,
+               const size_t volume)
+{
+  T value = SumReduction<T>::identity;
+  for (size_t idx = 0; idx < iters; idx++) {
+    const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
+    if (offset < volume) {
+      const Point<DIM> point = pitches.unflatten(offset, origin);
+      const T update         = alpha * x[point] + beta * y[point];
+      out[point]             = update;
+      if (DOT) SumReduction<T>::template fold<true /*exclusive*/>(value, update * update);
+    }
+  }
+  if (DOT) reduce_output(result, value);
+}
+
+template <typename T, bool DOT>
+static DeferredReduction<SumReduction<T>> axpby_gpu(const Task* task,
+                                                    const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const T alpha = task->futures[0].get_result<T>();
+  const T beta  = task->futures[1].get_result<T>();
+  DeferredReduction<SumReduction<T>> result;
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                                                          \
+  case DIM: {                                                                                 \
+    const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);            \
+    if (rect.empty()) break;                                                                  \
+    const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);        \
+    const AccessorRO<T, DIM> x   = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);        \
+    const AccessorRO<T, DIM> y   = derez.unpack_accessor_RO<T, DIM>(regions[2], rect);        \
+    Pitches<DIM - 1> pitches;                                                                 \
+    const size_t volume = pitches.flatten(rect);                                              \
+    const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;               \
+    if (blocks >= MAX_REDUCTION_CTAS) {                                                       \
+      const size_t iters = (blocks + MAX_REDUCTION_CTAS - 1) / MAX_REDUCTION_CTAS;            \
+      legate_axpby<T, DIM, DOT><<<MAX_REDUCTION_CTAS, THREADS_PER_BLOCK>>>(                   \
+        result, out, x, y, alpha, beta, iters, rect.lo, pitches, volume);                     \
+    } else {                                                                                  \
+      legate_axpby<T, DIM, DOT><<<blocks, THREADS_PER_BLOCK>>>(                               \
+        result, out, x, y, alpha, beta, 1 /*iters*/, rect.lo, pitches, volume);               \
+    }                                                                                         \
+    break;                                                                                    \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return result;
+}
+
+template <typename T>
+/*static*/ void AxpbyTask<T>::gpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  axpby_gpu<T, false /*dot*/>(task, regions);
+}
+
+template <typename T>
+/*static*/ DeferredReduction<SumReduction<T>> AxpbyDotTask<T>::gpu_variant(
+  const Task* task, const std::vector<PhysicalRegion>& regions, Context ctx, Runtime* runtime)
+{
+  return axpby_gpu<T, true /*dot*/>(task, regions);
+}
+
+template void AxpbyTask<float>::gpu_variant(const Task*,
+                                            const std::vector<PhysicalRegion>&,
+                                            Context,
+                                            Runtime*);
+template void AxpbyTask<double>::gpu_variant(const Task*,
+                                             const std::vector<PhysicalRegion>&,
+                                             Context,
+                                             Runtime*);
+template DeferredReduction<SumReduction<float>> AxpbyDotTask<float>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template DeferredReduction<SumReduction<double>> AxpbyDotTask<double>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+
+}  // namespace numpy
+}  // namespace legate
@@ -0,0 +1,85 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_AXPBY_H__
+#define __NUMPY_AXPBY_H__
+
+#include "numpy.h"
+
+// Fused level-1 kernels for the Krylov solvers. Computing z = a*x + b*y
+// with the ufuncs takes three tasks and two temporaries, and a following
+// dot product reads z once more; these do it all in one pass.
+
+namespace legate {
+namespace numpy {
+
+// z := a*x + b*y with a and b passed as futures
+template <typename T>
+class AxpbyTask : public NumPyTask<AxpbyTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+#ifdef LEGATE_USE_CUDA
+  static void gpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Same update as AxpbyTask that also returns z.z for the residual norm
+template <typename T>
+class AxpbyDotTask : public NumPyTask<AxpbyDotTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static T cpu_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static T omp_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+#endif
+#ifdef LEGATE_USE_CUDA
+  static Legion::DeferredReduction<Legion::SumReduction<T>> gpu_variant(
+    const Legion::Task* task,
+    const std::vector<Legion::PhysicalRegion>& regions,
+    Legion::Context ctx,
+    Legion::Runtime* runtime);
+#endif
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_AXPBY_H__
@@ -0,0 +1,427 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "bfloat16.h"
+#include "point_task.h"
+#include "proj.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Every task here runs a single function over tiles that are all
+// partitioned the same way, with a straight loop over the pointers when
+// the instances are dense
+template <int DIM, typename OUT, typename IN, typename FUNC>
+static void map_tile(const AccessorWO<OUT, DIM>& out,
+                     const AccessorRO<IN, DIM>& in,
+                     const Rect<DIM>& rect,
+                     FUNC func,
+                     bool parallel)
+{
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (out.accessor.is_dense_row_major(rect) && in.accessor.is_dense_row_major(rect)) {
+    OUT* outptr     = out.ptr(rect);
+    const IN* inptr = in.ptr(rect);
+    for_each_index(
+      size_t(0), volume, parallel, [&](size_t idx) { outptr[idx] = func(inptr[idx]); });
+  } else {
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> point = pitches.unflatten(idx, rect.lo);
+      out[point]             = func(in[point]);
+    });
+  }
+}
+
+template <int DIM, typename FUNC>
+static void map_tile(const AccessorWO<uint16_t, DIM>& out,
+                     const AccessorRO<uint16_t, DIM>& in1,
+                     const AccessorRO<uint16_t, DIM>& in2,
+                     const Rect<DIM>& rect,
+                     FUNC func,
+                     bool parallel)
+{
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (out.accessor.is_dense_row_major(rect) && in1.accessor.is_dense_row_major(rect) &&
+      in2.accessor.is_dense_row_major(rect)) {
+    uint16_t* outptr       = out.ptr(rect);
+    const uint16_t* in1ptr = in1.ptr(rect);
+    const uint16_t* in2ptr = in2.ptr(rect);
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      outptr[idx] = func(in1ptr[idx], in2ptr[idx]);
+    });
+  } else {
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> point = pitches.unflatten(idx, rect.lo);
+      out[point]             = func(in1[point], in2[point]);
+    });
+  }
+}
+
+template <typename T, int DIM>
+static void convert(const Task* task,
+                    LegateDeserializer& derez,
+                    const std::vector<PhysicalRegion>& regions,
+                    bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const bool narrow = derez.unpack_bool();
+  if (narrow) {
+    const AccessorWO<uint16_t, DIM> out = derez.unpack_accessor_WO<uint16_t, DIM>(regions[0], rect);
+    const AccessorRO<T, DIM> in         = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+    map_tile<DIM>(
+      out,
+      in,
+      rect,
+      [](T value) { return float_to_bfloat16(static_cast<float>(value)); },
+      parallel);
+  } else {
+    const AccessorWO<T, DIM> out       = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+    const AccessorRO<uint16_t, DIM> in = derez.unpack_accessor_RO<uint16_t, DIM>(regions[1], rect);
+    map_tile<DIM>(
+      out,
+      in,
+      rect,
+      [](uint16_t value) { return static_cast<T>(bfloat16_to_float(value)); },
+      parallel);
+  }
+}
+
+template <typename T>
+static void convert_task(const Task* task,
+                         const std::vector<PhysicalRegion>& regions,
+                         bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                     \
+  case DIM: {                                            \
+    convert<T, DIM>(task, derez, regions, parallel);     \
+    break;                                               \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+// Rounds the float32 result of a function of float32 values
+template <typename FUNC>
+struct Narrowed {
+  FUNC func;
+  uint16_t operator()(uint16_t value) const
+  {
+    return float_to_bfloat16(func(bfloat16_to_float(value)));
+  }
+};
+
+template <typename FUNC>
+static Narrowed<FUNC> narrowed(FUNC func)
+{
+  return Narrowed<FUNC>{func};
+}
+
+template <int DIM>
+static void unary_ufunc(NumPyOpCode op,
+                        const AccessorWO<uint16_t, DIM>& out,
+                        const AccessorRO<uint16_t, DIM>& in,
+                        const Rect<DIM>& rect,
+                        bool parallel)
+{
+  switch (op) {
+    case NumPyOpCode::NUMPY_NEGATIVE: {
+      // Only the sign bit changes so there is nothing to round
+      map_tile<DIM>(
+        out, in, rect, [](uint16_t value) { return uint16_t(value ^ 0x8000u); }, parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_ABSOLUTE: {
+      map_tile<DIM>(
+        out, in, rect, [](uint16_t value) { return uint16_t(value & 0x7fffu); }, parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_SQRT: {
+      map_tile<DIM>(out, in, rect, narrowed([](float x) { return std::sqrt(x); }), parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_EXP: {
+      map_tile<DIM>(out, in, rect, narrowed([](float x) { return std::exp(x); }), parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_LOG: {
+      map_tile<DIM>(out, in, rect, narrowed([](float x) { return std::log(x); }), parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_TANH: {
+      map_tile<DIM>(out, in, rect, narrowed([](float x) { return std::tanh(x); }), parallel);
+      break;
+    }
+    default: assert(false);
+  }
+}
+
+// Wraps a function of two float32 values so that it works on bfloat16
+// arrays or on a bfloat16 array and a scalar on either side of it
+template <int DIM, typename FUNC>
+static void binary_ufunc(LegateDeserializer& derez,
+                         const std::vector<PhysicalRegion>& regions,
+                         const AccessorWO<uint16_t, DIM>& out,
+                         const AccessorRO<uint16_t, DIM>& in1,
+                         const Rect<DIM>& rect,
+                         FUNC func,
+                         bool parallel)
+{
+  const bool scalar = derez.unpack_bool();
+  if (scalar) {
+    const float value   = derez.unpack_value<float>();
+    const bool reversed = derez.unpack_bool();
+    if (reversed)
+      map_tile<DIM>(
+        out,
+        in1,
+        rect,
+        [=](uint16_t x) { return float_to_bfloat16(func(value, bfloat16_to_float(x))); },
+        parallel);
+    else
+      map_tile<DIM>(
+        out,
+        in1,
+        rect,
+        [=](uint16_t x) { return float_to_bfloat16(func(bfloat16_to_float(x), value)); },
+        parallel);
+  } else {
+    const AccessorRO<uint16_t, DIM> in2 = derez.unpack_accessor_RO<uint16_t, DIM>(regions[2], rect);
+    map_tile<DIM>(
+      out,
+      in1,
+      in2,
+      rect,
+      [=](uint16_t x, uint16_t y) {
+        return float_to_bfloat16(func(bfloat16_to_float(x), bfloat16_to_float(y)));
+      },
+      parallel);
+  }
+}
+
+template <int DIM>
+static void ufunc(const Task* task,
+                  LegateDeserializer& derez,
+                  const std::vector<PhysicalRegion>& regions,
+                  bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const NumPyOpCode op                = static_cast<NumPyOpCode>(derez.unpack_32bit_int());
+  const AccessorWO<uint16_t, DIM> out = derez.unpack_accessor_WO<uint16_t, DIM>(regions[0], rect);
+  const AccessorRO<uint16_t, DIM> in1 = derez.unpack_accessor_RO<uint16_t, DIM>(regions[1], rect);
+  switch (op) {
+    case NumPyOpCode::NUMPY_ADD: {
+      binary_ufunc<DIM>(
+        derez, regions, out, in1, rect, [](float x, float y) { return x + y; }, parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_SUBTRACT: {
+      binary_ufunc<DIM>(
+        derez, regions, out, in1, rect, [](float x, float y) { return x - y; }, parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_MULTIPLY: {
+      binary_ufunc<DIM>(
+        derez, regions, out, in1, rect, [](float x, float y) { return x * y; }, parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_DIVIDE: {
+      binary_ufunc<DIM>(
+        derez, regions, out, in1, rect, [](float x, float y) { return x / y; }, parallel);
+      break;
+    }
+    // NaNs win like they do for numpy.maximum and numpy.minimum
+    case NumPyOpCode::NUMPY_MAXIMUM: {
+      binary_ufunc<DIM>(
+        derez,
+        regions,
+        out,
+        in1,
+        rect,
+        [](float x, float y) { return (std::isnan(x) || x > y) ? x : y; },
+        parallel);
+      break;
+    }
+    case NumPyOpCode::NUMPY_MINIMUM: {
+      binary_ufunc<DIM>(
+        derez,
+        regions,
+        out,
+        in1,
+        rect,
+        [](float x, float y) { return (std::isnan(x) || x < y) ? x : y; },
+        parallel);
+      break;
+    }
+    default: unary_ufunc<DIM>(op, out, in1, rect, parallel);
+  }
+}
+
+static void ufunc_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                               \
+  case DIM: {                                      \
+    ufunc<DIM>(task, derez, regions, parallel);    \
+    break;                                         \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <int DIM>
+static float sum(const Task* task,
+                 LegateDeserializer& derez,
+                 const std::vector<PhysicalRegion>& regions,
+                 bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return SumReduction<float>::identity;
+  const AccessorRO<uint16_t, DIM> in = derez.unpack_accessor_RO<uint16_t, DIM>(regions[0], rect);
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (in.accessor.is_dense_row_major(rect)) {
+    const uint16_t* inptr = in.ptr(rect);
+    return sum_each_index<float>(
+      size_t(0), volume, parallel, [&](size_t idx) { return bfloat16_to_float(inptr[idx]); });
+  }
+  return sum_each_index<float>(size_t(0), volume, parallel, [&](size_t idx) {
+    return bfloat16_to_float(in[pitches.unflatten(idx, rect.lo)]);
+  });
+}
+
+static float sum_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                      \
+  case DIM: {                                             \
+    return sum<DIM>(task, derez, regions, parallel);      \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return SumReduction<float>::identity;
+}
+
+template <typename T>
+/*static*/ void Bfloat16ConvertTask<T>::cpu_variant(const Task* task,
+                                                    const std::vector<PhysicalRegion>& regions,
+                                                    Context ctx,
+                                                    Runtime* runtime)
+{
+  convert_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void Bfloat16ConvertTask<T>::omp_variant(const Task* task,
+                                                    const std::vector<PhysicalRegion>& regions,
+                                                    Context ctx,
+                                                    Runtime* runtime)
+{
+  convert_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ void Bfloat16UfuncTask::cpu_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  ufunc_task(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+/*static*/ void Bfloat16UfuncTask::omp_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  ufunc_task(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ float Bfloat16SumTask::cpu_variant(const Task* task,
+                                              const std::vector<PhysicalRegion>& regions,
+                                              Context ctx,
+                                              Runtime* runtime)
+{
+  return sum_task(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+/*static*/ float Bfloat16SumTask::omp_variant(const Task* task,
+                                              const std::vector<PhysicalRegion>& regions,
+                                              Context ctx,
+                                              Runtime* runtime)
+{
+  return sum_task(task, regions, true /*parallel*/);
+}
+#endif
+
+// Conversions go through float32 so these are all we need
+#define INSTANTIATE_BFLOAT16_TASKS(type, base_id)                              \
+  template <>                                                                  \
+  const int type<float>::TASK_ID = base_id + FLOAT_LT* NUMPY_MAX_VARIANTS;     \
+  template class type<float>;                                                  \
+  template <>                                                                  \
+  const int type<double>::TASK_ID = base_id + DOUBLE_LT* NUMPY_MAX_VARIANTS;   \
+  template class type<double>;
+
+INSTANTIATE_BFLOAT16_TASKS(Bfloat16ConvertTask,
+                           static_cast<int>(NumPyOpCode::NUMPY_BF16_CONVERT) * NUMPY_TYPE_OFFSET)
+
+const int Bfloat16UfuncTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_BF16_UFUNC) * NUMPY_TYPE_OFFSET +
+  UINT16_LT * NUMPY_MAX_VARIANTS;
+const int Bfloat16SumTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_BF16_SUM) * NUMPY_TYPE_OFFSET +
+  UINT16_LT * NUMPY_MAX_VARIANTS;
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  legate::numpy::Bfloat16ConvertTask<float>::register_variants();
+  legate::numpy::Bfloat16ConvertTask<double>::register_variants();
+  legate::numpy::Bfloat16UfuncTask::register_variants();
+  legate::numpy::Bfloat16SumTask::register_variants_with_return<
+    float,
+    legate::numpy::DeferredReduction<legate::numpy::SumReduction<float>>>();
+}
+}  // namespace
@@ -0,0 +1,111 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_BFLOAT16_H__
+#define __NUMPY_BFLOAT16_H__
+
+#include "numpy.h"
+#include <cstring>
+
+// bfloat16 values are the upper 16 bits of a float32. Neither NumPy nor
+// the Legate type system know about them, so they are stored in uint16
+// fields and every task here widens them to float32 in registers, does
+// its math there and rounds back to the nearest even bfloat16.
+
+namespace legate {
+namespace numpy {
+
+__CUDA_HD__ inline float bfloat16_to_float(uint16_t value)
+{
+  const uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+__CUDA_HD__ inline uint16_t float_to_bfloat16(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  // Keep NaNs quiet so rounding can never turn them into infinities
+  if ((bits & 0x7fffffffu) > 0x7f800000u) return static_cast<uint16_t>((bits >> 16) | 0x0040u);
+  bits += 0x7fffu + ((bits >> 16) & 1u);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+// Converts between bfloat16 and T in either direction
+template <typename T>
+class Bfloat16ConvertTask : public NumPyTask<Bfloat16ConvertTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Applies the unary or binary ufunc given by its NumPyOpCode. The second
+// operand of a binary ufunc is either another array or a float32 scalar.
+class Bfloat16UfuncTask : public NumPyTask<Bfloat16UfuncTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Sums a tile into a float32 accumulator
+class Bfloat16SumTask : public NumPyTask<Bfloat16SumTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static float cpu_variant(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           Legion::Context ctx,
+                           Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static float omp_variant(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           Legion::Context ctx,
+                           Legion::Runtime* runtime);
+#endif
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_BFLOAT16_H__
@@ -0,0 +1,336 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "bitmask.h"
+#include "point_task.h"
+#include "proj.h"
+#include <algorithm>
+#include <functional>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+namespace {
+
+const coord_t BITS_PER_WORD = 64;
+
+// The elements covered by a tile of words, which stops short of 64 for
+// every word in the last one
+Rect<1> element_rect(const Rect<1>& words, uint64_t size)
+{
+  return Rect<1>(words.lo[0] * BITS_PER_WORD,
+                 std::min((words.hi[0] + 1) * BITS_PER_WORD, static_cast<coord_t>(size)) - 1);
+}
+
+// Builds the word for each element of the rhs, which is either an array
+// or a scalar. The shifts leave no branches in the inner loop so it can
+// be vectorized.
+template <typename T, typename CMP, typename RHS>
+void pack_words(const AccessorWO<uint64_t, 1>& out,
+                const Rect<1>& words,
+                uint64_t size,
+                const AccessorRO<T, 1>& in,
+                const RHS& rhs,
+                CMP cmp,
+                bool parallel)
+{
+  const coord_t lo   = words.lo[0], hi = words.hi[0];
+  const coord_t last = static_cast<coord_t>(size);
+  for_each_index(lo, hi + 1, parallel, [&](coord_t w) {
+    const coord_t first = w * BITS_PER_WORD;
+    const coord_t stop  = std::min(first + BITS_PER_WORD, last);
+    uint64_t word       = 0;
+    for (coord_t x = first; x < stop; x++)
+      word |= static_cast<uint64_t>(cmp(in[x], rhs(x))) << (x - first);
+    out[w] = word;
+  });
+}
+
+template <typename T, typename CMP>
+void pack_words(const Task* task,
+                LegateDeserializer& derez,
+                const std::vector<PhysicalRegion>& regions,
+                const AccessorWO<uint64_t, 1>& out,
+                const Rect<1>& words,
+                uint64_t size,
+                CMP cmp,
+                bool parallel)
+{
+  const Rect<1> rect         = element_rect(words, size);
+  const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
+  const bool scalar          = derez.unpack_bool();
+  if (scalar) {
+    const T value = derez.unpack_value<T>();
+    pack_words<T>(out, words, size, in1, [=](coord_t) { return value; }, cmp, parallel);
+  } else {
+    const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
+    pack_words<T>(out, words, size, in1, [&](coord_t x) { return in2[x]; }, cmp, parallel);
+  }
+}
+
+template <typename T>
+void pack_bits(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> words = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (words.empty()) return;
+  const AccessorWO<uint64_t, 1> out = derez.unpack_accessor_WO<uint64_t, 1>(regions[0], words);
+  const uint64_t size               = derez.unpack_value<uint64_t>();
+  const NumPyOpCode op              = static_cast<NumPyOpCode>(derez.unpack_32bit_int());
+  switch (op) {
+    case NumPyOpCode::NUMPY_EQUAL:
+      pack_words<T>(task, derez, regions, out, words, size, std::equal_to<T>(), parallel);
+      break;
+    case NumPyOpCode::NUMPY_NOT_EQUAL:
+      pack_words<T>(task, derez, regions, out, words, size, std::not_equal_to<T>(), parallel);
+      break;
+    case NumPyOpCode::NUMPY_LESS:
+      pack_words<T>(task, derez, regions, out, words, size, std::less<T>(), parallel);
+      break;
+    case NumPyOpCode::NUMPY_LESS_EQUAL:
+      pack_words<T>(task, derez, regions, out, words, size, std::less_equal<T>(), parallel);
+      break;
+    case NumPyOpCode::NUMPY_GREATER:
+      pack_words<T>(task, derez, regions, out, words, size, std::greater<T>(), parallel);
+      break;
+    case NumPyOpCode::NUMPY_GREATER_EQUAL:
+      pack_words<T>(task, derez, regions, out, words, size, std::greater_equal<T>(), parallel);
+      break;
+    default: assert(false);
+  }
+}
+
+void unpack_bits(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> words = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (words.empty()) return;
+  const AccessorRO<uint64_t, 1> in = derez.unpack_accessor_RO<uint64_t, 1>(regions[0], words);
+  const uint64_t size              = derez.unpack_value<uint64_t>();
+  const Rect<1> rect               = element_rect(words, size);
+  const AccessorWO<bool, 1> out    = derez.unpack_accessor_WO<bool, 1>(regions[1], rect);
+  const coord_t lo                 = rect.lo[0], hi = rect.hi[0];
+  for_each_index(lo, hi + 1, parallel, [&](coord_t x) {
+    out[x] = (in[x / BITS_PER_WORD] >> (x % BITS_PER_WORD)) & 1;
+  });
+}
+
+void bitmask_logical(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> words = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (words.empty()) return;
+  const AccessorWO<uint64_t, 1> out = derez.unpack_accessor_WO<uint64_t, 1>(regions[0], words);
+  const uint64_t size               = derez.unpack_value<uint64_t>();
+  const NumPyOpCode op              = static_cast<NumPyOpCode>(derez.unpack_32bit_int());
+  const AccessorRO<uint64_t, 1> in1 = derez.unpack_accessor_RO<uint64_t, 1>(regions[1], words);
+  const coord_t lo                  = words.lo[0], hi = words.hi[0];
+  if (op == NumPyOpCode::NUMPY_LOGICAL_NOT) {
+    // Keep the bits past the end of the mask clear, including any words
+    // that are there only to pad out the mask
+    const coord_t last  = static_cast<coord_t>((size - 1) / BITS_PER_WORD);
+    const unsigned tail = size % BITS_PER_WORD;
+    const uint64_t mask = (tail == 0) ? ~uint64_t(0) : (uint64_t(1) << tail) - 1;
+    for_each_index(lo, hi + 1, parallel, [&](coord_t w) {
+      out[w] = (w < last) ? ~in1[w] : (w == last) ? (~in1[w] & mask) : 0;
+    });
+    return;
+  }
+  const AccessorRO<uint64_t, 1> in2 = derez.unpack_accessor_RO<uint64_t, 1>(regions[2], words);
+  switch (op) {
+    case NumPyOpCode::NUMPY_LOGICAL_AND: {
+      for_each_index(lo, hi + 1, parallel, [&](coord_t w) { out[w] = in1[w] & in2[w]; });
+      break;
+    }
+    case NumPyOpCode::NUMPY_LOGICAL_OR: {
+      for_each_index(lo, hi + 1, parallel, [&](coord_t w) { out[w] = in1[w] | in2[w]; });
+      break;
+    }
+    case NumPyOpCode::NUMPY_LOGICAL_XOR: {
+      for_each_index(lo, hi + 1, parallel, [&](coord_t w) { out[w] = in1[w] ^ in2[w]; });
+      break;
+    }
+    default: assert(false);
+  }
+}
+
+uint64_t bitmask_count(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> words = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  // Nonzero needs the count of every tile to know where its indices go
+  const bool write_count = derez.unpack_bool();
+  AccessorWO<uint64_t, 1> counts;
+  const Point<1> tile = task->index_point;
+  if (write_count) counts = derez.unpack_accessor_WO<uint64_t, 1>(regions[1], Rect<1>(tile, tile));
+  uint64_t count = 0;
+  if (!words.empty()) {
+    const AccessorRO<uint64_t, 1> in = derez.unpack_accessor_RO<uint64_t, 1>(regions[0], words);
+    const coord_t lo                 = words.lo[0], hi = words.hi[0];
+    // The bits past the end of the mask are always clear so whole words count
+    count = sum_each_index<uint64_t>(lo, hi + 1, parallel, [&](coord_t w) -> uint64_t {
+      return __builtin_popcountll(in[w]);
+    });
+  }
+  if (write_count) counts[tile] = count;
+  return count;
+}
+
+}  // namespace
+
+template <typename T>
+/*static*/ void PackBitsTask<T>::cpu_variant(const Task* task,
+                                             const std::vector<PhysicalRegion>& regions,
+                                             Context ctx,
+                                             Runtime* runtime)
+{
+  pack_bits<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void PackBitsTask<T>::omp_variant(const Task* task,
+                                             const std::vector<PhysicalRegion>& regions,
+                                             Context ctx,
+                                             Runtime* runtime)
+{
+  pack_bits<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ void UnpackBitsTask::cpu_variant(const Task* task,
+                                            const std::vector<PhysicalRegion>& regions,
+                                            Context ctx,
+                                            Runtime* runtime)
+{
+  unpack_bits(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+/*static*/ void UnpackBitsTask::omp_variant(const Task* task,
+                                            const std::vector<PhysicalRegion>& regions,
+                                            Context ctx,
+                                            Runtime* runtime)
+{
+  unpack_bits(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ void BitmaskLogicalTask::cpu_variant(const Task* task,
+                                                const std::vector<PhysicalRegion>& regions,
+                                                Context ctx,
+                                                Runtime* runtime)
+{
+  bitmask_logical(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+/*static*/ void BitmaskLogicalTask::omp_variant(const Task* task,
+                                                const std::vector<PhysicalRegion>& regions,
+                                                Context ctx,
+                                                Runtime* runtime)
+{
+  bitmask_logical(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ uint64_t BitmaskCountTask::cpu_variant(const Task* task,
+                                                  const std::vector<PhysicalRegion>& regions,
+                                                  Context ctx,
+                                                  Runtime* runtime)
+{
+  return bitmask_count(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+/*static*/ uint64_t BitmaskCountTask::omp_variant(const Task* task,
+                                                  const std::vector<PhysicalRegion>& regions,
+                                                  Context ctx,
+                                                  Runtime* runtime)
+{
+  return bitmask_count(task, regions, true /*parallel*/);
+}
+#endif
+
+/*static*/ void BitmaskNonzeroTask::cpu_variant(const Task* task,
+                                                const std::vector<PhysicalRegion>& regions,
+                                                Context ctx,
+                                                Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> words = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (words.empty()) return;
+  const AccessorRO<uint64_t, 1> in = derez.unpack_accessor_RO<uint64_t, 1>(regions[0], words);
+  // The output was partitioned by the counts so it has exactly one entry
+  // for every bit that is set in our words
+  const Rect<2> out_rect = regions[1];
+  if (out_rect.empty()) return;
+  const AccessorWO<uint64_t, 2> out = derez.unpack_accessor_WO<uint64_t, 2>(regions[1], out_rect);
+  coord_t current_out               = out_rect.lo[1];
+  for (coord_t w = words.lo[0]; w <= words.hi[0]; w++) {
+    // Jump straight from one set bit to the next
+    uint64_t word = in[w];
+    while (word != 0) {
+      out[out_rect.lo[0]][current_out++] = w * BITS_PER_WORD + __builtin_ctzll(word);
+      word &= word - 1;
+    }
+  }
+}
+
+INSTANTIATE_NONCOMPLEX_TASKS(PackBitsTask,
+                             static_cast<int>(NumPyOpCode::NUMPY_PACK_BITS) * NUMPY_TYPE_OFFSET)
+
+const int UnpackBitsTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_UNPACK_BITS) * NUMPY_TYPE_OFFSET +
+  UINT64_LT * NUMPY_MAX_VARIANTS;
+const int BitmaskLogicalTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_BITMASK_LOGICAL) * NUMPY_TYPE_OFFSET +
+  UINT64_LT * NUMPY_MAX_VARIANTS;
+const int BitmaskCountTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_BITMASK_COUNT) * NUMPY_TYPE_OFFSET +
+  UINT64_LT * NUMPY_MAX_VARIANTS;
+const int BitmaskNonzeroTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_BITMASK_NONZERO) * NUMPY_TYPE_OFFSET +
+  UINT64_LT * NUMPY_MAX_VARIANTS;
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_NONCOMPLEX_TASKS(legate::numpy::PackBitsTask)
+  legate::numpy::UnpackBitsTask::register_variants();
+  legate::numpy::BitmaskLogicalTask::register_variants();
+  legate::numpy::BitmaskCountTask::register_variants_with_return<
+    uint64_t,
+    legate::numpy::DeferredReduction<legate::numpy::SumReduction<uint64_t>>>();
+  legate::numpy::BitmaskNonzeroTask::register_variants();
+}
+}  // namespace
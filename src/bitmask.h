@@ -0,0 +1,130 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_BITMASK_H__
+#define __NUMPY_BITMASK_H__
+
+#include "numpy.h"
+
+// Bitmasks keep one bit for every element of a flattened boolean array
+// in 64-bit words: element i lives in bit i % 64 of word i / 64 and the
+// bits past the last element are always zero, even in whole words that
+// are only there for padding. A tile of words always covers 64 times as
+// many elements, so every task here partitions the words and lines up
+// the element tiles with them.
+
+namespace legate {
+namespace numpy {
+
+// Compares every element of an array with either the elements of another
+// array or a scalar and sets the bit of each element for which it holds.
+// The comparison is passed as the NumPyOpCode of the ufunc.
+template <typename T>
+class PackBitsTask : public NumPyTask<PackBitsTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Expands the bits of a bitmask back into an array of bools
+class UnpackBitsTask : public NumPyTask<UnpackBitsTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Combines the words of one or two bitmasks with the logical operation
+// given by its NumPyOpCode
+class BitmaskLogicalTask : public NumPyTask<BitmaskLogicalTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Counts the set bits in a tile of words. The count is returned and can
+// also be written into the entry for the tile in an array of counts.
+class BitmaskCountTask : public NumPyTask<BitmaskCountTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static uint64_t cpu_variant(const Legion::Task* task,
+                              const std::vector<Legion::PhysicalRegion>& regions,
+                              Legion::Context ctx,
+                              Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static uint64_t omp_variant(const Legion::Task* task,
+                              const std::vector<Legion::PhysicalRegion>& regions,
+                              Legion::Context ctx,
+                              Legion::Runtime* runtime);
+#endif
+};
+
+// Writes the flattened indices of the set bits in a tile of words into
+// the range of the output that was made for the tile from the counts
+class BitmaskNonzeroTask : public NumPyTask<BitmaskNonzeroTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_BITMASK_H__
@@ -0,0 +1,415 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "checkpoint.h"
+#include "file_io.h"
+#include "proj.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+namespace {
+
+// The header at the start of every tile file
+struct TileHeader {
+  char magic[4];
+  uint32_t codec;
+  uint64_t raw_bytes;
+  uint64_t stored_bytes;
+};
+static_assert(sizeof(TileHeader) == 24, "tile headers must not have any padding");
+
+const char tile_magic[4] = {'L', 'G', 'C', 'K'};
+
+// Puts the same byte of every element next to each other, which turns
+// the slowly changing exponents and high order bytes of numbers into long
+// runs that compress well
+void byte_shuffle(const uint8_t* in, uint8_t* out, size_t elements, size_t itemsize)
+{
+  for (size_t b = 0; b < itemsize; b++)
+    for (size_t idx = 0; idx < elements; idx++) out[b * elements + idx] = in[idx * itemsize + b];
+}
+
+void byte_unshuffle(const uint8_t* in, uint8_t* out, size_t elements, size_t itemsize)
+{
+  for (size_t b = 0; b < itemsize; b++)
+    for (size_t idx = 0; idx < elements; idx++) out[idx * itemsize + b] = in[b * elements + idx];
+}
+
+inline uint32_t load32(const uint8_t* ptr)
+{
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+// Appends a length that did not fit in its four bits of the token
+inline bool put_length(uint8_t* out, size_t& pos, size_t capacity, size_t length)
+{
+  for (; length >= 255; length -= 255) {
+    if (pos == capacity) return false;
+    out[pos++] = 255;
+  }
+  if (pos == capacity) return false;
+  out[pos++] = length;
+  return true;
+}
+
+inline bool get_length(const uint8_t* in, size_t& pos, size_t size, size_t& length)
+{
+  uint8_t byte;
+  do {
+    if (pos == size) return false;
+    byte = in[pos++];
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Writes one sequence of the LZ4 block format: a token with the lengths
+// of the literals and of the match, the literals, and then the offset of
+// the match, which the last sequence of a block does not have
+bool put_sequence(const uint8_t* literals,
+                  size_t literal_length,
+                  size_t offset,
+                  size_t match_length,
+                  uint8_t* out,
+                  size_t& pos,
+                  size_t capacity)
+{
+  const size_t match_code = (offset > 0) ? match_length - 4 : 0;
+  if (pos == capacity) return false;
+  out[pos++] = (std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15);
+  if ((literal_length >= 15) && !put_length(out, pos, capacity, literal_length - 15)) return false;
+  if (literal_length > (capacity - pos)) return false;
+  memcpy(out + pos, literals, literal_length);
+  pos += literal_length;
+  if (offset == 0) return true;
+  if ((capacity - pos) < 2) return false;
+  out[pos++] = offset & 0xFF;
+  out[pos++] = offset >> 8;
+  return (match_code < 15) || put_length(out, pos, capacity, match_code - 15);
+}
+
+// Greedy LZ compression with a single hash table of recent positions.
+// Returns the compressed size or zero when it would not be smaller.
+size_t lz_compress(const uint8_t* in, size_t size, uint8_t* out, size_t capacity)
+{
+  const int hash_bits = 16;
+  std::vector<size_t> table(1 << hash_bits, SIZE_MAX);
+  size_t pos = 0, anchor = 0, written = 0;
+  // Like LZ4 we keep matches away from the end of the block
+  const size_t limit = (size > 12) ? size - 12 : 0;
+  while (pos < limit) {
+    const uint32_t sequence = load32(in + pos);
+    const uint32_t hash     = (sequence * 2654435761U) >> (32 - hash_bits);
+    const size_t match      = table[hash];
+    table[hash]             = pos;
+    if ((match == SIZE_MAX) || ((pos - match) > 65535) || (load32(in + match) != sequence)) {
+      pos++;
+      continue;
+    }
+    size_t length          = 4;
+    const size_t max_match = size - 5 - pos;
+    while ((length < max_match) && (in[match + length] == in[pos + length])) length++;
+    if (!put_sequence(in + anchor, pos - anchor, pos - match, length, out, written, capacity))
+      return 0;
+    pos += length;
+    anchor = pos;
+  }
+  if (!put_sequence(in + anchor, size - anchor, 0, 0, out, written, capacity)) return 0;
+  return (written < size) ? written : 0;
+}
+
+bool lz_decompress(const uint8_t* in, size_t size, uint8_t* out, size_t out_size)
+{
+  size_t pos = 0, written = 0;
+  while (pos < size) {
+    const uint8_t token   = in[pos++];
+    size_t literal_length = token >> 4;
+    if ((literal_length == 15) && !get_length(in, pos, size, literal_length)) return false;
+    if ((literal_length > (size - pos)) || (literal_length > (out_size - written))) return false;
+    memcpy(out + written, in + pos, literal_length);
+    pos += literal_length;
+    written += literal_length;
+    // The last sequence only has literals
+    if (pos == size) break;
+    if ((size - pos) < 2) return false;
+    const size_t offset = in[pos] | (in[pos + 1] << 8);
+    pos += 2;
+    size_t match_length = token & 15;
+    if ((match_length == 15) && !get_length(in, pos, size, match_length)) return false;
+    match_length += 4;
+    if ((offset == 0) || (offset > written) || (match_length > (out_size - written)))
+      return false;
+    // Matches can overlap what they produce so copy one byte at a time
+    for (size_t idx = 0; idx < match_length; idx++, written++) out[written] = out[written - offset];
+  }
+  return (written == out_size);
+}
+
+template <int DIM>
+std::string tile_path(const char* prefix, const Point<DIM>& color)
+{
+  std::string path = std::string(prefix) + ".";
+  for (int d = 0; d < DIM; d++) {
+    if (d > 0) path += "_";
+    path += std::to_string(color[d]);
+  }
+  return path;
+}
+
+// The part of the array that the tile of a color covers
+template <int DIM>
+Rect<DIM> tile_rect(const Point<DIM>& color,
+                    const Point<DIM>& tile,
+                    const Point<DIM>& origin,
+                    const Point<DIM>& extents)
+{
+  const Point<DIM> lo = color * tile + origin;
+  const Rect<DIM> bounds(Point<DIM>::ZEROES(), extents - Point<DIM>::ONES());
+  return bounds.intersection(Rect<DIM>(lo, lo + tile - Point<DIM>::ONES()));
+}
+
+void write_tile(
+  const std::string& path, const void* data, size_t bytes, size_t itemsize, bool compress)
+{
+  TileHeader header;
+  memcpy(header.magic, tile_magic, sizeof(tile_magic));
+  header.codec        = CHECKPOINT_CODEC_NONE;
+  header.raw_bytes    = bytes;
+  header.stored_bytes = bytes;
+  const void* payload = data;
+  std::vector<uint8_t> shuffled, packed;
+  if (compress && (bytes > 0)) {
+    const uint8_t* raw = static_cast<const uint8_t*>(data);
+    if (itemsize > 1) {
+      shuffled.resize(bytes);
+      byte_shuffle(raw, shuffled.data(), bytes / itemsize, itemsize);
+      raw = shuffled.data();
+    }
+    packed.resize(bytes);
+    const size_t size = lz_compress(raw, bytes, packed.data(), packed.size());
+    // Keep the tile as it is if it does not get any smaller
+    if (size > 0) {
+      header.codec        = CHECKPOINT_CODEC_SHUFFLE_LZ;
+      header.stored_bytes = size;
+      payload             = packed.data();
+    }
+  }
+  const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    log_numpy_io.error("Unable to open %s for writing: %s", path.c_str(), strerror(errno));
+    LEGATE_ABORT
+  }
+  if (!write_fully(fd, &header, sizeof(header), 0) ||
+      !write_fully(fd, payload, header.stored_bytes, sizeof(header))) {
+    log_numpy_io.error("Unable to write to %s: %s", path.c_str(), strerror(errno));
+    LEGATE_ABORT
+  }
+  // The manifest is written after every tile task is done and names the
+  // tiles as valid, so the tiles and their directory entries have to be
+  // on disk before that
+  if (fsync(fd) != 0) {
+    log_numpy_io.error("Unable to sync %s: %s", path.c_str(), strerror(errno));
+    LEGATE_ABORT
+  }
+  close(fd);
+  const size_t slash    = path.rfind('/');
+  const std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+  const int dir_fd      = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if ((dir_fd < 0) || (fsync(dir_fd) != 0)) {
+    log_numpy_io.error("Unable to sync %s: %s", dir.c_str(), strerror(errno));
+    LEGATE_ABORT
+  }
+  close(dir_fd);
+}
+
+void read_tile(const std::string& path, void* data, size_t bytes, size_t itemsize)
+{
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    log_numpy_io.error("Unable to open %s for reading: %s", path.c_str(), strerror(errno));
+    LEGATE_ABORT
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  TileHeader header;
+  if (!read_fully(fd, &header, sizeof(header), 0) ||
+      (memcmp(header.magic, tile_magic, sizeof(tile_magic)) != 0) ||
+      (header.raw_bytes != bytes)) {
+    log_numpy_io.error("%s is not a tile of this checkpoint", path.c_str());
+    LEGATE_ABORT
+  }
+  bool valid = true;
+  switch (header.codec) {
+    case CHECKPOINT_CODEC_NONE: {
+      valid = (header.stored_bytes == bytes) && read_fully(fd, data, bytes, sizeof(header));
+      break;
+    }
+    case CHECKPOINT_CODEC_SHUFFLE_LZ: {
+      std::vector<uint8_t> packed(header.stored_bytes);
+      valid = read_fully(fd, packed.data(), packed.size(), sizeof(header));
+      if (itemsize > 1) {
+        std::vector<uint8_t> shuffled(bytes);
+        valid = valid && lz_decompress(packed.data(), packed.size(), shuffled.data(), bytes);
+        if (valid)
+          byte_unshuffle(shuffled.data(), static_cast<uint8_t*>(data), bytes / itemsize, itemsize);
+      } else
+        valid = valid && lz_decompress(
+                           packed.data(), packed.size(), static_cast<uint8_t*>(data), bytes);
+      break;
+    }
+    default: valid = false;
+  }
+  if (!valid) {
+    log_numpy_io.error("Unable to read the tile in %s", path.c_str());
+    LEGATE_ABORT
+  }
+  close(fd);
+}
+
+}  // namespace
+
+template <typename T, int DIM>
+static void checkpoint(const Task* task,
+                       LegateDeserializer& derez,
+                       const std::vector<PhysicalRegion>& regions)
+{
+  // Our tile is the one of the key partition for our point, which has an
+  // origin of its own for views, rather than the one of the shape
+  NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const Point<DIM> extents    = derez.unpack_point<DIM>();
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[0]);
+  const bool compress         = derez.unpack_bool();
+  const Point<DIM> tile       = derez.unpack_point<DIM>();
+  const Point<DIM> origin     = derez.unpack_point<DIM>();
+  const char* prefix          = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  const Point<DIM> color =
+    task->is_index_space ? Point<DIM>(task->index_point) : Point<DIM>::ZEROES();
+  const Rect<DIM> rect = tile_rect(color, tile, origin, extents);
+  if (rect.empty()) return;
+  // Gather the tile in C order whatever the layout of the instance
+  std::vector<T> values(rect.volume());
+  size_t idx = 0;
+  for (PointInRectIterator<DIM> itr(rect, false /*column major*/); itr(); itr++)
+    values[idx++] = in[*itr];
+  write_tile(
+    tile_path(prefix, color), values.data(), values.size() * sizeof(T), sizeof(T), compress);
+}
+
+template <typename T>
+/*static*/ void CheckpointTask<T>::cpu_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                          \
+  case DIM: {                                 \
+    checkpoint<T, DIM>(task, derez, regions); \
+    break;                                    \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T, int DIM>
+static void restore(const Task* task,
+                    LegateDeserializer& derez,
+                    const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect     = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const Point<DIM> extents = derez.unpack_point<DIM>();
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const Point<DIM> tile        = derez.unpack_point<DIM>();
+  const Point<DIM> origin      = derez.unpack_point<DIM>();
+  const char* prefix           = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  // Walk the saved tiles that overlap ours and copy in the common parts
+  Rect<DIM> colors;
+  for (int d = 0; d < DIM; d++) {
+    colors.lo[d] = (rect.lo[d] - origin[d]) / tile[d];
+    colors.hi[d] = (rect.hi[d] - origin[d]) / tile[d];
+  }
+  std::vector<T> values;
+  for (PointInRectIterator<DIM> color(colors, false /*column major*/); color(); color++) {
+    const Rect<DIM> saved = tile_rect(*color, tile, origin, extents);
+    values.resize(saved.volume());
+    read_tile(tile_path(prefix, *color), values.data(), values.size() * sizeof(T), sizeof(T));
+    size_t pitch[DIM];
+    size_t stride = 1;
+    for (int d = DIM - 1; d >= 0; d--) {
+      pitch[d] = stride;
+      stride *= saved.hi[d] - saved.lo[d] + 1;
+    }
+    const Rect<DIM> overlap = rect.intersection(saved);
+    for (PointInRectIterator<DIM> itr(overlap, false /*column major*/); itr(); itr++) {
+      size_t idx = 0;
+      for (int d = 0; d < DIM; d++) idx += ((*itr)[d] - saved.lo[d]) * pitch[d];
+      out[*itr] = values[idx];
+    }
+  }
+}
+
+template <typename T>
+/*static*/ void RestoreTask<T>::cpu_variant(const Task* task,
+                                            const std::vector<PhysicalRegion>& regions,
+                                            Context ctx,
+                                            Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                       \
+  case DIM: {                              \
+    restore<T, DIM>(task, derez, regions); \
+    break;                                 \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+INSTANTIATE_ALL_TASKS(CheckpointTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_CHECKPOINT) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(RestoreTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_RESTORE) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_ALL_TASKS(legate::numpy::CheckpointTask)
+  REGISTER_ALL_TASKS(legate::numpy::RestoreTask)
+}
+}  // namespace
@@ -0,0 +1,74 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_CHECKPOINT_H__
+#define __NUMPY_CHECKPOINT_H__
+
+#include "numpy.h"
+
+// Checkpoints store every tile of an array in its own file named after
+// the path prefix and the color of the tile, such as prefix.2_0 for the
+// tile at color (2, 0). Each file starts with a small header that says
+// how the elements of the tile, in C order, are encoded after it. The
+// tiles are a regular grid whose first tile starts at the given origin,
+// which is at or before zero for views, so a restore can pull its own
+// tiles together from the saved ones whatever they look like.
+
+namespace legate {
+namespace numpy {
+
+enum CheckpointCodec {
+  CHECKPOINT_CODEC_NONE = 0,
+  // Byte shuffle followed by LZ4-style block compression
+  CHECKPOINT_CODEC_SHUFFLE_LZ = 1,
+};
+
+// Writes the tiles of an array. The path prefix is passed in the first
+// future and the arguments say whether to try to compress the tiles and
+// give the shape and origin of the tiles.
+template <typename T>
+class CheckpointTask : public NumPyTask<CheckpointTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+// Fills the tiles of an array from the saved tiles that overlap them.
+// The path prefix is passed in the first future and the shape and origin
+// of the saved tiles in the arguments.
+template <typename T>
+class RestoreTask : public NumPyTask<RestoreTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_CHECKPOINT_H__
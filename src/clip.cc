@@ -45,6 +45,32 @@ template class ClipInplace<bool>;
 template class ClipInplace<complex<float>>;
 template class ClipInplace<complex<double>>;
 
+template class ClipBroadcast<__half>;
+template class ClipBroadcast<float>;
+template class ClipBroadcast<double>;
+template class ClipBroadcast<int16_t>;
+template class ClipBroadcast<int32_t>;
+template class ClipBroadcast<int64_t>;
+template class ClipBroadcast<uint16_t>;
+template class ClipBroadcast<uint32_t>;
+template class ClipBroadcast<uint64_t>;
+template class ClipBroadcast<bool>;
+template class ClipBroadcast<complex<float>>;
+template class ClipBroadcast<complex<double>>;
+
+template class ClipInplaceBroadcast<__half>;
+template class ClipInplaceBroadcast<float>;
+template class ClipInplaceBroadcast<double>;
+template class ClipInplaceBroadcast<int16_t>;
+template class ClipInplaceBroadcast<int32_t>;
+template class ClipInplaceBroadcast<int64_t>;
+template class ClipInplaceBroadcast<uint16_t>;
+template class ClipInplaceBroadcast<uint32_t>;
+template class ClipInplaceBroadcast<uint64_t>;
+template class ClipInplaceBroadcast<bool>;
+template class ClipInplaceBroadcast<complex<float>>;
+template class ClipInplaceBroadcast<complex<double>>;
+
 template class ClipScalar<__half>;
 template class ClipScalar<float>;
 template class ClipScalar<double>;
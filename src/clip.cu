@@ -115,5 +115,77 @@ template void PointTask<ClipInplace<complex<float>>>::gpu_variant(
 template void PointTask<ClipInplace<complex<double>>>::gpu_variant(
   const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
 
+template void PointTask<ClipBroadcast<__half>>::gpu_variant(const Task*,
+                                                            const std::vector<PhysicalRegion>&,
+                                                            Context,
+                                                            Runtime*);
+template void PointTask<ClipBroadcast<float>>::gpu_variant(const Task*,
+                                                           const std::vector<PhysicalRegion>&,
+                                                           Context,
+                                                           Runtime*);
+template void PointTask<ClipBroadcast<double>>::gpu_variant(const Task*,
+                                                            const std::vector<PhysicalRegion>&,
+                                                            Context,
+                                                            Runtime*);
+template void PointTask<ClipBroadcast<int16_t>>::gpu_variant(const Task*,
+                                                             const std::vector<PhysicalRegion>&,
+                                                             Context,
+                                                             Runtime*);
+template void PointTask<ClipBroadcast<int32_t>>::gpu_variant(const Task*,
+                                                             const std::vector<PhysicalRegion>&,
+                                                             Context,
+                                                             Runtime*);
+template void PointTask<ClipBroadcast<int64_t>>::gpu_variant(const Task*,
+                                                             const std::vector<PhysicalRegion>&,
+                                                             Context,
+                                                             Runtime*);
+template void PointTask<ClipBroadcast<uint16_t>>::gpu_variant(const Task*,
+                                                              const std::vector<PhysicalRegion>&,
+                                                              Context,
+                                                              Runtime*);
+template void PointTask<ClipBroadcast<uint32_t>>::gpu_variant(const Task*,
+                                                              const std::vector<PhysicalRegion>&,
+                                                              Context,
+                                                              Runtime*);
+template void PointTask<ClipBroadcast<uint64_t>>::gpu_variant(const Task*,
+                                                              const std::vector<PhysicalRegion>&,
+                                                              Context,
+                                                              Runtime*);
+template void PointTask<ClipBroadcast<bool>>::gpu_variant(const Task*,
+                                                          const std::vector<PhysicalRegion>&,
+                                                          Context,
+                                                          Runtime*);
+template void PointTask<ClipBroadcast<complex<float>>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipBroadcast<complex<double>>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+
+template void PointTask<ClipInplaceBroadcast<__half>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<float>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<double>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<int16_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<int32_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<int64_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<uint16_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<uint32_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<uint64_t>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<bool>>::gpu_variant(const Task*,
+                                                                 const std::vector<PhysicalRegion>&,
+                                                                 Context,
+                                                                 Runtime*);
+template void PointTask<ClipInplaceBroadcast<complex<float>>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+template void PointTask<ClipInplaceBroadcast<complex<double>>>::gpu_variant(
+  const Task*, const std::vector<PhysicalRegion>&, Context, Runtime*);
+
 }  // namespace numpy
 }  // namespace legate
@@ -26,12 +26,24 @@ struct ClipOperation {
   using argument_type           = T;
   constexpr static auto op_code = NumPyOpCode::NUMPY_CLIP;
 
+  // Two independent selects instead of nested branches, so that dense
+  // loops compile to vector max and min instructions. Like NumPy, max
+  // wins when the bounds cross.
   __CUDA_HD__ constexpr T operator()(const T& a, const T min, const T max) const
   {
-    return (a < min) ? min : (a > max) ? max : a;
+    const T lo = (a < min) ? min : a;
+    return (lo > max) ? max : lo;
   }
 };
 
+template <typename T, int N, typename F>
+inline void with_clip_bounds(const ScalarOrRegion<T, N>& min,
+                             const ScalarOrRegion<T, N>& max,
+                             F&& fn)
+{
+  with_operand(min, [&](auto lo) { with_operand(max, [&](auto hi) { fn(lo, hi); }); });
+}
+
 #if defined(LEGATE_USE_CUDA) && defined(__CUDACC__)
 template <int DIM, typename T, typename Args>
 __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM) gpu_clip(const Args args)
@@ -53,6 +65,36 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   ClipOperation<T> func;
   args.inout[point] = func(args.inout[point], args.min, args.max);
 }
+
+template <int DIM, typename T, typename Args, typename Min, typename Max>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  gpu_clip_broadcast(const Args args, const Min min, const Max max, const bool dense)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= args.volume) return;
+  ClipOperation<T> func;
+  if (dense) {
+    args.outptr[idx] = func(args.inptr[idx], min[idx], max[idx]);
+  } else {
+    const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+    args.out[point]                = func(args.in[point], min[point], max[point]);
+  }
+}
+
+template <int DIM, typename T, typename Args, typename Min, typename Max>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  gpu_clip_inplace_broadcast(const Args args, const Min min, const Max max, const bool dense)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= args.volume) return;
+  ClipOperation<T> func;
+  if (dense) {
+    args.inoutptr[idx] = func(args.inoutptr[idx], min[idx], max[idx]);
+  } else {
+    const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+    args.inout[point]              = func(args.inout[point], min[point], max[point]);
+  }
+}
 #endif
 
 // Clip is like a unary operation but with some state for its operator
@@ -256,6 +298,241 @@ class ClipInplace : public PointTask<ClipInplace<T>> {
 #endif
 };
 
+// Clip with bounds that are arrays, broadcast against the input
+template <typename T>
+class ClipBroadcast : public PointTask<ClipBroadcast<T>> {
+ private:
+  using argument_type = typename ClipOperation<T>::argument_type;
+  using result_type   = typename ClipOperation<T>::argument_type;
+
+ public:
+  static const int TASK_ID =
+    task_id<ClipOperation<T>::op_code, NUMPY_BROADCAST_VARIANT_OFFSET, result_type, argument_type>;
+
+  // out_region = op(in_region, min_region, max_region)
+  static const int REGIONS = 4;
+
+  template <int N>
+  struct DeserializedArgs {
+    Legion::Rect<N> rect;
+    AccessorWO<result_type, N> out;
+    AccessorRO<argument_type, N> in;
+    ScalarOrRegion<argument_type, N> min;
+    ScalarOrRegion<argument_type, N> max;
+    Pitches<N - 1> pitches;
+    size_t volume;
+    result_type* outptr;
+    const argument_type* inptr;
+    bool deserialize(LegateDeserializer& derez,
+                     const Legion::Task* task,
+                     const std::vector<Legion::PhysicalRegion>& regions)
+    {
+      rect                  = NumPyProjectionFunctor::unpack_shape<N>(task, derez);
+      out                   = derez.unpack_accessor_WO<result_type, N>(regions[0], rect);
+      in                    = derez.unpack_accessor_RO<argument_type, N>(regions[1], rect);
+      unsigned region_index = 2;
+      unsigned future_index = 0;
+      min.deserialize(derez, task, regions, rect, region_index, future_index);
+      max.deserialize(derez, task, regions, rect, region_index, future_index);
+      volume = pitches.flatten(rect);
+#ifndef LEGION_BOUNDS_CHECKS
+      // Check to see if this is dense or not
+      return out.accessor.is_dense_row_major(rect) && in.accessor.is_dense_row_major(rect) &&
+             (outptr = out.ptr(rect)) && (inptr = in.ptr(rect));
+#else
+      // No dense execution if we're doing bounds checks
+      return false;
+#endif
+    }
+  };
+
+  template <int DIM>
+  static void dispatch_cpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    ClipOperation<T> func;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      if (dense && min.dense(args.rect) && max.dense(args.rect)) {
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.outptr[idx] = func(args.inptr[idx], min[idx], max[idx]);
+      } else {
+        for (size_t idx = 0; idx < args.volume; ++idx) {
+          const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+          args.out[point]                = func(args.in[point], min[point], max[point]);
+        }
+      }
+    });
+  }
+
+#ifdef LEGATE_USE_OPENMP
+  template <int DIM>
+  static void dispatch_omp(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    ClipOperation<T> func;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      if (dense && min.dense(args.rect) && max.dense(args.rect)) {
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.outptr[idx] = func(args.inptr[idx], min[idx], max[idx]);
+      } else {
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < args.volume; ++idx) {
+          const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+          args.out[point]                = func(args.in[point], min[point], max[point]);
+        }
+      }
+    });
+  }
+#endif
+#if defined(LEGATE_USE_CUDA) && defined(__CUDACC__)
+  template <int DIM>
+  static void dispatch_gpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      const bool all_dense = dense && min.dense(args.rect) && max.dense(args.rect);
+      gpu_clip_broadcast<DIM, T, DeserializedArgs<DIM>>
+        <<<blocks, THREADS_PER_BLOCK>>>(args, min, max, all_dense);
+    });
+  }
+#elif defined(LEGATE_USE_CUDA)
+  template <int DIM>
+  static void dispatch_gpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez);
+#endif
+};
+
+template <typename T>
+class ClipInplaceBroadcast : public PointTask<ClipInplaceBroadcast<T>> {
+ private:
+  using argument_type = typename ClipOperation<T>::argument_type;
+  using result_type   = typename ClipOperation<T>::argument_type;
+
+ public:
+  static const int TASK_ID = task_id<ClipOperation<T>::op_code,
+                                     NUMPY_INPLACE_BROADCAST_VARIANT_OFFSET,
+                                     result_type,
+                                     argument_type>;
+
+  // inout_region = op(inout_region, min_region, max_region)
+  static const int REGIONS = 3;
+
+  template <int N>
+  struct DeserializedArgs {
+    Legion::Rect<N> rect;
+    AccessorRW<result_type, N> inout;
+    ScalarOrRegion<argument_type, N> min;
+    ScalarOrRegion<argument_type, N> max;
+    Pitches<N - 1> pitches;
+    size_t volume;
+    argument_type* inoutptr;
+    bool deserialize(LegateDeserializer& derez,
+                     const Legion::Task* task,
+                     const std::vector<Legion::PhysicalRegion>& regions)
+    {
+      rect                  = NumPyProjectionFunctor::unpack_shape<N>(task, derez);
+      inout                 = derez.unpack_accessor_RW<result_type, N>(regions[0], rect);
+      unsigned region_index = 1;
+      unsigned future_index = 0;
+      min.deserialize(derez, task, regions, rect, region_index, future_index);
+      max.deserialize(derez, task, regions, rect, region_index, future_index);
+      volume = pitches.flatten(rect);
+#ifndef LEGION_BOUNDS_CHECKS
+      // Check to see if this is dense or not
+      return inout.accessor.is_dense_row_major(rect) && (inoutptr = inout.ptr(rect));
+#else
+      // No dense execution if we're doing bounds checks
+      return false;
+#endif
+    }
+  };
+
+  template <int DIM>
+  static void dispatch_cpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    ClipOperation<T> func;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      if (dense && min.dense(args.rect) && max.dense(args.rect)) {
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.inoutptr[idx] = func(args.inoutptr[idx], min[idx], max[idx]);
+      } else {
+        for (size_t idx = 0; idx < args.volume; ++idx) {
+          const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+          args.inout[point]              = func(args.inout[point], min[point], max[point]);
+        }
+      }
+    });
+  }
+
+#ifdef LEGATE_USE_OPENMP
+  template <int DIM>
+  static void dispatch_omp(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    ClipOperation<T> func;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      if (dense && min.dense(args.rect) && max.dense(args.rect)) {
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.inoutptr[idx] = func(args.inoutptr[idx], min[idx], max[idx]);
+      } else {
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < args.volume; ++idx) {
+          const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+          args.inout[point]              = func(args.inout[point], min[point], max[point]);
+        }
+      }
+    });
+  }
+#endif
+#if defined(LEGATE_USE_CUDA) && defined(__CUDACC__)
+  template <int DIM>
+  static void dispatch_gpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez)
+  {
+    DeserializedArgs<DIM> args;
+    const bool dense = args.deserialize(derez, task, regions);
+    if (args.volume == 0) return;
+    const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    with_clip_bounds(args.min, args.max, [&](auto min, auto max) {
+      const bool all_dense = dense && min.dense(args.rect) && max.dense(args.rect);
+      gpu_clip_inplace_broadcast<DIM, T, DeserializedArgs<DIM>>
+        <<<blocks, THREADS_PER_BLOCK>>>(args, min, max, all_dense);
+    });
+  }
+#elif defined(LEGATE_USE_CUDA)
+  template <int DIM>
+  static void dispatch_gpu(const Legion::Task* task,
+                           const std::vector<Legion::PhysicalRegion>& regions,
+                           LegateDeserializer& derez);
+#endif
+};
+
 template <typename T>
 class ClipScalar : public NumPyTask<ClipScalar<T>> {
  private:
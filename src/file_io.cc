@@ -0,0 +1,358 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "file_io.h"
+#include "proj.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+Logger log_numpy_io("numpy_io");
+
+namespace {
+
+// Finds the value for a key in the Python dict literal of a .npy header
+// and returns the position of its first character
+size_t find_npy_value(const std::string& dict, const char* key)
+{
+  const std::string quoted = std::string("'") + key + "'";
+  size_t pos               = dict.find(quoted);
+  if (pos == std::string::npos) return pos;
+  pos = dict.find(':', pos + quoted.size());
+  if (pos == std::string::npos) return pos;
+  pos++;
+  while ((pos < dict.size()) && (dict[pos] == ' ')) pos++;
+  return (pos < dict.size()) ? pos : std::string::npos;
+}
+
+}  // namespace
+
+// pread and pwrite can stop short so keep going until everything is done
+bool read_fully(int fd, void* buffer, size_t bytes, size_t offset)
+{
+  char* ptr = static_cast<char*>(buffer);
+  while (bytes > 0) {
+    const ssize_t result = pread(fd, ptr, bytes, offset);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    // Running into the end of the file is an error for us
+    if (result == 0) return false;
+    ptr += result;
+    offset += result;
+    bytes -= result;
+  }
+  return true;
+}
+
+bool write_fully(int fd, const void* buffer, size_t bytes, size_t offset)
+{
+  const char* ptr = static_cast<const char*>(buffer);
+  while (bytes > 0) {
+    const ssize_t result = pwrite(fd, ptr, bytes, offset);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    ptr += result;
+    offset += result;
+    bytes -= result;
+  }
+  return true;
+}
+
+bool parse_npy_header(int fd, NpyHeader& header)
+{
+  // Magic string, two version bytes and then the header length which is
+  // two bytes in version 1 and four bytes in versions 2 and 3
+  unsigned char prefix[12];
+  if (!read_fully(fd, prefix, 10, 0)) return false;
+  if (memcmp(prefix, "\x93NUMPY", 6) != 0) return false;
+  size_t length, start;
+  switch (prefix[6]) {
+    case 1: {
+      length = prefix[8] | (prefix[9] << 8);
+      start  = 10;
+      break;
+    }
+    case 2:
+    case 3: {
+      if (!read_fully(fd, prefix + 10, 2, 10)) return false;
+      length = prefix[8] | (prefix[9] << 8) | (prefix[10] << 16) | ((size_t)prefix[11] << 24);
+      start  = 12;
+      break;
+    }
+    default: return false;
+  }
+  std::string dict(length, '\0');
+  if (!read_fully(fd, &dict[0], length, start)) return false;
+  header.data_offset = start + length;
+  // 'descr': '<f8'
+  size_t pos = find_npy_value(dict, "descr");
+  if ((pos == std::string::npos) || ((dict[pos] != '\'') && (dict[pos] != '"'))) return false;
+  const size_t end = dict.find(dict[pos], pos + 1);
+  if (end == std::string::npos) return false;
+  header.descr = dict.substr(pos + 1, end - pos - 1);
+  // 'fortran_order': False
+  pos = find_npy_value(dict, "fortran_order");
+  if (pos == std::string::npos) return false;
+  header.fortran_order = (dict.compare(pos, 4, "True") == 0);
+  // 'shape': (3, 4, )
+  pos = find_npy_value(dict, "shape");
+  if ((pos == std::string::npos) || (dict[pos] != '(')) return false;
+  header.shape.clear();
+  const char* ptr = dict.c_str() + pos + 1;
+  while (true) {
+    while ((*ptr == ' ') || (*ptr == ',')) ptr++;
+    if (*ptr == ')') break;
+    char* next;
+    const unsigned long long extent = strtoull(ptr, &next, 10);
+    if (next == ptr) return false;
+    header.shape.push_back(extent);
+    ptr = next;
+  }
+  return true;
+}
+
+// Moves a tile between its instance and the file where the whole array
+// is stored in C order starting at the offset. The trailing dimensions
+// that the tile covers completely are contiguous in the file so they are
+// merged into runs which go straight to or from the instance when it is
+// dense over them and through a buffer otherwise.
+template <typename T, int DIM, bool READ>
+static bool transfer_tile(int fd,
+                          size_t offset,
+                          const Rect<DIM>& rect,
+                          const Point<DIM>& extents,
+                          T* ptr,
+                          const size_t* strides)
+{
+  size_t file_pitch[DIM];
+  size_t pitch = 1;
+  for (int d = DIM - 1; d >= 0; d--) {
+    file_pitch[d] = pitch;
+    pitch *= extents[d];
+  }
+  int inner  = DIM - 1;
+  size_t run = rect.hi[inner] - rect.lo[inner] + 1;
+  while ((inner > 0) && (rect.lo[inner] == 0) && (rect.hi[inner] == (extents[inner] - 1))) {
+    inner--;
+    run *= rect.hi[inner] - rect.lo[inner] + 1;
+  }
+  bool dense = (strides[DIM - 1] == 1);
+  for (int d = DIM - 2; dense && (d >= inner); d--)
+    dense = (strides[d] == (strides[d + 1] * (rect.hi[d + 1] - rect.lo[d + 1] + 1)));
+  std::vector<T> buffer(dense ? 0 : run);
+  Point<DIM> point = rect.lo;
+  while (true) {
+    size_t file_offset = 0, inst_offset = 0;
+    for (int d = 0; d < DIM; d++) {
+      file_offset += point[d] * file_pitch[d];
+      inst_offset += (point[d] - rect.lo[d]) * strides[d];
+    }
+    const size_t position = offset + file_offset * sizeof(T);
+    T* base               = ptr + inst_offset;
+    if (dense) {
+      if (READ ? !read_fully(fd, base, run * sizeof(T), position)
+               : !write_fully(fd, base, run * sizeof(T), position))
+        return false;
+    } else {
+      if (READ && !read_fully(fd, buffer.data(), run * sizeof(T), position)) return false;
+      // Walk the run in the instance one element at a time
+      Point<DIM> local = point;
+      for (size_t idx = 0; idx < run; idx++) {
+        size_t element = 0;
+        for (int d = inner; d < DIM; d++) element += (local[d] - point[d]) * strides[d];
+        if (READ)
+          base[element] = buffer[idx];
+        else
+          buffer[idx] = base[element];
+        for (int d = DIM - 1; d >= inner; d--) {
+          if (local[d] < rect.hi[d]) {
+            local[d]++;
+            break;
+          }
+          local[d] = rect.lo[d];
+        }
+      }
+      if (!READ && !write_fully(fd, buffer.data(), run * sizeof(T), position)) return false;
+    }
+    // Step to the next run
+    int d = inner - 1;
+    for (; d >= 0; d--) {
+      if (point[d] < rect.hi[d]) {
+        point[d]++;
+        break;
+      }
+      point[d] = rect.lo[d];
+    }
+    if (d < 0) break;
+  }
+  return true;
+}
+
+template <typename T, int DIM>
+static void read_file(const Task* task,
+                      LegateDeserializer& derez,
+                      const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect     = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const Point<DIM> extents = derez.unpack_point<DIM>();
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const bool npy               = derez.unpack_bool();
+  size_t offset                = derez.unpack_value<uint64_t>();
+  const char* path             = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  const int fd                 = open(path, O_RDONLY);
+  if (fd < 0) {
+    log_numpy_io.error("Unable to open %s for reading: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  if (npy) {
+    NpyHeader header;
+    if (!parse_npy_header(fd, header)) {
+      log_numpy_io.error("%s is not a valid .npy file", path);
+      LEGATE_ABORT
+    }
+    size_t volume = 1;
+    for (unsigned idx = 0; idx < header.shape.size(); idx++) volume *= header.shape[idx];
+    if (volume != Rect<DIM>(Point<DIM>::ZEROES(), extents - Point<DIM>::ONES()).volume()) {
+      log_numpy_io.error("The shape of %s changed while it was being loaded", path);
+      LEGATE_ABORT
+    }
+    offset = header.data_offset;
+  }
+  // Each run is read front to back so let the kernel read ahead of us
+  posix_fadvise(fd, offset, 0, POSIX_FADV_SEQUENTIAL);
+  size_t strides[DIM];
+  T* ptr = out.ptr(rect, strides);
+  if (!transfer_tile<T, DIM, true /*read*/>(fd, offset, rect, extents, ptr, strides)) {
+    log_numpy_io.error("Unable to read from %s: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  close(fd);
+}
+
+template <typename T>
+/*static*/ void ReadFileTask<T>::cpu_variant(const Task* task,
+                                             const std::vector<PhysicalRegion>& regions,
+                                             Context ctx,
+                                             Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                         \
+  case DIM: {                                \
+    read_file<T, DIM>(task, derez, regions); \
+    break;                                   \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T, int DIM>
+static void write_file(const Task* task,
+                       LegateDeserializer& derez,
+                       const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect     = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const Point<DIM> extents = derez.unpack_point<DIM>();
+  if (rect.empty()) return;
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  const bool truncate         = derez.unpack_bool();
+  const bool has_header       = derez.unpack_bool();
+  const size_t offset         = derez.unpack_value<uint64_t>();
+  const char* path            = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  const int fd                = open(path, O_WRONLY | O_CREAT, 0666);
+  if (fd < 0) {
+    log_numpy_io.error("Unable to open %s for writing: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  // Whoever owns the first element takes care of the rest of the file
+  if (rect.contains(Point<DIM>::ZEROES())) {
+    if (has_header) {
+      const Future& header = task->futures[1];
+      if (!write_fully(fd, header.get_untyped_pointer(), header.get_untyped_size(), 0)) {
+        log_numpy_io.error("Unable to write to %s: %s", path, strerror(errno));
+        LEGATE_ABORT
+      }
+    }
+    // Only cut off what is past the end so the other tasks can keep going
+    if (truncate) {
+      const size_t volume = Rect<DIM>(Point<DIM>::ZEROES(), extents - Point<DIM>::ONES()).volume();
+      if (ftruncate(fd, offset + volume * sizeof(T)) != 0) {
+        log_numpy_io.error("Unable to resize %s: %s", path, strerror(errno));
+        LEGATE_ABORT
+      }
+    }
+  }
+  size_t strides[DIM];
+  // The transfer only reads from the instance when writing the file
+  T* ptr = const_cast<T*>(in.ptr(rect, strides));
+  if (!transfer_tile<T, DIM, false /*read*/>(fd, offset, rect, extents, ptr, strides)) {
+    log_numpy_io.error("Unable to write to %s: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  close(fd);
+}
+
+template <typename T>
+/*static*/ void WriteFileTask<T>::cpu_variant(const Task* task,
+                                              const std::vector<PhysicalRegion>& regions,
+                                              Context ctx,
+                                              Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                          \
+  case DIM: {                                 \
+    write_file<T, DIM>(task, derez, regions); \
+    break;                                    \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+INSTANTIATE_ALL_TASKS(ReadFileTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_READ_FILE) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(WriteFileTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_WRITE_FILE) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_ALL_TASKS(legate::numpy::ReadFileTask)
+  REGISTER_ALL_TASKS(legate::numpy::WriteFileTask)
+}
+}  // namespace
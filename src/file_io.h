@@ -0,0 +1,86 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_FILE_IO_H__
+#define __NUMPY_FILE_IO_H__
+
+#include "numpy.h"
+#include <string>
+
+// Parallel file I/O. The data in the file is always in C order for the
+// whole array, and every point task computes the byte ranges of its own
+// tile and moves them directly between the file and its instance, so no
+// single node ever has to hold the whole array.
+
+namespace legate {
+namespace numpy {
+
+extern Legion::Logger log_numpy_io;
+
+// Like pread and pwrite but they keep going until everything is done.
+// Running into the end of the file is an error when reading.
+bool read_fully(int fd, void* buffer, size_t bytes, size_t offset);
+bool write_fully(int fd, const void* buffer, size_t bytes, size_t offset);
+
+// The parts of a .npy header that we care about
+struct NpyHeader {
+  std::string descr;
+  bool fortran_order;
+  std::vector<size_t> shape;
+  // Where the array data starts in the file
+  size_t data_offset;
+};
+
+// Reads and parses the header at the start of an open .npy file.
+// Returns false if the file is not a well-formed .npy file.
+bool parse_npy_header(int fd, NpyHeader& header);
+
+// Fills an array from the file. The path of the file is passed in the
+// first future. For .npy files the data offset comes from the header,
+// otherwise it is passed in the arguments.
+template <typename T>
+class ReadFileTask : public NumPyTask<ReadFileTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+// Writes an array into the file at a given offset. The path is passed
+// in the first future and an optional header for the start of the file
+// in the second one, which the task owning the first element writes.
+template <typename T>
+class WriteFileTask : public NumPyTask<WriteFileTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_FILE_IO_H__
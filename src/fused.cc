@@ -0,0 +1,519 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fused.h"
+#include "point_task.h"
+#include "proj.h"
+#include "universal_functions/absolute.h"
+#include "universal_functions/add.h"
+#include "universal_functions/arccos.h"
+#include "universal_functions/arcsin.h"
+#include "universal_functions/arctan.h"
+#include "universal_functions/cos.h"
+#include "universal_functions/divide.h"
+#include "universal_functions/equal.h"
+#include "universal_functions/exp.h"
+#include "universal_functions/greater.h"
+#include "universal_functions/greater_equal.h"
+#include "universal_functions/less.h"
+#include "universal_functions/less_equal.h"
+#include "universal_functions/log.h"
+#include "universal_functions/multiply.h"
+#include "universal_functions/negative.h"
+#include "universal_functions/not_equal.h"
+#include "universal_functions/power.h"
+#include "universal_functions/sin.h"
+#include "universal_functions/sqrt.h"
+#include "universal_functions/subtract.h"
+#include "universal_functions/tan.h"
+#include "universal_functions/tanh.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#ifdef LEGATE_USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Elements per block, small enough that all the registers of a program
+// stay in the L1 or L2 cache while it runs over the block
+static const size_t FUSED_BLOCK_SIZE = 512;
+// Partial sums of different threads are this many bytes apart so that no
+// two of them share a cache line
+static const size_t FUSED_PARTIAL_STRIDE = 128;
+
+template <typename T, typename OP>
+static inline void apply_unary(T* out, const T* in, size_t count, OP op)
+{
+  for (size_t idx = 0; idx < count; idx++) out[idx] = static_cast<T>(op(in[idx]));
+}
+
+template <typename T, typename OP>
+static inline void apply_binary(T* out, const T* in1, const T* in2, size_t count, OP op)
+{
+  for (size_t idx = 0; idx < count; idx++) out[idx] = static_cast<T>(op(in1[idx], in2[idx]));
+}
+
+// Comparisons produce ones and zeros of type T so that they can feed a where
+template <typename T, typename OP>
+static inline void apply_compare(T* out, const T* in1, const T* in2, size_t count, OP op)
+{
+  const T one  = ProdReduction<T>::identity;
+  const T zero = SumReduction<T>::identity;
+  for (size_t idx = 0; idx < count; idx++) out[idx] = op(in1[idx], in2[idx]) ? one : zero;
+}
+
+template <typename T>
+static void execute(const FusedInstruction& inst, T* out, const T* const* srcs, size_t count)
+{
+  switch (inst.op) {
+    case NumPyOpCode::NUMPY_ABSOLUTE: {
+      apply_unary(out, srcs[0], count, AbsoluteOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_ARCCOS: {
+      apply_unary(out, srcs[0], count, ArcCosOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_ARCSIN: {
+      apply_unary(out, srcs[0], count, ArcSinOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_ARCTAN: {
+      apply_unary(out, srcs[0], count, ArcTanOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_COS: {
+      apply_unary(out, srcs[0], count, CosOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_EXP: {
+      apply_unary(out, srcs[0], count, ExpOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_LOG: {
+      apply_unary(out, srcs[0], count, LogOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_NEGATIVE: {
+      apply_unary(out, srcs[0], count, NegativeOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_SIN: {
+      apply_unary(out, srcs[0], count, SinOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_SQRT: {
+      apply_unary(out, srcs[0], count, SqrtOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_TAN: {
+      apply_unary(out, srcs[0], count, TanOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_TANH: {
+      apply_unary(out, srcs[0], count, TanhOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_ADD: {
+      apply_binary(out, srcs[0], srcs[1], count, AddOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_DIVIDE: {
+      apply_binary(out, srcs[0], srcs[1], count, DivideOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_MULTIPLY: {
+      apply_binary(out, srcs[0], srcs[1], count, MultiplyOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_POWER: {
+      apply_binary(out, srcs[0], srcs[1], count, PowerOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_SUBTRACT: {
+      apply_binary(out, srcs[0], srcs[1], count, SubtractOperation<T>());
+      break;
+    }
+    // Same folds as the maximum and minimum tasks
+    case NumPyOpCode::NUMPY_MAXIMUM: {
+      for (size_t idx = 0; idx < count; idx++) {
+        T value = srcs[0][idx];
+        MaxReduction<T>::template fold<true /*exclusive*/>(value, srcs[1][idx]);
+        out[idx] = value;
+      }
+      break;
+    }
+    case NumPyOpCode::NUMPY_MINIMUM: {
+      for (size_t idx = 0; idx < count; idx++) {
+        T value = srcs[0][idx];
+        MinReduction<T>::template fold<true /*exclusive*/>(value, srcs[1][idx]);
+        out[idx] = value;
+      }
+      break;
+    }
+    case NumPyOpCode::NUMPY_EQUAL: {
+      apply_compare(out, srcs[0], srcs[1], count, EqualOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_NOT_EQUAL: {
+      apply_compare(out, srcs[0], srcs[1], count, NotEqualOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_GREATER: {
+      apply_compare(out, srcs[0], srcs[1], count, GreaterOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_GREATER_EQUAL: {
+      apply_compare(out, srcs[0], srcs[1], count, GreaterEqualOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_LESS: {
+      apply_compare(out, srcs[0], srcs[1], count, LessOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_LESS_EQUAL: {
+      apply_compare(out, srcs[0], srcs[1], count, LessEqualOperation<T>());
+      break;
+    }
+    case NumPyOpCode::NUMPY_WHERE: {
+      const T zero = SumReduction<T>::identity;
+      NotEqualOperation<T> nonzero;
+      for (size_t idx = 0; idx < count; idx++)
+        out[idx] = nonzero(srcs[0][idx], zero) ? srcs[1][idx] : srcs[2][idx];
+      break;
+    }
+    default: assert(false);
+  }
+}
+
+// The constants, registers and instructions of a program, which follow its
+// arrays in the arguments of both fused tasks
+template <typename T>
+struct FusedCode {
+  std::vector<T> constants;
+  int num_registers;
+  std::vector<FusedInstruction> program;
+
+  void unpack(LegateDeserializer& derez)
+  {
+    const int num_constants = derez.unpack_32bit_int();
+    for (int idx = 0; idx < num_constants; idx++) constants.push_back(derez.unpack_value<T>());
+    num_registers              = derez.unpack_32bit_int();
+    const int num_instructions = derez.unpack_32bit_int();
+    assert(num_instructions > 0);
+    program.resize(num_instructions);
+    for (int idx = 0; idx < num_instructions; idx++) {
+      program[idx].op  = static_cast<NumPyOpCode>(derez.unpack_32bit_int());
+      program[idx].dst = derez.unpack_32bit_int();
+      for (int src = 0; src < 3; src++) program[idx].src[src] = derez.unpack_32bit_int();
+    }
+  }
+};
+
+// Stores the values of a program in the output array, the last instruction
+// writes them in place when the output is dense
+template <typename T, int DIM>
+struct FusedWrite {
+  const AccessorWO<T, DIM>& out;
+  const Pitches<DIM - 1>& pitches;
+  const Rect<DIM>& rect;
+  T* outptr;
+
+  T* target(size_t offset, T* staged) const
+  {
+    return (outptr != nullptr) ? outptr + offset : staged;
+  }
+  void consume(const T* values, size_t offset, size_t count, int thread) const
+  {
+    if (outptr != nullptr) return;
+    for (size_t elem = 0; elem < count; elem++)
+      out[pitches.unflatten(offset + elem, rect.lo)] = values[elem];
+  }
+};
+
+// Adds the values of a program up instead of storing them, with a partial
+// sum for every thread
+template <typename T>
+struct FusedSum {
+  static constexpr size_t stride = (FUSED_PARTIAL_STRIDE + sizeof(T) - 1) / sizeof(T);
+  T* partials;
+
+  T* target(size_t offset, T* staged) const { return staged; }
+  void consume(const T* values, size_t offset, size_t count, int thread) const
+  {
+    T& partial = partials[thread * stride];
+    for (size_t elem = 0; elem < count; elem++)
+      SumReduction<T>::template fold<true /*exclusive*/>(partial, values[elem]);
+  }
+};
+
+template <typename T, int DIM, typename SINK>
+static void run_program(const Rect<DIM>& rect,
+                        const Pitches<DIM - 1>& pitches,
+                        const std::vector<AccessorRO<T, DIM>>& inputs,
+                        const FusedCode<T>& code,
+                        const SINK& sink,
+                        bool parallel)
+{
+  const size_t volume        = rect.volume();
+  const int num_inputs       = inputs.size();
+  const int num_constants    = code.constants.size();
+  const int num_registers    = code.num_registers;
+  const int first_temporary  = num_inputs + num_constants;
+  const int last_instruction = code.program.size() - 1;
+  const size_t num_blocks    = (volume + FUSED_BLOCK_SIZE - 1) / FUSED_BLOCK_SIZE;
+  // Dense inputs are read straight from their instances
+  std::vector<const T*> inptrs(num_inputs, nullptr);
+  for (int idx = 0; idx < num_inputs; idx++)
+    if (inputs[idx].accessor.is_dense_row_major(rect)) inptrs[idx] = inputs[idx].ptr(rect);
+
+  // Runs the program over the blocks in [lo, hi) with the scratch space of
+  // one thread: a block for each register and one more where the result is
+  // staged when the sink does not take it in place
+  auto run_blocks = [&](int thread, size_t lo, size_t hi) {
+    std::unique_ptr<T[]> buffer(new T[(num_registers + 1) * FUSED_BLOCK_SIZE]);
+    T* scratch = buffer.get();
+    std::vector<const T*> values(num_registers, nullptr);
+    for (int reg = num_inputs; reg < num_registers; reg++)
+      values[reg] = scratch + reg * FUSED_BLOCK_SIZE;
+    for (int idx = 0; idx < num_constants; idx++)
+      std::fill_n(scratch + (num_inputs + idx) * FUSED_BLOCK_SIZE,
+                  FUSED_BLOCK_SIZE,
+                  code.constants[idx]);
+    T* staged = scratch + num_registers * FUSED_BLOCK_SIZE;
+
+    for (size_t block = lo; block < hi; block++) {
+      const size_t offset = block * FUSED_BLOCK_SIZE;
+      const size_t count  = std::min(FUSED_BLOCK_SIZE, volume - offset);
+      for (int idx = 0; idx < num_inputs; idx++) {
+        if (inptrs[idx] != nullptr) {
+          values[idx] = inptrs[idx] + offset;
+        } else {
+          T* in = scratch + idx * FUSED_BLOCK_SIZE;
+          for (size_t elem = 0; elem < count; elem++)
+            in[elem] = inputs[idx][pitches.unflatten(offset + elem, rect.lo)];
+          values[idx] = in;
+        }
+      }
+      T* result = sink.target(offset, staged);
+      for (int idx = 0; idx <= last_instruction; idx++) {
+        const FusedInstruction& inst = code.program[idx];
+        assert(inst.dst >= first_temporary && inst.dst < num_registers);
+        const T* srcs[3];
+        for (int src = 0; src < 3; src++)
+          srcs[src] = (inst.src[src] >= 0) ? values[inst.src[src]] : nullptr;
+        T* dst = (idx < last_instruction) ? scratch + inst.dst * FUSED_BLOCK_SIZE : result;
+        execute<T>(inst, dst, srcs, count);
+      }
+      sink.consume(result, offset, count, thread);
+    }
+  };
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+    // Every thread takes one contiguous range of the blocks
+#pragma omp parallel
+    {
+      const int thread     = omp_get_thread_num();
+      const size_t threads = omp_get_num_threads();
+      const size_t chunk   = (num_blocks + threads - 1) / threads;
+      const size_t lo      = std::min(num_blocks, thread * chunk);
+      run_blocks(thread, lo, std::min(num_blocks, lo + chunk));
+    }
+    return;
+  }
+#endif
+  run_blocks(0, 0, num_blocks);
+}
+
+template <typename T, int DIM>
+static void fused(const Task* task,
+                  LegateDeserializer& derez,
+                  const std::vector<PhysicalRegion>& regions,
+                  bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const int num_inputs         = derez.unpack_32bit_int();
+  std::vector<AccessorRO<T, DIM>> inputs;
+  for (int idx = 0; idx < num_inputs; idx++)
+    inputs.push_back(derez.unpack_accessor_RO<T, DIM>(regions[idx + 1], rect));
+  FusedCode<T> code;
+  code.unpack(derez);
+
+  Pitches<DIM - 1> pitches;
+  pitches.flatten(rect);
+  T* outptr = out.accessor.is_dense_row_major(rect) ? out.ptr(rect) : nullptr;
+  const FusedWrite<T, DIM> sink{out, pitches, rect, outptr};
+  run_program<T, DIM>(rect, pitches, inputs, code, sink, parallel);
+}
+
+template <typename T, int DIM>
+static T fused_sum(const Task* task,
+                   LegateDeserializer& derez,
+                   const std::vector<PhysicalRegion>& regions,
+                   bool parallel)
+{
+  T result             = SumReduction<T>::identity;
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return result;
+  const int num_inputs = derez.unpack_32bit_int();
+  std::vector<AccessorRO<T, DIM>> inputs;
+  for (int idx = 0; idx < num_inputs; idx++)
+    inputs.push_back(derez.unpack_accessor_RO<T, DIM>(regions[idx], rect));
+  FusedCode<T> code;
+  code.unpack(derez);
+
+  Pitches<DIM - 1> pitches;
+  pitches.flatten(rect);
+#ifdef LEGATE_USE_OPENMP
+  const int num_threads = parallel ? omp_get_max_threads() : 1;
+#else
+  const int num_threads = 1;
+#endif
+  const size_t stride = FusedSum<T>::stride;
+  std::vector<T> partials(num_threads * stride, SumReduction<T>::identity);
+  const FusedSum<T> sink{partials.data()};
+  run_program<T, DIM>(rect, pitches, inputs, code, sink, parallel);
+  for (int idx = 0; idx < num_threads; idx++)
+    SumReduction<T>::template fold<true /*exclusive*/>(result, partials[idx * stride]);
+  return result;
+}
+
+template <typename T>
+static void fused_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                               \
+  case DIM: {                                      \
+    fused<T, DIM>(task, derez, regions, parallel); \
+    break;                                         \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void FusedTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  fused_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void FusedTask<T>::omp_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  fused_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T>
+static T fused_sum_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                          \
+  case DIM: {                                                 \
+    return fused_sum<T, DIM>(task, derez, regions, parallel); \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return SumReduction<T>::identity;
+}
+
+template <typename T>
+/*static*/ T FusedSumTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  return fused_sum_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ T FusedSumTask<T>::omp_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  return fused_sum_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T>
+/*static*/ T FusedScalarTask<T>::cpu_variant(const Task* task,
+                                             const std::vector<PhysicalRegion>& regions,
+                                             Context ctx,
+                                             Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  FusedCode<T> code;
+  code.unpack(derez);
+  // Every register holds a single value
+  const int num_inputs    = task->futures.size();
+  const int num_constants = code.constants.size();
+  std::vector<T> registers(code.num_registers);
+  for (int idx = 0; idx < num_inputs; idx++)
+    registers[idx] = task->futures[idx].get_result<T>(true /*silence warnings*/);
+  for (int idx = 0; idx < num_constants; idx++)
+    registers[num_inputs + idx] = code.constants[idx];
+  for (const FusedInstruction& inst : code.program) {
+    assert(inst.dst >= num_inputs + num_constants && inst.dst < code.num_registers);
+    const T* srcs[3];
+    for (int src = 0; src < 3; src++)
+      srcs[src] = (inst.src[src] >= 0) ? &registers[inst.src[src]] : nullptr;
+    execute<T>(inst, &registers[inst.dst], srcs, 1);
+  }
+  return registers[code.program.back().dst];
+}
+
+INSTANTIATE_ALL_TASKS(FusedTask, static_cast<int>(NumPyOpCode::NUMPY_FUSED) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(FusedSumTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_FUSED_SUM) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(FusedScalarTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_FUSED_SCALAR) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_ALL_TASKS(legate::numpy::FusedTask)
+  REGISTER_ALL_TASKS_WITH_REDUCTION_RETURN(legate::numpy::FusedSumTask, SumReduction)
+  REGISTER_ALL_TASKS_WITH_RETURN(legate::numpy::FusedScalarTask)
+}
+}  // namespace
@@ -0,0 +1,99 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_FUSED_H__
+#define __NUMPY_FUSED_H__
+
+#include "numpy.h"
+
+namespace legate {
+namespace numpy {
+
+// One step of a fused elementwise program. Registers are numbered with
+// the input arrays first, then the scalar constants, then the values the
+// program computes. Unused sources are -1.
+struct FusedInstruction {
+  NumPyOpCode op;
+  int dst;
+  int src[3];
+};
+
+// Evaluates a straight line program of elementwise ufuncs over its input
+// arrays in one pass and writes the value of its last instruction to the
+// output. Every register holds values of type T. The program is run over
+// blocks of elements so each instruction is a tight loop over a block
+// that stays in cache.
+template <typename T>
+class FusedTask : public NumPyTask<FusedTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 0;  // the number of inputs is not fixed
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Evaluates a fused program like FusedTask but adds its values up instead
+// of storing them, so an elementwise chain that ends in a sum never writes
+// out the array it sums
+template <typename T>
+class FusedSumTask : public NumPyTask<FusedSumTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 0;  // the number of inputs is not fixed
+
+ public:
+  static T cpu_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static T omp_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+#endif
+};
+
+// Evaluates a fused program once over futures instead of arrays, so a chain
+// of operations on scalars takes one task launch instead of one per step.
+// The inputs are the futures of the task.
+template <typename T>
+class FusedScalarTask : public NumPyTask<FusedScalarTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 0;
+
+ public:
+  static T cpu_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_FUSED_H__
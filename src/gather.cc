@@ -0,0 +1,241 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gather.h"
+#include "point_task.h"
+#include "proj.h"
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Indices count from the back of the dimension when they are negative
+static inline coord_t wrap_index(coord_t index, coord_t extent)
+{
+  const coord_t result = (index < 0) ? index + extent : index;
+  assert((0 <= result) && (result < extent));
+  return result;
+}
+
+template <typename T, int DIM>
+static void gather_ranges(const Task* task,
+                          LegateDeserializer& derez,
+                          const std::vector<PhysicalRegion>& regions,
+                          bool parallel)
+{
+  const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<Rect<DIM>, 1> out = derez.unpack_accessor_WO<Rect<DIM>, 1>(regions[0], rect);
+  const AccessorRO<T, 1> index       = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
+  const Point<DIM> extents           = derez.unpack_point<DIM>();
+  for_each_index(rect.lo[0], rect.hi[0] + 1, parallel, [&](coord_t x) {
+    Point<DIM> lo = Point<DIM>::ZEROES();
+    Point<DIM> hi = extents - Point<DIM>::ONES();
+    lo[0] = hi[0] = wrap_index(index[x], extents[0]);
+    out[x]        = Rect<DIM>(lo, hi);
+  });
+}
+
+template <typename T>
+static void gather_ranges_task(const Task* task,
+                               const std::vector<PhysicalRegion>& regions,
+                               bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                       \
+  case DIM: {                                              \
+    gather_ranges<T, DIM>(task, derez, regions, parallel); \
+    break;                                                 \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void GatherRangesTask<T>::cpu_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  gather_ranges_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void GatherRangesTask<T>::omp_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  gather_ranges_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T, int DIM>
+static void gather(const Task* task,
+                   LegateDeserializer& derez,
+                   const std::vector<PhysicalRegion>& regions,
+                   bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const Rect<1> index_rect(Point<1>(rect.lo[0]), Point<1>(rect.hi[0]));
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const AccessorRO<int64_t, 1> index =
+    derez.unpack_accessor_RO<int64_t, 1>(regions[1], index_rect);
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[2]);
+  const Point<DIM> extents    = derez.unpack_point<DIM>();
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+    const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+    Point<DIM> q       = p;
+    q[0]               = wrap_index(index[p[0]], extents[0]);
+    out[p]             = in[q];
+  });
+}
+
+template <typename T>
+static void gather_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                \
+  case DIM: {                                       \
+    gather<T, DIM>(task, derez, regions, parallel); \
+    break;                                          \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void GatherTask<T>::cpu_variant(const Task* task,
+                                           const std::vector<PhysicalRegion>& regions,
+                                           Context ctx,
+                                           Runtime* runtime)
+{
+  gather_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void GatherTask<T>::omp_variant(const Task* task,
+                                           const std::vector<PhysicalRegion>& regions,
+                                           Context ctx,
+                                           Runtime* runtime)
+{
+  gather_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T, int DIM>
+static void scatter_add(const Task* task,
+                        LegateDeserializer& derez,
+                        const std::vector<PhysicalRegion>& regions,
+                        Runtime* runtime,
+                        bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const Rect<1> index_rect(Point<1>(rect.lo[0]), Point<1>(rect.hi[0]));
+  // The rows that we add to are only the ones that our indices pick out,
+  // so we get an accessor for the bounds of all of them
+  const Domain dom = runtime->get_index_space_domain(task->regions[0].region.get_index_space());
+  const Rect<DIM> out_rect = dom.bounds<DIM, coord_t>();
+  const AccessorRD<SumReduction<T>, false /*exclusive*/, DIM> out =
+    derez.unpack_accessor_RD<SumReduction<T>, false, DIM>(regions[0], out_rect);
+  const AccessorRO<int64_t, 1> index =
+    derez.unpack_accessor_RO<int64_t, 1>(regions[1], index_rect);
+  const AccessorRO<T, DIM> values = derez.unpack_accessor_RO<T, DIM>(regions[2], rect);
+  const Point<DIM> extents        = derez.unpack_point<DIM>();
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  // Folds are atomic, so threads with the same index can add at once
+  for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+    const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+    Point<DIM> q       = p;
+    q[0]               = wrap_index(index[p[0]], extents[0]);
+    out.reduce(q, values[p]);
+  });
+}
+
+template <typename T>
+static void scatter_add_task(const Task* task,
+                             const std::vector<PhysicalRegion>& regions,
+                             Runtime* runtime,
+                             bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                              \
+  case DIM: {                                                     \
+    scatter_add<T, DIM>(task, derez, regions, runtime, parallel); \
+    break;                                                        \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void ScatterAddTask<T>::cpu_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  scatter_add_task<T>(task, regions, runtime, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void ScatterAddTask<T>::omp_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  scatter_add_task<T>(task, regions, runtime, true /*parallel*/);
+}
+#endif
+
+INSTANTIATE_INT_TASKS(GatherRangesTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_GATHER_RANGES) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(GatherTask, static_cast<int>(NumPyOpCode::NUMPY_GATHER) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(ScatterAddTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_SCATTER_ADD) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnamed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_INT_TASKS(legate::numpy::GatherRangesTask)
+  REGISTER_ALL_TASKS(legate::numpy::GatherTask)
+  REGISTER_ALL_TASKS(legate::numpy::ScatterAddTask)
+}
+}  // namespace
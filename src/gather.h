@@ -0,0 +1,98 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_GATHER_H__
+#define __NUMPY_GATHER_H__
+
+#include "numpy.h"
+
+// These tasks index the first dimension of an array with a vector of
+// integers. The index vector is split into tiles and the output or the
+// values are split the same way along their first dimension. Each point
+// task gets the rows of the array that its indices pick out through an
+// image partition that is built from the rectangles of GatherRangesTask.
+
+namespace legate {
+namespace numpy {
+
+// Writes the rectangle of the row that each index picks out so we can
+// build an image partition with the rows that each tile needs. T is the
+// type of the indices.
+template <typename T>
+class GatherRangesTask : public NumPyTask<GatherRangesTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// out[i, ...] = in[index[i], ...]
+template <typename T>
+class GatherTask : public NumPyTask<GatherTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// out[index[i], ...] += values[i, ...], with the sums folded into the
+// output through a sum reduction so that repeated indices all count, even
+// when they are in different tiles
+template <typename T>
+class ScatterAddTask : public NumPyTask<ScatterAddTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_GATHER_H__
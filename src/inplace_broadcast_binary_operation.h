@@ -37,6 +37,20 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
     args.inout[point]              = func(args.inout[point], args.scalar);
   }
 }
+
+template <int DIM, typename ScalarOperation, typename Args>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  gpu_inplace_scalar_rhs_op(const Args args, const ScalarOperation op, const bool dense)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= args.volume) return;
+  if (dense) {
+    args.inoutptr[idx] = op(args.inoutptr[idx]);
+  } else {
+    const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+    args.inout[point]              = op(args.inout[point]);
+  }
+}
 #endif
 
 // Base class for all Legate's binary operation tasks
@@ -91,14 +105,15 @@ class InplaceBroadcastBinaryOperationTask : public PointTask<Derived> {
     DeserializedArgs<DIM> args;
     const bool dense = args.deserialize(derez, task, regions);
     if (args.volume == 0) return;
-    BinaryFunction func;
-    if (dense) {
-      for (size_t idx = 0; idx < args.volume; ++idx)
-        args.inoutptr[idx] = func(args.inoutptr[idx], args.scalar);
-    } else {
-      const Scalar<second_argument_type, DIM> scalar(args.scalar);
-      CPULoop<DIM>::binary_inplace(func, args.inout, scalar, args.rect);
-    }
+    const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+    rhs_op.visit([&](const auto& op) {
+      if (dense) {
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.inoutptr[idx] = op(args.inoutptr[idx]);
+      } else {
+        CPULoop<DIM>::unary_inplace(op, args.inout, args.rect);
+      }
+    });
   }
 
 #ifdef LEGATE_USE_OPENMP
@@ -110,15 +125,16 @@ class InplaceBroadcastBinaryOperationTask : public PointTask<Derived> {
     DeserializedArgs<DIM> args;
     const bool dense = args.deserialize(derez, task, regions);
     if (args.volume == 0) return;
-    BinaryFunction func;
-    if (dense) {
+    const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+    rhs_op.visit([&](const auto& op) {
+      if (dense) {
 #pragma omp parallel for schedule(static)
-      for (size_t idx = 0; idx < args.volume; ++idx)
-        args.inoutptr[idx] = func(args.inoutptr[idx], args.scalar);
-    } else {
-      const Scalar<second_argument_type, DIM> scalar(args.scalar);
-      OMPLoop<DIM>::binary_inplace(func, args.inout, scalar, args.rect);
-    }
+        for (size_t idx = 0; idx < args.volume; ++idx)
+          args.inoutptr[idx] = op(args.inoutptr[idx]);
+      } else {
+        OMPLoop<DIM>::unary_inplace(op, args.inout, args.rect);
+      }
+    });
   }
 #endif
 #if defined(LEGATE_USE_CUDA) && defined(__CUDACC__)
@@ -130,6 +146,23 @@ class InplaceBroadcastBinaryOperationTask : public PointTask<Derived> {
     DeserializedArgs<DIM> args;
     const bool dense = args.deserialize(derez, task, regions);
     if (args.volume == 0) return;
+    launch_gpu<DIM>(
+      args,
+      dense,
+      std::integral_constant<bool, ScalarRhsOperation<BinaryFunction>::on_device>{});
+  }
+
+  template <int DIM>
+  static void launch_gpu(const DeserializedArgs<DIM>& args, const bool dense, std::true_type)
+  {
+    const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+    gpu_inplace_scalar_rhs_op<DIM><<<blocks, THREADS_PER_BLOCK>>>(args, rhs_op, dense);
+  }
+
+  template <int DIM>
+  static void launch_gpu(const DeserializedArgs<DIM>& args, const bool dense, std::false_type)
+  {
     const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
     gpu_inplace_broadcast_binary_op<DIM, BinaryFunction, DeserializedArgs<DIM>>
       <<<blocks, THREADS_PER_BLOCK>>>(args, dense);
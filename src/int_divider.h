@@ -0,0 +1,134 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_INT_DIVIDER_H__
+#define __NUMPY_INT_DIVIDER_H__
+
+#include "numpy.h"
+#include <type_traits>
+
+namespace legate {
+namespace numpy {
+
+template <typename U>
+struct WideUnsigned;
+template <>
+struct WideUnsigned<uint16_t> {
+  using type = uint32_t;
+};
+template <>
+struct WideUnsigned<uint32_t> {
+  using type = uint64_t;
+};
+template <>
+struct WideUnsigned<uint64_t> {
+  using type = __uint128_t;
+};
+
+// The upper half of the full product of two unsigned integers
+template <typename U>
+__CUDA_HD__ inline U mulhi(U a, U b)
+{
+  using W = typename WideUnsigned<U>::type;
+  return static_cast<U>((static_cast<W>(a) * static_cast<W>(b)) >> (8 * sizeof(U)));
+}
+
+template <>
+__CUDA_HD__ inline uint64_t mulhi<uint64_t>(uint64_t a, uint64_t b)
+{
+#ifdef __CUDA_ARCH__
+  return __umul64hi(a, b);
+#else
+  return static_cast<uint64_t>((static_cast<__uint128_t>(a) * b) >> 64);
+#endif
+}
+
+template <typename T>
+__CUDA_HD__ inline bool is_negative(T value, std::true_type /*signed*/)
+{
+  return value < 0;
+}
+
+template <typename T>
+__CUDA_HD__ inline bool is_negative(T, std::false_type /*signed*/)
+{
+  return false;
+}
+
+// Divides integers by a divisor that stays the same for all of them with a
+// multiplication and two shifts instead of a hardware division, which takes
+// tens of cycles and does not vectorize. The magic number is the one from
+// Granlund and Montgomery, "Division by Invariant Integers using
+// Multiplication", for the unsigned magnitudes. Quotients and remainders
+// truncate towards zero like the C operators, and dividing by zero gives
+// zero for both like NumPy does.
+template <typename T>
+class IntDivider {
+ private:
+  using U = typename std::make_unsigned<T>::type;
+  // Arithmetic on U without promotions to signed int
+  using UW = typename std::conditional<(sizeof(U) < sizeof(unsigned)), unsigned, U>::type;
+  static constexpr unsigned BITS = 8 * sizeof(U);
+
+ public:
+  IntDivider(T d) : divisor(d), negative(is_negative(d, std::is_signed<T>{}))
+  {
+    const U ad = magnitude(d);
+    mask       = (ad == 0) ? 0 : ~U(0);
+    // The smallest l with the divisor at most 2^l
+    unsigned l = 0;
+    while ((l < BITS) && ((UW(1) << l) < ad)) l++;
+    using W = typename WideUnsigned<U>::type;
+    magic   = (ad == 0) ? 0 : static_cast<U>((((W(1) << l) - ad) << BITS) / ad + 1);
+    shift1  = (l > 0) ? 1 : 0;
+    shift2  = (l > 0) ? l - 1 : 0;
+  }
+
+ public:
+  __CUDA_HD__ inline T quotient(T n) const
+  {
+    const UW an     = magnitude(n);
+    const UW t      = mulhi<U>(magic, an);
+    const UW q      = ((t + ((an - t) >> shift1)) >> shift2) & mask;
+    const bool flip = is_negative(n, std::is_signed<T>{}) != negative;
+    return static_cast<T>(static_cast<U>(flip ? UW(0) - q : q));
+  }
+  __CUDA_HD__ inline T remainder(T n) const
+  {
+    const UW r = UW(n) - UW(quotient(n)) * UW(divisor);
+    return static_cast<T>(static_cast<U>(r & mask));
+  }
+
+ private:
+  __CUDA_HD__ static inline U magnitude(T value)
+  {
+    return is_negative(value, std::is_signed<T>{}) ? static_cast<U>(UW(0) - UW(value))
+                                                   : static_cast<U>(value);
+  }
+
+ private:
+  T divisor;
+  bool negative;
+  U magic;
+  U mask;
+  unsigned shift1;
+  unsigned shift2;
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_INT_DIVIDER_H__
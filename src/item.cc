@@ -15,6 +15,7 @@
  */
 
 #include "item.h"
+#include "proj.h"
 
 using namespace Legion;
 
@@ -81,8 +82,97 @@ template <typename T>
   }
 }
 
+template <typename T, int DIM>
+static void read_items(const Task* task,
+                       LegateDeserializer& derez,
+                       const std::vector<PhysicalRegion>& regions,
+                       Runtime* runtime)
+{
+  const Rect<DIM> rect        = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  const Rect<DIM> out_rect =
+    runtime->get_index_space_domain(task->regions[1].region.get_index_space());
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[1], out_rect);
+  // Index launches give every point task its own points in its local
+  // arguments, single tasks find them after the shared arguments
+  LegateDeserializer local(task->local_args, task->local_arglen);
+  LegateDeserializer& items = task->is_index_space ? local : derez;
+  const int count           = items.unpack_32bit_int();
+  // The values go to consecutive slots of our piece of the buffer in the
+  // order of the points
+  Point<DIM> slot = out_rect.lo;
+  for (int idx = 0; idx < count; idx++) {
+    const Point<DIM> p = items.unpack_point<DIM>();
+    assert(rect.contains(p));
+    out[slot] = in[p];
+    slot[DIM - 1]++;
+  }
+}
+
+template <typename T>
+/*static*/ void ReadItemsTask<T>::cpu_variant(const Task* task,
+                                              const std::vector<PhysicalRegion>& regions,
+                                              Context ctx,
+                                              Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                   \
+  case DIM: {                                          \
+    read_items<T, DIM>(task, derez, regions, runtime); \
+    break;                                             \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T, int DIM>
+static void write_items(const Task* task,
+                        LegateDeserializer& derez,
+                        const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect         = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const AccessorRW<T, DIM> out = derez.unpack_accessor_RW<T, DIM>(regions[0], rect);
+  LegateDeserializer local(task->local_args, task->local_arglen);
+  LegateDeserializer& items = task->is_index_space ? local : derez;
+  const int count           = items.unpack_32bit_int();
+  for (int idx = 0; idx < count; idx++) {
+    const Point<DIM> p = items.unpack_point<DIM>();
+    const T value      = items.unpack_value<T>();
+    assert(rect.contains(p));
+    out[p] = value;
+  }
+}
+
+template <typename T>
+/*static*/ void WriteItemsTask<T>::cpu_variant(const Task* task,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               Context ctx,
+                                               Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                           \
+  case DIM: {                                  \
+    write_items<T, DIM>(task, derez, regions); \
+    break;                                     \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
 INSTANTIATE_ALL_TASKS(ReadItemTask, static_cast<int>(NumPyOpCode::NUMPY_READ) * NUMPY_TYPE_OFFSET)
 INSTANTIATE_ALL_TASKS(WriteItemTask, static_cast<int>(NumPyOpCode::NUMPY_WRITE) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(ReadItemsTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_READ_ITEMS) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(WriteItemsTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_WRITE_ITEMS) * NUMPY_TYPE_OFFSET)
 
 }  // namespace numpy
 }  // namespace legate
@@ -93,5 +183,7 @@ static void __attribute__((constructor)) register_tasks(void)
 {
   REGISTER_ALL_TASKS_WITH_VALUE_RETURN(legate::numpy::ReadItemTask)
   REGISTER_ALL_TASKS(legate::numpy::WriteItemTask)
+  REGISTER_ALL_TASKS(legate::numpy::ReadItemsTask)
+  REGISTER_ALL_TASKS(legate::numpy::WriteItemsTask)
 }
 }  // namespace
@@ -59,6 +59,40 @@ class WriteItemTask : public NumPyTask<WriteItemTask<T>> {
                           Legion::Runtime* runtime);
 #endif
 };
+
+// Reads the elements at a list of points with one launch. The points come
+// grouped by the tile of the array that holds them, only the tiles with
+// points get a point task, and each one gets its own group in its local
+// arguments. The values go to the slots of a buffer that belong to the
+// point task.
+template <typename T>
+class ReadItemsTask : public NumPyTask<ReadItemsTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+// Writes a value to each of a list of points with one launch, with the
+// points grouped by tile like they are for ReadItemsTask
+template <typename T>
+class WriteItemsTask : public NumPyTask<WriteItemsTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
 }  // namespace numpy
 }  // namespace legate
 
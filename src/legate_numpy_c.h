@@ -107,6 +107,37 @@ enum NumPyOpCode {
   NUMPY_INCLUSIVE_SCAN      = 72,
   NUMPY_CONVERT_TO_RECT     = 73,
   NUMPY_ARANGE              = 74,
+  NUMPY_POTRF               = 75,
+  NUMPY_TRSM                = 76,
+  NUMPY_SYRK                = 77,
+  NUMPY_GEMM                = 78,
+  NUMPY_GEQRF               = 79,
+  NUMPY_NRM2                = 80,
+  NUMPY_AXPBY               = 81,
+  NUMPY_READ_FILE           = 82,
+  NUMPY_WRITE_FILE          = 83,
+  NUMPY_COUNT_LINES         = 84,
+  NUMPY_READ_TEXT           = 85,
+  NUMPY_CHECKPOINT          = 86,
+  NUMPY_RESTORE             = 87,
+  NUMPY_PACK_BITS           = 88,
+  NUMPY_UNPACK_BITS         = 89,
+  NUMPY_BITMASK_LOGICAL     = 90,
+  NUMPY_BITMASK_COUNT       = 91,
+  NUMPY_BITMASK_NONZERO     = 92,
+  NUMPY_BF16_CONVERT        = 93,
+  NUMPY_BF16_UFUNC          = 94,
+  NUMPY_BF16_SUM            = 95,
+  NUMPY_FUSED               = 96,
+  NUMPY_FUSED_SUM           = 97,
+  NUMPY_FUSED_SCALAR        = 98,
+  NUMPY_READ_ITEMS          = 99,
+  NUMPY_WRITE_ITEMS         = 100,
+  NUMPY_GATHER              = 101,
+  NUMPY_SCATTER_ADD         = 102,
+  NUMPY_GATHER_RANGES       = 103,
+  NUMPY_MASKED_SELECT       = 104,
+  NUMPY_MASKED_ASSIGN       = 105,
 };
 
 // Match these to NumPyRedopCode in legate/numpy/config.py
@@ -246,6 +277,12 @@ enum NumpyTaskOffset {
   NUMPY_BINCOUNT_OFFSET = 200000,
 };
 
+// Semantic information that we attach to fields for the mapper
+// Match these to NumPySemanticTag in legate/numpy/config.py
+enum NumPySemanticTag {
+  NUMPY_FILE_BACKED_SEMANTIC_TAG = 100,  // bool, field is attached to a file
+};
+
 // Match these to NumPyMappingTag in legate/numpy/config.py
 enum NumPyTag {
   NUMPY_SUBRANKABLE_TAG = 0x1,
@@ -270,6 +307,7 @@ enum NumPyTunable {
   NUMPY_TUNABLE_MAX_EAGER_VOLUME      = 9,
   NUMPY_TUNABLE_FIELD_REUSE_SIZE      = 10,
   NUMPY_TUNABLE_FIELD_REUSE_FREQUENCY = 11,
+  NUMPY_TUNABLE_FIELD_POOL_SIZE       = 13,
 };
 
 enum NumPyBounds {
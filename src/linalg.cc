@@ -0,0 +1,413 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "linalg.h"
+#include "proj.h"
+#include <cblas.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef LEGATE_USE_OPENMP
+#include <omp.h>
+#endif
+
+// OpenBLAS always exports the Fortran LAPACK interface even
+// when it is built without LAPACKE so we call that directly
+extern "C" {
+void spotrf_(const char* uplo, const int* n, float* a, const int* lda, int* info);
+void dpotrf_(const char* uplo, const int* n, double* a, const int* lda, int* info);
+void sgelqf_(const int* m,
+             const int* n,
+             float* a,
+             const int* lda,
+             float* tau,
+             float* work,
+             const int* lwork,
+             int* info);
+void dgelqf_(const int* m,
+             const int* n,
+             double* a,
+             const int* lda,
+             double* tau,
+             double* work,
+             const int* lwork,
+             int* info);
+}
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Thin overloads so the tile kernels below can be written once for both types
+
+static inline void lapack_potrf(
+  const char* uplo, const int* n, float* a, const int* lda, int* info)
+{
+  spotrf_(uplo, n, a, lda, info);
+}
+
+static inline void lapack_potrf(
+  const char* uplo, const int* n, double* a, const int* lda, int* info)
+{
+  dpotrf_(uplo, n, a, lda, info);
+}
+
+static inline void lapack_gelqf(const int* m,
+                                const int* n,
+                                float* a,
+                                const int* lda,
+                                float* tau,
+                                float* work,
+                                const int* lwork,
+                                int* info)
+{
+  sgelqf_(m, n, a, lda, tau, work, lwork, info);
+}
+
+static inline void lapack_gelqf(const int* m,
+                                const int* n,
+                                double* a,
+                                const int* lda,
+                                double* tau,
+                                double* work,
+                                const int* lwork,
+                                int* info)
+{
+  dgelqf_(m, n, a, lda, tau, work, lwork, info);
+}
+
+static inline void blas_trsm(CBLAS_SIDE side,
+                             CBLAS_UPLO uplo,
+                             CBLAS_TRANSPOSE trans,
+                             coord_t m,
+                             coord_t n,
+                             const float* a,
+                             size_t lda,
+                             float* b,
+                             size_t ldb)
+{
+  cblas_strsm(CblasRowMajor, side, uplo, trans, CblasNonUnit, m, n, 1.f, a, lda, b, ldb);
+}
+
+static inline void blas_trsm(CBLAS_SIDE side,
+                             CBLAS_UPLO uplo,
+                             CBLAS_TRANSPOSE trans,
+                             coord_t m,
+                             coord_t n,
+                             const double* a,
+                             size_t lda,
+                             double* b,
+                             size_t ldb)
+{
+  cblas_dtrsm(CblasRowMajor, side, uplo, trans, CblasNonUnit, m, n, 1.0, a, lda, b, ldb);
+}
+
+static inline void blas_syrk(coord_t n, coord_t k, const float* a, size_t lda, float* c, size_t ldc)
+{
+  cblas_ssyrk(CblasRowMajor, CblasLower, CblasNoTrans, n, k, -1.f, a, lda, 1.f, c, ldc);
+}
+
+static inline void blas_syrk(
+  coord_t n, coord_t k, const double* a, size_t lda, double* c, size_t ldc)
+{
+  cblas_dsyrk(CblasRowMajor, CblasLower, CblasNoTrans, n, k, -1.0, a, lda, 1.0, c, ldc);
+}
+
+static inline void blas_gemm(CBLAS_TRANSPOSE trans_a,
+                             CBLAS_TRANSPOSE trans_b,
+                             coord_t m,
+                             coord_t n,
+                             coord_t k,
+                             const float* a,
+                             size_t lda,
+                             const float* b,
+                             size_t ldb,
+                             float* c,
+                             size_t ldc)
+{
+  cblas_sgemm(CblasRowMajor, trans_a, trans_b, m, n, k, -1.f, a, lda, b, ldb, 1.f, c, ldc);
+}
+
+static inline void blas_gemm(CBLAS_TRANSPOSE trans_a,
+                             CBLAS_TRANSPOSE trans_b,
+                             coord_t m,
+                             coord_t n,
+                             coord_t k,
+                             const double* a,
+                             size_t lda,
+                             const double* b,
+                             size_t ldb,
+                             double* c,
+                             size_t ldc)
+{
+  cblas_dgemm(CblasRowMajor, trans_a, trans_b, m, n, k, -1.0, a, lda, b, ldb, 1.0, c, ldc);
+}
+
+template <typename T>
+static int potrf_tile(const Task* task, const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (rect.empty()) return 0;
+  const AccessorRW<T, 2> tile = derez.unpack_accessor_RW<T, 2>(regions[0], rect);
+  size_t strides[2];
+  T* ptr = tile.ptr(rect, strides);
+  assert(strides[1] == 1);
+  const int n   = (rect.hi[0] - rect.lo[0]) + 1;
+  const int lda = strides[0];
+  assert(n == ((rect.hi[1] - rect.lo[1]) + 1));
+  // A row-major lower triangle is a column-major upper triangle so
+  // we can factor in place without transposing the tile
+  int info = 0;
+  lapack_potrf("U", &n, ptr, &lda, &info);
+  if (info != 0) {
+    // Poison the tile so that a failed factor is never mistaken for a
+    // valid one, the caller checks the info of every diagonal tile
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++) ptr[i * lda + j] = std::numeric_limits<T>::quiet_NaN();
+    return info;
+  }
+  // Clear out the strict upper triangle
+  for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++) ptr[i * lda + j] = T(0);
+  return 0;
+}
+
+template <typename T>
+static void trsm_tile(const Task* task, const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const bool left  = derez.unpack_bool();
+  const bool lower = derez.unpack_bool();
+  const bool trans = derez.unpack_bool();
+  int dim          = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> b_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (b_rect.empty()) return;
+  const AccessorRW<T, 2> b = derez.unpack_accessor_RW<T, 2>(regions[0], b_rect);
+  dim                      = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> a_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  const AccessorRO<T, 2> a = derez.unpack_accessor_RO<T, 2>(regions[1], a_rect);
+  size_t b_strides[2], a_strides[2];
+  T* b_ptr       = b.ptr(b_rect, b_strides);
+  const T* a_ptr = a.ptr(a_rect, a_strides);
+  assert(b_strides[1] == 1);
+  assert(a_strides[1] == 1);
+  const coord_t m = (b_rect.hi[0] - b_rect.lo[0]) + 1;
+  const coord_t n = (b_rect.hi[1] - b_rect.lo[1]) + 1;
+  assert(((a_rect.hi[0] - a_rect.lo[0]) + 1) == (left ? m : n));
+  blas_trsm(left ? CblasLeft : CblasRight,
+            lower ? CblasLower : CblasUpper,
+            trans ? CblasTrans : CblasNoTrans,
+            m,
+            n,
+            a_ptr,
+            a_strides[0],
+            b_ptr,
+            b_strides[0]);
+}
+
+template <typename T>
+static void syrk_tile(const Task* task, const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  int dim = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> c_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (c_rect.empty()) return;
+  const AccessorRW<T, 2> c = derez.unpack_accessor_RW<T, 2>(regions[0], c_rect);
+  dim                      = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> a_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (a_rect.empty()) return;
+  const AccessorRO<T, 2> a = derez.unpack_accessor_RO<T, 2>(regions[1], a_rect);
+  size_t c_strides[2], a_strides[2];
+  T* c_ptr       = c.ptr(c_rect, c_strides);
+  const T* a_ptr = a.ptr(a_rect, a_strides);
+  assert(c_strides[1] == 1);
+  assert(a_strides[1] == 1);
+  const coord_t n = (c_rect.hi[0] - c_rect.lo[0]) + 1;
+  const coord_t k = (a_rect.hi[1] - a_rect.lo[1]) + 1;
+  assert(n == ((a_rect.hi[0] - a_rect.lo[0]) + 1));
+  blas_syrk(n, k, a_ptr, a_strides[0], c_ptr, c_strides[0]);
+}
+
+template <typename T>
+static void gemm_tile(const Task* task, const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const bool trans_a = derez.unpack_bool();
+  const bool trans_b = derez.unpack_bool();
+  int dim            = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> c_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (c_rect.empty()) return;
+  const AccessorRW<T, 2> c = derez.unpack_accessor_RW<T, 2>(regions[0], c_rect);
+  dim                      = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> a_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (a_rect.empty()) return;
+  const AccessorRO<T, 2> a = derez.unpack_accessor_RO<T, 2>(regions[1], a_rect);
+  dim                      = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> b_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (b_rect.empty()) return;
+  const AccessorRO<T, 2> b = derez.unpack_accessor_RO<T, 2>(regions[2], b_rect);
+  size_t c_strides[2], a_strides[2], b_strides[2];
+  T* c_ptr       = c.ptr(c_rect, c_strides);
+  const T* a_ptr = a.ptr(a_rect, a_strides);
+  const T* b_ptr = b.ptr(b_rect, b_strides);
+  assert(c_strides[1] == 1);
+  assert(a_strides[1] == 1);
+  assert(b_strides[1] == 1);
+  const coord_t m = (c_rect.hi[0] - c_rect.lo[0]) + 1;
+  const coord_t n = (c_rect.hi[1] - c_rect.lo[1]) + 1;
+  const coord_t k =
+    trans_a ? (a_rect.hi[0] - a_rect.lo[0]) + 1 : (a_rect.hi[1] - a_rect.lo[1]) + 1;
+  blas_gemm(trans_a ? CblasTrans : CblasNoTrans,
+            trans_b ? CblasTrans : CblasNoTrans,
+            m,
+            n,
+            k,
+            a_ptr,
+            a_strides[0],
+            b_ptr,
+            b_strides[0],
+            c_ptr,
+            c_strides[0]);
+}
+
+template <typename T>
+static void geqrf_tile(const Task* task, const std::vector<PhysicalRegion>& regions)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  int dim = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> r_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  if (r_rect.empty()) return;
+  const AccessorWO<T, 2> r = derez.unpack_accessor_WO<T, 2>(regions[0], r_rect);
+  dim                      = derez.unpack_dimension();
+  assert(dim == 2);
+  const Rect<2> a_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
+  const AccessorRO<T, 2> a = derez.unpack_accessor_RO<T, 2>(regions[1], a_rect);
+  const int k              = (r_rect.hi[1] - r_rect.lo[1]) + 1;
+  assert(k == ((r_rect.hi[0] - r_rect.lo[0]) + 1));
+  const int m = a_rect.empty() ? 0 : (a_rect.hi[0] - a_rect.lo[0]) + 1;
+  // Make a dense copy of our rows since LAPACK destroys its input. The
+  // copy is a row-major m x k matrix which is a column-major k x m matrix
+  // holding A^T, and the LQ factorization of A^T = R^T Q^T leaves R in the
+  // row-major upper triangle so we never have to transpose anything.
+  T* temp = (m > 0) ? (T*)malloc(m * k * sizeof(T)) : NULL;
+  if (m > 0) {
+    assert(a_rect.hi[1] - a_rect.lo[1] + 1 == k);
+    for (coord_t i = 0; i < m; i++)
+      for (coord_t j = 0; j < k; j++)
+        temp[i * k + j] = a[Point<2>(a_rect.lo[0] + i, a_rect.lo[1] + j)];
+    int info  = 0;
+    int lwork = -1;
+    T query;
+    T* tau = (T*)malloc(std::min(m, k) * sizeof(T));
+    lapack_gelqf(&k, &m, temp, &k, tau, &query, &lwork, &info);
+    assert(info == 0);
+    lwork   = std::max(1, static_cast<int>(query));
+    T* work = (T*)malloc(lwork * sizeof(T));
+    lapack_gelqf(&k, &m, temp, &k, tau, work, &lwork, &info);
+    assert(info == 0);
+    free(work);
+    free(tau);
+  }
+  // Only the first min(m, k) rows of R can be non-zero
+  const int rows = std::min(m, k);
+  for (int i = 0; i < k; i++)
+    for (int j = 0; j < k; j++)
+      r[Point<2>(r_rect.lo[0] + i, r_rect.lo[1] + j)] =
+        ((i < rows) && (j >= i)) ? temp[i * k + j] : T(0);
+  if (temp != NULL) free(temp);
+}
+
+#define LINALG_TILE_VARIANTS(TASK, FUNC, RETURN)                                            \
+  template <typename T>                                                                      \
+  /*static*/ RETURN TASK<T>::cpu_variant(const Task* task,                                   \
+                                         const std::vector<PhysicalRegion>& regions,         \
+                                         Context ctx,                                        \
+                                         Runtime* runtime)                                   \
+  {                                                                                          \
+    openblas_set_num_threads(1);                                                             \
+    return FUNC<T>(task, regions);                                                           \
+  }
+
+#define LINALG_TILE_OMP_VARIANTS(TASK, FUNC, RETURN)                                         \
+  template <typename T>                                                                      \
+  /*static*/ RETURN TASK<T>::omp_variant(const Task* task,                                   \
+                                         const std::vector<PhysicalRegion>& regions,         \
+                                         Context ctx,                                        \
+                                         Runtime* runtime)                                   \
+  {                                                                                          \
+    openblas_set_num_threads(omp_get_max_threads());                                         \
+    return FUNC<T>(task, regions);                                                           \
+  }
+
+LINALG_TILE_VARIANTS(PotrfTask, potrf_tile, int)
+LINALG_TILE_VARIANTS(TrsmTask, trsm_tile, void)
+LINALG_TILE_VARIANTS(SyrkTask, syrk_tile, void)
+LINALG_TILE_VARIANTS(GemmTask, gemm_tile, void)
+LINALG_TILE_VARIANTS(GeqrfTask, geqrf_tile, void)
+#ifdef LEGATE_USE_OPENMP
+LINALG_TILE_OMP_VARIANTS(PotrfTask, potrf_tile, int)
+LINALG_TILE_OMP_VARIANTS(TrsmTask, trsm_tile, void)
+LINALG_TILE_OMP_VARIANTS(SyrkTask, syrk_tile, void)
+LINALG_TILE_OMP_VARIANTS(GemmTask, gemm_tile, void)
+LINALG_TILE_OMP_VARIANTS(GeqrfTask, geqrf_tile, void)
+#endif
+
+// These are only supported for the types that LAPACK supports
+#define INSTANTIATE_LINALG_TASKS(type, base_id)                                \
+  template <>                                                                  \
+  const int type<float>::TASK_ID = base_id + FLOAT_LT* NUMPY_MAX_VARIANTS;     \
+  template class type<float>;                                                  \
+  template <>                                                                  \
+  const int type<double>::TASK_ID = base_id + DOUBLE_LT* NUMPY_MAX_VARIANTS;   \
+  template class type<double>;
+
+INSTANTIATE_LINALG_TASKS(PotrfTask, static_cast<int>(NumPyOpCode::NUMPY_POTRF) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_LINALG_TASKS(TrsmTask, static_cast<int>(NumPyOpCode::NUMPY_TRSM) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_LINALG_TASKS(SyrkTask, static_cast<int>(NumPyOpCode::NUMPY_SYRK) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_LINALG_TASKS(GemmTask, static_cast<int>(NumPyOpCode::NUMPY_GEMM) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_LINALG_TASKS(GeqrfTask, static_cast<int>(NumPyOpCode::NUMPY_GEQRF) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  legate::numpy::PotrfTask<float>::register_variants_with_return<int, int>();
+  legate::numpy::PotrfTask<double>::register_variants_with_return<int, int>();
+  legate::numpy::TrsmTask<float>::register_variants();
+  legate::numpy::TrsmTask<double>::register_variants();
+  legate::numpy::SyrkTask<float>::register_variants();
+  legate::numpy::SyrkTask<double>::register_variants();
+  legate::numpy::GemmTask<float>::register_variants();
+  legate::numpy::GemmTask<double>::register_variants();
+  legate::numpy::GeqrfTask<float>::register_variants();
+  legate::numpy::GeqrfTask<double>::register_variants();
+}
+}  // namespace
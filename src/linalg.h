@@ -0,0 +1,138 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_LINALG_H__
+#define __NUMPY_LINALG_H__
+
+#include "numpy.h"
+
+// Tile kernels for the task-based dense linear algebra in
+// legate/numpy/linalg/linalg.py. Each task works on a single 2-D tile
+// and the Python side builds the tiled algorithms out of them, leaving
+// it to Legion to find the parallelism between tiles.
+
+namespace legate {
+namespace numpy {
+
+// Cholesky factorization of a diagonal tile in place. The lower triangle
+// holds the factor afterwards and the strict upper triangle is zeroed.
+// Returns the LAPACK info value; on failure the tile is poisoned with
+// NaNs so that every later diagonal tile reports the failure as well.
+template <typename T>
+class PotrfTask : public NumPyTask<PotrfTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static int cpu_variant(const Legion::Task* task,
+                         const std::vector<Legion::PhysicalRegion>& regions,
+                         Legion::Context ctx,
+                         Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static int omp_variant(const Legion::Task* task,
+                         const std::vector<Legion::PhysicalRegion>& regions,
+                         Legion::Context ctx,
+                         Legion::Runtime* runtime);
+#endif
+};
+
+// Triangular solve with multiple right-hand sides: B := op(A)^-1 B
+// for the left side or B := B op(A)^-1 for the right side
+template <typename T>
+class TrsmTask : public NumPyTask<TrsmTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Symmetric rank-k update of the lower triangle: C := C - A A^T
+template <typename T>
+class SyrkTask : public NumPyTask<SyrkTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Tile update C := C - op(A) op(B)
+template <typename T>
+class GemmTask : public NumPyTask<GemmTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+// Computes the R factor of the QR factorization of a block of rows,
+// this is the leaf operation of a tall-skinny QR reduction tree
+template <typename T>
+class GeqrfTask : public NumPyTask<GeqrfTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_LINALG_H__
@@ -42,7 +42,8 @@ NumPyMapper::NumPyMapper(MapperRuntime* rt, Machine m, TaskID first, TaskID last
     min_omp_chunk(extract_env("NUMPY_MIN_OMP_CHUNK", 1 << 17, 2)),
     eager_fraction(extract_env("NUMPY_EAGER_FRACTION", 16, 1)),
     field_reuse_frac(extract_env("NUMPY_FIELD_REUSE_FRAC", 256, 256)),
-    field_reuse_freq(extract_env("NUMPY_FIELD_REUSE_FREQ", 32, 32))
+    field_reuse_freq(extract_env("NUMPY_FIELD_REUSE_FREQ", 32, 32)),
+    field_pool_frac(extract_env("NUMPY_FIELD_POOL_FRAC", 8, 8))
 //--------------------------------------------------------------------------
 {
   // Query to find all our local processors
@@ -123,7 +124,8 @@ NumPyMapper::NumPyMapper(const NumPyMapper& rhs)
     min_omp_chunk(0),
     eager_fraction(0),
     field_reuse_frac(0),
-    field_reuse_freq(0)
+    field_reuse_freq(0),
+    field_pool_frac(0)
 //--------------------------------------------------------------------------
 {
   // should never be called
@@ -634,6 +636,21 @@ bool NumPyMapper::map_numpy_array(const MapperContext ctx,
     // We already did the acquire
     return false;
   }
+  // Arrays backed by files are attached to a mapping of the whole file,
+  // which is usually much bigger than any of our memories. CPU tasks use
+  // the attachment in place and leave it to the kernel to page the tiles
+  // in and out. Everyone else gets copies of their tiles that we don't
+  // hold on to, so they can be collected once they are no longer needed.
+  PhysicalInstance file_instance;
+  if (find_file_backed_instance(ctx, region, fid, valid, file_instance)) {
+    if (target_proc.exists() && (target_memory.kind() != Memory::GPU_FB_MEM) &&
+        machine.has_affinity(target_proc, file_instance.get_location())) {
+      result = file_instance;
+      // Needs acquire to keep the runtime happy
+      return true;
+    }
+    memoize_result = false;
+  }
   // See if we already have it in our local instances
   const FieldMemInfo info_key(region.get_tree_id(), fid, target_memory);
   std::map<FieldMemInfo, InstanceInfos>::const_iterator finder = local_instances.find(info_key);
@@ -940,6 +957,37 @@ bool NumPyMapper::map_numpy_array(const MapperContext ctx,
   return true;
 }
 
+//--------------------------------------------------------------------------
+bool NumPyMapper::find_file_backed_instance(const MapperContext ctx,
+                                            LogicalRegion region,
+                                            FieldID fid,
+                                            const std::vector<PhysicalInstance>& valid,
+                                            PhysicalInstance& result)
+//--------------------------------------------------------------------------
+{
+  for (std::vector<PhysicalInstance>::const_iterator it = valid.begin(); it != valid.end();
+       it++) {
+    if (!it->is_external_instance() || !it->has_field(fid)) continue;
+    // Only the attachments of files are marked, the ones of NumPy
+    // arrays in memory we treat like any other instance
+    const void* value;
+    size_t size;
+    if (!runtime->retrieve_semantic_information(ctx,
+                                                region.get_field_space(),
+                                                fid,
+                                                NUMPY_FILE_BACKED_SEMANTIC_TAG,
+                                                value,
+                                                size,
+                                                true /*can fail*/,
+                                                false /*wait until ready*/))
+      return false;
+    if ((size != sizeof(bool)) || !*static_cast<const bool*>(value)) return false;
+    result = *it;
+    return true;
+  }
+  return false;
+}
+
 //--------------------------------------------------------------------------
 void NumPyMapper::filter_failed_acquires(std::vector<PhysicalInstance>& needed_acquires,
                                          std::set<PhysicalInstance>& failed_acquires)
@@ -2011,21 +2059,7 @@ void NumPyMapper::select_tunable_value(const MapperContext ctx,
       break;
     }
     case NUMPY_TUNABLE_FIELD_REUSE_SIZE: {
-      // We assume that all memories of the same kind are symmetric in size
-      size_t local_mem_size;
-      if (!local_gpus.empty()) {
-        assert(!local_frame_buffers.empty());
-        local_mem_size = local_frame_buffers.begin()->second.capacity();
-        local_mem_size *= local_frame_buffers.size();
-      } else if (!local_omps.empty()) {
-        assert(!local_numa_domains.empty());
-        local_mem_size = local_numa_domains.begin()->second.capacity();
-        local_mem_size *= local_numa_domains.size();
-      } else
-        local_mem_size = local_system_memory.capacity();
-      // Multiply this by the total number of nodes and then scale by the frac
-      const size_t global_mem_size  = local_mem_size * total_nodes;
-      const size_t field_reuse_size = global_mem_size / field_reuse_frac;
+      const size_t field_reuse_size = global_memory_size() / field_reuse_frac;
       // Pack this one explicity since it must be of size 8
       size_t* result = (size_t*)malloc(sizeof(field_reuse_size));
       *result        = field_reuse_size;
@@ -2033,6 +2067,16 @@ void NumPyMapper::select_tunable_value(const MapperContext ctx,
       output.size    = sizeof(field_reuse_size);
       break;
     }
+    case NUMPY_TUNABLE_FIELD_POOL_SIZE: {
+      // A fraction of zero turns off the size classes of the field pool
+      const size_t field_pool_size =
+        (field_pool_frac > 0) ? global_memory_size() / field_pool_frac : 0;
+      size_t* result = (size_t*)malloc(sizeof(field_pool_size));
+      *result        = field_pool_size;
+      output.value   = result;
+      output.size    = sizeof(field_pool_size);
+      break;
+    }
     case NUMPY_TUNABLE_FIELD_REUSE_FREQUENCY: {
       pack_tunable(field_reuse_freq, output);
       break;
@@ -2156,6 +2200,26 @@ void NumPyMapper::decode_task_id(TaskID tid,
   op_code = (NumPyOpCode)(tid / NUMPY_TYPE_OFFSET);
 }
 
+//--------------------------------------------------------------------------
+size_t NumPyMapper::global_memory_size(void) const
+//--------------------------------------------------------------------------
+{
+  // We assume that all memories of the same kind are symmetric in size
+  size_t local_mem_size;
+  if (!local_gpus.empty()) {
+    assert(!local_frame_buffers.empty());
+    local_mem_size = local_frame_buffers.begin()->second.capacity();
+    local_mem_size *= local_frame_buffers.size();
+  } else if (!local_omps.empty()) {
+    assert(!local_numa_domains.empty());
+    local_mem_size = local_numa_domains.begin()->second.capacity();
+    local_mem_size *= local_numa_domains.size();
+  } else
+    local_mem_size = local_system_memory.capacity();
+  // Multiply this by the total number of nodes
+  return local_mem_size * total_nodes;
+}
+
 //--------------------------------------------------------------------------
 /*static*/ unsigned NumPyMapper::extract_env(const char* env_name,
                                              const unsigned default_value,
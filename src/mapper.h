@@ -377,6 +377,11 @@ class NumPyMapper : public Legion::Mapping::Mapper {
                        Legion::Mapping::PhysicalInstance& result,
                        bool memoize,
                        Legion::ReductionOpID redop = 0);
+  bool find_file_backed_instance(const Legion::Mapping::MapperContext ctx,
+                                 Legion::LogicalRegion region,
+                                 Legion::FieldID fid,
+                                 const std::vector<Legion::Mapping::PhysicalInstance>& valid,
+                                 Legion::Mapping::PhysicalInstance& result);
   void filter_failed_acquires(std::vector<Legion::Mapping::PhysicalInstance>& needed_acquires,
                               std::set<Legion::Mapping::PhysicalInstance>& failed_acquires);
   void report_failed_mapping(const Legion::Mappable& mappable,
@@ -419,6 +424,7 @@ class NumPyMapper : public Legion::Mapping::Mapper {
                       NumPyOpCode& op_code,
                       LegateTypeCode& type_code,
                       NumPyVariantCode& variant_code);
+  size_t global_memory_size(void) const;
   static unsigned extract_env(const char* name,
                               const unsigned default_value,
                               const unsigned test_value);
@@ -437,6 +443,7 @@ class NumPyMapper : public Legion::Mapping::Mapper {
   const unsigned eager_fraction;
   const unsigned field_reuse_frac;
   const unsigned field_reuse_freq;
+  const unsigned field_pool_frac;
 
  protected:
   std::vector<Legion::Processor> local_cpus;
@@ -0,0 +1,220 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "mask.h"
+#include "point_task.h"
+#include "proj.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#ifdef LEGATE_USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+// Calls fn with every point of the tile where the mask is set and the
+// number of set points before it in C order. With threads every thread
+// counts its own chunk of the tile first to know where its points start.
+template <int DIM, typename F>
+static void for_each_masked(const AccessorRO<bool, DIM>& mask,
+                            const Rect<DIM>& rect,
+                            bool parallel,
+                            F&& fn)
+{
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (!parallel) {
+    coord_t count = 0;
+    for (size_t idx = 0; idx < volume; idx++) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      if (mask[p]) fn(p, count++);
+    }
+    return;
+  }
+#ifdef LEGATE_USE_OPENMP
+  std::vector<coord_t> offsets(omp_get_max_threads() + 1, 0);
+#pragma omp parallel
+  {
+    const int tid        = omp_get_thread_num();
+    const size_t threads = omp_get_num_threads();
+    const size_t chunk   = (volume + threads - 1) / threads;
+    const size_t lo      = std::min(volume, tid * chunk);
+    const size_t hi      = std::min(volume, lo + chunk);
+    coord_t count        = 0;
+    for (size_t idx = lo; idx < hi; idx++)
+      if (mask[pitches.unflatten(idx, rect.lo)]) count++;
+    offsets[tid + 1] = count;
+#pragma omp barrier
+#pragma omp single
+    std::partial_sum(offsets.begin(), offsets.begin() + threads + 1, offsets.begin());
+    count = offsets[tid];
+    for (size_t idx = lo; idx < hi; idx++) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      if (mask[p]) fn(p, count++);
+    }
+  }
+#else
+  assert(false);
+#endif
+}
+
+template <typename T, int DIM>
+static void masked_select(const Task* task,
+                          LegateDeserializer& derez,
+                          const std::vector<PhysicalRegion>& regions,
+                          bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  // Our range of the packed values is empty when none of our mask is set
+  const Rect<1> out_rect = regions[2];
+  if (out_rect.empty()) return;
+  const AccessorRO<T, DIM> in      = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  const AccessorRO<bool, DIM> mask = derez.unpack_accessor_RO<bool, DIM>(regions[1], rect);
+  const AccessorWO<T, 1> out       = derez.unpack_accessor_WO<T, 1>(regions[2], out_rect);
+  for_each_masked<DIM>(mask, rect, parallel, [&](const Point<DIM>& p, coord_t k) {
+    out[out_rect.lo[0] + k] = in[p];
+  });
+}
+
+template <typename T>
+static void masked_select_task(const Task* task,
+                               const std::vector<PhysicalRegion>& regions,
+                               bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                       \
+  case DIM: {                                              \
+    masked_select<T, DIM>(task, derez, regions, parallel); \
+    break;                                                 \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void MaskedSelectTask<T>::cpu_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  masked_select_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void MaskedSelectTask<T>::omp_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  masked_select_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T, int DIM>
+static void masked_assign(const Task* task,
+                          LegateDeserializer& derez,
+                          const std::vector<PhysicalRegion>& regions,
+                          bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorRW<T, DIM> out     = derez.unpack_accessor_RW<T, DIM>(regions[0], rect);
+  const AccessorRO<bool, DIM> mask = derez.unpack_accessor_RO<bool, DIM>(regions[1], rect);
+  const bool scalar                = derez.unpack_bool();
+  if (scalar) {
+    // Every set point gets the same value so there is nothing to count
+    const T value = task->futures[0].get_result<T>();
+    Pitches<DIM - 1> pitches;
+    const size_t volume = pitches.flatten(rect);
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      if (mask[p]) out[p] = value;
+    });
+  } else {
+    const Rect<1> in_rect = regions[2];
+    if (in_rect.empty()) return;
+    const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[2], in_rect);
+    for_each_masked<DIM>(mask, rect, parallel, [&](const Point<DIM>& p, coord_t k) {
+      out[p] = in[in_rect.lo[0] + k];
+    });
+  }
+}
+
+template <typename T>
+static void masked_assign_task(const Task* task,
+                               const std::vector<PhysicalRegion>& regions,
+                               bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                       \
+  case DIM: {                                              \
+    masked_assign<T, DIM>(task, derez, regions, parallel); \
+    break;                                                 \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+template <typename T>
+/*static*/ void MaskedAssignTask<T>::cpu_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  masked_assign_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void MaskedAssignTask<T>::omp_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  masked_assign_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+INSTANTIATE_ALL_TASKS(MaskedSelectTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_MASKED_SELECT) * NUMPY_TYPE_OFFSET)
+INSTANTIATE_ALL_TASKS(MaskedAssignTask,
+                      static_cast<int>(NumPyOpCode::NUMPY_MASKED_ASSIGN) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnamed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  REGISTER_ALL_TASKS(legate::numpy::MaskedSelectTask)
+  REGISTER_ALL_TASKS(legate::numpy::MaskedAssignTask)
+}
+}  // namespace
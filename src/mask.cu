@@ -0,0 +1,202 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "cuda_help.h"
+#include "mask.h"
+#include "point_task.h"
+#include "proj.h"
+#include <thrust/execution_policy.h>
+#include <thrust/scan.h>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+template <int DIM>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_mask_flags(const DeferredBuffer<coord_t, 1> offsets,
+                    const AccessorRO<bool, DIM> mask,
+                    const Pitches<DIM - 1> pitches,
+                    const Point<DIM> lo,
+                    const size_t volume)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= volume) return;
+  offsets[idx] = mask[pitches.unflatten(idx, lo)] ? 1 : 0;
+}
+
+// Same order as for_each_masked in mask.cc: the number of set points
+// before each point of the tile in C order
+template <int DIM>
+static DeferredBuffer<coord_t, 1> scan_mask(const AccessorRO<bool, DIM>& mask,
+                                            const Pitches<DIM - 1>& pitches,
+                                            const Rect<DIM>& rect,
+                                            const size_t volume)
+{
+  const Rect<1> bounds(Point<1>(0), Point<1>(volume - 1));
+  DeferredBuffer<coord_t, 1> offsets(Memory::GPU_FB_MEM, Domain(bounds));
+  const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+  legate_mask_flags<DIM><<<blocks, THREADS_PER_BLOCK>>>(offsets, mask, pitches, rect.lo, volume);
+  coord_t* ptr = offsets.ptr(0);
+  thrust::exclusive_scan(thrust::device, ptr, ptr + volume, ptr);
+  return offsets;
+}
+
+template <typename T, int DIM>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_masked_select(const AccessorWO<T, 1> out,
+                       const AccessorRO<T, DIM> in,
+                       const AccessorRO<bool, DIM> mask,
+                       const DeferredBuffer<coord_t, 1> offsets,
+                       const Pitches<DIM - 1> pitches,
+                       const Point<DIM> lo,
+                       const coord_t out_lo,
+                       const size_t volume)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= volume) return;
+  const Point<DIM> p = pitches.unflatten(idx, lo);
+  if (mask[p]) out[out_lo + offsets[idx]] = in[p];
+}
+
+template <typename T, int DIM>
+static void masked_select(const Task* task,
+                          LegateDeserializer& derez,
+                          const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  // Our range of the packed values is empty when none of our mask is set
+  const Rect<1> out_rect = regions[2];
+  if (out_rect.empty()) return;
+  const AccessorRO<T, DIM> in      = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  const AccessorRO<bool, DIM> mask = derez.unpack_accessor_RO<bool, DIM>(regions[1], rect);
+  const AccessorWO<T, 1> out       = derez.unpack_accessor_WO<T, 1>(regions[2], out_rect);
+  Pitches<DIM - 1> pitches;
+  const size_t volume                      = pitches.flatten(rect);
+  const DeferredBuffer<coord_t, 1> offsets = scan_mask<DIM>(mask, pitches, rect, volume);
+  const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+  legate_masked_select<T, DIM><<<blocks, THREADS_PER_BLOCK>>>(
+    out, in, mask, offsets, pitches, rect.lo, out_rect.lo[0], volume);
+}
+
+template <typename T>
+/*static*/ void MaskedSelectTask<T>::gpu_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                             \
+  case DIM: {                                    \
+    masked_select<T, DIM>(task, derez, regions); \
+    break;                                       \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+INSTANTIATE_TASK_VARIANT(MaskedSelectTask, gpu_variant)
+
+template <typename T, int DIM>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_masked_fill(const AccessorRW<T, DIM> out,
+                     const AccessorRO<bool, DIM> mask,
+                     const T value,
+                     const Pitches<DIM - 1> pitches,
+                     const Point<DIM> lo,
+                     const size_t volume)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= volume) return;
+  const Point<DIM> p = pitches.unflatten(idx, lo);
+  if (mask[p]) out[p] = value;
+}
+
+template <typename T, int DIM>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_masked_assign(const AccessorRW<T, DIM> out,
+                       const AccessorRO<T, 1> in,
+                       const AccessorRO<bool, DIM> mask,
+                       const DeferredBuffer<coord_t, 1> offsets,
+                       const Pitches<DIM - 1> pitches,
+                       const Point<DIM> lo,
+                       const coord_t in_lo,
+                       const size_t volume)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= volume) return;
+  const Point<DIM> p = pitches.unflatten(idx, lo);
+  if (mask[p]) out[p] = in[in_lo + offsets[idx]];
+}
+
+template <typename T, int DIM>
+static void masked_assign(const Task* task,
+                          LegateDeserializer& derez,
+                          const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorRW<T, DIM> out     = derez.unpack_accessor_RW<T, DIM>(regions[0], rect);
+  const AccessorRO<bool, DIM> mask = derez.unpack_accessor_RO<bool, DIM>(regions[1], rect);
+  const bool scalar                = derez.unpack_bool();
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+  if (scalar) {
+    // Every set point gets the same value so there is nothing to count
+    const T value = task->futures[0].get_result<T>();
+    legate_masked_fill<T, DIM>
+      <<<blocks, THREADS_PER_BLOCK>>>(out, mask, value, pitches, rect.lo, volume);
+  } else {
+    const Rect<1> in_rect = regions[2];
+    if (in_rect.empty()) return;
+    const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[2], in_rect);
+    const DeferredBuffer<coord_t, 1> offsets = scan_mask<DIM>(mask, pitches, rect, volume);
+    legate_masked_assign<T, DIM><<<blocks, THREADS_PER_BLOCK>>>(
+      out, in, mask, offsets, pitches, rect.lo, in_rect.lo[0], volume);
+  }
+}
+
+template <typename T>
+/*static*/ void MaskedAssignTask<T>::gpu_variant(const Task* task,
+                                                 const std::vector<PhysicalRegion>& regions,
+                                                 Context ctx,
+                                                 Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                             \
+  case DIM: {                                    \
+    masked_assign<T, DIM>(task, derez, regions); \
+    break;                                       \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+}
+
+INSTANTIATE_TASK_VARIANT(MaskedAssignTask, gpu_variant)
+
+}  // namespace numpy
+}  // namespace legate
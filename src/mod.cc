@@ -15,6 +15,8 @@
  */
 
 #include "mod.h"
+#include "int_divider.h"
+#include "point_task.h"
 #include "proj.h"
 #include <cmath>
 
@@ -317,87 +319,95 @@ template <typename T>
 }
 #endif
 
+template <typename T, int DIM>
+static void int_mod_broadcast(const Task* task,
+                              LegateDeserializer& derez,
+                              const std::vector<PhysicalRegion>& regions,
+                              bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  assert(task->futures.size() == 1);
+  const T in2 = task->futures[0].get_result<T>();
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  if (task->regions.size() == 1) {
+    const AccessorRW<T, DIM> out = derez.unpack_accessor_RW<T, DIM>(regions[0], rect);
+    const IntDivider<T> divider(in2);
+#ifndef LEGION_BOUNDS_CHECKS
+    if (out.accessor.is_dense_row_major(rect)) {
+      T* outptr = out.ptr(rect);
+      for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+        outptr[idx] = divider.remainder(outptr[idx]);
+      });
+      return;
+    }
+#endif
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      out[p]             = divider.remainder(out[p]);
+    });
+    return;
+  }
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const AccessorRO<T, DIM> in1 = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  const unsigned index         = derez.unpack_32bit_uint();
+  assert((index == 0) || (index == 1));
+  if (index == 0) {
+    // The scalar is the dividend so every element divides it differently
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      out[p]             = in2 % in1[p];
+    });
+    return;
+  }
+  const IntDivider<T> divider(in2);
+#ifndef LEGION_BOUNDS_CHECKS
+  if (out.accessor.is_dense_row_major(rect) && in1.accessor.is_dense_row_major(rect)) {
+    T* outptr      = out.ptr(rect);
+    const T* inptr = in1.ptr(rect);
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      outptr[idx] = divider.remainder(inptr[idx]);
+    });
+    return;
+  }
+#endif
+  for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+    const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+    out[p]             = divider.remainder(in1[p]);
+  });
+}
+
 template <typename T>
-/*static*/ void IntModBroadcast<T>::cpu_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
+static void int_mod_broadcast_task(const Task* task,
+                                   const std::vector<PhysicalRegion>& regions,
+                                   bool parallel)
 {
   LegateDeserializer derez(task->args, task->arglen);
   const int dim = derez.unpack_dimension();
-  assert(task->futures.size() == 1);
-  const T in2 = task->futures[0].get_result<T>();
   switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 1> out = derez.unpack_accessor_RW<T, 1>(regions[0], rect);
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] %= in2;
-      } else {
-        const AccessorWO<T, 1> out = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-        const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2 % in1[x];
-        } else {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x] % in2;
-        }
-      }
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 2> out = derez.unpack_accessor_RW<T, 2>(regions[0], rect);
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-          for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] %= in2;
-      } else {
-        const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-        const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2 % in1[x][y];
-        } else {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y] % in2;
-        }
-      }
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 3> out = derez.unpack_accessor_RW<T, 3>(regions[0], rect);
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-          for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-            for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] %= in2;
-      } else {
-        const AccessorWO<T, 3> out = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-        const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2 % in1[x][y][z];
-        } else {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z] % in2;
-        }
-      }
-      break;
-    }
+#define DIMFUNC(DIM)                                           \
+  case DIM: {                                                  \
+    int_mod_broadcast<T, DIM>(task, derez, regions, parallel); \
+    break;                                                     \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
     default: assert(false);
   }
 }
 
+// A scalar divisor is the same for every element, so the remainders come
+// from a precomputed multiply and shift instead of a hardware division
+template <typename T>
+/*static*/ void IntModBroadcast<T>::cpu_variant(const Task* task,
+                                                const std::vector<PhysicalRegion>& regions,
+                                                Context ctx,
+                                                Runtime* runtime)
+{
+  int_mod_broadcast_task<T>(task, regions, false /*parallel*/);
+}
+
 #ifdef LEGATE_USE_OPENMP
 template <typename T>
 /*static*/ void IntModBroadcast<T>::omp_variant(const Task* task,
@@ -405,88 +415,7 @@ template <typename T>
                                                 Context ctx,
                                                 Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  assert(task->futures.size() == 1);
-  const T in2 = task->futures[0].get_result<T>();
-  switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 1> out = derez.unpack_accessor_RW<T, 1>(regions[0], rect);
-#pragma omp parallel for
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] %= in2;
-      } else {
-        const AccessorWO<T, 1> out = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-        const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2 % in1[x];
-        } else {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x] % in2;
-        }
-      }
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 2> out = derez.unpack_accessor_RW<T, 2>(regions[0], rect);
-#pragma omp parallel for
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-          for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] %= in2;
-      } else {
-        const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-        const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2 % in1[x][y];
-        } else {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y] % in2;
-        }
-      }
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      if (task->regions.size() == 1) {
-        const AccessorRW<T, 3> out = derez.unpack_accessor_RW<T, 3>(regions[0], rect);
-#pragma omp parallel for
-        for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-          for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-            for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] %= in2;
-      } else {
-        const AccessorWO<T, 3> out = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-        const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
-        const unsigned index       = derez.unpack_32bit_uint();
-        assert((index == 0) || (index == 1));
-        if (index == 0) {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2 % in1[x][y][z];
-        } else {
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z] % in2;
-        }
-      }
-      break;
-    }
-    default: assert(false);
-  }
+  int_mod_broadcast_task<T>(task, regions, true /*parallel*/);
 }
 #endif
 
@@ -16,6 +16,7 @@
 
 #include "cuda_help.h"
 #include "mod.h"
+#include "int_divider.h"
 #include "proj.h"
 
 using namespace Legion;
@@ -377,6 +378,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_1d(const AccessorWO<T, 1> out,
                               const AccessorRO<T, 1> in1,
                               const T in2,
+                              const IntDivider<T> divider,
                               const Point<1> origin,
                               const size_t max)
 {
@@ -386,20 +388,20 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   if (FIRST)
     out[x] = in2 % in1[x];
   else
-    out[x] = in1[x] % in2;
+    out[x] = divider.remainder(in1[x]);
 }
 
 template <typename T>
 __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_1d_inplace(const AccessorRW<T, 1> out,
-                                      const T in,
+                                      const IntDivider<T> divider,
                                       const Point<1> origin,
                                       const size_t max)
 {
   const size_t offset = blockIdx.x * blockDim.x + threadIdx.x;
   if (offset >= max) return;
   const coord_t x = origin[0] + offset;
-  out[x] %= in;
+  out[x] = divider.remainder(out[x]);
 }
 
 template <typename T, bool FIRST>
@@ -407,6 +409,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_2d(const AccessorWO<T, 2> out,
                               const AccessorRO<T, 2> in1,
                               const T in2,
+                              const IntDivider<T> divider,
                               const Point<2> origin,
                               const Point<1> pitch,
                               const size_t max)
@@ -418,13 +421,13 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   if (FIRST)
     out[x][y] = in2 % in1[x][y];
   else
-    out[x][y] = in1[x][y] % in2;
+    out[x][y] = divider.remainder(in1[x][y]);
 }
 
 template <typename T>
 __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_2d_inplace(const AccessorRW<T, 2> out,
-                                      const T in,
+                                      const IntDivider<T> divider,
                                       const Point<2> origin,
                                       const Point<1> pitch,
                                       const size_t max)
@@ -433,7 +436,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   if (offset >= max) return;
   const coord_t x = origin[0] + offset / pitch[0];
   const coord_t y = origin[1] + offset % pitch[0];
-  out[x][y] %= in;
+  out[x][y] = divider.remainder(out[x][y]);
 }
 
 template <typename T, bool FIRST>
@@ -441,6 +444,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_3d(const AccessorWO<T, 3> out,
                               const AccessorRO<T, 3> in1,
                               const T in2,
+                              const IntDivider<T> divider,
                               const Point<3> origin,
                               const Point<2> pitch,
                               const size_t max)
@@ -453,13 +457,13 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   if (FIRST)
     out[x][y][z] = in2 % in1[x][y][z];
   else
-    out[x][y][z] = in1[x][y][z] % in2;
+    out[x][y][z] = divider.remainder(in1[x][y][z]);
 }
 
 template <typename T>
 __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   legate_int_mod_broadcast_3d_inplace(const AccessorRW<T, 3> out,
-                                      const T in,
+                                      const IntDivider<T> divider,
                                       const Point<3> origin,
                                       const Point<2> pitch,
                                       const size_t max)
@@ -469,7 +473,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   const coord_t x = origin[0] + offset / pitch[0];
   const coord_t y = origin[1] + (offset % pitch[0]) / pitch[1];
   const coord_t z = origin[2] + (offset % pitch[0]) % pitch[1];
-  out[x][y][z] %= in;
+  out[x][y][z] = divider.remainder(out[x][y][z]);
 }
 
 template <typename T>
@@ -482,6 +486,9 @@ template <typename T>
   const int dim = derez.unpack_dimension();
   assert(task->futures.size() == 1);
   const T in2 = task->futures[0].get_result<T>();
+  // Scalar divisors use the same divider as the CPU variants, which also
+  // makes the remainder of a division by zero zero
+  const IntDivider<T> divider(in2);
   switch (dim) {
     case 1: {
       const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
@@ -491,7 +498,7 @@ template <typename T>
         const size_t volume        = rect.volume();
         const size_t blocks        = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
         legate_int_mod_broadcast_1d_inplace<T>
-          <<<blocks, THREADS_PER_BLOCK>>>(out, in2, rect.lo, volume);
+          <<<blocks, THREADS_PER_BLOCK>>>(out, divider, rect.lo, volume);
       } else {
         const AccessorWO<T, 1> out = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
         const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
@@ -501,10 +508,10 @@ template <typename T>
         const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
         if (index == 0)
           legate_int_mod_broadcast_1d<T, true>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, volume);
+            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, divider, rect.lo, volume);
         else
           legate_int_mod_broadcast_1d<T, false>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, volume);
+            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, divider, rect.lo, volume);
       }
       break;
     }
@@ -517,7 +524,7 @@ template <typename T>
         const size_t blocks        = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
         const coord_t pitch        = rect.hi[1] - rect.lo[1] + 1;
         legate_int_mod_broadcast_2d_inplace<T>
-          <<<blocks, THREADS_PER_BLOCK>>>(out, in2, rect.lo, Point<1>(pitch), volume);
+          <<<blocks, THREADS_PER_BLOCK>>>(out, divider, rect.lo, Point<1>(pitch), volume);
       } else {
         const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
         const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
@@ -527,11 +534,11 @@ template <typename T>
         const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
         const coord_t pitch = rect.hi[1] - rect.lo[1] + 1;
         if (index == 0)
-          legate_int_mod_broadcast_2d<T, true>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<1>(pitch), volume);
+          legate_int_mod_broadcast_2d<T, true><<<blocks, THREADS_PER_BLOCK>>>(
+            out, in1, in2, divider, rect.lo, Point<1>(pitch), volume);
         else
-          legate_int_mod_broadcast_2d<T, false>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<1>(pitch), volume);
+          legate_int_mod_broadcast_2d<T, false><<<blocks, THREADS_PER_BLOCK>>>(
+            out, in1, in2, divider, rect.lo, Point<1>(pitch), volume);
       }
       break;
     }
@@ -546,7 +553,7 @@ template <typename T>
         const coord_t diffz        = rect.hi[2] - rect.lo[2] + 1;
         const coord_t pitch[2]     = {diffy * diffz, diffz};
         legate_int_mod_broadcast_3d_inplace<T>
-          <<<blocks, THREADS_PER_BLOCK>>>(out, in2, rect.lo, Point<2>(pitch), volume);
+          <<<blocks, THREADS_PER_BLOCK>>>(out, divider, rect.lo, Point<2>(pitch), volume);
       } else {
         const AccessorWO<T, 3> out = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
         const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
@@ -558,11 +565,11 @@ template <typename T>
         const coord_t diffz    = rect.hi[2] - rect.lo[2] + 1;
         const coord_t pitch[2] = {diffy * diffz, diffz};
         if (index == 0)
-          legate_int_mod_broadcast_3d<T, true>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<2>(pitch), volume);
+          legate_int_mod_broadcast_3d<T, true><<<blocks, THREADS_PER_BLOCK>>>(
+            out, in1, in2, divider, rect.lo, Point<2>(pitch), volume);
         else
-          legate_int_mod_broadcast_3d<T, false>
-            <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<2>(pitch), volume);
+          legate_int_mod_broadcast_3d<T, false><<<blocks, THREADS_PER_BLOCK>>>(
+            out, in1, in2, divider, rect.lo, Point<2>(pitch), volume);
       }
       break;
     }
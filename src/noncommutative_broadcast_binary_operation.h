@@ -47,6 +47,20 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
     }
   }
 }
+
+template <int DIM, typename ScalarOperation, typename Args>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  gpu_scalar_rhs_op(const Args args, const ScalarOperation op, const bool dense)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= args.volume) return;
+  if (dense) {
+    args.outptr[idx] = op(args.inptr[idx]);
+  } else {
+    const Legion::Point<DIM> point = args.pitches.unflatten(idx, args.rect.lo);
+    args.out[point]                = op(args.in[point]);
+  }
+}
 #endif
 
 // Base class for all Legate's noncommutative binary operation tasks
@@ -112,13 +126,14 @@ class NoncommutativeBroadcastBinaryOperationTask : public PointTask<Derived> {
     if (args.volume == 0) return;
     BinaryFunction func;
     if (args.scalar_on_rhs) {
-      if (dense) {
-        for (size_t idx = 0; idx < args.volume; ++idx)
-          args.outptr[idx] = func(args.inptr[idx], args.scalar);
-      } else {
-        const Scalar<second_argument_type, DIM> scalar(args.scalar);
-        CPULoop<DIM>::binary_loop(func, args.out, args.in, scalar, args.rect);
-      }
+      const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+      rhs_op.visit([&](const auto& op) {
+        if (dense) {
+          for (size_t idx = 0; idx < args.volume; ++idx) args.outptr[idx] = op(args.inptr[idx]);
+        } else {
+          CPULoop<DIM>::unary_loop(op, args.out, args.in, args.rect);
+        }
+      });
     } else {
       if (dense) {
         for (size_t idx = 0; idx < args.volume; ++idx)
@@ -141,14 +156,15 @@ class NoncommutativeBroadcastBinaryOperationTask : public PointTask<Derived> {
     if (args.volume == 0) return;
     BinaryFunction func;
     if (args.scalar_on_rhs) {
-      if (dense) {
+      const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+      rhs_op.visit([&](const auto& op) {
+        if (dense) {
 #pragma omp parallel for schedule(static)
-        for (size_t idx = 0; idx < args.volume; ++idx)
-          args.outptr[idx] = func(args.inptr[idx], args.scalar);
-      } else {
-        const Scalar<second_argument_type, DIM> scalar(args.scalar);
-        OMPLoop<DIM>::binary_loop(func, args.out, args.in, scalar, args.rect);
-      }
+          for (size_t idx = 0; idx < args.volume; ++idx) args.outptr[idx] = op(args.inptr[idx]);
+        } else {
+          OMPLoop<DIM>::unary_loop(op, args.out, args.in, args.rect);
+        }
+      });
     } else {
       if (dense) {
 #pragma omp parallel for schedule(static)
@@ -170,6 +186,27 @@ class NoncommutativeBroadcastBinaryOperationTask : public PointTask<Derived> {
     DeserializedArgs<DIM> args;
     const bool dense = args.deserialize(derez, task, regions);
     if (args.volume == 0) return;
+    launch_gpu<DIM>(
+      args,
+      dense,
+      std::integral_constant<bool, ScalarRhsOperation<BinaryFunction>::on_device>{});
+  }
+
+  template <int DIM>
+  static void launch_gpu(const DeserializedArgs<DIM>& args, const bool dense, std::true_type)
+  {
+    if (!args.scalar_on_rhs) {
+      launch_gpu<DIM>(args, dense, std::false_type{});
+      return;
+    }
+    const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    const ScalarRhsOperation<BinaryFunction> rhs_op(args.scalar);
+    gpu_scalar_rhs_op<DIM><<<blocks, THREADS_PER_BLOCK>>>(args, rhs_op, dense);
+  }
+
+  template <int DIM>
+  static void launch_gpu(const DeserializedArgs<DIM>& args, const bool dense, std::false_type)
+  {
     const size_t blocks = (args.volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
     gpu_noncommutative_broadcast_binary_op<DIM, BinaryFunction, DeserializedArgs<DIM>>
       <<<blocks, THREADS_PER_BLOCK>>>(args, dense);
@@ -15,6 +15,7 @@
  */
 
 #include "nonzero.h"
+#include "point_task.h"
 #include "proj.h"
 #include <algorithm>
 #include <numeric>
@@ -581,11 +582,47 @@ template <typename T>
 }
 #endif
 
+// The rectangle of the range [lo, hi) of the output, which covers every
+// dimension of the coordinates for nonzero and is just the range for the
+// vectors of masked values
+template <int DIM>
+static inline Rect<DIM> range_rect(coord_t nonzero_dim, coord_t lo, coord_t hi);
+
+template <>
+inline Rect<1> range_rect<1>(coord_t nonzero_dim, coord_t lo, coord_t hi)
+{
+  return Rect<1>(Point<1>(lo), Point<1>(hi - 1));
+}
+
+template <>
+inline Rect<2> range_rect<2>(coord_t nonzero_dim, coord_t lo, coord_t hi)
+{
+  coord_t pt1[2] = {0, lo};
+  coord_t pt2[2] = {nonzero_dim, hi - 1};
+  return Rect<2>(Point<2>(pt1), Point<2>(pt2));
+}
+
+template <typename T, int DIM>
+static void convert_range_to_rect(LegateDeserializer& derez,
+                                  const std::vector<PhysicalRegion>& regions,
+                                  const AccessorRO<T, 1>& in,
+                                  const Rect<1>& rect,
+                                  coord_t nonzero_dim,
+                                  bool parallel)
+{
+  const AccessorRW<Rect<DIM>, 1> out = derez.unpack_accessor_RW<Rect<DIM>, 1>(regions[1], rect);
+
+  auto ptr = out.ptr(rect);
+  new (ptr) Rect<DIM>(range_rect<DIM>(nonzero_dim, 0, in[rect.lo[0]]));
+  for_each_index(rect.lo[0] + 1, rect.hi[0] + 1, parallel, [&](coord_t x) {
+    new (ptr + (x - rect.lo[0])) Rect<DIM>(range_rect<DIM>(nonzero_dim, in[x - 1], in[x]));
+  });
+}
+
 template <typename T>
-void ConvertRangeToRectTask<T>::cpu_variant(const Task* task,
-                                            const std::vector<PhysicalRegion>& regions,
-                                            Context ctx,
-                                            Runtime* runtime)
+static void convert_range_to_rect_task(const Task* task,
+                                       const std::vector<PhysicalRegion>& regions,
+                                       bool parallel)
 {
   LegateDeserializer derez(task->args, task->arglen);
   const coord_t nonzero_dim = derez.unpack_32bit_int();
@@ -593,20 +630,21 @@ void ConvertRangeToRectTask<T>::cpu_variant(const Task* task,
   assert(dim == 1);
   const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
   assert(!rect.empty());
-  const auto begin                 = rect.lo[0];
-  const auto end                   = rect.hi[0];
-  const AccessorRO<T, 1> in        = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
-  const AccessorRW<Rect<2>, 1> out = derez.unpack_accessor_RW<Rect<2>, 1>(regions[1], rect);
+  const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
+  // A negative dimension asks for the ranges of a vector
+  if (nonzero_dim < 0)
+    convert_range_to_rect<T, 1>(derez, regions, in, rect, nonzero_dim, parallel);
+  else
+    convert_range_to_rect<T, 2>(derez, regions, in, rect, nonzero_dim, parallel);
+}
 
-  auto ptr       = out.ptr(rect);
-  coord_t pt1[2] = {0, 0};
-  coord_t pt2[2] = {nonzero_dim, static_cast<coord_t>(in[rect.lo[0]] - 1)};
-  new (ptr) Rect<2>(Point<2>(pt1), Point<2>(pt2));
-  for (coord_t x = begin + 1; x <= end; x++) {
-    coord_t pt1[2] = {0, static_cast<coord_t>(in[x - 1])};
-    coord_t pt2[2] = {nonzero_dim, static_cast<coord_t>(in[x] - 1)};
-    new (ptr + x) Rect<2>(Point<2>(pt1), Point<2>(pt2));
-  }
+template <typename T>
+void ConvertRangeToRectTask<T>::cpu_variant(const Task* task,
+                                            const std::vector<PhysicalRegion>& regions,
+                                            Context ctx,
+                                            Runtime* runtime)
+{
+  convert_range_to_rect_task<T>(task, regions, false /*parallel*/);
 };
 
 #ifdef LEGATE_USE_OPENMP
@@ -616,27 +654,7 @@ void ConvertRangeToRectTask<T>::omp_variant(const Task* task,
                                             Context ctx,
                                             Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const coord_t nonzero_dim = derez.unpack_32bit_int();
-  const int dim             = derez.unpack_dimension();
-  assert(dim == 1);
-  const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-  assert(!rect.empty());
-  const auto begin                 = rect.lo[0];
-  const auto end                   = rect.hi[0];
-  const AccessorRO<T, 1> in        = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
-  const AccessorRW<Rect<2>, 1> out = derez.unpack_accessor_RW<Rect<2>, 1>(regions[1], rect);
-
-  auto ptr       = out.ptr(rect);
-  coord_t pt1[2] = {0, 0};
-  coord_t pt2[2] = {nonzero_dim, static_cast<coord_t>(in[rect.lo[0]] - 1)};
-  new (ptr) Rect<2>(Point<2>(pt1), Point<2>(pt2));
-#pragma omp parallel for
-  for (coord_t x = begin + 1; x <= end; x++) {
-    coord_t pt1[2] = {0, static_cast<coord_t>(in[x - 1])};
-    coord_t pt2[2] = {nonzero_dim, static_cast<coord_t>(in[x] - 1)};
-    new (ptr + x) Rect<2>(Point<2>(pt1), Point<2>(pt2));
-  }
+  convert_range_to_rect_task<T>(task, regions, true /*parallel*/);
 };
 #endif  // LEGATE_USE_OPENMP
 
@@ -819,6 +819,27 @@ struct MakeRect {
 
   coord_t nonzero_dim;
 };
+
+struct MakeRange {
+  template <typename T>
+  __CUDA_HD__ Rect<1> operator()(const T lo, const T hi)
+  {
+    return Rect<1>{Point<1>(static_cast<coord_t>(lo)), Point<1>(static_cast<coord_t>(hi) - 1)};
+  }
+};
+
+template <typename T, int DIM, typename MAKE>
+static void write_rects(const AccessorRW<Rect<DIM>, 1>& out,
+                        const Rect<1>& rect,
+                        DeferredBuffer<T, 1>& buffer,
+                        size_t size,
+                        MAKE make)
+{
+  auto out_iter = make_accessor_iterator(out, rect);
+  thrust::uninitialized_fill(thrust::device, out_iter, out_iter + size, Rect<DIM>{});
+  thrust::transform(
+    thrust::device, buffer.ptr(0), buffer.ptr(0) + size, buffer.ptr(0) + 1, out_iter, make);
+}
 }  // namespace detail
 
 template <typename T>
@@ -833,27 +854,26 @@ template <typename T>
   assert(dim == 1);
   const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
   assert(!rect.empty());
-  const auto begin                 = rect.lo[0];
-  const auto end                   = rect.hi[0];
-  const AccessorRO<T, 1> in        = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
-  const AccessorRW<Rect<2>, 1> out = derez.unpack_accessor_RW<Rect<2>, 1>(regions[1], rect);
-  auto in_iter                     = make_accessor_iterator(in, rect);
-  auto out_iter                    = make_accessor_iterator(out, rect);
-  auto const size                  = rect.volume();
+  const auto begin          = rect.lo[0];
+  const auto end            = rect.hi[0];
+  const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
+  auto in_iter              = make_accessor_iterator(in, rect);
+  auto const size           = rect.volume();
 
   Rect<1> bounds(Point<1>(0), Point<1>(size + 1));
   auto buffer = DeferredBuffer<T, 1>(Memory::GPU_FB_MEM, Domain(bounds));
-  thrust::uninitialized_fill(thrust::device, out_iter, out_iter + size, Rect<2>{});
   // We just really need to initialize the first value to 0, but uninitialized fill of the whole
   // buffer is just easier to do
   thrust::uninitialized_fill(thrust::device, buffer.ptr(0), buffer.ptr(0) + size + 1, 0);
   thrust::copy(thrust::device, in_iter, in_iter + size, buffer.ptr(0) + 1);
-  thrust::transform(thrust::device,
-                    buffer.ptr(0),
-                    buffer.ptr(0) + size,
-                    buffer.ptr(0) + 1,
-                    out_iter,
-                    detail::MakeRect{nonzero_dim});
+  // A negative dimension asks for the ranges of a vector
+  if (nonzero_dim < 0) {
+    const AccessorRW<Rect<1>, 1> out = derez.unpack_accessor_RW<Rect<1>, 1>(regions[1], rect);
+    detail::write_rects(out, rect, buffer, size, detail::MakeRange{});
+  } else {
+    const AccessorRW<Rect<2>, 1> out = derez.unpack_accessor_RW<Rect<2>, 1>(regions[1], rect);
+    detail::write_rects(out, rect, buffer, size, detail::MakeRect{nonzero_dim});
+  }
 }
 
 INSTANTIATE_INT_VARIANT(ConvertRangeToRectTask, gpu_variant)
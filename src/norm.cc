@@ -15,155 +15,166 @@
  */
 
 #include "norm.h"
+#include "point_task.h"
 #include "proj.h"
 #ifdef LEGATE_USE_OPENMP
 #include <alloca.h>
 #include <omp.h>
 #endif
 
+// Number of elements the nrm2 kernel scales at a time
+#define NRM2_BLOCK 256
+
 using namespace Legion;
 
 namespace legate {
 namespace numpy {
 
-template <typename T>
-/*static*/ void NormTask<T>::cpu_variant(const Task* task,
-                                         const std::vector<PhysicalRegion>& regions,
-                                         Context ctx,
-                                         Runtime* runtime)
+template <typename T, int DIM>
+static void norm_initialize(const Task* task,
+                            LegateDeserializer& derez,
+                            const std::vector<PhysicalRegion>& regions,
+                            const int collapse_dim,
+                            bool parallel)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  // Still need to unpack the axis
-  derez.unpack_dimension();
-  const int collapse_dim = derez.unpack_dimension();
-  const int init_dim     = derez.unpack_dimension();
-  switch (init_dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) return;
-      const AccessorWO<T, 1> out =
-        (collapse_dim >= 0) ? derez.unpack_accessor_WO<T, 1>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = SumReduction<T>::identity;
-      break;
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out =
+    (collapse_dim >= 0) ? derez.unpack_accessor_WO<T, DIM>(
+                            regions[0], rect, collapse_dim, task->index_point[collapse_dim])
+                        : derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+    out[pitches.unflatten(idx, rect.lo)] = SumReduction<T>::identity;
+  });
+}
+
+// Sums the powers of the elements along the reduction axis into the output.
+// Both sides are walked through raw pointers one row of the last dimension
+// at a time. When the last dimension is the one being reduced the output
+// stride along it is zero and the row collapses into a register before it
+// is folded into the output, otherwise every element of the row lands in a
+// different output. Either way the inner loop is dense for the usual
+// layouts so the compiler can vectorize it.
+template <typename T, int DIM>
+class AxisNorm {
+ public:
+  AxisNorm(T* out, const size_t* out_strides, const T* in, const size_t* in_strides,
+           const Rect<DIM>& bounds, const NormPower<T>& p)
+    : out_ptr(out), in_ptr(in), rect(bounds), power(p)
+  {
+    for (int d = 0; d < DIM; d++) {
+      out_pitch[d] = out_strides[d];
+      in_pitch[d]  = in_strides[d];
     }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) return;
-      const AccessorWO<T, 2> out =
-        (collapse_dim >= 0) ? derez.unpack_accessor_WO<T, 2>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = SumReduction<T>::identity;
-      break;
+    Rect<DIM - 1> outer;
+    for (int d = 0; d < (DIM - 1); d++) {
+      outer.lo[d] = rect.lo[d];
+      outer.hi[d] = rect.hi[d];
     }
-    default: assert(false);  // shouldn't see any other cases
+    rows = row_pitches.flatten(outer);
   }
-  const int dim   = derez.unpack_dimension();
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
-  switch (dim) {
-    // Should never get the case of 1 as this would just be a copy since
-    // reducing our only dimension should have called SumReducTask
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) return;
-      const AccessorRW<T, 2> inout =
-        (collapse_dim >= 0) ? derez.unpack_accessor_RW<T, 2, 1>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_RW<T, 2>(regions[0], rect);
-      const AccessorRO<T, 2> in = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
-      switch (order) {
-        case 1: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-              T val = in[x][y];
-              if (val < T{0}) val = -val;
-              SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-            }
-          break;
-        }
-        case 2: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-              T val = in[x][y];
-              ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-              SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-            }
-          break;
-        }
-        default: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-              T val = in[x][y];
-              if (val < T{0}) val = -val;
-              T prod = val;
-              for (int i = 0; i < (order - 1); i++)
-                ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-              SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], prod);
-            }
-          break;
+
+ public:
+  // Process the rows in [row_lo, row_hi) for the columns in [col_lo, col_hi)
+  void run(size_t row_lo, size_t row_hi, coord_t col_lo, coord_t col_hi) const
+  {
+    const size_t out_col = out_pitch[DIM - 1];
+    const size_t in_col  = in_pitch[DIM - 1];
+    Point<DIM - 1> lo;
+    for (int d = 0; d < (DIM - 1); d++) lo[d] = rect.lo[d];
+    for (size_t row = row_lo; row < row_hi; row++) {
+      const Point<DIM - 1> point = row_pitches.unflatten(row, lo);
+      size_t out_offset          = col_lo * out_col;
+      size_t in_offset           = col_lo * in_col;
+      for (int d = 0; d < (DIM - 1); d++) {
+        out_offset += (point[d] - rect.lo[d]) * out_pitch[d];
+        in_offset += (point[d] - rect.lo[d]) * in_pitch[d];
+      }
+      T* out            = out_ptr + out_offset;
+      const T* in       = in_ptr + in_offset;
+      const coord_t num = col_hi - col_lo;
+      if (out_col == 0) {
+        T value = SumReduction<T>::identity;
+        if (in_col == 1) {
+          for (coord_t c = 0; c < num; c++)
+            SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[c]));
+        } else {
+          for (coord_t c = 0; c < num; c++)
+            SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[c * in_col]));
         }
+        SumReduction<T>::template fold<true /*exclusive*/>(out[0], value);
+      } else if ((out_col == 1) && (in_col == 1)) {
+        for (coord_t c = 0; c < num; c++)
+          SumReduction<T>::template fold<true /*exclusive*/>(out[c], power(in[c]));
+      } else {
+        for (coord_t c = 0; c < num; c++)
+          SumReduction<T>::template fold<true /*exclusive*/>(out[c * out_col],
+                                                             power(in[c * in_col]));
       }
-      break;
     }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) return;
-      const AccessorRW<T, 3> inout =
-        (collapse_dim >= 0) ? derez.unpack_accessor_RW<T, 3, 2>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_RW<T, 3>(regions[0], rect);
-      const AccessorRO<T, 3> in = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
-      switch (order) {
-        case 1: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                T val = in[x][y][z];
-                if (val < T{0}) val = -val;
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-              }
-          break;
-        }
-        case 2: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                T val = in[x][y][z];
-                ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-              }
-          break;
-        }
-        default: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                T val = in[x][y][z];
-                if (val < T{0}) val = -val;
-                T prod = val;
-                for (int i = 0; i < (order - 1); i++)
-                  ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], prod);
-              }
-          break;
-        }
+  }
+
+ public:
+  size_t rows;
+
+ private:
+  T* const out_ptr;
+  const T* const in_ptr;
+  const Rect<DIM> rect;
+  const NormPower<T> power;
+  size_t out_pitch[DIM];
+  size_t in_pitch[DIM];
+  Pitches<DIM - 2> row_pitches;
+};
+
+template <typename T, int DIM>
+static void norm_axis(const Task* task,
+                      LegateDeserializer& derez,
+                      const std::vector<PhysicalRegion>& regions,
+                      const int axis,
+                      const int collapse_dim,
+                      const NormPower<T>& power,
+                      bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorRW<T, DIM> inout =
+    (collapse_dim >= 0) ? derez.unpack_accessor_RW<T, DIM, DIM - 1>(
+                            regions[0], rect, collapse_dim, task->index_point[collapse_dim])
+                        : derez.unpack_accessor_RW<T, DIM>(regions[0], rect);
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  size_t out_strides[DIM], in_strides[DIM];
+  T* out_ptr      = inout.ptr(rect, out_strides);
+  const T* in_ptr = in.ptr(rect, in_strides);
+  const AxisNorm<T, DIM> kernel(out_ptr, out_strides, in_ptr, in_strides, rect, power);
+  const coord_t cols = rect.hi[DIM - 1] - rect.lo[DIM - 1] + 1;
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+    if (axis == (DIM - 1)) {
+      // Every row has its own output so the rows can go in parallel
+#pragma omp parallel for schedule(static)
+      for (size_t row = 0; row < kernel.rows; row++) kernel.run(row, row + 1, 0, cols);
+    } else {
+      // Rows share outputs so hand each thread its own columns instead
+      const int threads   = omp_get_max_threads();
+      const coord_t chunk = (cols + threads - 1) / threads;
+#pragma omp parallel for schedule(static)
+      for (int t = 0; t < threads; t++) {
+        const coord_t lo = t * chunk;
+        const coord_t hi = ((lo + chunk) < cols) ? (lo + chunk) : cols;
+        if (lo < hi) kernel.run(0, kernel.rows, lo, hi);
       }
-      break;
     }
-    default: assert(false);
+    return;
   }
+#endif
+  kernel.run(0, kernel.rows, 0, cols);
 }
 
-#ifdef LEGATE_USE_OPENMP
 template <typename T>
-/*static*/ void NormTask<T>::omp_variant(const Task* task,
-                                         const std::vector<PhysicalRegion>& regions,
-                                         Context ctx,
-                                         Runtime* runtime)
+static void norm_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
 {
   LegateDeserializer derez(task->args, task->arglen);
   const int axis         = derez.unpack_dimension();
@@ -171,208 +182,127 @@ template <typename T>
   const int init_dim     = derez.unpack_dimension();
   switch (init_dim) {
     case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) return;
-      const AccessorWO<T, 1> out =
-        (collapse_dim >= 0) ? derez.unpack_accessor_WO<T, 1>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-#pragma omp parallel for
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = SumReduction<T>::identity;
+      norm_initialize<T, 1>(task, derez, regions, collapse_dim, parallel);
       break;
     }
     case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) return;
-      const AccessorWO<T, 2> out =
-        (collapse_dim >= 0) ? derez.unpack_accessor_WO<T, 2>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-#pragma omp parallel for
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = SumReduction<T>::identity;
+      norm_initialize<T, 2>(task, derez, regions, collapse_dim, parallel);
       break;
     }
     default: assert(false);  // shouldn't see any other cases
   }
-  const int dim   = derez.unpack_dimension();
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
+  const int dim = derez.unpack_dimension();
+  const NormPower<T> power(task->futures[0].get_result<double>());
   switch (dim) {
     // Should never get the case of 1 as this would just be a copy since
     // reducing our only dimension should have called SumReducTask
     case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) return;
-      const AccessorRW<T, 2> inout =
-        (collapse_dim >= 0) ? derez.unpack_accessor_RW<T, 2, 1>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_RW<T, 2>(regions[0], rect);
-      const AccessorRO<T, 2> in = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
-      switch (order) {
-        case 1: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-                T val = in[x][y];
-                if (val < T{0}) val = -val;
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-              }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-                T val = in[x][y];
-                if (val < T{0}) val = -val;
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-              }
-          }
-          break;
-        }
-        case 2: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-                T val = in[x][y];
-                ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-              }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-                T val = in[x][y];
-                ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], val);
-              }
-          }
-          break;
-        }
-        default: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-                T val = in[x][y];
-                if (val < T{0}) val = -val;
-                T prod = val;
-                for (int i = 0; i < (order - 1); i++)
-                  ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], prod);
-              }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) {
-                T val = in[x][y];
-                if (val < T{0}) val = -val;
-                T prod = val;
-                for (int i = 0; i < (order - 1); i++)
-                  ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-                SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y], prod);
-              }
-          }
-          break;
-        }
-      }
+      norm_axis<T, 2>(task, derez, regions, axis, collapse_dim, power, parallel);
       break;
     }
     case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) return;
-      const AccessorRW<T, 3> inout =
-        (collapse_dim >= 0) ? derez.unpack_accessor_RW<T, 3, 2>(
-                                regions[0], rect, collapse_dim, task->index_point[collapse_dim])
-                            : derez.unpack_accessor_RW<T, 3>(regions[0], rect);
-      const AccessorRO<T, 3> in = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
-      switch (order) {
-        case 1: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  if (val < T{0}) val = -val;
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-                }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  if (val < T{0}) val = -val;
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-                }
-          }
-          break;
-        }
-        case 2: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  ProdReduction<T>::template fold<true /*excluisve*/>(val, val);
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-                }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], val);
-                }
-          }
-          break;
-        }
-        default: {
-          if (axis == 0) {
-// Flip dimension order to avoid races between threads on the collapsing dim
-#pragma omp parallel for
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  if (val < T{0}) val = -val;
-                  T prod = val;
-                  for (int i = 0; i < (order - 1); i++)
-                    ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], prod);
-                }
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) {
-                  T val = in[x][y][z];
-                  if (val < T{0}) val = -val;
-                  T prod = val;
-                  for (int i = 0; i < (order - 1); i++)
-                    ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-                  SumReduction<T>::template fold<true /*exclusive*/>(inout[x][y][z], prod);
-                }
-          }
-          break;
-        }
-      }
+      norm_axis<T, 3>(task, derez, regions, axis, collapse_dim, power, parallel);
       break;
     }
     default: assert(false);
   }
 }
+
+template <typename T>
+/*static*/ void NormTask<T>::cpu_variant(const Task* task,
+                                         const std::vector<PhysicalRegion>& regions,
+                                         Context ctx,
+                                         Runtime* runtime)
+{
+  norm_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void NormTask<T>::omp_variant(const Task* task,
+                                         const std::vector<PhysicalRegion>& regions,
+                                         Context ctx,
+                                         Runtime* runtime)
+{
+  norm_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+// Sums the powers of the elements in [lo, hi) of the flattened rectangle
+template <typename T, int DIM>
+static T norm_sum(const AccessorRO<T, DIM>& in,
+                  const T* ptr,
+                  const Pitches<DIM - 1>& pitches,
+                  const Rect<DIM>& rect,
+                  const NormPower<T>& power,
+                  size_t lo,
+                  size_t hi)
+{
+  T result = SumReduction<T>::identity;
+  if (ptr != NULL) {
+    for (size_t idx = lo; idx < hi; idx++)
+      SumReduction<T>::template fold<true /*exclusive*/>(result, power(ptr[idx]));
+  } else {
+    for (size_t idx = lo; idx < hi; idx++)
+      SumReduction<T>::template fold<true /*exclusive*/>(
+        result, power(in[pitches.unflatten(idx, rect.lo)]));
+  }
+  return result;
+}
+
+template <typename T, int DIM>
+static T norm_reduce(const Task* task,
+                     LegateDeserializer& derez,
+                     const std::vector<PhysicalRegion>& regions,
+                     const NormPower<T>& power,
+                     bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return SumReduction<T>::identity;
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  const T* ptr        = in.accessor.is_dense_row_major(rect) ? in.ptr(rect) : NULL;
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+    const int max_threads = omp_get_max_threads();
+    T* results            = (T*)alloca(max_threads * sizeof(T));
+    const size_t chunk    = (volume + max_threads - 1) / max_threads;
+#pragma omp parallel for schedule(static)
+    for (int t = 0; t < max_threads; t++) {
+      const size_t lo = t * chunk;
+      const size_t hi = ((lo + chunk) < volume) ? (lo + chunk) : volume;
+      results[t] = (lo < hi) ? norm_sum<T, DIM>(in, ptr, pitches, rect, power, lo, hi)
+                             : SumReduction<T>::identity;
+    }
+    T result = results[0];
+    for (int t = 1; t < max_threads; t++)
+      SumReduction<T>::template fold<true /*exclusive*/>(result, results[t]);
+    return result;
+  }
 #endif
+  return norm_sum<T, DIM>(in, ptr, pitches, rect, power, 0, volume);
+}
+
+template <typename T>
+static T norm_reduce_task(const Task* task,
+                          const std::vector<PhysicalRegion>& regions,
+                          bool parallel)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  const NormPower<T> power(task->futures[0].get_result<double>());
+  switch (dim) {
+#define DIMFUNC(DIM)                                                       \
+  case DIM: {                                                              \
+    return norm_reduce<T, DIM>(task, derez, regions, power, parallel);     \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return SumReduction<T>::identity;
+}
 
 template <typename T>
 /*static*/ T NormReducTask<T>::cpu_variant(const Task* task,
@@ -380,50 +310,7 @@ template <typename T>
                                            Context ctx,
                                            Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim   = derez.unpack_dimension();
-  T result        = SumReduction<T>::identity;
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
-  switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
-      switch (order) {
-        case 1: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-            T val = in[x];
-            if (val < T{0}) val = -val;
-            SumReduction<T>::template fold<true /*exclusive*/>(result, val);
-          }
-          break;
-        }
-        case 2: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-            T val = in[x];
-            ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-            SumReduction<T>::template fold<true /*exclusive*/>(result, val);
-          }
-          break;
-        }
-        default: {
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-            T val = in[x];
-            if (val < T{0}) val = -val;
-            T prod = val;
-            for (int i = 0; i < (order - 1); i++)
-              ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-            SumReduction<T>::template fold<true /*exclusive*/>(result, prod);
-          }
-          break;
-        }
-      }
-      break;
-    }
-    default: assert(false);  // should have any other dimensions
-  }
-  return result;
+  return norm_reduce_task<T>(task, regions, false /*parallel*/);
 }
 
 #ifdef LEGATE_USE_OPENMP
@@ -432,79 +319,190 @@ template <typename T>
                                            const std::vector<PhysicalRegion>& regions,
                                            Context ctx,
                                            Runtime* runtime)
+{
+  return norm_reduce_task<T>(task, regions, true /*parallel*/);
+}
+#endif  // LEGATE_USE_OPENMP
+
+// Accumulates the elements in [lo, hi) of the flattened rectangle
+template <typename T, int DIM>
+static void nrm2_accumulate(Nrm2Accumulator<T>& accumulator,
+                            const AccessorRO<T, DIM>& in,
+                            const T* ptr,
+                            const Pitches<DIM - 1>& pitches,
+                            const Rect<DIM>& rect,
+                            size_t lo,
+                            size_t hi)
+{
+  if (ptr != NULL) {
+    for (size_t idx = lo; idx < hi; idx += NRM2_BLOCK)
+      accumulator.accumulate(ptr + idx, ((idx + NRM2_BLOCK) < hi) ? NRM2_BLOCK : (hi - idx));
+  } else {
+    // Gather blocks so the strided case can use the same dense kernel
+    T block[NRM2_BLOCK];
+    for (size_t idx = lo; idx < hi; idx += NRM2_BLOCK) {
+      const size_t count = ((idx + NRM2_BLOCK) < hi) ? NRM2_BLOCK : (hi - idx);
+      for (size_t i = 0; i < count; i++) block[i] = in[pitches.unflatten(idx + i, rect.lo)];
+      accumulator.accumulate(block, count);
+    }
+  }
+}
+
+template <typename T, int DIM>
+static void nrm2_partial(const Task* task,
+                         LegateDeserializer& derez,
+                         const std::vector<PhysicalRegion>& regions,
+                         Nrm2Accumulator<T>& result,
+                         bool parallel)
+{
+  const Rect<DIM> rect        = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  // Empty pieces still write their (0, 0) partial after this
+  if (rect.empty()) return;
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  const T* ptr        = in.accessor.is_dense_row_major(rect) ? in.ptr(rect) : NULL;
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+    const int max_threads = omp_get_max_threads();
+    std::vector<Nrm2Accumulator<T>> partials(max_threads);
+    // Keep the chunks aligned to whole blocks
+    size_t chunk = (volume + max_threads - 1) / max_threads;
+    chunk        = ((chunk + NRM2_BLOCK - 1) / NRM2_BLOCK) * NRM2_BLOCK;
+#pragma omp parallel for schedule(static)
+    for (int t = 0; t < max_threads; t++) {
+      const size_t lo = t * chunk;
+      const size_t hi = ((lo + chunk) < volume) ? (lo + chunk) : volume;
+      if (lo < hi) nrm2_accumulate<T, DIM>(partials[t], in, ptr, pitches, rect, lo, hi);
+    }
+    for (int t = 0; t < max_threads; t++) result.merge(partials[t]);
+    return;
+  }
+#endif
+  nrm2_accumulate<T, DIM>(result, in, ptr, pitches, rect, 0, volume);
+}
+
+template <typename T, int DIM>
+static void nrm2_write(const Task* task,
+                       LegateDeserializer& derez,
+                       const std::vector<PhysicalRegion>& regions,
+                       const Nrm2Accumulator<T>& result,
+                       bool index_launch)
+{
+  // Each point task owns the entry of the partial fields at its point
+  const Point<DIM> point = index_launch ? Point<DIM>(task->index_point) : Point<DIM>::ZEROES();
+  const Rect<DIM> rect(point, point);
+  const AccessorWO<T, DIM> scale = derez.unpack_accessor_WO<T, DIM>(regions[1], rect);
+  const AccessorWO<T, DIM> sumsq = derez.unpack_accessor_WO<T, DIM>(regions[2], rect);
+  scale[point]                   = result.scale;
+  sumsq[point]                   = result.sumsq;
+}
+
+template <typename T>
+static void nrm2_task(const Task* task, const std::vector<PhysicalRegion>& regions, bool parallel)
 {
   LegateDeserializer derez(task->args, task->arglen);
-  const int dim         = derez.unpack_dimension();
-  const int max_threads = omp_get_max_threads();
-  T* results            = (T*)alloca(max_threads * sizeof(T));
-  for (int i = 0; i < max_threads; i++) results[i] = SumReduction<T>::identity;
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
+  Nrm2Accumulator<T> result;
+  const int dim = derez.unpack_dimension();
   switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorRO<T, 1> in = derez.unpack_accessor_RO<T, 1>(regions[0], rect);
-      switch (order) {
-        case 1: {
-#pragma omp parallel
-          {
-            const int tid = omp_get_thread_num();
-#pragma omp for nowait
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-              T val = in[x];
-              if (val < T{0}) val = -val;
-              SumReduction<T>::template fold<true /*exclusive*/>(results[tid], val);
-            }
-          }
-          break;
-        }
-        case 2: {
-#pragma omp parallel
-          {
-            const int tid = omp_get_thread_num();
-#pragma omp for nowait
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-              T val = in[x];
-              ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-              SumReduction<T>::template fold<true /*exclusive*/>(results[tid], val);
-            }
-          }
-          break;
-        }
-        default: {
-#pragma omp parallel
-          {
-            const int tid = omp_get_thread_num();
-#pragma omp for nowait
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) {
-              T val = in[x];
-              if (val < T{0}) val = -val;
-              T prod = val;
-              for (int i = 0; i < (order - 1); i++)
-                ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-              SumReduction<T>::template fold<true /*exclusive*/>(results[tid], prod);
-            }
-          }
-          break;
-        }
-      }
-      break;
-    }
-    default: assert(false);  // should have any other dimensions
+#define DIMFUNC(DIM)                                                \
+  case DIM: {                                                       \
+    nrm2_partial<T, DIM>(task, derez, regions, result, parallel);   \
+    break;                                                          \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  const bool index_launch = derez.unpack_bool();
+  const int partial_dim   = derez.unpack_dimension();
+  switch (partial_dim) {
+#define DIMFUNC(DIM)                                                   \
+  case DIM: {                                                          \
+    nrm2_write<T, DIM>(task, derez, regions, result, index_launch);    \
+    break;                                                             \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
   }
-  T result = results[0];
-  for (int i = 1; i < max_threads; i++)
-    SumReduction<T>::template fold<true /*exclusive*/>(result, results[i]);
-  return result;
 }
-#endif  // LEGATE_USE_OPENMP
+
+template <typename T>
+/*static*/ void Nrm2Task<T>::cpu_variant(const Task* task,
+                                         const std::vector<PhysicalRegion>& regions,
+                                         Context ctx,
+                                         Runtime* runtime)
+{
+  nrm2_task<T>(task, regions, false /*parallel*/);
+}
+
+#ifdef LEGATE_USE_OPENMP
+template <typename T>
+/*static*/ void Nrm2Task<T>::omp_variant(const Task* task,
+                                         const std::vector<PhysicalRegion>& regions,
+                                         Context ctx,
+                                         Runtime* runtime)
+{
+  nrm2_task<T>(task, regions, true /*parallel*/);
+}
+#endif
+
+template <typename T, int DIM>
+static void nrm2_merge(const Task* task,
+                       LegateDeserializer& derez,
+                       const std::vector<PhysicalRegion>& regions,
+                       Nrm2Accumulator<T>& result)
+{
+  const Rect<DIM> rect           = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  const AccessorRO<T, DIM> scale = derez.unpack_accessor_RO<T, DIM>(regions[0], rect);
+  const AccessorRO<T, DIM> sumsq = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  for (PointInRectIterator<DIM> itr(rect); itr(); itr++) result.merge(scale[*itr], sumsq[*itr]);
+}
+
+template <typename T>
+/*static*/ T Nrm2Scalar<T>::cpu_variant(const Task* task,
+                                        const std::vector<PhysicalRegion>& regions,
+                                        Context ctx,
+                                        Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  Nrm2Accumulator<T> result;
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+#define DIMFUNC(DIM)                                 \
+  case DIM: {                                        \
+    nrm2_merge<T, DIM>(task, derez, regions, result); \
+    break;                                           \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
+  }
+  return result.norm();
+}
 
 INSTANTIATE_ALL_TASKS(NormTask, static_cast<int>(NumPyOpCode::NUMPY_NORM) * NUMPY_TYPE_OFFSET)
 INSTANTIATE_ALL_TASKS(NormReducTask,
                       static_cast<int>(NumPyOpCode::NUMPY_NORM) * NUMPY_TYPE_OFFSET +
                         NUMPY_REDUCTION_VARIANT_OFFSET)
 
+// The scaled 2-norm is only provided for the types that LAPACK covers
+#define INSTANTIATE_NRM2_TASKS(type, base_id)                                  \
+  template <>                                                                  \
+  const int type<float>::TASK_ID = base_id + FLOAT_LT* NUMPY_MAX_VARIANTS;     \
+  template class type<float>;                                                  \
+  template <>                                                                  \
+  const int type<double>::TASK_ID = base_id + DOUBLE_LT* NUMPY_MAX_VARIANTS;   \
+  template class type<double>;
+
+INSTANTIATE_NRM2_TASKS(Nrm2Task,
+                       static_cast<int>(NumPyOpCode::NUMPY_NRM2) * NUMPY_TYPE_OFFSET +
+                         NUMPY_NORMAL_VARIANT_OFFSET)
+INSTANTIATE_NRM2_TASKS(Nrm2Scalar,
+                       static_cast<int>(NumPyOpCode::NUMPY_NRM2) * NUMPY_TYPE_OFFSET +
+                         NUMPY_SCALAR_VARIANT_OFFSET)
+
 }  // namespace numpy
 }  // namespace legate
 
@@ -514,5 +512,9 @@ static void __attribute__((constructor)) register_tasks(void)
 {
   REGISTER_ALL_TASKS(legate::numpy::NormTask)
   REGISTER_ALL_TASKS_WITH_REDUCTION_RETURN(legate::numpy::NormReducTask, SumReduction)
+  legate::numpy::Nrm2Task<float>::register_variants();
+  legate::numpy::Nrm2Task<double>::register_variants();
+  legate::numpy::Nrm2Scalar<float>::register_variants_with_return<float, float>();
+  legate::numpy::Nrm2Scalar<double>::register_variants_with_return<double, double>();
 }
 }  // namespace
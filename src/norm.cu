@@ -19,7 +19,6 @@
 #include "norm.h"
 #include "proj.h"
 #include "sum.h"
-#include <type_traits>
 
 using namespace Legion;
 
@@ -33,7 +32,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
                      const Rect<2> bounds,
                      const T identity,
                      const int axis,
-                     const int order)
+                     const NormPower<T> power)
 {
   coord_t y = bounds.lo[1] + blockIdx.x * blockDim.x + threadIdx.x;
   coord_t x = bounds.lo[0] + (blockIdx.z * gridDim.y + blockIdx.y) * blockDim.y + threadIdx.y;
@@ -42,36 +41,12 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   T value = identity;
   if (axis == 0) {
     while (x <= bounds.hi[0]) {
-      T val = in[x][y];
-      if (std::is_signed<T>::value && val < T(0)) val = -val;
-      if (order == 1)
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      else if (order == 2) {
-        ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      } else {
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++)
-          ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, prod);
-      }
+      SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[x][y]));
       x += gridDim.z * gridDim.y * blockDim.y;
     }
   } else {
     while (y <= bounds.hi[1]) {
-      T val = in[x][y];
-      if (std::is_signed<T>::value && val < T(0)) val = -val;
-      if (order == 1)
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      else if (order == 2) {
-        ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      } else {
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++)
-          ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, prod);
-      }
+      SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[x][y]));
       y += gridDim.x * blockDim.x;
     }
 #if __CUDA_ARCH__ >= 700
@@ -124,7 +99,7 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
                      const Rect<3> bounds,
                      const T identity,
                      const int axis,
-                     const int order)
+                     const NormPower<T> power)
 {
   coord_t z = bounds.lo[2] + blockIdx.x * blockDim.x + threadIdx.x;
   coord_t y = bounds.lo[1] + blockIdx.y * blockDim.y + threadIdx.y;
@@ -134,53 +109,17 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
   T value = identity;
   if (axis == 0) {
     while (x <= bounds.hi[0]) {
-      T val = in[x][y][z];
-      if (std::is_signed<T>::value && val < T(0)) val = -val;
-      if (order == 1)
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      else if (order == 2) {
-        ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      } else {
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++)
-          ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, prod);
-      }
+      SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[x][y][z]));
       x += gridDim.z * blockDim.z;
     }
   } else if (axis == 1) {
     while (y <= bounds.hi[1]) {
-      T val = in[x][y][z];
-      if (std::is_signed<T>::value && val < T(0)) val = -val;
-      if (order == 1)
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      else if (order == 2) {
-        ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      } else {
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++)
-          ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, prod);
-      }
+      SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[x][y][z]));
       y += gridDim.y * blockDim.y;
     }
   } else {
     while (z <= bounds.hi[2]) {
-      T val = in[x][y][z];
-      if (std::is_signed<T>::value && val < T(0)) val = -val;
-      if (order == 1)
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      else if (order == 2) {
-        ProdReduction<T>::template fold<true /*exclusive*/>(val, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, val);
-      } else {
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++)
-          ProdReduction<T>::template fold<true /*exclusive*/>(prod, val);
-        SumReduction<T>::template fold<true /*exclusive*/>(value, prod);
-      }
+      SumReduction<T>::template fold<true /*exclusive*/>(value, power(in[x][y][z]));
       z += gridDim.x * blockDim.x;
     }
 #if __CUDA_ARCH__ >= 700
@@ -266,9 +205,8 @@ template <typename T>
     }
     default: assert(false);  // shouldn't see any other cases
   }
-  const int dim   = derez.unpack_dimension();
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
+  const int dim = derez.unpack_dimension();
+  const NormPower<T> power(task->futures[0].get_result<double>());
   switch (dim) {
     // Should never get the case of 1 as this would just be a copy since
     // reducing our only dimension should have called SumReducTask
@@ -285,7 +223,7 @@ template <typename T>
       dim3 blocks(1, 1, 1);
       raster_2d_reduction(blocks, threads, rect, axis, (const void*)legate_vec_norm_2d<T>);
       legate_vec_norm_2d<T>
-        <<<blocks, threads>>>(inout, in, rect, SumReduction<T>::identity, axis, order);
+        <<<blocks, threads>>>(inout, in, rect, SumReduction<T>::identity, axis, power);
       break;
     }
     case 3: {
@@ -301,7 +239,7 @@ template <typename T>
       dim3 blocks(1, 1, 1);
       raster_3d_reduction(blocks, threads, rect, axis, (const void*)legate_vec_norm_3d<T>);
       legate_vec_norm_3d<T>
-        <<<blocks, threads>>>(inout, in, rect, SumReduction<T>::identity, axis, order);
+        <<<blocks, threads>>>(inout, in, rect, SumReduction<T>::identity, axis, power);
       break;
     }
     default: assert(false);
@@ -317,41 +255,15 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
                             const size_t iters,
                             const Point<1> origin,
                             const size_t max,
-                            const int order,
+                            const NormPower<T> power,
                             const T identity)
 {
   T value = identity;
-  if (order == 1) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset;
-        T val           = in[x];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else if (order == 2) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset;
-        T val           = in[x];
-        ProdReduction<T>::template fold<true>(val, val);
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset;
-        T val           = in[x];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++) ProdReduction<T>::template fold<true>(prod, val);
-        SumReduction<T>::template fold<true>(value, prod);
-      }
+  for (unsigned idx = 0; idx < iters; idx++) {
+    const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
+    if (offset < max) {
+      const coord_t x = origin[0] + offset;
+      SumReduction<T>::template fold<true>(value, power(in[x]));
     }
   }
   reduce_output(result, value);
@@ -365,44 +277,16 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
                             const Point<2> origin,
                             const Point<1> pitch,
                             const size_t max,
-                            const int order,
+                            const NormPower<T> power,
                             const T identity)
 {
   T value = identity;
-  if (order == 1) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + offset % pitch[0];
-        T val           = in[x][y];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else if (order == 2) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + offset % pitch[0];
-        T val           = in[x][y];
-        ProdReduction<T>::template fold<true>(val, val);
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + offset % pitch[0];
-        T val           = in[x][y];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++) ProdReduction<T>::template fold<true>(prod, val);
-        SumReduction<T>::template fold<true>(value, prod);
-      }
+  for (unsigned idx = 0; idx < iters; idx++) {
+    const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
+    if (offset < max) {
+      const coord_t x = origin[0] + offset / pitch[0];
+      const coord_t y = origin[1] + offset % pitch[0];
+      SumReduction<T>::template fold<true>(value, power(in[x][y]));
     }
   }
   reduce_output(result, value);
@@ -416,47 +300,17 @@ __global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
                             const Point<3> origin,
                             const Point<2> pitch,
                             const size_t max,
-                            const int order,
+                            const NormPower<T> power,
                             const T identity)
 {
   T value = identity;
-  if (order == 1) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + (offset % pitch[0]) / pitch[1];
-        const coord_t z = origin[2] + (offset % pitch[0]) % pitch[1];
-        T val           = in[x][y][z];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else if (order == 2) {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + (offset % pitch[0]) / pitch[1];
-        const coord_t z = origin[2] + (offset % pitch[0]) % pitch[1];
-        T val           = in[x][y][z];
-        ProdReduction<T>::template fold<true>(val, val);
-        SumReduction<T>::template fold<true>(value, val);
-      }
-    }
-  } else {
-    for (unsigned idx = 0; idx < iters; idx++) {
-      const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
-      if (offset < max) {
-        const coord_t x = origin[0] + offset / pitch[0];
-        const coord_t y = origin[1] + (offset % pitch[0]) / pitch[1];
-        const coord_t z = origin[2] + (offset % pitch[0]) % pitch[1];
-        T val           = in[x][y][z];
-        if (std::is_signed<T>::value && val < T(0)) val = -val;
-        T prod = val;
-        for (int i = 0; i < (order - 1); i++) ProdReduction<T>::template fold<true>(prod, val);
-        SumReduction<T>::template fold<true>(value, prod);
-      }
+  for (unsigned idx = 0; idx < iters; idx++) {
+    const size_t offset = (idx * gridDim.x + blockIdx.x) * blockDim.x + threadIdx.x;
+    if (offset < max) {
+      const coord_t x = origin[0] + offset / pitch[0];
+      const coord_t y = origin[1] + (offset % pitch[0]) / pitch[1];
+      const coord_t z = origin[2] + (offset % pitch[0]) % pitch[1];
+      SumReduction<T>::template fold<true>(value, power(in[x][y][z]));
     }
   }
   reduce_output(result, value);
@@ -467,9 +321,8 @@ template <typename T>
   const Task* task, const std::vector<PhysicalRegion>& regions, Context ctx, Runtime* runtime)
 {
   LegateDeserializer derez(task->args, task->arglen);
-  const int dim   = derez.unpack_dimension();
-  const int order = task->futures[0].get_result<int>();
-  assert(order > 0);
+  const int dim = derez.unpack_dimension();
+  const NormPower<T> power(task->futures[0].get_result<double>());
   DeferredReduction<SumReduction<T>> result;
   switch (dim) {
     case 1: {
@@ -481,10 +334,10 @@ template <typename T>
       if (blocks >= MAX_REDUCTION_CTAS) {
         const size_t iters = (blocks + MAX_REDUCTION_CTAS - 1) / MAX_REDUCTION_CTAS;
         legate_vec_norm_reduce_1d<T><<<MAX_REDUCTION_CTAS, THREADS_PER_BLOCK>>>(
-          result, in, iters, rect.lo, volume, order, SumReduction<T>::identity);
+          result, in, iters, rect.lo, volume, power, SumReduction<T>::identity);
       } else {
         legate_vec_norm_reduce_1d<T><<<blocks, THREADS_PER_BLOCK>>>(
-          result, in, 1 /*iters*/, rect.lo, volume, order, SumReduction<T>::identity);
+          result, in, 1 /*iters*/, rect.lo, volume, power, SumReduction<T>::identity);
       }
       break;
     }
@@ -498,7 +351,7 @@ template <typename T>
       if (blocks >= MAX_REDUCTION_CTAS) {
         const size_t iters = (blocks + MAX_REDUCTION_CTAS - 1) / MAX_REDUCTION_CTAS;
         legate_vec_norm_reduce_2d<T><<<MAX_REDUCTION_CTAS, THREADS_PER_BLOCK>>>(
-          result, in, iters, rect.lo, Point<1>(pitch), volume, order, SumReduction<T>::identity);
+          result, in, iters, rect.lo, Point<1>(pitch), volume, power, SumReduction<T>::identity);
       } else {
         legate_vec_norm_reduce_2d<T><<<blocks, THREADS_PER_BLOCK>>>(result,
                                                                     in,
@@ -506,7 +359,7 @@ template <typename T>
                                                                     rect.lo,
                                                                     Point<1>(pitch),
                                                                     volume,
-                                                                    order,
+                                                                    power,
                                                                     SumReduction<T>::identity);
       }
       break;
@@ -523,7 +376,7 @@ template <typename T>
       if (blocks >= MAX_REDUCTION_CTAS) {
         const size_t iters = (blocks + MAX_REDUCTION_CTAS - 1) / MAX_REDUCTION_CTAS;
         legate_vec_norm_reduce_3d<T><<<MAX_REDUCTION_CTAS, THREADS_PER_BLOCK>>>(
-          result, in, iters, rect.lo, Point<2>(pitch), volume, order, SumReduction<T>::identity);
+          result, in, iters, rect.lo, Point<2>(pitch), volume, power, SumReduction<T>::identity);
       } else {
         legate_vec_norm_reduce_3d<T><<<blocks, THREADS_PER_BLOCK>>>(result,
                                                                     in,
@@ -531,7 +384,7 @@ template <typename T>
                                                                     rect.lo,
                                                                     Point<2>(pitch),
                                                                     volume,
-                                                                    order,
+                                                                    power,
                                                                     SumReduction<T>::identity);
       }
       break;
@@ -18,10 +18,142 @@
 #define __NUMPY_NORM_H__
 
 #include "numpy.h"
+#include <cmath>
+#include <limits>
 
 namespace legate {
 namespace numpy {
 
+// Fractional orders are only supported for floating point types, the
+// Python side converts everything else before asking for one
+template <typename T>
+__CUDA_HD__ inline T norm_real_power(T value, double order)
+{
+  assert(false);
+  return value;
+}
+
+template <>
+__CUDA_HD__ inline float norm_real_power<float>(float value, double order)
+{
+  return powf(value, static_cast<float>(order));
+}
+
+template <>
+__CUDA_HD__ inline double norm_real_power<double>(double value, double order)
+{
+  return pow(value, order);
+}
+
+// Raises the magnitude of an element to the order of a p-norm. Integral
+// orders are evaluated with repeated squaring so the common orders cost
+// one or two multiplies and large ones only O(log p) of them; other
+// orders go through pow.
+template <typename T>
+class NormPower {
+ public:
+  NormPower(double ord)
+    : order(ord), exponent(static_cast<int>(ord)), integral(static_cast<double>(exponent) == ord)
+  {
+    assert(ord > 0.0);
+  }
+
+ public:
+  __CUDA_HD__ inline T operator()(T value) const
+  {
+    if (value < T(0)) value = -value;
+    if (!integral) return norm_real_power<T>(value, order);
+    if (exponent == 1) return value;
+    T result = value;
+    T base   = value;
+    // We already have the first power in the result
+    for (int remaining = exponent - 1; remaining > 0; remaining >>= 1) {
+      if (remaining & 1) ProdReduction<T>::template fold<true /*exclusive*/>(result, base);
+      if (remaining > 1) ProdReduction<T>::template fold<true /*exclusive*/>(base, base);
+    }
+    return result;
+  }
+
+ private:
+  double order;
+  int exponent;
+  bool integral;
+};
+
+// Running sum of squares kept as scale^2 * sumsq, as in the reference
+// BLAS nrm2, so that neither huge nor tiny elements overflow or underflow
+// when they are squared. Partial sums from blocks or threads are merged
+// by rescaling the one with the smaller scale.
+template <typename T>
+class Nrm2Accumulator {
+ public:
+  Nrm2Accumulator(void) : scale(0), sumsq(0) {}
+
+ public:
+  inline void merge(T other_scale, T other_sumsq)
+  {
+    if (other_scale == T(0)) return;
+    // Equal scales need no rescaling, which also keeps two infinite
+    // scales from making a NaN out of inf / inf
+    if (scale == other_scale) {
+      sumsq += other_sumsq;
+      return;
+    }
+    if (scale < other_scale) {
+      const T ratio = scale / other_scale;
+      sumsq         = other_sumsq + sumsq * ratio * ratio;
+      scale         = other_scale;
+    } else {
+      const T ratio = other_scale / scale;
+      sumsq += other_sumsq * ratio * ratio;
+    }
+  }
+  inline void merge(const Nrm2Accumulator<T>& other) { merge(other.scale, other.sumsq); }
+  // Folds in a block of values. The first pass finds the largest
+  // magnitude and the second sums the squares after scaling by a power of
+  // two near it, so the scaling is exact and both passes are plain loops
+  // that vectorize; the block is small enough to still be in cache for
+  // the second pass.
+  inline void accumulate(const T* values, size_t count)
+  {
+    T amax       = T(0);
+    bool has_nan = false;
+    for (size_t i = 0; i < count; i++) {
+      const T value = std::fabs(values[i]);
+      // Written this way so that NaNs are skipped here and show up in the sum
+      amax = (value > amax) ? value : amax;
+      has_nan |= (value != value);
+    }
+    if ((amax == T(0)) || std::isinf(amax)) {
+      // There is no sum of squares for these, so a NaN has to be put
+      // into the partial here or it would be lost
+      const T nan = std::numeric_limits<T>::quiet_NaN();
+      if (amax == T(0)) {
+        if (has_nan) merge(T(1), nan);
+      } else
+        merge(amax, has_nan ? nan : T(1));
+      return;
+    }
+    int shift;
+    std::frexp(amax, &shift);
+    // Keep both the scale and its inverse representable
+    const int min_shift = 1 - std::numeric_limits<T>::max_exponent;
+    shift               = ((shift - 1) > min_shift) ? (shift - 1) : min_shift;
+    const T inverse     = std::ldexp(T(1), -shift);
+    T block_sumsq   = T(0);
+    for (size_t i = 0; i < count; i++) {
+      const T value = values[i] * inverse;
+      block_sumsq += value * value;
+    }
+    merge(std::ldexp(T(1), shift), block_sumsq);
+  }
+  inline T norm(void) const { return scale * std::sqrt(sumsq); }
+
+ public:
+  T scale;
+  T sumsq;
+};
+
 template <typename T>
 class NormTask : public NumPyTask<NormTask<T>> {
  public:
@@ -73,6 +205,42 @@ class NormReducTask : public NumPyTask<NormReducTask<T>> {
 #endif
 };
 
+// Overflow-safe 2-norm of a whole array. Each point task writes the scale
+// and scaled sum of squares of its piece into two fields and the scalar
+// task merges the pieces into the norm; this keeps the pieces in scaled
+// form where a sum reduction of the squares could overflow.
+template <typename T>
+class Nrm2Task : public NumPyTask<Nrm2Task<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 3;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#ifdef LEGATE_USE_OPENMP
+  static void omp_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+#endif
+};
+
+template <typename T>
+class Nrm2Scalar : public NumPyTask<Nrm2Scalar<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 2;
+
+ public:
+  static T cpu_variant(const Legion::Task* task,
+                       const std::vector<Legion::PhysicalRegion>& regions,
+                       Legion::Context ctx,
+                       Legion::Runtime* runtime);
+};
+
 }  // namespace numpy
 }  // namespace legate
 
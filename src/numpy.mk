@@ -23,8 +23,12 @@ GEN_CPU_SRC +=	  universal_functions/absolute.cc  	\
 		  arange.cc	                       	\
 		  arg.cc	                       	\
 		  argmin.cc	                       	\
+		  axpby.cc				\
+		  bfloat16.cc				\
 		  bincount.cc	                       	\
+		  bitmask.cc				\
 		  universal_functions/ceil.cc	       	\
+		  checkpoint.cc				\
 		  clip.cc	       			\
 		  close.cc	                       	\
 		  contains.cc				\
@@ -50,9 +54,12 @@ GEN_CPU_SRC +=	  universal_functions/absolute.cc  	\
 		  equal_reduce.cc                      	\
 		  universal_functions/exp.cc	       	\
 		  eye.cc	                       	\
+		  file_io.cc				\
 		  fill.cc	                       	\
 		  universal_functions/floor.cc	       	\
 		  universal_functions/floor_divide.cc  	\
+		  fused.cc				\
+		  gather.cc				\
 		  universal_functions/greater.cc       	\
 		  universal_functions/greater_equal.cc 	\
 		  greater_equal_reduce.cc	       	\
@@ -65,9 +72,11 @@ GEN_CPU_SRC +=	  universal_functions/absolute.cc  	\
 		  universal_functions/less_equal.cc    	\
 		  less_equal_reduce.cc                 	\
 		  less_reduce.cc                       	\
+		  linalg.cc				\
 		  universal_functions/log.cc	       	\
 		  universal_functions/logical_not.cc   	\
 		  mapper.cc				\
+		  mask.cc				\
 		  max.cc	                       	\
 		  min.cc	                       	\
 		  mod.cc	                       	\
@@ -90,6 +99,7 @@ GEN_CPU_SRC +=	  universal_functions/absolute.cc  	\
 		  sum.cc	                       	\
 		  universal_functions/tan.cc	       	\
 		  universal_functions/tanh.cc	       	\
+		  text_io.cc				\
 		  tile.cc	                       	\
 		  trans.cc	                       	\
 		  where.cc				\
@@ -104,6 +114,7 @@ GEN_GPU_SRC +=    universal_functions/absolute.cu      	\
 		  arange.cu	                       	\
 		  arg.cu	                        \
 		  argmin.cu	                        \
+		  axpby.cu				\
 		  bincount.cu	                        \
 		  universal_functions/ceil.cu	        \
 		  clip.cu	        		\
@@ -147,6 +158,7 @@ GEN_GPU_SRC +=    universal_functions/absolute.cu      	\
 		  less_reduce.cu                       	\
 		  universal_functions/log.cu	        \
 		  universal_functions/logical_not.cu   	\
+		  mask.cu				\
 		  max.cu	                        \
 		  min.cu	                        \
 		  mod.cu	                        \
@@ -144,6 +144,105 @@ class Scalar<T, 1> {
   const T& value;
 };
 
+// Binds a scalar as the second argument of a binary operation so that
+// loops over the other argument can apply it as a unary one. Operations
+// can specialize this to do work that only depends on the scalar once
+// per task instead of once per element. Those that set on_device are
+// also used by the GPU kernels, which skip visit.
+template <class BinaryFunction, typename Enable = void>
+class ScalarRhsOperation {
+ private:
+  using first_argument_type  = typename BinaryFunction::first_argument_type;
+  using second_argument_type = typename BinaryFunction::second_argument_type;
+  using result_type = std::result_of_t<BinaryFunction(first_argument_type, second_argument_type)>;
+
+ public:
+  static constexpr bool on_device = false;
+
+ public:
+  ScalarRhsOperation(const second_argument_type& s) : scalar(s) {}
+
+ public:
+  inline result_type operator()(const first_argument_type& a) const { return func(a, scalar); }
+  // Calls f with the function to apply to every element. Specializations
+  // that pick between several functions for the scalar do it once here, so
+  // the loops in f get compiled and vectorized for each of them.
+  template <typename F>
+  inline void visit(F&& f) const { f(*this); }
+
+ private:
+  BinaryFunction func;
+  const second_argument_type scalar;
+};
+
+// An operand that is either a scalar in a future or a region, which may be
+// a broadcast view of a smaller array through its transform
+template <typename T, int N>
+struct ScalarOrRegion {
+  bool scalar;
+  T value;
+  AccessorRO<T, N> accessor;
+
+  void deserialize(LegateDeserializer& derez,
+                   const Legion::Task* task,
+                   const std::vector<Legion::PhysicalRegion>& regions,
+                   const Legion::Rect<N>& rect,
+                   unsigned& region_index,
+                   unsigned& future_index)
+  {
+    scalar = derez.unpack_bool();
+    if (scalar)
+      value = task->futures[future_index++].get_result<T>(true /*silence warnings*/);
+    else
+      accessor = derez.unpack_accessor_RO<T, N>(regions[region_index++], rect);
+  }
+};
+
+// The two kinds of ScalarOrRegion with the same index syntax. Loops are
+// instantiated separately for each so that neither pays for a branch on
+// the other in its inner loop.
+template <typename T, int N>
+class ScalarOperand {
+ public:
+  ScalarOperand(const T& v) : value(v) {}
+
+ public:
+  inline bool dense(const Legion::Rect<N>& rect) { return true; }
+  __CUDA_HD__ inline T operator[](size_t idx) const { return value; }
+  __CUDA_HD__ inline T operator[](const Legion::Point<N>& point) const { return value; }
+
+ private:
+  T value;
+};
+
+template <typename T, int N>
+class RegionOperand {
+ public:
+  RegionOperand(const AccessorRO<T, N>& acc) : accessor(acc), ptr(nullptr) {}
+
+ public:
+  inline bool dense(const Legion::Rect<N>& rect)
+  {
+    // Broadcast views have zero strides so they are never dense
+    return accessor.accessor.is_dense_row_major(rect) && (ptr = accessor.ptr(rect));
+  }
+  __CUDA_HD__ inline T operator[](size_t idx) const { return ptr[idx]; }
+  __CUDA_HD__ inline T operator[](const Legion::Point<N>& point) const { return accessor[point]; }
+
+ private:
+  AccessorRO<T, N> accessor;
+  const T* ptr;
+};
+
+template <typename T, int N, typename F>
+inline void with_operand(const ScalarOrRegion<T, N>& arg, F&& fn)
+{
+  if (arg.scalar)
+    fn(ScalarOperand<T, N>(arg.value));
+  else
+    fn(RegionOperand<T, N>(arg.accessor));
+}
+
 template <>
 class CPULoop<1> {
  public:
@@ -530,6 +629,38 @@ class OMPLoop<4> {
 };
 #endif
 
+// Calls body on every index in [lo, hi) for tasks that share one function
+// between their CPU and OpenMP variants. Only the OpenMP variants pass
+// parallel, and only builds with OpenMP have the pragma at all.
+template <typename I, typename F>
+inline void for_each_index(I lo, I hi, bool parallel, F&& body)
+{
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+#pragma omp parallel for schedule(static)
+    for (I idx = lo; idx < hi; idx++) body(idx);
+    return;
+  }
+#endif
+  for (I idx = lo; idx < hi; idx++) body(idx);
+}
+
+// Like for_each_index but returns the sum of what body gives for each index
+template <typename T, typename I, typename F>
+inline T sum_each_index(I lo, I hi, bool parallel, F&& body)
+{
+  T result = 0;
+#ifdef LEGATE_USE_OPENMP
+  if (parallel) {
+#pragma omp parallel for schedule(static) reduction(+ : result)
+    for (I idx = lo; idx < hi; idx++) result += body(idx);
+    return result;
+  }
+#endif
+  for (I idx = lo; idx < hi; idx++) result += body(idx);
+  return result;
+}
+
 template <class Derived>
 class PointTask : public NumPyTask<Derived> {
  public:
@@ -0,0 +1,433 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "text_io.h"
+#include "file_io.h"
+#include "proj.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+
+using namespace Legion;
+
+namespace legate {
+namespace numpy {
+
+namespace {
+
+// Hands out the lines in a range of a file one at a time through a big
+// buffer so that we only go to the file every few megabytes
+class LineReader {
+ public:
+  LineReader(int fd, size_t start, size_t stop)
+    : fd_(fd), position_(start), stop_(stop), buffer_(1 << 22), begin_(0), end_(0), failed_(false)
+  {
+  }
+
+ public:
+  // Returns the next line without its newline or false at the end
+  bool next(const char*& line, const char*& line_end)
+  {
+    while (true) {
+      const char* data    = buffer_.data();
+      const void* newline = memchr(data + begin_, '\n', end_ - begin_);
+      if (newline != nullptr) {
+        line     = data + begin_;
+        line_end = static_cast<const char*>(newline);
+        begin_   = line_end - data + 1;
+        return true;
+      }
+      if (position_ == stop_) {
+        // The last line of a file does not need a newline
+        if (begin_ == end_) return false;
+        line     = data + begin_;
+        line_end = data + end_;
+        begin_   = end_;
+        return true;
+      }
+      // Move the start of the current line to the front and refill
+      const size_t left = end_ - begin_;
+      memmove(&buffer_[0], data + begin_, left);
+      if (left == buffer_.size()) buffer_.resize(2 * buffer_.size());
+      begin_               = 0;
+      end_                 = left;
+      const size_t bytes   = std::min(buffer_.size() - left, stop_ - position_);
+      const ssize_t result = pread(fd_, &buffer_[left], bytes, position_);
+      if (result < 0) {
+        if (errno == EINTR) continue;
+        failed_ = true;
+        return false;
+      }
+      // The file got shorter on us so stop where it ends now
+      if (result == 0) stop_ = position_;
+      position_ += result;
+      end_ += result;
+    }
+  }
+  bool failed(void) const { return failed_; }
+
+ private:
+  const int fd_;
+  size_t position_, stop_;
+  std::vector<char> buffer_;
+  size_t begin_, end_;
+  bool failed_;
+};
+
+inline bool is_space(char c)
+{
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+// Drops any comment and the whitespace around what is left of a line and
+// returns whether there is anything left, which makes it a row of data
+bool trim_line(const char*& begin, const char*& end, char comment)
+{
+  if (comment != '\0') {
+    const void* pos = memchr(begin, comment, end - begin);
+    if (pos != nullptr) end = static_cast<const char*>(pos);
+  }
+  while ((begin < end) && is_space(*begin)) begin++;
+  while ((end > begin) && is_space(end[-1])) end--;
+  return (begin < end);
+}
+
+// Finds the next field of a trimmed row, without any whitespace around
+// it, and moves past it and its delimiter
+bool next_field(
+  const char*& pos, const char* end, char delimiter, const char*& field, const char*& field_end)
+{
+  if (delimiter == '\0') {
+    while ((pos < end) && is_space(*pos)) pos++;
+    if (pos == end) return false;
+    field = pos;
+    while ((pos < end) && !is_space(*pos)) pos++;
+    field_end = pos;
+    return true;
+  }
+  // One past the end means we already took the last field
+  if (pos > end) return false;
+  field           = pos;
+  const void* sep = memchr(pos, delimiter, end - pos);
+  field_end       = (sep != nullptr) ? static_cast<const char*>(sep) : end;
+  pos             = field_end + 1;
+  while ((field < field_end) && is_space(*field)) field++;
+  while ((field_end > field) && is_space(field_end[-1])) field_end--;
+  return true;
+}
+
+// Whether there are fields left in the row after we took the ones we want
+bool has_more_fields(const char* pos, const char* end, char delimiter)
+{
+  if (delimiter != '\0') return (pos <= end);
+  while ((pos < end) && is_space(*pos)) pos++;
+  return (pos < end);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, bool>::type parse_value(const char* begin,
+                                                                           const char* end,
+                                                                           T& value)
+{
+  const char* pos = begin;
+  bool negative   = false;
+  if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negative = (*pos++ == '-');
+  if (pos == end) return false;
+  unsigned long long magnitude = 0;
+  for (; pos < end; pos++) {
+    const unsigned digit = *pos - '0';
+    if ((digit > 9) || (magnitude > ((ULLONG_MAX - digit) / 10))) break;
+    magnitude = magnitude * 10 + digit;
+  }
+  if (pos != end) {
+    // NumPy also takes integers written like floats, such as 1e3 or 2.0
+    const std::string copy(begin, end);
+    char* last;
+    const double result = strtod(copy.c_str(), &last);
+    if ((last != (copy.c_str() + copy.size())) || (result != std::trunc(result)) ||
+        (result < static_cast<double>(std::numeric_limits<T>::min())) ||
+        (result >= std::ldexp(1.0, std::numeric_limits<T>::digits)))
+      return false;
+    value = static_cast<T>(result);
+    return true;
+  }
+  if (negative && std::is_unsigned<T>::value && (magnitude > 0)) return false;
+  const unsigned long long limit =
+    static_cast<unsigned long long>(std::numeric_limits<T>::max()) +
+    ((negative && std::is_signed<T>::value) ? 1 : 0);
+  if (magnitude > limit) return false;
+  value = negative ? static_cast<T>(0ULL - magnitude) : static_cast<T>(magnitude);
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type parse_value(const char* begin,
+                                                                                 const char* end,
+                                                                                 T& value)
+{
+  // Plain decimals with at most 19 significant digits and a power of ten
+  // that is exact in a double are the product or quotient of two exact
+  // doubles, which is correctly rounded. Everything else, including the
+  // infinities and NaNs, goes through strtod.
+  static const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* pos = begin;
+  bool negative   = false;
+  if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negative = (*pos++ == '-');
+  uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+  bool fast = false, dot = false;
+  for (; pos < end; pos++) {
+    if ((*pos == '.') && !dot) {
+      dot = true;
+      continue;
+    }
+    const unsigned digit = *pos - '0';
+    if (digit > 9) break;
+    fast     = true;
+    mantissa = mantissa * 10 + digit;
+    if (mantissa > 0) digits++;
+    if (dot) exponent--;
+    if (digits > 19) {
+      fast = false;
+      break;
+    }
+  }
+  if (fast && (pos < end) && ((*pos == 'e') || (*pos == 'E'))) {
+    pos++;
+    bool negative_exponent = false;
+    if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negative_exponent = (*pos++ == '-');
+    int power = 0;
+    fast      = (pos < end);
+    for (; fast && (pos < end); pos++) {
+      const unsigned digit = *pos - '0';
+      if ((digit > 9) || (power > 1000)) fast = false;
+      power = power * 10 + digit;
+    }
+    exponent += negative_exponent ? -power : power;
+  }
+  if (fast && (pos == end) && (mantissa < (1ULL << 53)) && (exponent >= -22) && (exponent <= 22)) {
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0)
+      result /= powers_of_ten[-exponent];
+    else
+      result *= powers_of_ten[exponent];
+    value = static_cast<T>(negative ? -result : result);
+    return true;
+  }
+  const std::string copy(begin, end);
+  char* last;
+  const double result = strtod(copy.c_str(), &last);
+  if ((copy.empty()) || (last != (copy.c_str() + copy.size()))) return false;
+  value = static_cast<T>(result);
+  return true;
+}
+
+template <typename T>
+inline void store(const AccessorWO<T, 1>& out, coord_t row, coord_t col, T value)
+{
+  out[row] = value;
+}
+
+template <typename T>
+inline void store(const AccessorWO<T, 2>& out, coord_t row, coord_t col, T value)
+{
+  out[Point<2>(row, col)] = value;
+}
+
+int open_text_file(const char* path)
+{
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    log_numpy_io.error("Unable to open %s for reading: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  return fd;
+}
+
+}  // namespace
+
+/*static*/ void CountLinesTask::cpu_variant(const Task* task,
+                                            const std::vector<PhysicalRegion>& regions,
+                                            Context ctx,
+                                            Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  assert(dim == 1);
+  const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<uint64_t, 1> counts = derez.unpack_accessor_WO<uint64_t, 1>(regions[0], rect);
+  const char comment                   = derez.unpack_32bit_int();
+  const unsigned chunks                = derez.unpack_32bit_uint();
+  std::vector<uint64_t> splits(chunks + 1);
+  for (unsigned idx = 0; idx <= chunks; idx++) splits[idx] = derez.unpack_value<uint64_t>();
+  const char* path = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  const int fd     = open_text_file(path);
+  for (coord_t chunk = rect.lo[0]; chunk <= rect.hi[0]; chunk++) {
+    LineReader reader(fd, splits[chunk], splits[chunk + 1]);
+    uint64_t count = 0;
+    const char *begin, *end;
+    while (reader.next(begin, end))
+      if (trim_line(begin, end, comment)) count++;
+    if (reader.failed()) {
+      log_numpy_io.error("Unable to read from %s: %s", path, strerror(errno));
+      LEGATE_ABORT
+    }
+    counts[chunk] = count;
+  }
+  close(fd);
+}
+
+template <typename T, int DIM>
+static void read_text(const Task* task,
+                      LegateDeserializer& derez,
+                      const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const Point<DIM> extents     = derez.unpack_point<DIM>();
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  const char comment           = derez.unpack_32bit_int();
+  const char delimiter         = derez.unpack_32bit_int();
+  const unsigned chunks        = derez.unpack_32bit_uint();
+  // Every row of the file has one value for each column of the result
+  const coord_t columns = (DIM == 1) ? 1 : extents[DIM - 1];
+  // Where each chunk starts in the file and the index of its first row
+  std::vector<uint64_t> starts(chunks), first_rows(chunks);
+  for (unsigned idx = 0; idx < chunks; idx++) {
+    starts[idx]     = derez.unpack_value<uint64_t>();
+    first_rows[idx] = derez.unpack_value<uint64_t>();
+  }
+  const uint64_t stop = derez.unpack_value<uint64_t>();
+  const char* path    = static_cast<const char*>(task->futures[0].get_untyped_pointer());
+  // Start from the last chunk that begins at or before our first row
+  const unsigned chunk =
+    std::upper_bound(first_rows.begin(), first_rows.end(), static_cast<uint64_t>(rect.lo[0])) -
+    first_rows.begin() - 1;
+  const coord_t first_col = (DIM == 1) ? 0 : rect.lo[DIM - 1];
+  const coord_t last_col  = (DIM == 1) ? 0 : rect.hi[DIM - 1];
+  const int fd            = open_text_file(path);
+  LineReader reader(fd, starts[chunk], stop);
+  coord_t row = first_rows[chunk];
+  const char *begin, *end;
+  while ((row <= rect.hi[0]) && reader.next(begin, end)) {
+    if (!trim_line(begin, end, comment)) continue;
+    if (row >= rect.lo[0]) {
+      const char* pos = begin;
+      const char *field, *field_end;
+      for (coord_t col = 0; col < columns; col++) {
+        if (!next_field(pos, end, delimiter, field, field_end)) {
+          log_numpy_io.error("Row %lld of %s has %lld columns instead of %lld",
+                             row,
+                             path,
+                             col,
+                             columns);
+          LEGATE_ABORT
+        }
+        if ((col < first_col) || (col > last_col)) continue;
+        T value;
+        if (!parse_value(field, field_end, value)) {
+          log_numpy_io.error("Unable to convert '%.*s' in row %lld of %s",
+                             static_cast<int>(field_end - field),
+                             field,
+                             row,
+                             path);
+          LEGATE_ABORT
+        }
+        store(out, row, col, value);
+      }
+      if (has_more_fields(pos, end, delimiter)) {
+        log_numpy_io.error("Row %lld of %s has more than %lld columns", row, path, columns);
+        LEGATE_ABORT
+      }
+    }
+    row++;
+  }
+  if (reader.failed()) {
+    log_numpy_io.error("Unable to read from %s: %s", path, strerror(errno));
+    LEGATE_ABORT
+  }
+  if (row <= rect.hi[0]) {
+    log_numpy_io.error("%s ended after %lld rows while loading it", path, row);
+    LEGATE_ABORT
+  }
+  close(fd);
+}
+
+template <typename T>
+/*static*/ void ReadTextTask<T>::cpu_variant(const Task* task,
+                                             const std::vector<PhysicalRegion>& regions,
+                                             Context ctx,
+                                             Runtime* runtime)
+{
+  LegateDeserializer derez(task->args, task->arglen);
+  const int dim = derez.unpack_dimension();
+  switch (dim) {
+    case 1: {
+      read_text<T, 1>(task, derez, regions);
+      break;
+    }
+    case 2: {
+      read_text<T, 2>(task, derez, regions);
+      break;
+    }
+    default: assert(false);
+  }
+}
+
+const int CountLinesTask::TASK_ID =
+  static_cast<int>(NumPyOpCode::NUMPY_COUNT_LINES) * NUMPY_TYPE_OFFSET +
+  UINT64_LT * NUMPY_MAX_VARIANTS;
+
+// Text only holds numbers that we can parse without any ambiguity
+#define INSTANTIATE_TEXT_TASKS(type, base_id)                                \
+  INSTANTIATE_INT_TASKS(type, base_id)                                       \
+  INSTANTIATE_UINT_TASKS(type, base_id)                                      \
+  template <>                                                                \
+  const int type<float>::TASK_ID = base_id + FLOAT_LT* NUMPY_MAX_VARIANTS;   \
+  template class type<float>;                                                \
+  template <>                                                                \
+  const int type<double>::TASK_ID = base_id + DOUBLE_LT* NUMPY_MAX_VARIANTS; \
+  template class type<double>;
+
+INSTANTIATE_TEXT_TASKS(ReadTextTask,
+                       static_cast<int>(NumPyOpCode::NUMPY_READ_TEXT) * NUMPY_TYPE_OFFSET)
+
+}  // namespace numpy
+}  // namespace legate
+
+namespace  // unnammed
+{
+static void __attribute__((constructor)) register_tasks(void)
+{
+  legate::numpy::CountLinesTask::register_variants();
+  REGISTER_INT_TASKS(legate::numpy::ReadTextTask)
+  REGISTER_UINT_TASKS(legate::numpy::ReadTextTask)
+  legate::numpy::ReadTextTask<float>::register_variants();
+  legate::numpy::ReadTextTask<double>::register_variants();
+}
+}  // namespace
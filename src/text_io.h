@@ -0,0 +1,60 @@
+/* Copyright 2021 NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __NUMPY_TEXT_IO_H__
+#define __NUMPY_TEXT_IO_H__
+
+#include "numpy.h"
+
+// Parallel loading of delimited text files. The frontend splits the file
+// into chunks at line boundaries, one task per chunk counts the rows in
+// it, and then the tasks for the tiles of the result parse their rows
+// starting from the chunk that holds the first one.
+
+namespace legate {
+namespace numpy {
+
+// Counts the rows with data in each chunk of the file
+class CountLinesTask : public NumPyTask<CountLinesTask> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+// Parses the rows of a tile of the result
+template <typename T>
+class ReadTextTask : public NumPyTask<ReadTextTask<T>> {
+ public:
+  static const int TASK_ID;
+  static const int REGIONS = 1;
+
+ public:
+  static void cpu_variant(const Legion::Task* task,
+                          const std::vector<Legion::PhysicalRegion>& regions,
+                          Legion::Context ctx,
+                          Legion::Runtime* runtime);
+};
+
+}  // namespace numpy
+}  // namespace legate
+
+#endif  // __NUMPY_TEXT_IO_H__
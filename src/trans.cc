@@ -15,565 +15,274 @@
  */
 
 #include "trans.h"
-#include "cblas.h"
 #include "proj.h"
+#include <vector>
+#ifdef LEGATE_USE_OPENMP
+#include <omp.h>
+#endif
+
+// Leaves of the recursive tiling are at most this many bytes so that the
+// source and destination tiles of a leaf fit in the L1 cache together
+#define TRANS_LEAF_BYTES 8192
 
 using namespace Legion;
 
 namespace legate {
 namespace numpy {
 
-template <typename T, int BF>
-static void trans_block_2d(const Task* task,
-                           Runtime* runtime,
-                           LegateDeserializer& derez,
-                           const std::vector<PhysicalRegion>& regions)
+// Side of the square blocks that are transposed in registers, 8x8 for
+// types up to 32 bits and 4x4 for the wider types
+template <typename T>
+struct TransBlock {
+  static const int SIZE = (sizeof(T) <= 4) ? 8 : 4;
+};
+
+// Transposes one SIZE x SIZE block. The block is loaded along the source's
+// contiguous dimension and stored along the destination's contiguous
+// dimension. With the trip counts fixed at compile time the compiler keeps
+// the whole block in registers and turns the loops into vector loads,
+// shuffles and stores. DENSE means both contiguous dimensions have unit
+// stride which is the common case and lets the compiler assume it.
+template <typename T, bool DENSE>
+static inline void transpose_block(
+  T* out, const size_t out_i, const size_t out_j, const T* in, const size_t in_i, const size_t in_j)
 {
-  const Rect<2> out_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-  if (out_rect.empty()) return;
-  const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], out_rect);
-  // We know what the output shape has to be based on the input shape
-  const Rect<2> in_rect(Point<2>(out_rect.lo[1], out_rect.lo[0]),
-                        Point<2>(out_rect.hi[1], out_rect.hi[0]));
-  const AccessorRO<T, 2> in = derez.unpack_accessor_RO<T, 2>(regions[1], in_rect);
-  for (coord_t i1 = in_rect.lo[0]; i1 <= in_rect.hi[0]; i1 += BF) {
-    for (coord_t j1 = in_rect.lo[1]; j1 <= in_rect.hi[1]; j1 += BF) {
-      const coord_t max_i2 = ((i1 + BF) <= in_rect.hi[0]) ? i1 + BF : in_rect.hi[0];
-      const coord_t max_j2 = ((j1 + BF) <= in_rect.hi[1]) ? j1 + BF : in_rect.hi[1];
-      for (int i2 = i1; i2 <= max_i2; i2++)
-        for (int j2 = j1; j2 <= max_j2; j2++) out[j2][i2] = in[i2][j2];
-    }
-  }
+  const int SIZE = TransBlock<T>::SIZE;
+  T block[SIZE][SIZE];
+  for (int i = 0; i < SIZE; i++)
+    for (int j = 0; j < SIZE; j++) block[i][j] = in[i * in_i + j * (DENSE ? 1 : in_j)];
+  for (int j = 0; j < SIZE; j++)
+    for (int i = 0; i < SIZE; i++) out[i * (DENSE ? 1 : out_i) + j * out_j] = block[i][j];
 }
 
-#ifdef LEGATE_USE_OPENMP
-template <typename T, int BF>
-static void trans_block_2d_omp(const Task* task,
-                               Runtime* runtime,
-                               LegateDeserializer& derez,
-                               const std::vector<PhysicalRegion>& regions)
-{
-  const Rect<2> out_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-  if (out_rect.empty()) return;
-  const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], out_rect);
-  // We know what the output shape has to be based on the input shape
-  const Rect<2> in_rect(Point<2>(out_rect.lo[1], out_rect.lo[0]),
-                        Point<2>(out_rect.hi[1], out_rect.hi[0]));
-  const AccessorRO<T, 2> in = derez.unpack_accessor_RO<T, 2>(regions[1], in_rect);
-#pragma omp parallel for
-  for (coord_t i1 = in_rect.lo[0]; i1 <= in_rect.hi[0]; i1 += BF) {
-    for (coord_t j1 = in_rect.lo[1]; j1 <= in_rect.hi[1]; j1 += BF) {
-      const coord_t max_i2 = ((i1 + BF) <= in_rect.hi[0]) ? i1 + BF : in_rect.hi[0];
-      const coord_t max_j2 = ((j1 + BF) <= in_rect.hi[1]) ? j1 + BF : in_rect.hi[1];
-      for (int i2 = i1; i2 <= max_i2; i2++)
-        for (int j2 = j1; j2 <= max_j2; j2++) out[j2][i2] = in[i2][j2];
+// Cache-oblivious permutation of an N-D rectangle. The source accessor has
+// already been permuted into the destination's index space so the two
+// sides differ only in their strides. The rectangle is recursively halved
+// along its longest dimension until a piece fits in the cache, and each
+// piece is then walked as a stack of 2-D transposes in the plane of the
+// destination's fastest dimension (i) and the source's fastest one (j).
+template <typename T, int DIM>
+class Transposer {
+ public:
+  Transposer(T* out,
+             const size_t* out_strides,
+             const T* in,
+             const size_t* in_strides,
+             const Rect<DIM>& rect)
+    : out_ptr(out), in_ptr(in), origin(rect.lo)
+  {
+    for (int d = 0; d < DIM; d++) {
+      out_pitch[d] = out_strides[d];
+      in_pitch[d]  = in_strides[d];
     }
+    i_dim = transpose_fastest_dim<DIM>(rect, out_strides);
+    j_dim = transpose_fastest_dim<DIM>(rect, in_strides);
+    dense = (out_pitch[i_dim] == 1) && (in_pitch[j_dim] == 1);
   }
-}
-#endif
 
-template <>
-/*static*/ void TransTask<bool>::cpu_variant(const Task* task,
-                                             const std::vector<PhysicalRegion>& regions,
-                                             Context ctx,
-                                             Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d<bool, 128>(task, runtime, derez, regions);
-      break;
+ public:
+  void transpose(const Rect<DIM>& rect) const
+  {
+    if ((rect.volume() * sizeof(T)) <= TRANS_LEAF_BYTES) {
+      leaf(rect);
+      return;
     }
-    default: assert(false);  // unsupported transpose dimension
+    Rect<DIM> lower, upper;
+    halve(rect, lower, upper);
+    transpose(lower);
+    transpose(upper);
   }
-}
-
-template <>
-/*static*/ void TransTask<int16_t>::cpu_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d<int16_t, 64>(task, runtime, derez, regions);
-      break;
+  // Breaks the rectangle into pieces of no more than max_volume points
+  // that can be transposed independently
+  void split(const Rect<DIM>& rect, size_t max_volume, std::vector<Rect<DIM>>& pieces) const
+  {
+    if (rect.volume() <= max_volume) {
+      pieces.push_back(rect);
+      return;
     }
-    default: assert(false);  // unsupported transpose dimension
+    Rect<DIM> lower, upper;
+    halve(rect, lower, upper);
+    split(lower, max_volume, pieces);
+    split(upper, max_volume, pieces);
   }
-}
 
-template <>
-/*static*/ void TransTask<uint16_t>::cpu_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d<uint16_t, 64>(task, runtime, derez, regions);
-      break;
+ private:
+  void halve(const Rect<DIM>& rect, Rect<DIM>& lower, Rect<DIM>& upper) const
+  {
+    int dim        = 0;
+    coord_t extent = 0;
+    for (int d = 0; d < DIM; d++) {
+      const coord_t size = rect.hi[d] - rect.lo[d] + 1;
+      if (size > extent) {
+        dim    = d;
+        extent = size;
+      }
     }
-    default: assert(false);  // unsupported transpose dimension
+    assert(extent > 1);
+    // Keep the cut on a block boundary so the halves still have full blocks
+    const int SIZE = TransBlock<T>::SIZE;
+    coord_t half   = extent / 2;
+    if (half > SIZE) half -= half % SIZE;
+    lower         = rect;
+    upper         = rect;
+    lower.hi[dim] = rect.lo[dim] + half - 1;
+    upper.lo[dim] = rect.lo[dim] + half;
   }
-}
 
-template <>
-/*static*/ void TransTask<__half>::cpu_variant(const Task* task,
-                                               const std::vector<PhysicalRegion>& regions,
-                                               Context ctx,
-                                               Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d<__half, 64>(task, runtime, derez, regions);
-      break;
+  void leaf(const Rect<DIM>& rect) const
+  {
+    // Walk every point in the dimensions outside the (i, j) plane
+    Point<DIM> point = rect.lo;
+    while (true) {
+      if (i_dim == j_dim)
+        copy_line(rect, point);
+      else if (dense)
+        transpose_plane<true>(rect, point);
+      else
+        transpose_plane<false>(rect, point);
+      int d = DIM - 1;
+      for (; d >= 0; d--) {
+        if ((d == i_dim) || (d == j_dim)) continue;
+        if (point[d] < rect.hi[d]) {
+          point[d]++;
+          break;
+        }
+        point[d] = rect.lo[d];
+      }
+      if (d < 0) break;
     }
-    default: assert(false);  // unsupported transpose dimension
   }
-}
 
-#ifdef LEGATE_USE_OPENMP
-template <>
-/*static*/ void TransTask<bool>::omp_variant(const Task* task,
-                                             const std::vector<PhysicalRegion>& regions,
-                                             Context ctx,
-                                             Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d_omp<bool, 128>(task, runtime, derez, regions);
-      break;
+  template <bool DENSE>
+  void transpose_plane(const Rect<DIM>& rect, const Point<DIM>& point) const
+  {
+    const int SIZE     = TransBlock<T>::SIZE;
+    T* out             = out_ptr + offset(point, out_pitch);
+    const T* in        = in_ptr + offset(point, in_pitch);
+    const coord_t m    = rect.hi[i_dim] - rect.lo[i_dim] + 1;
+    const coord_t n    = rect.hi[j_dim] - rect.lo[j_dim] + 1;
+    const size_t out_i = out_pitch[i_dim];
+    const size_t out_j = out_pitch[j_dim];
+    const size_t in_i  = in_pitch[i_dim];
+    const size_t in_j  = in_pitch[j_dim];
+    coord_t i          = 0;
+    for (; (i + SIZE) <= m; i += SIZE) {
+      coord_t j = 0;
+      for (; (j + SIZE) <= n; j += SIZE)
+        transpose_block<T, DENSE>(
+          out + i * out_i + j * out_j, out_i, out_j, in + i * in_i + j * in_j, in_i, in_j);
+      // Ragged edge along j
+      for (; j < n; j++)
+        for (coord_t ii = i; ii < (i + SIZE); ii++)
+          out[ii * out_i + j * out_j] = in[ii * in_i + j * in_j];
     }
-    default: assert(false);  // unsupported transpose dimension
+    // Ragged edge along i
+    for (; i < m; i++)
+      for (coord_t j = 0; j < n; j++) out[i * out_i + j * out_j] = in[i * in_i + j * in_j];
   }
-}
 
-template <>
-/*static*/ void TransTask<int16_t>::omp_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d_omp<int16_t, 64>(task, runtime, derez, regions);
-      break;
+  void copy_line(const Rect<DIM>& rect, const Point<DIM>& point) const
+  {
+    // Both sides are contiguous in the same dimension so this is a copy
+    T* out             = out_ptr + offset(point, out_pitch);
+    const T* in        = in_ptr + offset(point, in_pitch);
+    const coord_t n    = rect.hi[i_dim] - rect.lo[i_dim] + 1;
+    const size_t out_i = out_pitch[i_dim];
+    const size_t in_i  = in_pitch[i_dim];
+    if ((out_i == 1) && (in_i == 1)) {
+      for (coord_t i = 0; i < n; i++) out[i] = in[i];
+    } else {
+      for (coord_t i = 0; i < n; i++) out[i * out_i] = in[i * in_i];
     }
-    default: assert(false);  // unsupported transpose dimension
   }
-}
 
-template <>
-/*static*/ void TransTask<uint16_t>::omp_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d_omp<uint16_t, 64>(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<__half>::omp_variant(const Task* task,
-                                               const std::vector<PhysicalRegion>& regions,
-                                               Context ctx,
-                                               Runtime* runtime)
-{
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_block_2d_omp<__half, 64>(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-#endif
-
-static void trans_32bit_2d(const Task* task,
-                           Runtime* runtime,
-                           LegateDeserializer& derez,
-                           const std::vector<PhysicalRegion>& regions)
-{
-  const Rect<2> out_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-  if (out_rect.empty()) return;
-  const AccessorWO<float, 2> out = derez.unpack_accessor_WO<float, 2>(regions[0], out_rect);
-  size_t out_strides[2];
-  float* out_ptr = out.ptr(out_rect, out_strides);
-  // We know what the output shape has to be based on the input shape
-  const Rect<2> in_rect(Point<2>(out_rect.lo[1], out_rect.lo[0]),
-                        Point<2>(out_rect.hi[1], out_rect.hi[0]));
-  const AccessorRO<float, 2> in = derez.unpack_accessor_RO<float, 2>(regions[1], in_rect);
-  size_t in_strides[2];
-  const float* in_ptr = in.ptr(in_rect, in_strides);
-  const coord_t m     = (in_rect.hi[0] - in_rect.lo[0]) + 1;
-  const coord_t n     = (in_rect.hi[1] - in_rect.lo[1]) + 1;
-  cblas_somatcopy(
-    CblasRowMajor, CblasTrans, m, n, 1.f /*scale*/, in_ptr, in_strides[0], out_ptr, out_strides[0]);
-}
-
-template <>
-/*static*/ void TransTask<float>::cpu_variant(const Task* task,
-                                              const std::vector<PhysicalRegion>& regions,
-                                              Context ctx,
-                                              Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+  inline size_t offset(const Point<DIM>& point, const size_t pitch[DIM]) const
+  {
+    size_t result = 0;
+    for (int d = 0; d < DIM; d++) result += (point[d] - origin[d]) * pitch[d];
+    return result;
   }
-}
-
-template <>
-/*static*/ void TransTask<uint32_t>::cpu_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
 
-template <>
-/*static*/ void TransTask<int32_t>::cpu_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
+ private:
+  T* const out_ptr;
+  const T* const in_ptr;
+  const Point<DIM> origin;
+  size_t out_pitch[DIM];
+  size_t in_pitch[DIM];
+  int i_dim, j_dim;
+  bool dense;
+};
+
+template <typename T, int DIM>
+static void transpose_nd(const Task* task,
+                         LegateDeserializer& derez,
+                         const std::vector<PhysicalRegion>& regions,
+                         bool parallel)
 {
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<complex<__half>>::cpu_variant(const Task* task,
-                                                        const std::vector<PhysicalRegion>& regions,
-                                                        Context ctx,
-                                                        Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  // The source is permuted into our index space by its accessor transform
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  size_t out_strides[DIM], in_strides[DIM];
+  T* out_ptr      = out.ptr(rect, out_strides);
+  const T* in_ptr = in.ptr(rect, in_strides);
+  const Transposer<T, DIM> transposer(out_ptr, out_strides, in_ptr, in_strides, rect);
 #ifdef LEGATE_USE_OPENMP
-template <>
-/*static*/ void TransTask<float>::omp_variant(const Task* task,
-                                              const std::vector<PhysicalRegion>& regions,
-                                              Context ctx,
-                                              Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<uint32_t>::omp_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+  if (parallel) {
+    // Give each thread a few pieces so that the ragged ones even out
+    const size_t target = 4 * omp_get_max_threads();
+    size_t max_volume   = (rect.volume() + target - 1) / target;
+    if ((max_volume * sizeof(T)) < TRANS_LEAF_BYTES) max_volume = TRANS_LEAF_BYTES / sizeof(T);
+    std::vector<Rect<DIM>> pieces;
+    transposer.split(rect, max_volume, pieces);
+    const int num_pieces = pieces.size();
+#pragma omp parallel for schedule(static)
+    for (int idx = 0; idx < num_pieces; idx++) transposer.transpose(pieces[idx]);
+    return;
   }
-}
-
-template <>
-/*static*/ void TransTask<int32_t>::omp_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<complex<__half>>::omp_variant(const Task* task,
-                                                        const std::vector<PhysicalRegion>& regions,
-                                                        Context ctx,
-                                                        Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_32bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
 #endif
-
-static void trans_64bit_2d(const Task* task,
-                           Runtime* runtime,
-                           LegateDeserializer& derez,
-                           const std::vector<PhysicalRegion>& regions)
-{
-  const Rect<2> out_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-  if (out_rect.empty()) return;
-  const AccessorWO<double, 2> out = derez.unpack_accessor_WO<double, 2>(regions[0], out_rect);
-  size_t out_strides[2];
-  double* out_ptr = out.ptr(out_rect, out_strides);
-  // We know what the output shape has to be based on the input shape
-  const Rect<2> in_rect(Point<2>(out_rect.lo[1], out_rect.lo[0]),
-                        Point<2>(out_rect.hi[1], out_rect.hi[0]));
-  const AccessorRO<double, 2> in = derez.unpack_accessor_RO<double, 2>(regions[1], in_rect);
-  size_t in_strides[2];
-  const double* in_ptr = in.ptr(in_rect, in_strides);
-  const coord_t m      = (in_rect.hi[0] - in_rect.lo[0]) + 1;
-  const coord_t n      = (in_rect.hi[1] - in_rect.lo[1]) + 1;
-  cblas_domatcopy(
-    CblasRowMajor, CblasTrans, m, n, 1.0 /*scale*/, in_ptr, in_strides[0], out_ptr, out_strides[0]);
+  transposer.transpose(rect);
 }
 
-template <>
-/*static*/ void TransTask<double>::cpu_variant(const Task* task,
-                                               const std::vector<PhysicalRegion>& regions,
-                                               Context ctx,
-                                               Runtime* runtime)
+template <typename T>
+/*static*/ void TransTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
 {
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
   LegateDeserializer derez(task->args, task->arglen);
   const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
   switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+#define DIMFUNC(DIM)                                                \
+  case DIM: {                                                       \
+    transpose_nd<T, DIM>(task, derez, regions, false /*parallel*/); \
+    break;                                                          \
   }
-}
-
-template <>
-/*static*/ void TransTask<int64_t>::cpu_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<uint64_t>::cpu_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<complex<float>>::cpu_variant(const Task* task,
-                                                       const std::vector<PhysicalRegion>& regions,
-                                                       Context ctx,
-                                                       Runtime* runtime)
-{
-  openblas_set_num_threads(1);  // make sure this isn't overzealous
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
   }
 }
 
 #ifdef LEGATE_USE_OPENMP
-template <>
-/*static*/ void TransTask<double>::omp_variant(const Task* task,
-                                               const std::vector<PhysicalRegion>& regions,
-                                               Context ctx,
-                                               Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<int64_t>::omp_variant(const Task* task,
-                                                const std::vector<PhysicalRegion>& regions,
-                                                Context ctx,
-                                                Runtime* runtime)
+template <typename T>
+/*static*/ void TransTask<T>::omp_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
 {
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
   LegateDeserializer derez(task->args, task->arglen);
   const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
   switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+#define DIMFUNC(DIM)                                               \
+  case DIM: {                                                      \
+    transpose_nd<T, DIM>(task, derez, regions, true /*parallel*/); \
+    break;                                                         \
   }
-}
-
-template <>
-/*static*/ void TransTask<uint64_t>::omp_variant(const Task* task,
-                                                 const std::vector<PhysicalRegion>& regions,
-                                                 Context ctx,
-                                                 Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
-  }
-}
-
-template <>
-/*static*/ void TransTask<complex<float>>::omp_variant(const Task* task,
-                                                       const std::vector<PhysicalRegion>& regions,
-                                                       Context ctx,
-                                                       Runtime* runtime)
-{
-  // Assuming that openblas is built with OpenMP support we shouldn't need
-  // to set the number of threads as it will use our OpenMP threads
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  // We only support 2-D transposes for now
-  switch (dim) {
-    case 2: {
-      trans_64bit_2d(task, runtime, derez, regions);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
   }
 }
 #endif
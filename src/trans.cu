@@ -20,65 +20,129 @@
 
 #define TILE_DIM 32
 #define BLOCK_ROWS 8
+// Limit on the z dimension of the grid
+#define MAX_PLANE_CTAS 65535
 
 using namespace Legion;
 
 namespace legate {
 namespace numpy {
 
-template <typename T>
+// Strides and extents of the two sides of a transpose. The source accessor
+// has been permuted into the destination's index space so both sides are
+// walked with the same coordinates.
+template <int DIM>
+struct TransPlan {
+  coord_t extents[DIM];
+  size_t out_pitch[DIM];
+  size_t in_pitch[DIM];
+  // Fastest-varying dimensions of the destination and the source
+  int i_dim, j_dim;
+};
+
+// Each CTA transposes one TILE_DIM x TILE_DIM tile of the plane spanned by
+// the two fastest dimensions, and loops over the planes of the remaining
+// dimensions in the z dimension of the grid
+template <typename T, int DIM>
 __global__ void __launch_bounds__((TILE_DIM * BLOCK_ROWS), MIN_CTAS_PER_SM)
-  legate_transpose_2d(const AccessorWO<T, 2> out,
-                      const AccessorRO<T, 2> in,
-                      const Point<2> lo_in,
-                      const Point<2> hi_in,
-                      const Point<2> lo_out,
-                      const Point<2> hi_out)
+  legate_transpose_nd(T* out, const T* in, const TransPlan<DIM> plan, const size_t planes)
 {
   __shared__ T tile[TILE_DIM][TILE_DIM + 1 /*avoid bank conflicts*/];
 
-  // These are reversed here for coalescing
-  coord_t x = blockIdx.y * TILE_DIM + threadIdx.y;
-  coord_t y = blockIdx.x * TILE_DIM + threadIdx.x;
-
-  // Check to see if we hit our y-bounds, if so we can just mask off those threads
-  if ((lo_in[1] + y) <= hi_in[1]) {
-    // Check to see if we're going to hit our x-bounds while striding
-    if ((lo_in[0] + (blockIdx.y + 1) * TILE_DIM - 1) <= hi_in[0]) {
-// No overflow case
+  const coord_t m      = plan.extents[plan.i_dim];
+  const coord_t n      = plan.extents[plan.j_dim];
+  const coord_t i_base = blockIdx.y * TILE_DIM;
+  const coord_t j_base = blockIdx.x * TILE_DIM;
+  for (size_t plane = blockIdx.z; plane < planes; plane += gridDim.z) {
+    // Find the start of this plane on both sides
+    size_t out_offset = 0;
+    size_t in_offset  = 0;
+    size_t index      = plane;
+    for (int d = DIM - 1; d >= 0; d--) {
+      if ((d == plan.i_dim) || (d == plan.j_dim)) continue;
+      const coord_t coord = index % plan.extents[d];
+      index /= plan.extents[d];
+      out_offset += coord * plan.out_pitch[d];
+      in_offset += coord * plan.in_pitch[d];
+    }
+    // Read rows along the source's contiguous dimension for coalescing
+    coord_t j = j_base + threadIdx.x;
+    if (j < n) {
 #pragma unroll
-      for (int i = 0; i < TILE_DIM; i += BLOCK_ROWS)
-        tile[threadIdx.y + i][threadIdx.x] = in[lo_in + Point<2>(x + i, y)];
-    } else {
-// Overflow case
+      for (int k = 0; k < TILE_DIM; k += BLOCK_ROWS) {
+        const coord_t i = i_base + threadIdx.y + k;
+        if (i < m)
+          tile[threadIdx.y + k][threadIdx.x] =
+            in[in_offset + i * plan.in_pitch[plan.i_dim] + j * plan.in_pitch[plan.j_dim]];
+      }
+    }
+    // Make sure all the data is in shared memory
+    __syncthreads();
+    // Write rows along the destination's contiguous dimension
+    const coord_t i = i_base + threadIdx.x;
+    if (i < m) {
 #pragma unroll
-      for (int i = 0; i < TILE_DIM; i += BLOCK_ROWS)
-        if ((lo_in[0] + x + i) <= hi_in[0])
-          tile[threadIdx.y + i][threadIdx.x] = in[lo_in + Point<2>(x + i, y)];
+      for (int k = 0; k < TILE_DIM; k += BLOCK_ROWS) {
+        j = j_base + threadIdx.y + k;
+        if (j < n)
+          out[out_offset + i * plan.out_pitch[plan.i_dim] + j * plan.out_pitch[plan.j_dim]] =
+            tile[threadIdx.x][threadIdx.y + k];
+      }
     }
+    // Everyone has to be done with the tile before we refill it
+    __syncthreads();
   }
-  // Make sure all the data is in shared memory
-  __syncthreads();
+}
 
-  // Transpose the coordinates
-  x = blockIdx.x * TILE_DIM + threadIdx.y;
-  y = blockIdx.y * TILE_DIM + threadIdx.x;
+// When both sides are contiguous in the same dimension the permutation
+// only moves whole rows around and a strided copy is already coalesced
+template <typename T, int DIM>
+__global__ void __launch_bounds__(THREADS_PER_BLOCK, MIN_CTAS_PER_SM)
+  legate_permute_copy(T* out, const T* in, const TransPlan<DIM> plan, const size_t volume)
+{
+  const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (idx >= volume) return;
+  size_t out_offset = 0;
+  size_t in_offset  = 0;
+  size_t index      = idx;
+  for (int d = DIM - 1; d >= 0; d--) {
+    const coord_t coord = index % plan.extents[d];
+    index /= plan.extents[d];
+    out_offset += coord * plan.out_pitch[d];
+    in_offset += coord * plan.in_pitch[d];
+  }
+  out[out_offset] = in[in_offset];
+}
 
-  // Check to see if we hit our y-bounds, if so we can just mask off those threads
-  if ((lo_out[1] + y) <= hi_out[1]) {
-    // Check to see if we're going to hit our x-bounds while striding
-    if ((lo_out[0] + (blockIdx.x + 1) * TILE_DIM - 1) <= hi_out[0]) {
-// No overflow case
-#pragma unroll
-      for (int i = 0; i < TILE_DIM; i += BLOCK_ROWS)
-        out[lo_out + Point<2>(x + i, y)] = tile[threadIdx.x][threadIdx.y + i];
-    } else {
-// Overflow case
-#pragma unroll
-      for (int i = 0; i < TILE_DIM; i += BLOCK_ROWS)
-        if ((lo_out[0] + x + i) <= hi_out[0])
-          out[lo_out + Point<2>(x + i, y)] = tile[threadIdx.x][threadIdx.y + i];
-    }
+template <typename T, int DIM>
+static void transpose_nd(const Task* task,
+                         LegateDeserializer& derez,
+                         const std::vector<PhysicalRegion>& regions)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  // The source is permuted into our index space by its accessor transform
+  const AccessorRO<T, DIM> in = derez.unpack_accessor_RO<T, DIM>(regions[1], rect);
+  TransPlan<DIM> plan;
+  T* out_ptr      = out.ptr(rect, plan.out_pitch);
+  const T* in_ptr = in.ptr(rect, plan.in_pitch);
+  for (int d = 0; d < DIM; d++) plan.extents[d] = rect.hi[d] - rect.lo[d] + 1;
+  plan.i_dim          = transpose_fastest_dim<DIM>(rect, plan.out_pitch);
+  plan.j_dim          = transpose_fastest_dim<DIM>(rect, plan.in_pitch);
+  const size_t volume = rect.volume();
+  if (plan.i_dim == plan.j_dim) {
+    const size_t blocks = (volume + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    legate_permute_copy<T, DIM><<<blocks, THREADS_PER_BLOCK>>>(out_ptr, in_ptr, plan, volume);
+  } else {
+    const coord_t m     = plan.extents[plan.i_dim];
+    const coord_t n     = plan.extents[plan.j_dim];
+    const size_t planes = volume / (m * n);
+    const dim3 blocks((n + TILE_DIM - 1) / TILE_DIM,
+                      (m + TILE_DIM - 1) / TILE_DIM,
+                      (planes < MAX_PLANE_CTAS) ? planes : MAX_PLANE_CTAS);
+    const dim3 threads(TILE_DIM, BLOCK_ROWS, 1);
+    legate_transpose_nd<T, DIM><<<blocks, threads>>>(out_ptr, in_ptr, plan, planes);
   }
 }
 
@@ -91,23 +155,14 @@ template <typename T>
   LegateDeserializer derez(task->args, task->arglen);
   const int dim = derez.unpack_dimension();
   switch (dim) {
-    case 2: {
-      const Rect<2> out_rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (out_rect.empty()) break;
-      const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], out_rect);
-      // We know what the output shape has to be based on the input shape
-      const Rect<2> in_rect(Point<2>(out_rect.lo[1], out_rect.lo[0]),
-                            Point<2>(out_rect.hi[1], out_rect.hi[0]));
-      const AccessorRO<T, 2> in = derez.unpack_accessor_RO<T, 2>(regions[1], in_rect);
-      const coord_t m           = (in_rect.hi[0] - in_rect.lo[0]) + 1;
-      const coord_t n           = (in_rect.hi[1] - in_rect.lo[1]) + 1;
-      const dim3 blocks((n + TILE_DIM - 1) / TILE_DIM, (m + TILE_DIM - 1) / TILE_DIM, 1);
-      const dim3 threads(TILE_DIM, BLOCK_ROWS, 1);
-      legate_transpose_2d<T>
-        <<<blocks, threads>>>(out, in, in_rect.lo, in_rect.hi, out_rect.lo, out_rect.hi);
-      break;
-    }
-    default: assert(false);  // unsupported transpose dimension
+#define DIMFUNC(DIM)                            \
+  case DIM: {                                   \
+    transpose_nd<T, DIM>(task, derez, regions); \
+    break;                                      \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
+    default: assert(false);
   }
 }
 
@@ -21,6 +21,23 @@
 
 namespace legate {
 namespace numpy {
+// The transpose task reads its source through an affine view that permutes
+// the source into the index space of the destination, so both accessors
+// name the same points and the permutation only shows up in the strides.
+// This finds the fastest-varying dimension of one side of the copy, which
+// is where that side wants to be walked contiguously.
+template <int DIM>
+inline int transpose_fastest_dim(const Legion::Rect<DIM>& rect, const size_t strides[DIM])
+{
+  int result = -1;
+  for (int d = 0; d < DIM; d++) {
+    // Dimensions with a single point can have any stride
+    if (rect.lo[d] == rect.hi[d]) continue;
+    if ((result < 0) || (strides[d] < strides[result])) result = d;
+  }
+  return (result < 0) ? (DIM - 1) : result;
+}
+
 template <typename T>
 class TransTask : public NumPyTask<TransTask<T>> {
  public:
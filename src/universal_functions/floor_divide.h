@@ -17,6 +17,7 @@
 #ifndef __NUMPY_FLOOR_DIVIDE_H__
 #define __NUMPY_FLOOR_DIVIDE_H__
 
+#include "int_divider.h"
 #include "universal_function.h"
 #include <cmath>
 
@@ -32,6 +33,28 @@ struct FloorDivideOperation {
   constexpr T operator()(const T& a, const T& b) const { return floor(a / b); }
 };
 
+// Integers divided by a broadcast scalar use a precomputed multiply and
+// shift instead of a division for every element, on GPUs as well so that
+// dividing by zero gives zero everywhere
+template <class T>
+class ScalarRhsOperation<
+  FloorDivideOperation<T>,
+  std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>> {
+ public:
+  static constexpr bool on_device = true;
+
+ public:
+  ScalarRhsOperation(const T& s) : divider(s) {}
+
+ public:
+  __CUDA_HD__ inline T operator()(const T& a) const { return divider.quotient(a); }
+  template <typename F>
+  inline void visit(F&& f) const { f(*this); }
+
+ private:
+  const IntDivider<T> divider;
+};
+
 // Standard data-parallel division task
 template <typename T>
 using FloorDivide = NoncommutativeBinaryUniversalFunction<FloorDivideOperation<T>>;
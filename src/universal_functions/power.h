@@ -18,7 +18,10 @@
 #define __NUMPY_POWER_H__
 
 #include "universal_function.h"
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <type_traits>
 
 namespace legate {
 namespace numpy {
@@ -35,6 +38,142 @@ struct PowerOperation {
   }
 };
 
+// Raises base to a non-negative whole power with log2(n) multiplies
+template <typename T>
+inline T power_by_squaring(T base, uint64_t n)
+{
+  T result = T(1);
+  for (; n > 0; n >>= 1) {
+    if (n & 1) result *= base;
+    base *= base;
+  }
+  return result;
+}
+
+// Small whole and half exponents of floating point bases run as chains of
+// multiplies with a square root or a reciprocal at the end instead of pow.
+// The most common ones get their own loops without any branches. Results
+// match pow for zeros, infinities and NaNs, but a long chain can be a few
+// ulps further from the exact power than pow is.
+template <class T>
+class ScalarRhsOperation<PowerOperation<T>, std::enable_if_t<std::is_floating_point<T>::value>> {
+ public:
+  static constexpr bool on_device = false;
+
+ private:
+  enum class Kind { GENERIC, ONE, IDENTITY, SQUARE, CUBE, RECIPROCAL, SQRT, RSQRT, CHAIN };
+  static constexpr uint64_t MAX_CHAIN = 16;
+
+  // pow(a, 0.5) is +0 for -0 and +inf for -inf where sqrt gives -0 and
+  // NaN. Adding zero turns -0 into +0 and the select stays branch-free.
+  static inline T root(const T& a)
+  {
+    constexpr T inf = std::numeric_limits<T>::infinity();
+    return (a == -inf) ? inf : std::sqrt(a + T(0));
+  }
+
+ public:
+  ScalarRhsOperation(const T& e) : exponent(e)
+  {
+    const T twice = e + e;
+    if (!(std::trunc(twice) == twice && std::abs(twice) <= T(2 * MAX_CHAIN + 1))) return;
+    const uint64_t n = static_cast<uint64_t>(std::abs(twice));
+    whole            = n >> 1;
+    half             = (n & 1) != 0;
+    negative         = e < T(0);
+    if (e == T(0))
+      kind = Kind::ONE;
+    else if (e == T(1))
+      kind = Kind::IDENTITY;
+    else if (e == T(2))
+      kind = Kind::SQUARE;
+    else if (e == T(3))
+      kind = Kind::CUBE;
+    else if (e == T(-1))
+      kind = Kind::RECIPROCAL;
+    else if (e == T(0.5))
+      kind = Kind::SQRT;
+    else if (e == T(-0.5))
+      kind = Kind::RSQRT;
+    else
+      kind = Kind::CHAIN;
+  }
+
+ public:
+  inline T operator()(const T& a) const
+  {
+    if (kind != Kind::CHAIN) return pow(a, exponent);
+    // The sign of the base only matters for whole powers: half powers
+    // of finite negative bases are NaN from the root anyway
+    const T result =
+      half ? power_by_squaring(std::abs(a), whole) * root(a) : power_by_squaring(a, whole);
+    return negative ? T(1) / result : result;
+  }
+  template <typename F>
+  inline void visit(F&& f) const
+  {
+    switch (kind) {
+      case Kind::ONE: f([](const T&) { return T(1); }); break;
+      case Kind::IDENTITY: f([](const T& a) { return a; }); break;
+      case Kind::SQUARE: f([](const T& a) { return a * a; }); break;
+      case Kind::CUBE: f([](const T& a) { return a * a * a; }); break;
+      case Kind::RECIPROCAL: f([](const T& a) { return T(1) / a; }); break;
+      case Kind::SQRT: f([](const T& a) { return root(a); }); break;
+      case Kind::RSQRT: f([](const T& a) { return T(1) / root(a); }); break;
+      default: f(*this);
+    }
+  }
+
+ private:
+  const T exponent;
+  Kind kind      = Kind::GENERIC;
+  uint64_t whole = 0;
+  bool half      = false;
+  bool negative  = false;
+};
+
+// Integer bases with non-negative exponents are exact with repeated
+// squaring, which wraps around on overflow like NumPy does. The products
+// are unsigned and at least as wide as an int to keep them well defined.
+template <class T>
+class ScalarRhsOperation<
+  PowerOperation<T>,
+  std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>> {
+ private:
+  using U = std::make_unsigned_t<T>;
+  using W = std::conditional_t<(sizeof(U) < sizeof(unsigned)), unsigned, U>;
+
+  static inline T wrap(W value) { return static_cast<T>(static_cast<U>(value)); }
+  static inline W widen(T value) { return static_cast<W>(static_cast<U>(value)); }
+
+ public:
+  static constexpr bool on_device = false;
+
+ public:
+  ScalarRhsOperation(const T& e) : exponent(e) {}
+
+ public:
+  inline T operator()(const T& a) const
+  {
+    if (exponent < T(0)) return T(pow(a, exponent));
+    return wrap(power_by_squaring(widen(a), static_cast<uint64_t>(exponent)));
+  }
+  template <typename F>
+  inline void visit(F&& f) const
+  {
+    switch (exponent) {
+      case 0: f([](const T&) { return T(1); }); break;
+      case 1: f([](const T& a) { return a; }); break;
+      case 2: f([](const T& a) { return wrap(widen(a) * widen(a)); }); break;
+      case 3: f([](const T& a) { return wrap(widen(a) * widen(a) * widen(a)); }); break;
+      default: f(*this);
+    }
+  }
+
+ private:
+  const T exponent;
+};
+
 template <typename T>
 using Power = NoncommutativeBinaryUniversalFunction<PowerOperation<T>>;
 }  // namespace numpy
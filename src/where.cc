@@ -15,6 +15,7 @@
  */
 
 #include "where.h"
+#include "point_task.h"
 #include "proj.h"
 
 using namespace Legion;
@@ -22,54 +23,117 @@ using namespace Legion;
 namespace legate {
 namespace numpy {
 
+template <typename T, int DIM>
+static ScalarOrRegion<T, DIM> unpack_where_arg(const Task* task,
+                                               LegateDeserializer& derez,
+                                               const std::vector<PhysicalRegion>& regions,
+                                               const Rect<DIM>& rect,
+                                               bool broadcast,
+                                               unsigned& region_index,
+                                               unsigned& future_index)
+{
+  ScalarOrRegion<T, DIM> arg{};
+  // Only the broadcast variant says whether an operand is a future
+  if (broadcast)
+    arg.deserialize(derez, task, regions, rect, region_index, future_index);
+  else
+    arg.accessor = derez.unpack_accessor_RO<T, DIM>(regions[region_index++], rect);
+  return arg;
+}
+
+template <typename T, int DIM, typename Cond, typename In1, typename In2>
+static void where_blend(const AccessorWO<T, DIM>& out,
+                        Cond cond,
+                        In1 in1,
+                        In2 in2,
+                        const Rect<DIM>& rect,
+                        bool parallel)
+{
+  Pitches<DIM - 1> pitches;
+  const size_t volume = pitches.flatten(rect);
+  T* outptr           = nullptr;
+#ifndef LEGION_BOUNDS_CHECKS
+  // No dense execution if we're doing bounds checks
+  if (out.accessor.is_dense_row_major(rect) && cond.dense(rect) && in1.dense(rect) &&
+      in2.dense(rect))
+    outptr = out.ptr(rect);
+#endif
+  if (outptr != nullptr) {
+    // A select on flat pointers that the compiler turns into vector blends
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      outptr[idx] = cond[idx] ? in1[idx] : in2[idx];
+    });
+  } else {
+    for_each_index(size_t(0), volume, parallel, [&](size_t idx) {
+      const Point<DIM> p = pitches.unflatten(idx, rect.lo);
+      out[p]             = cond[p] ? in1[p] : in2[p];
+    });
+  }
+}
+
+template <typename T, int DIM>
+static void where(const Task* task,
+                  LegateDeserializer& derez,
+                  const std::vector<PhysicalRegion>& regions,
+                  bool broadcast,
+                  bool parallel)
+{
+  const Rect<DIM> rect = NumPyProjectionFunctor::unpack_shape<DIM>(task, derez);
+  if (rect.empty()) return;
+  const AccessorWO<T, DIM> out = derez.unpack_accessor_WO<T, DIM>(regions[0], rect);
+  unsigned region_index        = 1;
+  unsigned future_index        = 0;
+  const ScalarOrRegion<bool, DIM> cond =
+    unpack_where_arg<bool, DIM>(task, derez, regions, rect, broadcast, region_index, future_index);
+  const ScalarOrRegion<T, DIM> in1 =
+    unpack_where_arg<T, DIM>(task, derez, regions, rect, broadcast, region_index, future_index);
+  const ScalarOrRegion<T, DIM> in2 =
+    unpack_where_arg<T, DIM>(task, derez, regions, rect, broadcast, region_index, future_index);
+  if (cond.scalar) {
+    // Only one of the inputs is ever read, so just copy or fill with it
+    const ScalarOrRegion<T, DIM>& in = cond.value ? in1 : in2;
+    const ScalarOperand<bool, DIM> always(true);
+    with_operand(
+      in, [&](auto operand) { where_blend(out, always, operand, operand, rect, parallel); });
+    return;
+  }
+  const RegionOperand<bool, DIM> mask(cond.accessor);
+  with_operand(in1, [&](auto operand1) {
+    with_operand(in2, [&](auto operand2) {
+      where_blend(out, mask, operand1, operand2, rect, parallel);
+    });
+  });
+}
+
 template <typename T>
-/*static*/ void WhereTask<T>::cpu_variant(const Task* task,
-                                          const std::vector<PhysicalRegion>& regions,
-                                          Context ctx,
-                                          Runtime* runtime)
+static void where_task(const Task* task,
+                       const std::vector<PhysicalRegion>& regions,
+                       bool broadcast,
+                       bool parallel)
 {
   LegateDeserializer derez(task->args, task->arglen);
   const int dim = derez.unpack_dimension();
   switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 1> out     = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-      const AccessorRO<bool, 1> cond = derez.unpack_accessor_RO<bool, 1>(regions[1], rect);
-      const AccessorRO<T, 1> in1     = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-      const AccessorRO<T, 1> in2     = derez.unpack_accessor_RO<T, 1>(regions[3], rect);
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1[x] : in2[x];
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 2> out     = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-      const AccessorRO<bool, 2> cond = derez.unpack_accessor_RO<bool, 2>(regions[1], rect);
-      const AccessorRO<T, 2> in1     = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-      const AccessorRO<T, 2> in2     = derez.unpack_accessor_RO<T, 2>(regions[3], rect);
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-          out[x][y] = cond[x][y] ? in1[x][y] : in2[x][y];
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 3> out     = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-      const AccessorRO<bool, 3> cond = derez.unpack_accessor_RO<bool, 3>(regions[1], rect);
-      const AccessorRO<T, 3> in1     = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-      const AccessorRO<T, 3> in2     = derez.unpack_accessor_RO<T, 3>(regions[3], rect);
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-          for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-            out[x][y][z] = cond[x][y][z] ? in1[x][y][z] : in2[x][y][z];
-      break;
-    }
+#define DIMFUNC(DIM)                                          \
+  case DIM: {                                                 \
+    where<T, DIM>(task, derez, regions, broadcast, parallel); \
+    break;                                                    \
+  }
+    LEGATE_FOREACH_N(DIMFUNC)
+#undef DIMFUNC
     default: assert(false);
   }
 }
 
+template <typename T>
+/*static*/ void WhereTask<T>::cpu_variant(const Task* task,
+                                          const std::vector<PhysicalRegion>& regions,
+                                          Context ctx,
+                                          Runtime* runtime)
+{
+  where_task<T>(task, regions, false /*broadcast*/, false /*parallel*/);
+}
+
 #ifdef LEGATE_USE_OPENMP
 template <typename T>
 /*static*/ void WhereTask<T>::omp_variant(const Task* task,
@@ -77,51 +141,9 @@ template <typename T>
                                           Context ctx,
                                           Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim = derez.unpack_dimension();
-  switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 1> out     = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-      const AccessorRO<bool, 1> cond = derez.unpack_accessor_RO<bool, 1>(regions[1], rect);
-      const AccessorRO<T, 1> in1     = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-      const AccessorRO<T, 1> in2     = derez.unpack_accessor_RO<T, 1>(regions[3], rect);
-#pragma omp parallel for
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1[x] : in2[x];
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 2> out     = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-      const AccessorRO<bool, 2> cond = derez.unpack_accessor_RO<bool, 2>(regions[1], rect);
-      const AccessorRO<T, 2> in1     = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-      const AccessorRO<T, 2> in2     = derez.unpack_accessor_RO<T, 2>(regions[3], rect);
-#pragma omp parallel for
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-          out[x][y] = cond[x][y] ? in1[x][y] : in2[x][y];
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 3> out     = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-      const AccessorRO<bool, 3> cond = derez.unpack_accessor_RO<bool, 3>(regions[1], rect);
-      const AccessorRO<T, 3> in1     = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-      const AccessorRO<T, 3> in2     = derez.unpack_accessor_RO<T, 3>(regions[3], rect);
-#pragma omp parallel for
-      for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-        for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-          for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-            out[x][y][z] = cond[x][y][z] ? in1[x][y][z] : in2[x][y][z];
-      break;
-    }
-    default: assert(false);
-  }
+  where_task<T>(task, regions, false /*broadcast*/, true /*parallel*/);
 }
-#endif  // LEGATE_USE_OPNEMP
+#endif  // LEGATE_USE_OPENMP
 
 template <typename T>
 /*static*/ void WhereBroadcast<T>::cpu_variant(const Task* task,
@@ -129,224 +151,7 @@ template <typename T>
                                                Context ctx,
                                                Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim         = derez.unpack_dimension();
-  unsigned future_index = 0;
-  switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 1> out = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          if (condition) {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1;
-          } else {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2[x];
-          }
-        } else {
-          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2;
-            }
-          } else {
-            const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2[x];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 1> cond = derez.unpack_accessor_RO<bool, 1>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1 : in2[x];
-          }
-        } else {
-          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1[x] : in2;
-        }
-      }
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          if (condition) {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1;
-          } else {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2[x][y];
-          }
-        } else {
-          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2;
-            }
-          } else {
-            const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2[x][y];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 2> cond = derez.unpack_accessor_RO<bool, 2>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = cond[x][y] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                out[x][y] = cond[x][y] ? in1 : in2[x][y];
-          }
-        } else {
-          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              out[x][y] = cond[x][y] ? in1[x][y] : in2;
-        }
-      }
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 3> out = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          if (condition) {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1;
-          } else {
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2[x][y][z];
-          }
-        } else {
-          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2;
-            }
-          } else {
-            const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-            if (condition) {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z];
-            } else {
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2[x][y][z];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 3> cond = derez.unpack_accessor_RO<bool, 3>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                  out[x][y][z] = cond[x][y][z] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                  out[x][y][z] = cond[x][y][z] ? in1 : in2[x][y][z];
-          }
-        } else {
-          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                out[x][y][z] = cond[x][y][z] ? in1[x][y][z] : in2;
-        }
-      }
-      break;
-    }
-    default: assert(false);
-  }
+  where_task<T>(task, regions, true /*broadcast*/, false /*parallel*/);
 }
 
 #ifdef LEGATE_USE_OPENMP
@@ -356,251 +161,7 @@ template <typename T>
                                                Context ctx,
                                                Runtime* runtime)
 {
-  LegateDeserializer derez(task->args, task->arglen);
-  const int dim         = derez.unpack_dimension();
-  unsigned future_index = 0;
-  switch (dim) {
-    case 1: {
-      const Rect<1> rect = NumPyProjectionFunctor::unpack_shape<1>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 1> out = derez.unpack_accessor_WO<T, 1>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          if (condition) {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1;
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2[x];
-          }
-        } else {
-          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2;
-            }
-          } else {
-            const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in1[x];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = in2[x];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 1> cond = derez.unpack_accessor_RO<bool, 1>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1 : in2[x];
-          }
-        } else {
-          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++) out[x] = cond[x] ? in1[x] : in2;
-        }
-      }
-      break;
-    }
-    case 2: {
-      const Rect<2> rect = NumPyProjectionFunctor::unpack_shape<2>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 2> out = derez.unpack_accessor_WO<T, 2>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          if (condition) {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1;
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2[x][y];
-          }
-        } else {
-          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2;
-            }
-          } else {
-            const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in1[x][y];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = in2[x][y];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 2> cond = derez.unpack_accessor_RO<bool, 2>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++) out[x][y] = cond[x][y] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                out[x][y] = cond[x][y] ? in1 : in2[x][y];
-          }
-        } else {
-          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              out[x][y] = cond[x][y] ? in1[x][y] : in2;
-        }
-      }
-      break;
-    }
-    case 3: {
-      const Rect<3> rect = NumPyProjectionFunctor::unpack_shape<3>(task, derez);
-      if (rect.empty()) break;
-      const AccessorWO<T, 3> out = derez.unpack_accessor_WO<T, 3>(regions[0], rect);
-      const bool future_cond     = derez.unpack_bool();
-      if (future_cond) {
-        const bool condition = task->futures[future_index++].get_result<bool>();
-        const bool future1   = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          if (condition) {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1;
-          } else {
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2[x][y][z];
-          }
-        } else {
-          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2;
-            }
-          } else {
-            const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-            if (condition) {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in1[x][y][z];
-            } else {
-#pragma omp parallel for
-              for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-                for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                  for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++) out[x][y][z] = in2[x][y][z];
-            }
-          }
-        }
-      } else {
-        const AccessorRO<bool, 3> cond = derez.unpack_accessor_RO<bool, 3>(regions[1], rect);
-        const bool future1             = derez.unpack_bool();
-        if (future1) {
-          const T in1        = task->futures[future_index++].get_result<T>();
-          const bool future2 = derez.unpack_bool();
-          if (future2) {
-            const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                  out[x][y][z] = cond[x][y][z] ? in1 : in2;
-          } else {
-            const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-#pragma omp parallel for
-            for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-              for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-                for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                  out[x][y][z] = cond[x][y][z] ? in1 : in2[x][y][z];
-          }
-        } else {
-          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
-          const bool future2         = derez.unpack_bool();
-          assert(future2);  // this would have been the general case
-          const T in2 = task->futures[future_index++].get_result<T>();
-#pragma omp parallel for
-          for (coord_t x = rect.lo[0]; x <= rect.hi[0]; x++)
-            for (coord_t y = rect.lo[1]; y <= rect.hi[1]; y++)
-              for (coord_t z = rect.lo[2]; z <= rect.hi[2]; z++)
-                out[x][y][z] = cond[x][y][z] ? in1[x][y][z] : in2;
-        }
-      }
-      break;
-    }
-    default: assert(false);
-  }
+  where_task<T>(task, regions, true /*broadcast*/, true /*parallel*/);
 }
 #endif  // LEGATE_USE_OPENMP
 
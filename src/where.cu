@@ -319,7 +319,7 @@ template <typename T>
           const T in1        = task->futures[future_index++].get_result<T>();
           const bool future2 = derez.unpack_bool();
           assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
+          const AccessorRO<T, 1> in2 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
           if (condition) {
             legate_where_set_1d<T, true>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, volume);
@@ -328,7 +328,7 @@ template <typename T>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, volume);
           }
         } else {
-          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[2], rect);
+          const AccessorRO<T, 1> in1 = derez.unpack_accessor_RO<T, 1>(regions[1], rect);
           const bool future2         = derez.unpack_bool();
           if (future2) {
             const T in2 = task->futures[future_index++].get_result<T>();
@@ -391,7 +391,7 @@ template <typename T>
           const T in1        = task->futures[future_index++].get_result<T>();
           const bool future2 = derez.unpack_bool();
           assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
+          const AccessorRO<T, 2> in2 = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
           if (condition) {
             legate_where_set_2d<T, true>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<1>(pitch), volume);
@@ -400,7 +400,7 @@ template <typename T>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<1>(pitch), volume);
           }
         } else {
-          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[2], rect);
+          const AccessorRO<T, 2> in1 = derez.unpack_accessor_RO<T, 2>(regions[1], rect);
           const bool future2         = derez.unpack_bool();
           if (future2) {
             const T in2 = task->futures[future_index++].get_result<T>();
@@ -465,7 +465,7 @@ template <typename T>
           const T in1        = task->futures[future_index++].get_result<T>();
           const bool future2 = derez.unpack_bool();
           assert(!future2);  // this would have been the scalar case
-          const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
+          const AccessorRO<T, 3> in2 = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
           if (condition) {
             legate_where_set_3d<T, true>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<2>(pitch), volume);
@@ -474,7 +474,7 @@ template <typename T>
               <<<blocks, THREADS_PER_BLOCK>>>(out, in1, in2, rect.lo, Point<2>(pitch), volume);
           }
         } else {
-          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[2], rect);
+          const AccessorRO<T, 3> in1 = derez.unpack_accessor_RO<T, 3>(regions[1], rect);
           const bool future2         = derez.unpack_bool();
           if (future2) {
             const T in2 = task->futures[future_index++].get_result<T>();
@@ -0,0 +1,49 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    for dtype in (np.float32, np.float64):
+        xnp = np.random.randn(10000).astype(dtype)
+        ynp = np.random.randn(10000).astype(dtype)
+        x = lg.array(xnp)
+        y = lg.array(ynp)
+
+        assert np.allclose(2.5 * xnp + ynp, lg.linalg.axpy(2.5, x, y))
+        assert np.allclose(
+            2.5 * xnp - 0.5 * ynp, lg.linalg.axpby(2.5, x, -0.5, y)
+        )
+
+        # The coefficients can also be results of earlier reductions
+        alpha = x.dot(y)
+        znp = xnp.dot(ynp) * xnp + ynp
+        z, norm = lg.linalg.axpby_dot(alpha, x, 1.0, y)
+        assert np.allclose(znp, z, rtol=1e-4)
+        assert np.allclose(znp.dot(znp), norm, rtol=1e-4)
+
+    # Integer vectors go through the ufuncs
+    anp = np.arange(10)
+    a = lg.array(anp)
+    assert np.array_equal(3 * anp + anp, lg.linalg.axpy(3, a, a))
+
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,84 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def round_bf16(values):
+    # Round to the nearest even bfloat16 value and widen it back again
+    bits = np.asarray(values, dtype=np.float32).view(np.uint32)
+    bits = (bits + 0x7FFF + ((bits >> 16) & 1)) & 0xFFFF0000
+    return bits.astype(np.uint32).view(np.float32)
+
+
+def test():
+    for shape in ((1,), (1000,), (70, 90)):
+        anp = np.random.randn(*shape).astype(np.float32)
+        bnp = np.random.randn(*shape).astype(np.float32) + 3.0
+        a = lg.bfloat16.array(anp)
+        b = lg.bfloat16.array(bnp)
+        ra = round_bf16(anp)
+        rb = round_bf16(bnp)
+
+        assert a.shape == shape
+        assert a.nbytes * 2 == anp.nbytes
+        assert np.array_equal(a.astype(np.float32), ra)
+        assert np.array_equal(a.astype(np.float64), ra.astype(np.float64))
+
+        # Every ufunc rounds its float32 result exactly once
+        assert np.array_equal(np.asarray(a + b), round_bf16(ra + rb))
+        assert np.array_equal(np.asarray(a - b), round_bf16(ra - rb))
+        assert np.array_equal(np.asarray(a * b), round_bf16(ra * rb))
+        assert np.array_equal(np.asarray(a / b), round_bf16(ra / rb))
+        assert np.array_equal(np.asarray(a * 2.5), round_bf16(ra * 2.5))
+        assert np.array_equal(np.asarray(1.0 - a), round_bf16(1.0 - ra))
+        assert np.array_equal(np.asarray(-a), -ra)
+        assert np.array_equal(np.asarray(abs(a)), np.abs(ra))
+        assert np.array_equal(
+            np.asarray(lg.bfloat16.maximum(a, b)), np.maximum(ra, rb)
+        )
+        assert np.allclose(
+            np.asarray(lg.bfloat16.sqrt(b)), np.sqrt(rb), rtol=1e-2
+        )
+        assert np.allclose(
+            np.asarray(lg.bfloat16.tanh(a)), np.tanh(ra), rtol=1e-2
+        )
+
+        # Sums accumulate in float32
+        assert np.allclose(a.sum(), np.sum(ra), rtol=1e-4, atol=1e-3)
+        assert np.allclose(a.mean(), np.mean(ra), rtol=1e-4, atol=1e-3)
+
+    # Dot products widen both sides to float32
+    xnp = np.random.randn(60, 40).astype(np.float32)
+    ynp = np.random.randn(40, 30).astype(np.float32)
+    x = lg.bfloat16.array(xnp)
+    y = lg.bfloat16.array(ynp)
+    expected = round_bf16(np.dot(round_bf16(xnp), round_bf16(ynp)))
+    assert np.allclose(np.asarray(x.dot(y)), expected, rtol=1e-2, atol=1e-2)
+    assert np.allclose(np.asarray(x @ y), expected, rtol=1e-2, atol=1e-2)
+
+    # Broadcasting goes through float32 arrays
+    r = lg.bfloat16.array(xnp[0])
+    assert np.array_equal(
+        np.asarray(x + r), round_bf16(round_bf16(xnp) + round_bf16(xnp[0]))
+    )
+
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,63 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Sizes that do and do not fill the last word
+    for size in (1, 63, 64, 1000, 100001):
+        anp = np.random.randn(size)
+        bnp = np.random.randn(size)
+        a = lg.array(anp)
+        b = lg.array(bnp)
+
+        m = lg.bitmask.less(a, 0.5)
+        assert m.nbytes < a.nbytes
+        assert np.array_equal(m.unpack(), anp < 0.5)
+        assert m.count_nonzero() == np.count_nonzero(anp < 0.5)
+        assert np.array_equal(m.nonzero()[0], np.nonzero(anp < 0.5)[0])
+
+        n = lg.bitmask.greater_equal(a, b)
+        assert np.array_equal(n.unpack(), anp >= bnp)
+        assert np.array_equal((m & n).unpack(), (anp < 0.5) & (anp >= bnp))
+        assert np.array_equal((m | n).unpack(), (anp < 0.5) | (anp >= bnp))
+        assert np.array_equal((m ^ n).unpack(), (anp < 0.5) ^ (anp >= bnp))
+        # Inverting must not set any bits past the end of the mask
+        assert (~m).count_nonzero() == size - m.count_nonzero()
+        assert np.array_equal((~m).unpack(), anp >= 0.5)
+
+    # Multi-dimensional masks and packing existing arrays of bools
+    anp = np.random.randint(0, 10, size=(70, 90))
+    m = lg.bitmask.equal(lg.array(anp), 3)
+    assert m.shape == anp.shape
+    assert np.array_equal(m.unpack(), anp == 3)
+    for x, y in zip(m.nonzero(), np.nonzero(anp == 3)):
+        assert np.array_equal(x, y)
+    p = lg.bitmask.pack(lg.array(anp % 2 == 0))
+    assert p.count_nonzero() == np.count_nonzero(anp % 2 == 0)
+    assert not lg.bitmask.equal(lg.array(anp), 10).any()
+
+    # Broadcasting goes through an array of bools first
+    q = lg.bitmask.not_equal(lg.array(anp), lg.array(anp[0]))
+    assert np.array_equal(q.unpack(), anp != anp[0])
+
+    return
+
+
+if __name__ == "__main__":
+    test()
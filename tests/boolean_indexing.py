@@ -0,0 +1,51 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Filtering by predicates
+    anp = np.random.randn(100000)
+    a = lg.array(anp)
+    assert np.array_equal(a[a > 0.5], anp[anp > 0.5])
+    assert np.array_equal(a[a > 100.0], anp[anp > 100.0])
+    bnp = np.random.randint(0, 100, size=(300, 200))
+    b = lg.array(bnp)
+    assert np.array_equal(b[(b % 7) == 0], bnp[(bnp % 7) == 0])
+    cnp = np.random.rand(40, 50, 60).astype(np.float32)
+    c = lg.array(cnp)
+    masknp = np.random.rand(40, 50, 60) < 0.1
+    assert np.array_equal(c[lg.array(masknp)], cnp[masknp])
+
+    # Assigning a single value and one value for every set entry
+    a[a < 0.0] = 0.0
+    anp[anp < 0.0] = 0.0
+    assert np.array_equal(a, anp)
+    mask = (b % 3) == 1
+    masknp = (bnp % 3) == 1
+    b[mask] = -b[mask]
+    bnp[masknp] = -bnp[masknp]
+    assert np.array_equal(b, bnp)
+    c[c > 0.5] = np.float32(2)
+    cnp[cnp > 0.5] = np.float32(2)
+    assert np.array_equal(c, cnp)
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,63 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import tempfile
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    xnp = np.linspace(0.0, 1.0, 300 * 200).reshape(300, 200)
+    ynp = np.random.randint(0, 100, size=(10000,)).astype(np.int32)
+    znp = np.random.randn(7)
+    for compress in (False, True):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            x = lg.array(xnp)
+            y = lg.array(ynp)
+            lg.checkpoint(tmpdir, compress=compress, x=x, y=y[10:], z=znp, s=3)
+            data = lg.restore(tmpdir)
+            assert sorted(data) == ["s", "x", "y", "z"]
+            assert np.array_equal(data["x"], xnp)
+            assert data["y"].dtype == np.int32
+            assert np.array_equal(data["y"], ynp[10:])
+            assert np.array_equal(data["z"], znp)
+            assert data["s"] == 3
+
+            # A later checkpoint replaces the arrays in the directory
+            lg.checkpoint(tmpdir, compress=compress, x=x + 1)
+            data = lg.restore(tmpdir)
+            assert sorted(data) == ["x"]
+            assert np.array_equal(data["x"], xnp + 1)
+            # And it only keeps the files of the last one
+            assert sorted(os.listdir(tmpdir)) == ["gen1", "manifest.json"]
+
+            # A checkpoint that stops part way leaves the last one alone
+            os.makedirs(os.path.join(tmpdir, "gen2"))
+            with open(os.path.join(tmpdir, "gen2", "x.0_0"), "wb") as f:
+                f.write(b"partial")
+            data = lg.restore(tmpdir)
+            assert np.array_equal(data["x"], xnp + 1)
+            lg.checkpoint(tmpdir, compress=compress, y=y[10:])
+            data = lg.restore(tmpdir)
+            assert np.array_equal(data["y"], ynp[10:])
+
+    return
+
+
+if __name__ == "__main__":
+    test()
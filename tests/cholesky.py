@@ -0,0 +1,67 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Make something large enough to be split into several tiles
+    n = 600
+    xnp = np.random.randn(n, n)
+    anp = xnp @ xnp.T + n * np.eye(n)
+    a = lg.array(anp)
+
+    L = lg.linalg.cholesky(a)
+    assert np.allclose(np.linalg.cholesky(anp), L)
+
+    bnp = np.random.randn(n, 3)
+    b = lg.array(bnp)
+    y = lg.linalg.solve_triangular(L, b, lower=True)
+    x = lg.linalg.solve_triangular(L, y, lower=True, trans=True)
+    assert np.allclose(np.linalg.solve(anp, bnp), x)
+
+    cnp = np.random.randn(2000, 8)
+    dnp = np.random.randn(2000)
+    c = lg.array(cnp)
+    d = lg.array(dnp)
+    x, residuals, rank, _ = lg.linalg.lstsq(c, d)
+    xnp, residuals_np, rank_np, _ = np.linalg.lstsq(cnp, dnp, rcond=None)
+    assert np.allclose(xnp, x)
+    assert np.allclose(residuals_np, residuals)
+    assert rank == rank_np
+
+    # Complex input has no tiled kernels and goes through NumPy
+    znp = np.random.randn(50, 50) + 1j * np.random.randn(50, 50)
+    hnp = znp @ znp.conj().T + 50 * np.eye(50)
+    h = lg.array(hnp)
+    assert np.allclose(np.linalg.cholesky(hnp), lg.linalg.cholesky(h))
+    assert np.allclose(
+        np.linalg.solve(np.tril(hnp), bnp[:50]),
+        lg.linalg.solve_triangular(h, bnp[:50], lower=True),
+    )
+    x, residuals, rank, _ = lg.linalg.lstsq(lg.array(znp), d[:50])
+    assert np.allclose(np.linalg.lstsq(znp, dnp[:50], rcond=None)[0], x)
+    assert np.allclose(
+        np.linalg.norm(znp, "nuc"), lg.linalg.norm(lg.array(znp), "nuc")
+    )
+
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,70 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    anp = np.random.randn(1000)
+    bnp = np.random.randn(1000)
+    cnp = np.random.randn(1000)
+    a = lg.array(anp)
+    b = lg.array(bnp)
+    c = lg.array(cnp)
+
+    # Intermediates can be overwritten but named operands must not be
+    d = a * b + c
+    assert np.allclose(d, anp * bnp + cnp)
+    d = -(a - b) / (c * c + 1.0)
+    assert np.allclose(d, -(anp - bnp) / (cnp * cnp + 1.0))
+    d = 2.0 * (a + b) + 1.0 - c
+    assert np.allclose(d, 2.0 * (anp + bnp) + 1.0 - cnp)
+    d = 3.0 - (a * b)
+    assert np.allclose(d, 3.0 - anp * bnp)
+    d = a[10:20] * 2.0 + 1.0
+    assert np.allclose(d, anp[10:20] * 2.0 + 1.0)
+    assert np.array_equal(a, anp)
+    assert np.array_equal(b, bnp)
+    assert np.array_equal(c, cnp)
+
+    # Views of a temporary share its storage
+    e = a + b
+    f = e[:500]
+    g = e + 1.0
+    assert np.allclose(e, anp + bnp)
+    assert np.allclose(f, anp[:500] + bnp[:500])
+    assert np.allclose(g, anp + bnp + 1.0)
+
+    # Temporaries that broadcast or change type are never reused
+    xnp = np.random.randint(0, 10, size=(10, 100)).astype(np.int32)
+    x = lg.array(xnp)
+    row = lg.array(anp[:100])
+    assert np.allclose((x[:1] + 1) + row, (xnp[:1] + 1) + anp[:100])
+    assert np.allclose((x + 1) * 0.5, (xnp + 1) * 0.5)
+    assert np.array_equal((x + 1) * 2, (xnp + 1) * 2)
+    assert np.array_equal(x, xnp)
+
+    # Functions called from C code see no temporaries
+    total = sum([a, b, c])
+    assert np.allclose(total, anp + bnp + cnp)
+    assert np.array_equal(a, anp)
+
+    return
+
+
+if __name__ == "__main__":
+    test()
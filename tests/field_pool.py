@@ -0,0 +1,86 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+from legate.numpy.array import runtime
+
+
+def test_rounded_reuse():
+    before = lg.field_pool_statistics()
+    # Every size here is different but they all round up to 5120, so the
+    # only fields that can be reused are rounded ones
+    for step in range(128):
+        size = 4097 + 7 * step
+        a = lg.ones(size) * 2.0
+        assert np.isclose(a.sum(), 2.0 * size)
+        del a
+    after = lg.field_pool_statistics()
+    if runtime.max_field_pool_size > 0 and (
+        after["allocations"] > before["allocations"]
+    ):
+        assert after["rounded"] > before["rounded"]
+        assert after["reuses"] > before["reuses"]
+
+
+def test_eviction():
+    before = lg.field_pool_statistics()
+    # Shrink the budget so that freed regions cannot stay in the pool
+    budget = runtime.max_field_pool_size
+    runtime.max_field_pool_size = 1
+    try:
+        for step in range(64):
+            size = (1 << 16) + (1 << 14) * (step % 16)
+            a = lg.ones(size) * 2.0
+            assert np.isclose(a.sum(), 2.0 * size)
+            del a
+    finally:
+        runtime.max_field_pool_size = budget
+    after = lg.field_pool_statistics()
+    if budget > 0 and after["allocations"] > before["allocations"]:
+        assert after["evictions"] > before["evictions"]
+
+
+def test():
+    before = lg.field_pool_statistics()
+    # Shapes that drift a little on every step share size classes
+    for step in range(200):
+        size = 1000 + 3 * step
+        anp = np.random.randn(size)
+        a = lg.array(anp)
+        b = a * 2.0 + 1.0
+        assert np.allclose(b, anp * 2.0 + 1.0)
+        c = lg.ones((size, 3)) * a[:, np.newaxis]
+        assert np.allclose(c, np.ones((size, 3)) * anp[:, np.newaxis])
+        assert np.isclose(b.sum(), (anp * 2.0 + 1.0).sum())
+    after = lg.field_pool_statistics()
+    for key, value in after.items():
+        assert value >= 0
+    assert after["high_water"] >= after["bytes_in_use"] + after["bytes_held"]
+    assert after["high_water"] >= before["high_water"]
+    # Any fields that we made should have been rounded up to a size class
+    # and reused by the sizes that came after them in that class
+    if after["allocations"] > before["allocations"]:
+        assert after["reuses"] > before["reuses"]
+        if runtime.max_field_pool_size > 0:
+            assert after["rounded"] > before["rounded"]
+    test_rounded_reuse()
+    test_eviction()
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,79 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+from legate.numpy.config import NumPyOpCode
+from legate.numpy.fusion import FusedProgram, evaluate
+
+
+def gaussian(dtype):
+    # exp(-x * x / 2) * c + d
+    program = FusedProgram(dtype)
+    x = program.input()
+    c = program.input()
+    d = program.input()
+    xx = program.apply(NumPyOpCode.MULTIPLY, x, x)
+    half = program.apply(NumPyOpCode.DIVIDE, xx, program.constant(2))
+    e = program.apply(
+        NumPyOpCode.EXP, program.apply(NumPyOpCode.NEGATIVE, half)
+    )
+    ec = program.apply(NumPyOpCode.MULTIPLY, e, c)
+    program.apply(NumPyOpCode.ADD, ec, d)
+    return program
+
+
+def test():
+    for dtype in (np.float32, np.float64):
+        for shape in ((1,), (1000,), (37, 41)):
+            xnp = np.random.randn(*shape).astype(dtype)
+            cnp = np.random.randn(*shape).astype(dtype)
+            dnp = np.random.randn(*shape).astype(dtype)
+            result = evaluate(
+                gaussian(dtype), [lg.array(xnp), lg.array(cnp), lg.array(dnp)]
+            )
+            assert result.dtype == dtype
+            assert np.allclose(result, np.exp(-xnp * xnp / 2) * cnp + dnp)
+
+    # Comparisons select with where, like the cumulative normal of
+    # black scholes
+    anp = np.random.randn(10000)
+    program = FusedProgram(np.float64)
+    d = program.input()
+    positive = program.apply(NumPyOpCode.GREATER, d, program.constant(0))
+    flipped = program.apply(NumPyOpCode.SUBTRACT, program.constant(1), d)
+    program.apply(NumPyOpCode.WHERE, positive, flipped, d)
+    result = evaluate(program, [lg.array(anp)])
+    assert np.allclose(result, np.where(anp > 0, 1 - anp, anp))
+
+    # Integers and inputs that are not dense
+    inp = np.random.randint(-100, 100, size=(60, 80)).astype(np.int32)
+    program = FusedProgram(np.int32)
+    x = program.input()
+    y = program.input()
+    biggest = program.apply(NumPyOpCode.MAXIMUM, x, y)
+    program.apply(NumPyOpCode.MULTIPLY, biggest, program.constant(3))
+    a = lg.array(inp)
+    result = evaluate(program, [a[:30, 1:41], a[30:, 40:]])
+    assert np.array_equal(
+        result, np.maximum(inp[:30, 1:41], inp[30:, 40:]) * 3
+    )
+
+    return
+
+
+if __name__ == "__main__":
+    test()
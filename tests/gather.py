@@ -0,0 +1,73 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Looking up the rows of an embedding table
+    tablenp = np.random.rand(1000, 16)
+    table = lg.array(tablenp)
+    idxnp = np.random.randint(-1000, 1000, size=(5000,))
+    idx = lg.array(idxnp)
+    assert np.array_equal(table[idx], tablenp[idxnp])
+    batchnp = idxnp.reshape(50, 100).astype(np.int32)
+    batch = lg.array(batchnp)
+    assert np.array_equal(table[batch], tablenp[batchnp])
+
+    # Vectors and arrays with more dimensions
+    xnp = np.arange(10000, dtype=np.int64)
+    x = lg.array(xnp)
+    assert np.array_equal(x[idx], xnp[idxnp])
+    ynp = np.random.rand(100, 8, 4).astype(np.float32)
+    y = lg.array(ynp)
+    rows = np.array([99, 0, 0, -3, 50])
+    assert np.array_equal(y[lg.array(rows)], ynp[rows])
+
+    # Adding into the rows with repeated indices
+    gradnp = np.random.rand(5000, 16)
+    grad = lg.array(gradnp)
+    lg.add.at(table, idx, grad)
+    np.add.at(tablenp, idxnp, gradnp)
+    assert np.allclose(table, tablenp)
+    lg.add.at(x, idx, 1)
+    np.add.at(xnp, idxnp, 1)
+    assert np.array_equal(x, xnp)
+    lg.add.at(y, rows, np.ones((8, 4), dtype=np.float32))
+    np.add.at(ynp, rows, np.ones((8, 4), dtype=np.float32))
+    assert np.allclose(y, ynp)
+
+    # Indices past either end raise before anything runs
+    for bad in (1000, -1001):
+        badnp = idxnp.copy()
+        badnp[1234] = bad
+        for func in (
+            lambda: table[lg.array(badnp)],
+            lambda: lg.add.at(table, lg.array(badnp), grad),
+        ):
+            try:
+                func()
+            except IndexError:
+                pass
+            else:
+                assert False
+    assert np.allclose(table, tablenp)
+    return
+
+
+if __name__ == "__main__":
+    test()
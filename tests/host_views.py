@@ -0,0 +1,51 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    anp = np.random.randn(1000, 1000)
+    a = lg.array(anp) * 2
+
+    # Back to back calls into NumPy share the same mapping
+    x = np.asarray(a)
+    y = np.asarray(a)
+    assert np.shares_memory(x, y)
+    assert np.allclose(x, anp * 2)
+    del x, y
+
+    # Changes the host makes show up in the next operation
+    np.asarray(a)[500:510] = 1.0
+    bnp = anp * 2
+    bnp[500:510] = 1.0
+    assert np.allclose(lg.sum(a), bnp.sum())
+
+    # And changes from operations show up in the next view
+    a += 1
+    assert np.allclose(np.asarray(a), bnp + 1)
+
+    # Views of slices work the same way
+    np.asarray(a[10:20, 5:15])[:] = 0.0
+    bnp[10:20, 5:15] = -1.0
+    assert np.allclose(lg.sum(a), (bnp + 1).sum())
+
+    return
+
+
+if __name__ == "__main__":
+    test()
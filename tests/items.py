@@ -0,0 +1,101 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Loops that set boundary values one point at a time
+    anp = np.zeros((100, 80))
+    a = lg.array(anp)
+    for i in range(100):
+        a[i, 0] = -1.0
+        a[i, 79] = float(i)
+        anp[i, 0] = -1.0
+        anp[i, 79] = float(i)
+    for j in range(80):
+        a[0, j] = 2.0
+        anp[0, j] = 2.0
+    # Later writes to the same point win
+    a[5, 5] = 1.0
+    a[5, 5] = 3.0
+    anp[5, 5] = 3.0
+    assert np.array_equal(a, anp)
+    # Also when some of them go through a view
+    a[5, 5] = 1.0
+    v = a[5:]
+    v[0, 5] = 2.0
+    a[5, 5] = 3.0
+    assert float(a[5, 5]) == 3.0
+    v[0, 6] = 4.0
+    anp[5, 6] = 4.0
+    assert np.array_equal(a, anp)
+
+    # Reading a single point after writing it
+    b = lg.arange(1000, dtype=np.int64)
+    b[10] = -5
+    assert int(b[10]) == -5
+    b[20] = 7
+    c = b + 1
+    assert int(c[20]) == 8
+    bnp = np.arange(1000, dtype=np.int64)
+    bnp[10] = -5
+    bnp[20] = 7
+    assert np.array_equal(b, bnp)
+
+    # Operations recorded before a write see the old value
+    xnp = np.random.rand(1000)
+    x = lg.array(xnp)
+    y = x * 2.0
+    x[3] = 100.0
+    z = x * 2.0
+    assert np.allclose(y, xnp * 2.0)
+    xnp[3] = 100.0
+    assert np.allclose(z, xnp * 2.0)
+
+    # Reading and writing lists of points
+    rows = np.array([0, 99, 50, 3, 3, -1])
+    cols = np.array([0, 79, 40, 7, 8, -2])
+    assert np.array_equal(a[rows, cols], anp[rows, cols])
+    assert np.array_equal(a[lg.array(rows), lg.array(cols)], anp[rows, cols])
+    a[rows, cols] = np.arange(6, dtype=np.float64)
+    anp[rows, cols] = np.arange(6, dtype=np.float64)
+    assert np.array_equal(a, anp)
+    a[rows, cols] = 9.0
+    anp[rows, cols] = 9.0
+    assert np.array_equal(a, anp)
+    dnp = np.random.randint(0, 100, size=(20, 30, 40))
+    d = lg.array(dnp)
+    pts = tuple(np.random.randint(0, n, size=(50,)) for n in dnp.shape)
+    assert np.array_equal(d[pts], dnp[pts])
+    # Wide enough to be split along the last axis as well, so that the
+    # buffer for the values has several pieces along that axis
+    wnp = np.random.rand(8, 100000)
+    w = lg.array(wnp)
+    pts = (
+        np.random.randint(0, 8, size=(500,)),
+        np.random.randint(0, 100000, size=(500,)),
+    )
+    assert np.array_equal(w[pts], wnp[pts])
+    w[pts] = -1.0
+    wnp[pts] = -1.0
+    assert np.array_equal(w, wnp)
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,91 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+# These exercise the expressions of lazy arrays when run with -lg:numpy:lazy
+# and have to give the same answers without it
+
+
+def test():
+    xnp = np.random.randn(1000)
+    ynp = np.random.randn(1000)
+    x = lg.array(xnp)
+    y = lg.array(ynp)
+
+    # A chain with a trailing sum
+    znp = np.exp(-xnp * xnp / 2.0) * ynp + 1.0
+    z = lg.exp(-x * x / 2.0) * y + 1.0
+    assert np.allclose(z, znp)
+    snp = (np.sin(xnp) * ynp - xnp).sum()
+    assert np.isclose((lg.sin(x) * y - x).sum(), snp)
+
+    # Intermediates that stay alive are computed once and shared
+    t = x * y
+    u = t + x
+    v = t - y
+    assert np.allclose(u, xnp * ynp + xnp)
+    assert np.allclose(v, xnp * ynp - ynp)
+    assert np.allclose(t, xnp * ynp)
+
+    # Writes to an operand after the expression has to leave its values
+    w = x * 3.0 + y
+    x[0] = 100.0
+    x[1:10] = lg.zeros(9)
+    assert np.allclose(w, xnp * 3.0 + ynp)
+    xnp[0] = 100.0
+    xnp[1:10] = 0.0
+    assert np.allclose(x, xnp)
+
+    # Summing an array that is still alive and then reading it
+    s = lg.sqrt(lg.absolute(y)) * 2.0
+    assert np.isclose(s.sum(), (np.sqrt(np.abs(ynp)) * 2.0).sum())
+    assert np.allclose(s, np.sqrt(np.abs(ynp)) * 2.0)
+
+    # Control flow on values of an expression
+    if ((x - x) + 1.0).sum() > 0:
+        pass
+    else:
+        assert False
+    assert float((x * 0.0 + 2.0)[5]) == 2.0
+
+    # In-place updates of a pending array, views and long chains
+    anp = np.random.randn(40, 50).astype(np.float32)
+    a = lg.array(anp)
+    b = a + a
+    b += 1.0
+    bnp = anp + anp + 1.0
+    assert np.allclose(b, bnp)
+    c = a[5:25, 10:40] * 2.0 - 1.0
+    assert np.allclose(c, anp[5:25, 10:40] * 2.0 - 1.0)
+    d = a
+    dnp = anp
+    for _ in range(100):
+        d = d * 0.5 + 0.25
+        dnp = dnp * np.float32(0.5) + np.float32(0.25)
+    assert np.allclose(d, dnp)
+    assert np.isclose(d.sum(), dnp.sum(), rtol=1e-4)
+
+    # Operations that do not fuse still see the values of lazy operands
+    e = x * 2.0
+    assert np.allclose(lg.dot(e, y), np.dot(xnp * 2.0, ynp))
+    assert np.allclose(e > 0.0, xnp * 2.0 > 0.0)
+    return
+
+
+if __name__ == "__main__":
+    test()
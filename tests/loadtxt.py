@@ -0,0 +1,73 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import tempfile
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "a.txt")
+        anp = np.random.randn(20000, 7)
+
+        # Whitespace separated floats
+        np.savetxt(path, anp)
+        assert np.array_equal(lg.loadtxt(path), np.loadtxt(path))
+
+        # Headers, comments, blank lines and other delimiters
+        with open(path, "w") as f:
+            f.write("a,b,c\n")
+            for i, row in enumerate(anp[:, :3]):
+                if i % 100 == 0:
+                    f.write("# comment\n\n")
+                f.write("%.17g, %.17g,%.17g # note\n" % tuple(row))
+        expected = np.loadtxt(path, delimiter=",", skiprows=1)
+        assert np.array_equal(
+            lg.loadtxt(path, delimiter=",", skiprows=1), expected
+        )
+        expected = np.loadtxt(
+            path, dtype=np.float32, delimiter=",", skiprows=1
+        )
+        assert np.array_equal(
+            lg.loadtxt(path, dtype=np.float32, delimiter=",", skiprows=1),
+            expected,
+        )
+
+        # Integers and single columns
+        bnp = np.random.randint(-1000000, 1000000, size=(30000,))
+        np.savetxt(path, bnp, fmt="%d")
+        for dtype in (np.int32, np.int64):
+            a = lg.loadtxt(path, dtype=dtype)
+            assert a.dtype == np.dtype(dtype)
+            assert np.array_equal(a, bnp)
+        assert lg.loadtxt(path, ndmin=2).shape == (30000, 1)
+
+        # Arguments that we leave to NumPy
+        assert np.array_equal(
+            lg.loadtxt(path, max_rows=10), np.loadtxt(path, max_rows=10)
+        )
+        assert np.array_equal(
+            lg.loadtxt(path, converters={0: float}), bnp.astype(float)
+        )
+
+    return
+
+
+if __name__ == "__main__":
+    test()
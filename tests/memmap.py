@@ -0,0 +1,58 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import tempfile
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "a.dat")
+        anp = np.random.randn(300, 400)
+        anp.tofile(path)
+
+        # Read-only and copy-on-write mappings leave the file alone
+        a = lg.memmap(path, dtype=np.float64, mode="r", shape=(300, 400))
+        assert np.allclose(a.sum(), anp.sum())
+        c = lg.memmap(path, dtype=np.float64, mode="c", shape=(300, 400))
+        c[:] = c * 2
+        assert np.allclose(c, anp * 2)
+        del c
+        assert np.array_equal(np.fromfile(path).reshape(300, 400), anp)
+
+        # Writable mappings are updated in place
+        b = lg.memmap(path, dtype=np.float64, mode="r+", shape=(300, 400))
+        b += 1
+        assert np.allclose(b, anp + 1)
+
+        # Offsets and inferred shapes work like they do for NumPy
+        d = lg.memmap(path, dtype=np.float64, mode="r", offset=800)
+        assert d.shape == (300 * 400 - 100,)
+
+        # Mapped .npy files
+        path = os.path.join(tmpdir, "b.npy")
+        np.save(path, anp)
+        e = lg.load(path, mmap_mode="r")
+        assert np.array_equal(e, anp)
+
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -31,18 +31,71 @@ def test():
     )
     assert np.allclose(np.linalg.norm(anp, ord=0), lg.linalg.norm(a, ord=0))
     assert np.allclose(np.linalg.norm(anp, ord=1), lg.linalg.norm(a, ord=1))
-    # assert(np.allclose(np.linalg.norm(anp, ord=-1), lg.linalg.norm(a, ord=-1))) # noqa E501
     assert np.allclose(np.linalg.norm(anp, ord=2), lg.linalg.norm(a, ord=2))
-    # assert(np.allclose(np.linalg.norm(anp, ord=-2), lg.linalg.norm(a, ord=-2))) # noqa E501
-
-    # bnp = np.random.randn(4,5)
-    # b = lg.array(bnp)
-    # assert(np.allclose(np.linalg.norm(bnp, 'fro'), lg.linalg.norm(b, 'fro')))
-    # assert(np.allclose(np.linalg.norm(bnp, 'nuc'), lg.linalg.norm(b, 'nuc')))
-    # assert(np.allclose(np.linalg.norm(bnp, np.inf), lg.linalg.norm(b, lg.inf))) # noqa E501
-    # assert(np.allclose(np.linalg.norm(bnp, -np.inf), lg.linalg.norm(b, -lg.inf))) # noqa E501
-    # assert(np.allclose(np.linalg.norm(bnp, 1), lg.linalg.norm(b, 1)))
-    # assert(np.allclose(np.linalg.norm(bnp, -1), lg.linalg.norm(b, -1)))
+    assert np.allclose(np.linalg.norm(anp, ord=-2), lg.linalg.norm(a, ord=-2))
+
+    assert np.allclose(np.linalg.norm(anp, ord=3), lg.linalg.norm(a, ord=3))
+    assert np.allclose(
+        np.linalg.norm(anp, ord=0.5), lg.linalg.norm(a, ord=0.5)
+    )
+    assert np.allclose(
+        np.linalg.norm(anp, ord=2.5), lg.linalg.norm(a, ord=2.5)
+    )
+    assert np.allclose(np.linalg.norm(anp, ord=-1), lg.linalg.norm(a, ord=-1))
+
+    # Fractional orders of types without a pow kernel
+    for dtype in (np.float16, np.int32, np.complex64):
+        dnp = (anp * 4).astype(dtype)
+        d = lg.array(dnp)
+        assert np.allclose(
+            np.linalg.norm(dnp, ord=1.5), lg.linalg.norm(d, ord=1.5), rtol=1e-3
+        )
+
+    # Squaring these directly would overflow or underflow
+    for scale in (1e200, 1e-200):
+        cnp = anp * scale
+        c = lg.array(cnp)
+        assert np.allclose(
+            np.linalg.norm(cnp) / scale, lg.linalg.norm(c) / scale
+        )
+
+    # Infinities in several pieces and NaNs next to zeros or infinities
+    for special in ([np.inf] * 2, [0.0, np.nan], [np.inf, np.nan]):
+        snp = np.zeros(1000)
+        snp[:: 1000 // len(special)] = special
+        s = lg.array(snp)
+        assert np.array_equal(
+            np.linalg.norm(snp), lg.linalg.norm(s), equal_nan=True
+        )
+    # An empty array still has a norm
+    assert np.linalg.norm(np.zeros(0)) == lg.linalg.norm(lg.zeros(0))
+
+    bnp = np.random.randn(4, 5)
+    b = lg.array(bnp)
+    assert np.allclose(np.linalg.norm(bnp), lg.linalg.norm(b))
+    assert np.allclose(np.linalg.norm(bnp, "fro"), lg.linalg.norm(b, "fro"))
+    assert np.allclose(np.linalg.norm(bnp, "nuc"), lg.linalg.norm(b, "nuc"))
+    assert np.allclose(np.linalg.norm(bnp, 2), lg.linalg.norm(b, 2))
+    assert np.allclose(np.linalg.norm(bnp, -2), lg.linalg.norm(b, -2))
+    assert np.allclose(np.linalg.norm(bnp, np.inf), lg.linalg.norm(b, lg.inf))
+    assert np.allclose(
+        np.linalg.norm(bnp, -np.inf), lg.linalg.norm(b, -lg.inf)
+    )
+    assert np.allclose(np.linalg.norm(bnp, 1), lg.linalg.norm(b, 1))
+    assert np.allclose(np.linalg.norm(bnp, -1), lg.linalg.norm(b, -1))
+    inp = (bnp * 10).astype(np.int64)
+    i = lg.array(inp)
+    assert np.allclose(np.linalg.norm(inp, "fro"), lg.linalg.norm(i, "fro"))
+    assert np.allclose(np.linalg.norm(inp), lg.linalg.norm(i))
+    enp = np.random.randn(3, 4, 5)
+    e = lg.array(enp)
+    assert np.allclose(np.linalg.norm(enp), lg.linalg.norm(e))
+    for axis in (0, 1):
+        for ord in (None, 1, 3, 0.5):
+            assert np.allclose(
+                np.linalg.norm(bnp, ord=ord, axis=axis),
+                lg.linalg.norm(b, ord=ord, axis=axis),
+            )
 
     return
 
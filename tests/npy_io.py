@@ -0,0 +1,63 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import tempfile
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "a.npy")
+        for shape in ((1000,), (100, 37), (20, 30, 40)):
+            for dtype in (np.int32, np.float32, np.float64):
+                anp = np.arange(np.prod(shape), dtype=dtype).reshape(shape)
+
+                # Files written by NumPy load in parallel
+                np.save(path, anp)
+                a = lg.load(path)
+                assert a.dtype == anp.dtype
+                assert np.array_equal(a, anp)
+
+                # And the other way around
+                lg.save(path, lg.array(anp) + 1)
+                assert np.array_equal(np.load(path), anp + 1)
+
+        # Fortran-ordered files hold the transpose in C order
+        bnp = np.asfortranarray(np.random.randn(50, 60))
+        np.save(path, bnp)
+        assert np.array_equal(lg.load(path), bnp)
+
+        # Saving a smaller array over a bigger one cuts the file down
+        lg.save(path, lg.ones((10, 10)))
+        assert np.array_equal(np.load(path), np.ones((10, 10)))
+
+        # Stored archive members are read in place, compressed ones are not
+        for savez in (np.savez, np.savez_compressed):
+            npz = os.path.join(tmpdir, "b.npz")
+            savez(npz, x=np.arange(100), y=bnp)
+            with lg.load(npz) as data:
+                assert sorted(data.files) == ["x", "y"]
+                assert np.array_equal(data["x"], np.arange(100))
+                assert np.array_equal(data["y"], bnp)
+
+    return
+
+
+if __name__ == "__main__":
+    test()
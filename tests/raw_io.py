@@ -0,0 +1,57 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import tempfile
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "a.bin")
+        for dtype in (np.int16, np.float32, np.float64):
+            anp = np.arange(10000, dtype=dtype).reshape(100, 100)
+
+            # Raw files round trip with NumPy in both directions
+            lg.array(anp).tofile(path)
+            assert np.array_equal(np.fromfile(path, dtype=dtype), anp.ravel())
+            anp.tofile(path)
+            a = lg.fromfile(path, dtype=dtype)
+            assert np.array_equal(a, anp.ravel())
+
+            # Offsets and counts
+            itemsize = np.dtype(dtype).itemsize
+            b = lg.fromfile(path, dtype=dtype, offset=10 * itemsize)
+            assert np.array_equal(b, anp.ravel()[10:])
+            c = lg.fromfile(path, dtype=dtype, count=500, offset=itemsize)
+            assert np.array_equal(c, anp.ravel()[1:501])
+
+        # Writing a view writes its elements in C order
+        anp = np.random.randn(60, 80)
+        lg.array(anp)[10:50, 20:70].tofile(path)
+        assert np.array_equal(np.fromfile(path), anp[10:50, 20:70].ravel())
+
+        # Text files still go through NumPy
+        lg.array(anp).tofile(path, sep=",")
+        assert np.allclose(lg.fromfile(path, sep=","), anp.ravel())
+
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,64 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    anp = np.random.rand(100)
+    a = lg.array(anp)
+    snp = anp.sum()
+    tnp = anp.max()
+    s = a.sum()
+    t = a.max()
+
+    # Short chains like the updates of a solver
+    alpha = s / (t * t)
+    alphanp = snp / (tnp * tnp)
+    assert np.isclose(-alpha, -alphanp)
+    assert np.isclose(lg.sqrt(alpha) - 1.0, np.sqrt(alphanp) - 1.0)
+    assert bool(alpha > 0.0)
+
+    # Chains that are longer than one program
+    x = s
+    xnp = snp
+    for _ in range(50):
+        x = x * 0.5 + t
+        xnp = xnp * 0.5 + tnp
+    assert np.isclose(x, xnp)
+
+    # Buffered values do not see later writes to their operands
+    y = s + 0.0
+    z = y * 2.0
+    y += 1.0
+    assert np.isclose(z, snp * 2.0)
+    assert np.isclose(y, snp + 1.0)
+
+    # Scalars feeding array operations
+    b = a * alpha + lg.maximum(s, t)
+    assert np.allclose(b, anp * alphanp + max(snp, tnp))
+
+    # Integer chains
+    cnp = np.arange(10, dtype=np.int64)
+    c = lg.array(cnp)
+    n = c.sum()
+    assert int((n * 3 - 5) // 1) == (cnp.sum() * 3 - 5)
+    return
+
+
+if __name__ == "__main__":
+    test()
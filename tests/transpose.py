@@ -13,6 +13,8 @@
 # limitations under the License.
 #
 
+import numpy as np
+
 import legate.numpy as lg
 
 
@@ -28,6 +30,11 @@ def test():
     assert lg.array_equal(y, [[1, 4, 7], [2, 5, 8], [3, 6, 9]])
     z = lg.transpose(y)
     assert lg.array_equal(x, z)
+
+    a = np.arange(2 * 3 * 4 * 5).reshape(2, 3, 4, 5)
+    x = lg.array(a)
+    for axes in [None, (0, 2, 1, 3), (3, 1, 2, 0), (1, -1, 0, 2)]:
+        assert lg.array_equal(lg.transpose(x, axes), np.transpose(a, axes))
     return
 
 
@@ -15,10 +15,18 @@
 
 from __future__ import absolute_import
 
-from .clip_tests import inplace_normal, normal, scalar
+from .clip_tests import (
+    broadcast,
+    inplace_broadcast,
+    inplace_normal,
+    normal,
+    scalar,
+)
 
 
 def test():
+    broadcast.test()
+    inplace_broadcast.test()
     inplace_normal.test()
     normal.test()
     scalar.test()
@@ -0,0 +1,40 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    np.random.seed(13)
+    anp = 20.0 * np.random.randn(40, 50) + 10.0
+    a = lg.array(anp)
+    lonp = -10.0 * np.random.rand(50)
+    lo = lg.array(lonp)
+
+    # test clip in place with bounds that broadcast against the array
+    lg.clip(a, lo, 5.0, out=a)
+    np.clip(anp, lonp, 5.0, out=anp)
+    assert np.array_equal(a, anp)
+    lg.clip(a, None, -lo, out=a)
+    np.clip(anp, None, -lonp, out=anp)
+    assert np.array_equal(a, anp)
+
+    return
+
+
+if __name__ == "__main__":
+    test()
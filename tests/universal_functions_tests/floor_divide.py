@@ -19,6 +19,7 @@ from .floor_divide_tests import (
     broadcast,
     inplace_broadcast,
     inplace_normal,
+    int_broadcast,
     normal,
     operator_inplace_broadcast,
     operator_inplace_normal,
@@ -31,6 +32,7 @@ def test():
     broadcast.test()
     inplace_broadcast.test()
     inplace_normal.test()
+    int_broadcast.test()
     normal.test()
     operator_normal.test()
     operator_inplace_broadcast.test()
@@ -0,0 +1,81 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Integer division and bucketing by a scalar for every width
+    for dtype in (np.int16, np.int32, np.int64, np.uint16, np.uint32):
+        info = np.iinfo(dtype)
+        anp = np.random.randint(0, info.max, size=(100, 30), dtype=dtype)
+        a = lg.array(anp)
+        for b in (1, 3, 7, 64, 1000, info.max):
+            b = dtype(b)
+            assert np.array_equal(lg.floor_divide(a, b), anp // b)
+            assert np.array_equal(a % b, anp % b)
+    anp = np.random.randint(0, 2 ** 63, size=(1000,), dtype=np.uint64)
+    a = lg.array(anp)
+    for b in (np.uint64(1), np.uint64(10 ** 9 + 7), np.uint64(2 ** 63 + 1)):
+        assert np.array_equal(a // b, anp // b)
+        assert np.array_equal(a % b, anp % b)
+
+    # Negative dividends and divisors truncate toward zero like the
+    # kernel that divides by a whole array does
+    for dtype in (np.int16, np.int32, np.int64):
+        info = np.iinfo(dtype)
+        anp = np.random.randint(info.min + 1, info.max, size=(1000,))
+        anp = anp.astype(dtype)
+        anp[:4] = (info.min + 1, -1, 0, info.max)
+        a = lg.array(anp)
+        for b in (-1, -3, -7, -64, -1000, info.min, info.max):
+            b = dtype(b)
+            assert np.array_equal(
+                lg.floor_divide(a, b), lg.floor_divide(a, lg.full_like(a, b))
+            )
+        # The smallest value divided by -1 wraps around to itself
+        m = lg.full((100,), info.min, dtype=dtype)
+        assert np.array_equal(
+            lg.floor_divide(m, dtype(-1)), np.full((100,), info.min, dtype)
+        )
+        for b in (1, 3, -3, info.min):
+            b = dtype(b)
+            assert np.array_equal(
+                lg.floor_divide(m, b), lg.floor_divide(m, lg.full_like(m, b))
+            )
+
+    # Dividing by a scalar zero gives zero for both, like NumPy
+    for dtype in (np.int16, np.int32, np.int64, np.uint32, np.uint64):
+        znp = np.arange(-50, 50).astype(dtype)
+        z = lg.array(znp)
+        zero = dtype(0)
+        with np.errstate(divide="ignore"):
+            assert np.array_equal(lg.floor_divide(z, zero), znp // zero)
+            assert np.array_equal(z % zero, znp % zero)
+            z //= zero
+            znp //= zero
+        assert np.array_equal(z, znp)
+
+    # In place
+    a //= np.uint64(12345)
+    anp //= np.uint64(12345)
+    assert np.array_equal(a, anp)
+    return
+
+
+if __name__ == "__main__":
+    test()
@@ -21,6 +21,7 @@ from .power_tests import (
     inplace_normal,
     normal,
     scalar,
+    special_broadcast,
 )
 
 
@@ -30,6 +31,7 @@ def test():
     inplace_normal.test()
     normal.test()
     scalar.test()
+    special_broadcast.test()
 
 
 if __name__ == "__main__":
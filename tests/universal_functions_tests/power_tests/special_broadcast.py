@@ -0,0 +1,75 @@
+# Copyright 2021 NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+
+import legate.numpy as lg
+
+
+def test():
+    # Whole and half exponents of floating point bases
+    for dtype in (np.float32, np.float64):
+        anp = (np.random.rand(40, 50) + 0.5).astype(dtype)
+        a = lg.array(anp)
+        for b in (0, 1, 2, 3, -1, 0.5, -0.5, 1.5, -2.5, 7, 16.5, 0.3):
+            b = dtype(b)
+            assert lg.allclose(lg.power(a, b), np.power(anp, b))
+        a **= dtype(2)
+        anp **= dtype(2)
+        assert lg.allclose(a, anp)
+
+    # Zeros, infinities and NaNs come out of the chains like they do
+    # out of pow, including the sign of zero
+    cnp = np.array([-0.0, 0.0, np.inf, -np.inf, np.nan, -2.0, 2.0, 0.25])
+    c = lg.array(cnp)
+    with np.errstate(all="ignore"):
+        for b in (0.5, -0.5, 1.5, -1.5, 2.5, -2.5, 2, -2, 3, -3):
+            expected = np.power(cnp, b)
+            result = np.asarray(lg.power(c, np.float64(b)))
+            assert np.array_equal(result, expected, equal_nan=True)
+            assert np.array_equal(np.signbit(result), np.signbit(expected))
+
+    # Integer bases are exact, including negative ones
+    for dtype in (np.int16, np.int32, np.int64, np.uint32):
+        low = 0 if np.issubdtype(dtype, np.unsignedinteger) else -8
+        anp = np.random.randint(low, 8, size=(1000,)).astype(dtype)
+        a = lg.array(anp)
+        for b in (0, 1, 2, 3, 4, 5):
+            b = dtype(b)
+            assert np.array_equal(lg.power(a, b), np.power(anp, b))
+        a **= dtype(3)
+        anp **= dtype(3)
+        assert np.array_equal(a, anp)
+
+    # Overflow wraps around like it does in NumPy
+    for dtype in (np.int16, np.int32, np.int64, np.uint32):
+        anp = np.random.randint(1000, 3000, size=(1000,)).astype(dtype)
+        a = lg.array(anp)
+        for b in (2, 3, 7, 13):
+            b = dtype(b)
+            assert np.array_equal(lg.power(a, b), np.power(anp, b))
+
+    # Large results that still fit are exact, well beyond what a double
+    # can hold
+    anp = np.array([3, -3, 2, -2, 7], dtype=np.int64)
+    a = lg.array(anp)
+    for b in (39, 62, 22):
+        b = np.int64(b)
+        assert np.array_equal(lg.power(a, b), np.power(anp, b))
+    return
+
+
+if __name__ == "__main__":
+    test()
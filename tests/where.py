@@ -39,6 +39,33 @@ def test():
     y = lg.array(ynp)
     assert np.array_equal(np.where(anp, xnp, ynp), lg.where(a, x, y))
 
+    # Scalars and rows broadcast against the mask without copies
+    masknp = np.random.rand(50, 40) < 0.5
+    matnp = np.random.rand(50, 40)
+    rownp = np.random.rand(40)
+    mask = lg.array(masknp)
+    mat = lg.array(matnp)
+    row = lg.array(rownp)
+    assert np.array_equal(
+        lg.where(mask, mat, 0.0), np.where(masknp, matnp, 0.0)
+    )
+    assert np.array_equal(
+        lg.where(mask, 1.0, mat), np.where(masknp, 1.0, matnp)
+    )
+    assert np.array_equal(
+        lg.where(mask, row, mat), np.where(masknp, rownp, matnp)
+    )
+    assert np.array_equal(
+        lg.where(mask, 1.0, row), np.where(masknp, 1.0, rownp)
+    )
+    assert np.array_equal(
+        lg.where(True, row, mat), np.where(True, rownp, matnp)
+    )
+    assert np.array_equal(
+        lg.where(False, 1.0, mat), np.where(False, 1.0, matnp)
+    )
+    return
+
 
 if __name__ == "__main__":
     test()